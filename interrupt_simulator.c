@@ -1,482 +1,27 @@
 #define _GNU_SOURCE
 #include "interrupt_simulator.h"
-
-// Tabla de Descriptores de Interrupción (IDT)
-irq_descriptor_t idt[MAX_INTERRUPTS];
-
-// Sistema de trazabilidad
-trace_entry_t trace_log[MAX_TRACE_LINES];
-int trace_index = 0;
-
-// Variables globales del sistema
-int system_running = 1;
-int timer_counter = 0;
-pthread_t timer_thread;
-pthread_mutex_t idt_mutex = PTHREAD_MUTEX_INITIALIZER;
-pthread_mutex_t trace_mutex = PTHREAD_MUTEX_INITIALIZER;
-system_stats_t stats;
-
-// Variables globales adicionales
-log_level_t current_log_level = LOG_LEVEL_USER_ONLY;  // Por defecto, solo acciones del usuario
-int show_timer_logs = 0;  // Timer logs ocultos por defecto
-
-
-// Función para obtener timestamp
-void get_timestamp(char *buffer, size_t size) {
-    time_t rawtime;
-    struct tm *timeinfo;
-    time(&rawtime);
-    timeinfo = localtime(&rawtime);
-    strftime(buffer, size, "%H:%M:%S", timeinfo);
-}
-
-// Función para agregar entrada a la traza (thread-safe)
-void add_trace(const char *event) {
-    pthread_mutex_lock(&trace_mutex);
-    get_timestamp(trace_log[trace_index].timestamp, sizeof(trace_log[trace_index].timestamp));
-    strncpy(trace_log[trace_index].event, event, sizeof(trace_log[trace_index].event) - 1);
-    trace_log[trace_index].event[sizeof(trace_log[trace_index].event) - 1] = '\0';
-    trace_log[trace_index].irq_num = -1;
-    trace_index = (trace_index + 1) % MAX_TRACE_LINES;
-    pthread_mutex_unlock(&trace_mutex);
-    
-    printf("[%s] %s\n", trace_log[(trace_index - 1 + MAX_TRACE_LINES) % MAX_TRACE_LINES].timestamp, event);
-    fflush(stdout);
-}
-
-// Función para agregar entrada a la traza con IRQ específico (thread-safe)
-void add_trace_with_irq(const char *event, int irq_num) {
-    pthread_mutex_lock(&trace_mutex);
-    get_timestamp(trace_log[trace_index].timestamp, sizeof(trace_log[trace_index].timestamp));
-    strncpy(trace_log[trace_index].event, event, sizeof(trace_log[trace_index].event) - 1);
-    trace_log[trace_index].event[sizeof(trace_log[trace_index].event) - 1] = '\0';
-    trace_log[trace_index].irq_num = irq_num;
-    trace_index = (trace_index + 1) % MAX_TRACE_LINES;
-    pthread_mutex_unlock(&trace_mutex);
-    
-    printf("[%s] %s\n", trace_log[(trace_index - 1 + MAX_TRACE_LINES) % MAX_TRACE_LINES].timestamp, event);
-    fflush(stdout);
-}
-
-// Función para logging silencioso (solo guarda en traza, no imprime)
-void add_trace_silent(const char *event) {
-    pthread_mutex_lock(&trace_mutex);
-    get_timestamp(trace_log[trace_index].timestamp, sizeof(trace_log[trace_index].timestamp));
-    strncpy(trace_log[trace_index].event, event, sizeof(trace_log[trace_index].event) - 1);
-    trace_log[trace_index].event[sizeof(trace_log[trace_index].event) - 1] = '\0';
-    trace_log[trace_index].irq_num = -1;
-    trace_index = (trace_index + 1) % MAX_TRACE_LINES;
-    pthread_mutex_unlock(&trace_mutex);
-    // NO imprime nada
-}
-
-void add_trace_with_irq_silent(const char *event, int irq_num) {
-    pthread_mutex_lock(&trace_mutex);
-    get_timestamp(trace_log[trace_index].timestamp, sizeof(trace_log[trace_index].timestamp));
-    strncpy(trace_log[trace_index].event, event, sizeof(trace_log[trace_index].event) - 1);
-    trace_log[trace_index].event[sizeof(trace_log[trace_index].event) - 1] = '\0';
-    trace_log[trace_index].irq_num = irq_num;
-    trace_index = (trace_index + 1) % MAX_TRACE_LINES;
-    pthread_mutex_unlock(&trace_mutex);
-    // NO imprime nada
-}
-
-// Función para controlar el nivel de logging
-void set_log_level(log_level_t level) {
-    current_log_level = level;
-    const char* level_names[] = {"SILENCIOSO", "SOLO USUARIO", "VERBOSE"};
-    printf("Nivel de logging cambiado a: %s\n", level_names[level]);
-}
-
-void toggle_timer_logs(void) {
-    show_timer_logs = !show_timer_logs;
-    printf("Logs del timer: %s\n", show_timer_logs ? "HABILITADOS" : "DESHABILITADOS");
-}
-
-// Función de logging inteligente
-void add_trace_smart(const char *event, int irq_num, int is_timer_related) {
-    // Siempre guardar en la traza para el historial
-    if (irq_num >= 0) {
-        add_trace_with_irq_silent(event, irq_num);
-    } else {
-        add_trace_silent(event);
-    }
-    
-    // Decidir si mostrar en pantalla
-    int should_print = 0;
-    
-    switch (current_log_level) {
-        case LOG_LEVEL_SILENT:
-            should_print = 0;
-            break;
-            
-        case LOG_LEVEL_USER_ONLY:
-            // Solo mostrar si no es del timer, o si los logs del timer están habilitados
-            if (is_timer_related) {
-                should_print = show_timer_logs;
-            } else {
-                should_print = 1;
-            }
-            break;
-            
-        case LOG_LEVEL_VERBOSE:
-            should_print = 1;
-            break;
-    }
-    
-    if (should_print) {
-        if (irq_num >= 0) {
-            printf("[%s] [IRQ%d] %s\n", 
-                   trace_log[(trace_index - 1 + MAX_TRACE_LINES) % MAX_TRACE_LINES].timestamp,
-                   irq_num, event);
-        } else {
-            printf("[%s] %s\n", 
-                   trace_log[(trace_index - 1 + MAX_TRACE_LINES) % MAX_TRACE_LINES].timestamp,
-                   event);
-        }
-        fflush(stdout);
-    }
-}
-
-// Validación de número de IRQ
-int validate_irq_num(int irq_num) {
-    return IS_VALID_IRQ(irq_num) ? SUCCESS : ERROR_INVALID_IRQ;
-}
-
-// Verificar si IRQ está disponible
-int is_irq_available(int irq_num) {
-    if (!IS_VALID_IRQ(irq_num)) return 0;
-    LOCK_IDT();
-    int available = (idt[irq_num].state == IRQ_STATE_FREE);
-    UNLOCK_IDT();
-    return available;
-}
-
-// Obtener string del estado del IRQ
-const char* get_irq_state_string(irq_state_t state) {
-    switch (state) {
-        case IRQ_STATE_FREE: return "LIBRE";
-        case IRQ_STATE_REGISTERED: return "REGISTRADO";
-        case IRQ_STATE_EXECUTING: return "EJECUTANDO";
-        default: return "DESCONOCIDO";
-    }
-}
-
-// Inicialización de la IDT
-void init_idt() {
-    LOCK_IDT();
-    for (int i = 0; i < MAX_INTERRUPTS; i++) {
-        idt[i].isr = NULL;
-        idt[i].state = IRQ_STATE_FREE;
-        idt[i].call_count = 0;
-        idt[i].last_call = 0;
-        idt[i].total_execution_time = 0;
-        snprintf(idt[i].description, sizeof(idt[i].description), 
-            "IRQ %d - Vector libre en IDT", i);
-    }
-    UNLOCK_IDT();
-    
-    add_trace("🚀 KERNEL: Tabla de Descriptores de Interrupción (IDT) inicializada");
-    add_trace("🎯 KERNEL: 16 vectores de interrupción disponibles para asignación");
-    add_trace("🔧 HARDWARE: Controlador de interrupciones (PIC/APIC) configurado");
-}
-
-// Inicialización de estadísticas del sistema
-void init_system_stats() {
-    memset(&stats, 0, sizeof(system_stats_t));
-    stats.system_start_time = time(NULL);
-}
-
-// Actualizar estadísticas (thread-safe)
-void update_stats(int irq_num, unsigned long execution_time) {
-    static pthread_mutex_t stats_mutex = PTHREAD_MUTEX_INITIALIZER;
-    
-    pthread_mutex_lock(&stats_mutex);
-    stats.total_interrupts++;
-    
-    if (irq_num == IRQ_TIMER) {
-        stats.timer_interrupts++;
-    } else if (irq_num == IRQ_KEYBOARD) {
-        stats.keyboard_interrupts++;
-    } else {
-        stats.custom_interrupts++;
-    }
-    
-    // Calcular tiempo promedio de respuesta
-    if (stats.total_interrupts > 0) {
-        stats.average_response_time = 
-            (stats.average_response_time * (stats.total_interrupts - 1) + execution_time) / 
-            stats.total_interrupts;
-    }
-    pthread_mutex_unlock(&stats_mutex);
-}
-
-// Registro de ISR en la IDT
-int register_isr(int irq_num, void (*isr_function)(int), const char *description) {
-    if (validate_irq_num(irq_num) != SUCCESS) {
-        add_trace("❌ KERNEL: Error en registro ISR - IRQ fuera de rango válido");
-        return ERROR_INVALID_IRQ;
-    }
-    
-    LOCK_IDT();
-    
-    if (idt[irq_num].state == IRQ_STATE_EXECUTING) {
-        UNLOCK_IDT();
-        add_trace("⚠️  KERNEL: Registro ISR fallido - IRQ actualmente en ejecución");
-        return ERROR_ISR_EXECUTING;
-    }
-    
-    idt[irq_num].isr = isr_function;
-    idt[irq_num].state = IRQ_STATE_REGISTERED;
-    idt[irq_num].call_count = 0;
-    idt[irq_num].total_execution_time = 0;
-    strncpy(idt[irq_num].description, description, sizeof(idt[irq_num].description) - 1);
-    idt[irq_num].description[sizeof(idt[irq_num].description) - 1] = '\0';
-    
-    UNLOCK_IDT();
-    
-    char trace_msg[MAX_TRACE_MSG_LEN];
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "📝 KERNEL: ISR registrada en IDT[%d] -> Handler: \"%s\"", 
-        irq_num, description);
-    add_trace_with_irq(trace_msg, irq_num);
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "🔗 HARDWARE: IRQ %d ahora conectada al kernel - Lista para recibir señales", 
-        irq_num);
-    add_trace_with_irq(trace_msg, irq_num);
-    
-    return SUCCESS;
-}
-
-// Desregistrar ISR
-int unregister_isr(int irq_num) {
-    if (validate_irq_num(irq_num) != SUCCESS) {
-        add_trace("❌ KERNEL: Error en desregistro ISR - IRQ fuera de rango válido");
-        return ERROR_INVALID_IRQ;
-    }
-    
-    LOCK_IDT();
-    
-    if (idt[irq_num].state == IRQ_STATE_EXECUTING) {
-        UNLOCK_IDT();
-        add_trace("⚠️  KERNEL: Desregistro ISR fallido - IRQ actualmente en ejecución");
-        return ERROR_ISR_EXECUTING;
-    }
-    
-    char old_description[MAX_DESCRIPTION_LEN];
-    strncpy(old_description, idt[irq_num].description, MAX_DESCRIPTION_LEN - 1);
-    old_description[MAX_DESCRIPTION_LEN - 1] = '\0';
-    
-    
-    idt[irq_num].isr = NULL;
-    idt[irq_num].state = IRQ_STATE_FREE;
-    idt[irq_num].call_count = 0;
-    idt[irq_num].total_execution_time = 0;
-    snprintf(idt[irq_num].description, sizeof(idt[irq_num].description), 
-        "IRQ %d - Disponible para asignación", irq_num);
-    
-    UNLOCK_IDT();
-    
-    char trace_msg[MAX_TRACE_MSG_LEN];
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "🗑️  KERNEL: ISR removida de IDT[%d] - Era: \"%s\"", 
-        irq_num, old_description);
-    add_trace_with_irq(trace_msg, irq_num);
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "🚫 HARDWARE: IRQ %d desconectada - Interrupciones no serán procesadas", 
-        irq_num);
-    add_trace_with_irq(trace_msg, irq_num);
-    
-    return SUCCESS;
-}
-
-// Despacho de interrupciones - VERSIÓN CORREGIDA
-void dispatch_interrupt(int irq_num) {
-    char trace_msg[MAX_TRACE_MSG_LEN];
-    struct timespec start_time, end_time;
-    void (*isr_function)(int) = NULL;
-    int is_timer_irq = (irq_num == IRQ_TIMER);
-    
-    if (validate_irq_num(irq_num) != SUCCESS) {
-        snprintf(trace_msg, sizeof(trace_msg), 
-            "❌ HARDWARE: IRQ %d RECHAZADA - Número fuera del rango válido (0-%d)", 
-            irq_num, MAX_INTERRUPTS-1);
-        add_trace_smart(trace_msg, -1, 0);
-        return;
-    }
-    
-    LOCK_IDT();
-    
-    // ✅ VERIFICAR ESTADO CORRECTO
-    if (idt[irq_num].state != IRQ_STATE_REGISTERED || idt[irq_num].isr == NULL) {
-        UNLOCK_IDT();
-        snprintf(trace_msg, sizeof(trace_msg), 
-            "❌ KERNEL: IRQ %d SIN HANDLER - Estado: %s", 
-            irq_num, get_irq_state_string(idt[irq_num].state));
-        add_trace_smart(trace_msg, irq_num, is_timer_irq);
-        return;
-    }
-    
-    // ✅ VERIFICAR SI YA SE ESTÁ EJECUTANDO (protección contra reentrancy)
-    if (idt[irq_num].state == IRQ_STATE_EXECUTING) {
-        UNLOCK_IDT();
-        snprintf(trace_msg, sizeof(trace_msg), 
-            "⚠️  KERNEL: IRQ %d ya ejecutándose - Interrupción ignorada (reentrancy)", irq_num);
-        add_trace_smart(trace_msg, irq_num, is_timer_irq);
-        return;
-    }
-    
-    // Simular el proceso real de Linux
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "🔥 HARDWARE: IRQ %d disparada - Línea de interrupción activada", irq_num);
-    add_trace_smart(trace_msg, irq_num, is_timer_irq);
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "🚨 CPU: Guardando contexto actual - Registros y estado del procesador");
-    add_trace_smart(trace_msg, irq_num, is_timer_irq);
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "🔍 KERNEL: Consultando IDT[%d] - Vector de interrupción encontrado", irq_num);
-    add_trace_smart(trace_msg, irq_num, is_timer_irq);
-    
-    // ✅ CAMBIAR ESTADO A EJECUTANDO
-    idt[irq_num].state = IRQ_STATE_EXECUTING;
-    idt[irq_num].call_count++;
-    idt[irq_num].last_call = time(NULL);
-    isr_function = idt[irq_num].isr;
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "⚡ KERNEL: Ejecutando ISR \"%s\" - Llamada #%d [Modo Kernel]", 
-        idt[irq_num].description, idt[irq_num].call_count);
-    
-    UNLOCK_IDT();
-    add_trace_smart(trace_msg, irq_num, is_timer_irq);
-    
-    // ✅ EJECUTAR LA ISR
-    clock_gettime(CLOCK_MONOTONIC, &start_time);
-    
-    if (isr_function) {
-        isr_function(irq_num);
-    }
-    
-    clock_gettime(CLOCK_MONOTONIC, &end_time);
-    
-    unsigned long execution_time = 
-        (end_time.tv_sec - start_time.tv_sec) * 1000000 +
-        (end_time.tv_nsec - start_time.tv_nsec) / 1000;
-    
-    // ✅ RESTAURAR ESTADO A REGISTRADO
-    LOCK_IDT();
-    idt[irq_num].state = IRQ_STATE_REGISTERED;  // ✅ VOLVER A REGISTRADO
-    idt[irq_num].total_execution_time += execution_time;
-    UNLOCK_IDT();
-    
-    update_stats(irq_num, execution_time);
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "🔄 CPU: Restaurando contexto - Volviendo al proceso interrumpido (%lu μs)", 
-        execution_time);
-    add_trace_smart(trace_msg, irq_num, is_timer_irq);
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "✅ KERNEL: IRQ %d procesada - Sistema listo para nuevas interrupciones", irq_num);
-    add_trace_smart(trace_msg, irq_num, is_timer_irq);
-}
-
-
-
-// ISR del Timer del Sistema (IRQ 0)
-void timer_isr(int irq_num) {
-    timer_counter++;
-    char trace_msg[MAX_TRACE_MSG_LEN];
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "    ⏰ TIMER_ISR: Tick del sistema #%d - Actualizando jiffies del kernel", 
-        timer_counter);
-    add_trace_smart(trace_msg, irq_num, 1);
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "    📊 SCHEDULER: Verificando quantum de procesos - Time slice check");
-    add_trace_smart(trace_msg, irq_num, 1);
-    
-    usleep(ISR_SIMULATION_DELAY_US);
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "    🔄 TIMER_ISR: Completada - Sistema de tiempo actualizado");
-    add_trace_smart(trace_msg, irq_num, 1);
-}
-
-// ISR del Teclado (IRQ 1)
-void keyboard_isr(int irq_num) {
-    char trace_msg[MAX_TRACE_MSG_LEN];
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "    ⌨️  KEYBOARD_ISR: Leyendo scancode del controlador 8042");
-    add_trace_with_irq(trace_msg, irq_num);
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "    🔤 INPUT_LAYER: Traduciendo scancode a keycode");
-    add_trace_with_irq(trace_msg, irq_num);
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "    📤 EVENT_QUEUE: Enviando evento de teclado a /dev/input/eventX");
-    add_trace_with_irq(trace_msg, irq_num);
-    
-    usleep(KEYBOARD_DELAY_US);
-}
-
-// ISR personalizada de ejemplo
-void custom_isr(int irq_num) {
-    char trace_msg[MAX_TRACE_MSG_LEN];
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "    🔧 CUSTOM_ISR: Procesando interrupción de dispositivo personalizado");
-    add_trace_with_irq(trace_msg, irq_num);
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "    💾 DEVICE_DRIVER: Intercambiando datos con hardware específico");
-    add_trace_with_irq(trace_msg, irq_num);
-    
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "    ✅ CUSTOM_ISR: Operación completada - Hardware listo para nuevas operaciones");
-    add_trace_with_irq(trace_msg, irq_num);
-    
-    usleep(CUSTOM_DELAY_US);
-}
-
-// ISR de error
-void error_isr(int irq_num) {
-    char trace_msg[MAX_TRACE_MSG_LEN];
-    snprintf(trace_msg, sizeof(trace_msg), "    ERROR ISR: Manejando error en IRQ %d", irq_num);
-    add_trace_with_irq(trace_msg, irq_num);
-    
-    usleep(50000); // 50ms
-}
-
-// Hilo del timer automático
-void* timer_thread_func(void* arg) {
-    (void)arg;
-    
-    add_trace("🕐 HARDWARE: Hilo del timer PIT (Programmable Interval Timer) iniciado");
-    add_trace("⚙️  TIMER: Configurado para generar IRQ0 cada 3 segundos");
-    
-    while (system_running) {
-        sleep(TIMER_INTERVAL_SEC);
-        if (system_running) {
-            char trace_msg[MAX_TRACE_MSG_LEN];
-            snprintf(trace_msg, sizeof(trace_msg), 
-                "⏲️  HARDWARE: Timer PIT disparando IRQ0 - Señal de reloj del sistema");
-            add_trace_smart(trace_msg, -1, 1);
-            
-            dispatch_interrupt(IRQ_TIMER);
-        }
-    }
-    
-    add_trace("🛑 HARDWARE: Timer PIT detenido - Hilo del timer finalizando");
-    return NULL;
-}
+#include "irq_shm.h"
+#include "irq_inject.h"
+#include "irq_fd_source.h"
+#include "irq_ctl.h"
+#include "irq_plugin.h"
+#include "irq_storm.h"
+#include "irq_budget.h"
+#include "irq_coro.h"
+#include "irq_workpool.h"
+#include "irq_balance.h"
+#include "irq_msix.h"
+#include "irq_device.h"
+#include "irq_slab.h"
+#include "irq_trace.h"
+#include "irq_capture.h"
+#include "irq_profile.h"
+#include "irq_replay.h"
+#include "irq_loadgen.h"
+#include "irq_stress.h"
+#include "irq_rand.h"
+#include "irq_suite.h"
+#include "irq_rt.h"
 
 void show_idt_status() {
     printf("\n╔══════════════════════════════════════════════════════════════════════════════╗\n");
@@ -488,26 +33,31 @@ void show_idt_status() {
 
     int usados = 0;
 
+    // Copiar la IDT y liberar el lock antes de imprimir para no frenar el despacho
+    irq_descriptor_t snapshot[MAX_INTERRUPTS];
+    sim_fold_static_dispatches(sim_current());
     LOCK_IDT();
+    memcpy(snapshot, sim_current()->idt, sizeof(snapshot));
+    UNLOCK_IDT();
+
     for (int i = 0; i < MAX_INTERRUPTS; i++) {
-        if (idt[i].call_count == 0)
+        if (snapshot[i].call_count == 0)
             continue; // Mostrar solo si fue usada en esta ejecución
 
-        const char* state_str = get_irq_state_string(idt[i].state);
+        const char* state_str = get_irq_state_string(snapshot[i].state);
         const char* icon = "";
 
-        switch (idt[i].state) {
+        switch (snapshot[i].state) {
             case IRQ_STATE_FREE:       icon = "⚪"; break;
             case IRQ_STATE_REGISTERED: icon = "🟢"; break;
             case IRQ_STATE_EXECUTING:  icon = "🔴"; break;
         }
 
         printf("║ %s%2d │ %-12s │ %8d │ %17lu │ %-21s ║\n", 
-               icon, i, state_str, idt[i].call_count, 
-               idt[i].total_execution_time, idt[i].description);
+               icon, i, state_str, snapshot[i].call_count, 
+               snapshot[i].total_execution_time, snapshot[i].description);
         usados++;
     }
-    UNLOCK_IDT();
 
     if (usados == 0) {
         printf("║                             ⚠️  Ninguna IRQ activa                            ║\n");
@@ -522,95 +72,45 @@ void show_idt_status() {
 void show_recent_trace() {
     printf("\n=== TRAZA RECIENTE ===\n");
     
-    pthread_mutex_lock(&trace_mutex);
-    int entries_to_show = (trace_index < 10) ? trace_index : 10;
-    int start = (trace_index - entries_to_show + MAX_TRACE_LINES) % MAX_TRACE_LINES;
-    
-    for (int i = 0; i < entries_to_show; i++) {
-        int idx = (start + i) % MAX_TRACE_LINES;
-        if (strlen(trace_log[idx].event) > 0) {
-            if (trace_log[idx].irq_num >= 0) {
-                printf("[%s] [IRQ%d] %s\n", 
-                       trace_log[idx].timestamp, trace_log[idx].irq_num, trace_log[idx].event);
-            } else {
-                printf("[%s] %s\n", trace_log[idx].timestamp, trace_log[idx].event);
-            }
+    trace_entry_t entries[10];
+    int count = copy_recent_traces(entries, 10);
+    for (int i = 0; i < count; i++) {
+        if (entries[i].irq_num >= 0) {
+            printf("[%s] [IRQ%d] %s\n", 
+                   entries[i].timestamp, entries[i].irq_num, entries[i].event);
+        } else {
+            printf("[%s] %s\n", entries[i].timestamp, entries[i].event);
         }
     }
-    pthread_mutex_unlock(&trace_mutex);
     printf("\n");
 }
 
-// Función auxiliar mejorada para detectar trazas del timer
-int is_timer_related_trace(const trace_entry_t *entry) {
-    // Verificar por IRQ número
-    if (entry->irq_num == IRQ_TIMER) {
-        return 1;
-    }
-    
-    // Verificar por contenido del mensaje (patrones más completos)
-    const char* timer_patterns[] = {
-        "TIMER", "Timer", "timer",
-        "TICK", "Tick", "tick",
-        "Hilo del timer", "timer_thread",
-        "DESPACHANDO IRQ 0", "FINALIZANDO IRQ 0",
-        ">>> DESPACHANDO IRQ 0", "<<< FINALIZANDO IRQ 0",
-        "iniciado", "finalizando"  // Para mensajes del hilo del timer
-    };
-    
-    int num_patterns = sizeof(timer_patterns) / sizeof(timer_patterns[0]);
-    
-    for (int i = 0; i < num_patterns; i++) {
-        if (strstr(entry->event, timer_patterns[i]) != NULL) {
-            return 1;
-        }
+static int get_non_timer_trace(int age, trace_entry_t *entry) {
+    if (irq_trace_is_timer(age)) {
+        return 0;
     }
-    
-    return 0;
+    return irq_trace_get(age, entry) == SUCCESS && !is_timer_related_trace(entry);
 }
 
 // Función corregida para mostrar última traza (excluyendo timer)
 void show_last_trace() {
     printf("\n=== ÚLTIMA TRAZA NO-TIMER ===\n");
-    pthread_mutex_lock(&trace_mutex);
     
     int found = 0;
-    int entries_checked = 0;
-    
-    // Calcular el número real de entradas en el buffer circular
-    int total_entries = 0;
-    int start_search = trace_index;
-    
-    // Si trace_index es 0, empezar desde el final del buffer
-    if (trace_index == 0) {
-        start_search = MAX_TRACE_LINES;
-    }
+    int total_entries = irq_trace_count();
+    trace_entry_t entry;
     
     // Buscar hacia atrás desde la entrada más reciente
-    for (int i = 0; i < MAX_TRACE_LINES && !found; i++) {
-        int idx = (start_search - 1 - i + MAX_TRACE_LINES) % MAX_TRACE_LINES;
-        entries_checked++;
-        
-        // Solo procesar entradas que tienen contenido válido
-        if (strlen(trace_log[idx].event) > 0) {
-            total_entries++;
+    for (int i = 0; i < total_entries && !found; i++) {
+        if (get_non_timer_trace(i, &entry)) {
+            printf("Entrada encontrada (posición %d desde el final):\n", i + 1);
             
-            // Verificar si es traza del timer usando la función auxiliar
-            if (!is_timer_related_trace(&trace_log[idx])) {
-                printf("Entrada encontrada (posición %d desde el final):\n", i + 1);
-                
-                if (trace_log[idx].irq_num >= 0) {
-                    printf("[%s] [IRQ%d] %s\n",
-                           trace_log[idx].timestamp, 
-                           trace_log[idx].irq_num, 
-                           trace_log[idx].event);
-                } else {
-                    printf("[%s] %s\n", 
-                           trace_log[idx].timestamp, 
-                           trace_log[idx].event);
-                }
-                found = 1;
+            if (entry.irq_num >= 0) {
+                printf("[%s] [IRQ%d] %s\n", entry.timestamp, entry.irq_num, entry.event);
+            } else {
+                printf("[%s] %s\n", entry.timestamp, entry.event);
             }
+            found = 1;
         }
     }
     
@@ -624,47 +124,31 @@ void show_last_trace() {
         }
     }
     
-    pthread_mutex_unlock(&trace_mutex);
     printf("\n");
 }
 
 // Función adicional para mostrar las últimas N trazas no-timer
 void show_last_n_non_timer_traces(int n) {
     printf("\n=== ÚLTIMAS %d TRAZAS NO-TIMER ===\n", n);
-    pthread_mutex_lock(&trace_mutex);
     
     int found_count = 0;
     int entries_checked = 0;
-    int start_search = trace_index;
-    
-    if (trace_index == 0) {
-        start_search = MAX_TRACE_LINES;
-    }
+    int total_entries = irq_trace_count();
+    trace_entry_t entry;
     
     printf("Buscando las últimas %d trazas que no sean del timer...\n\n", n);
     
     // Buscar hacia atrás desde la entrada más reciente
-    for (int i = 0; i < MAX_TRACE_LINES && found_count < n; i++) {
-        int idx = (start_search - 1 - i + MAX_TRACE_LINES) % MAX_TRACE_LINES;
+    for (int i = 0; i < total_entries && found_count < n; i++) {
         entries_checked++;
-        
-        // Solo procesar entradas que tienen contenido válido
-        if (strlen(trace_log[idx].event) > 0) {
-            // Verificar si es traza del timer
-            if (!is_timer_related_trace(&trace_log[idx])) {
-                found_count++;
-                printf("%d. ", found_count);
-                
-                if (trace_log[idx].irq_num >= 0) {
-                    printf("[%s] [IRQ%d] %s\n",
-                           trace_log[idx].timestamp, 
-                           trace_log[idx].irq_num, 
-                           trace_log[idx].event);
-                } else {
-                    printf("[%s] %s\n", 
-                           trace_log[idx].timestamp, 
-                           trace_log[idx].event);
-                }
+        if (get_non_timer_trace(i, &entry)) {
+            found_count++;
+            printf("%d. ", found_count);
+            
+            if (entry.irq_num >= 0) {
+                printf("[%s] [IRQ%d] %s\n", entry.timestamp, entry.irq_num, entry.event);
+            } else {
+                printf("[%s] %s\n", entry.timestamp, entry.event);
             }
         }
     }
@@ -676,31 +160,33 @@ void show_last_n_non_timer_traces(int n) {
         printf("\nSolo se encontraron %d trazas no-timer (de %d solicitadas)\n", found_count, n);
     }
     
-    pthread_mutex_unlock(&trace_mutex);
     printf("\n");
 }
 
 // Función mejorada para debug del buffer de trazas
 void debug_trace_buffer() {
     printf("\n=== DEBUG DEL BUFFER DE TRAZAS ===\n");
-    pthread_mutex_lock(&trace_mutex);
     
-    printf("trace_index actual: %d\n", trace_index);
-    printf("MAX_TRACE_LINES: %d\n\n", MAX_TRACE_LINES);
+    irq_trace_stats_t st;
+    irq_trace_get_stats(&st);
+    printf("Entradas escritas: %lu\n", st.emitted);
+    printf("Capacidad: %d registros de %d bytes (antes %zu bytes por entrada)\n",
+           st.capacity, st.record_size, st.legacy_entry_size);
+    printf("Plantillas internadas: %d │ Textos internados: %d │ Texto: %lu bytes escritos, %lu sobrescritos al leer\n\n",
+           st.templates, st.names, st.payload_bytes, st.payload_lost);
     
-    int valid_entries = 0;
+    int valid_entries = st.records;
     int timer_entries = 0;
     int non_timer_entries = 0;
+    trace_entry_t entry;
     
     printf("Análisis del contenido del buffer:\n");
-    for (int i = 0; i < MAX_TRACE_LINES; i++) {
-        if (strlen(trace_log[i].event) > 0) {
-            valid_entries++;
-            if (is_timer_related_trace(&trace_log[i])) {
-                timer_entries++;
-            } else {
-                non_timer_entries++;
-            }
+    for (int i = 0; i < valid_entries; i++) {
+        if (irq_trace_is_timer(i) ||
+            (irq_trace_get(i, &entry) == SUCCESS && is_timer_related_trace(&entry))) {
+            timer_entries++;
+        } else {
+            non_timer_entries++;
         }
     }
     
@@ -710,16 +196,13 @@ void debug_trace_buffer() {
     
     // Mostrar las últimas 5 entradas con su clasificación
     printf("\nÚltimas 5 entradas (con clasificación):\n");
-    int start = (trace_index - 5 + MAX_TRACE_LINES) % MAX_TRACE_LINES;
-    for (int i = 0; i < 5; i++) {
-        int idx = (start + i) % MAX_TRACE_LINES;
-        if (strlen(trace_log[idx].event) > 0) {
-            const char* type = is_timer_related_trace(&trace_log[idx]) ? "[TIMER]" : "[USER]";
-            printf("%s [%s] %s\n", type, trace_log[idx].timestamp, trace_log[idx].event);
+    for (int i = 4; i >= 0; i--) {
+        if (irq_trace_get(i, &entry) == SUCCESS) {
+            const char* type = is_timer_related_trace(&entry) ? "[TIMER]" : "[USER]";
+            printf("%s [%s] %s\n", type, entry.timestamp, entry.event);
         }
     }
     
-    pthread_mutex_unlock(&trace_mutex);
     printf("\n");
 }
 
@@ -730,6 +213,8 @@ void show_system_stats() {
     printf("║                     Simulando: /proc/stat y /proc/uptime                    ║\n");
     printf("╠══════════════════════════════════════════════════════════════════════════════╣\n");
     
+    system_stats_t stats;
+    sim_get_stats(sim_current(), &stats);
     time_t uptime = time(NULL) - stats.system_start_time;
     int hours = uptime / 3600;
     int minutes = (uptime % 3600) / 60;
@@ -752,6 +237,68 @@ void show_system_stats() {
     float irq_rate = uptime > 0 ? (float)stats.total_interrupts / uptime : 0;
     printf("║ 📈 Tasa de interrupciones:        %.2f IRQs/segundo                ║\n", irq_rate);
     
+    if (irq_inject_is_active()) {
+        irq_inject_stats_t inject;
+        irq_inject_get_stats(&inject);
+        printf("║ 📥 Inyectadas externamente:       %-10lu (lotes: %lu, máx: %lu)    ║\n",
+               inject.dispatched, inject.batches, inject.max_batch);
+        printf("║ ⏱️  Retardo de inyección:          %.2f μs prom. / %lu μs máx.      ║\n",
+               inject.average_delay_us, inject.max_delay_us);
+        printf("║ 🚧 Anillo lleno / IRQs inválidas: %-10lu / %-10lu              ║\n",
+               inject.full_events, inject.invalid);
+    }
+    
+    unsigned long shed = 0, episodes = 0;
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        irq_storm_info_t storm_info;
+        irq_storm_get_info(i, &storm_info);
+        shed += storm_info.shed;
+        episodes += storm_info.episodes;
+    }
+    if (episodes > 0) {
+        printf("║ 🌩️  Tormentas / IRQs descartadas:  %-10lu / %-10lu              ║\n",
+               episodes, shed);
+    }
+    
+    irq_workpool_stats_t pool;
+    irq_workpool_get_stats(&pool);
+    if (pool.submitted > 0) {
+        unsigned long stolen = 0;
+        for (int i = 0; i < pool.workers; i++) {
+            stolen += pool.worker[i].stolen;
+        }
+        printf("║ 🧰 Trabajo diferido (hecho/robado): %-10lu / %-10lu            ║\n",
+               pool.executed, stolen);
+    }
+    
+    irq_balance_stats_t balance;
+    irq_balance_get_stats(&balance);
+    if (balance.enabled || balance.migrations > 0) {
+        printf("║ ⚖️  Balanceo (rondas/migraciones): %-10lu / %-10lu              ║\n",
+               balance.rounds, balance.migrations);
+    }
+    
+    irq_coro_stats_t coro;
+    irq_coro_get_stats(-1, &coro);
+    if (coro.spawned > 0) {
+        printf("║ 🌀 Corrutinas (creadas/en vuelo): %-10lu / %-10lu              ║\n",
+               coro.spawned, coro.in_flight);
+    }
+    
+    for (int i = 0; i < irq_slab_count(); i++) {
+        irq_slab_stats_t slab;
+        irq_slab_get_stats(i, &slab);
+        printf("║ 🧱 Slab %-10s vivos/máx/remotos: %-8lu / %-8lu / %-10lu ║\n",
+               slab.name, slab.live, slab.high_water, slab.cross_frees);
+    }
+    
+    if (ctl_server_is_running()) {
+        ctl_stats_t ctl;
+        ctl_get_stats(&ctl);
+        printf("║ 🎛️  Plano de control:              %-10lu comandos (%lu viajes, máx: %lu) ║\n",
+               ctl.commands, ctl.round_trips, ctl.max_batch);
+    }
+    
     printf("╚══════════════════════════════════════════════════════════════════════════════╝\n");
 }
 
@@ -793,6 +340,8 @@ void show_help() {
 void debug_all_irq_states() {
     printf("\n=== DEBUG: TODOS LOS ESTADOS DE IRQ ===\n");
     
+    sim_context_t *sim = sim_current();
+    sim_fold_static_dispatches(sim);
     LOCK_IDT();
     
     int free_count = 0;
@@ -800,18 +349,18 @@ void debug_all_irq_states() {
     int executing_count = 0;
     
     for (int i = 0; i < MAX_INTERRUPTS; i++) {
-        const char* state_str = get_irq_state_string(idt[i].state);
+        const char* state_str = get_irq_state_string(sim->idt[i].state);
         const char* icon = "";
         
-        switch (idt[i].state) {
+        switch (sim->idt[i].state) {
             case IRQ_STATE_FREE:       icon = "⚪"; free_count++; break;
             case IRQ_STATE_REGISTERED: icon = "🟢"; registered_count++; break;
             case IRQ_STATE_EXECUTING:  icon = "🔴"; executing_count++; break;
         }
         
         printf("IRQ%2d: %s %-12s │ Calls: %3d │ %s\n", 
-               i, icon, state_str, idt[i].call_count, 
-               (idt[i].call_count > 0) ? idt[i].description : "Sin actividad");
+               i, icon, state_str, sim->idt[i].call_count, 
+               (sim->idt[i].call_count > 0) ? sim->idt[i].description : "Sin actividad");
     }
     
     UNLOCK_IDT();
@@ -833,25 +382,27 @@ void show_menu() {
     printf("║  2. 📝 Registrar ISR personalizada     │  7. 📊 Estadísticas del sistema     ║\n");
     printf("║  3. 🎯 Estado de la IDT                │  8. ⚙️  Configurar logging          ║\n");
     printf("║  4. 📜 Mostrar traza reciente          │  9. ❓ Ayuda del simulador          ║\n");
-    printf("║  5. 🧪 Suite de pruebas múltiples      │  0. 🚪 Salir del programa           ║\n");
+    printf("║  5. 🧪 Suite de pruebas múltiples      │ 10. 🛠️  Herramientas avanzadas       ║\n");
+    printf("║                                        │  0. 🚪 Salir del programa           ║\n");
     printf("╚══════════════════════════════════════════════════════════════════════════════╝\n");
-    printf("Seleccione una opción [0-9]: ");
+    printf("Seleccione una opción [0-10]: ");
     fflush(stdout);
 }
 
 void logging_submenu() {
+    sim_context_t *sim = sim_current();
     int option;
     
     while (1) {
         printf("\n=== CONFIGURACIÓN DE LOGGING ===\n");
         printf("Estado actual: ");
         
-        switch (current_log_level) {
+        switch (get_log_level()) {
             case LOG_LEVEL_SILENT:
                 printf("SILENCIOSO");
                 break;
             case LOG_LEVEL_USER_ONLY:
-                printf("SOLO USUARIO (Timer logs: %s)", show_timer_logs ? "ON" : "OFF");
+                printf("SOLO USUARIO (Timer logs: %s)", sim->show_timer_logs ? "ON" : "OFF");
                 break;
             case LOG_LEVEL_VERBOSE:
                 printf("VERBOSE");
@@ -861,7 +412,7 @@ void logging_submenu() {
         printf("\n\n1. Modo silencioso (solo guardar en historial)\n");
         printf("2. Modo usuario (solo acciones del usuario)\n");
         printf("3. Modo verbose (mostrar todo)\n");
-        printf("4. Toggle logs del timer (actual: %s)\n", show_timer_logs ? "ON" : "OFF");
+        printf("4. Toggle logs del timer (actual: %s)\n", sim->show_timer_logs ? "ON" : "OFF");
         printf("5. Mostrar logs del timer en tiempo real por 30 segundos\n");
         printf("0. Volver al menú principal\n");
         printf("Seleccione una opción: ");
@@ -884,13 +435,11 @@ void logging_submenu() {
                 break;
             case 5:
                 printf("Mostrando logs del timer por 30 segundos...\n");
-                int old_show_timer = show_timer_logs;
-                log_level_t old_level = current_log_level;
-                show_timer_logs = 1;
-                current_log_level = LOG_LEVEL_USER_ONLY;
+                int old_show_timer = sim_swap_timer_logs(sim, 1);
+                log_level_t old_level = swap_log_level(LOG_LEVEL_USER_ONLY);
                 sleep(30);
-                show_timer_logs = old_show_timer;
-                current_log_level = old_level;
+                sim_swap_timer_logs(sim, old_show_timer);
+                swap_log_level(old_level);
                 printf("Volviendo a la configuración anterior.\n");
                 break;
             case 0:
@@ -899,88 +448,107 @@ void logging_submenu() {
     }
 }
 
-
-void test_concurrent_interrupts() {
-    printf("Probando interrupciones concurrentes...\n");
+// Submenú de herramientas avanzadas (subsistemas de rendimiento)
+void advanced_submenu() {
+    int option;
     
-    // Generar múltiples interrupciones rápidamente
-    for (int i = 0; i < 5; i++) {
-        dispatch_interrupt(IRQ_TIMER);
-        dispatch_interrupt(IRQ_KEYBOARD);
-        usleep(100000); // 100ms
+    while (1) {
+        printf("\n=== HERRAMIENTAS AVANZADAS ===\n");
+        printf("1. 🔌 Fuentes de hardware reales (eventfd, timerfd, sockets)\n");
+        printf("2. 🧩 Plugins de ISR (.so)\n");
+        printf("3. 🌩️  Tormentas de interrupciones\n");
+        printf("4. ⏱️  Presupuestos de ejecución y watchdog\n");
+        printf("5. 🌀 Handlers cooperativos (corrutinas)\n");
+        printf("6. 🧰 Pool de trabajo diferido (robo de trabajo)\n");
+        printf("7. ⚖️  Balanceador de IRQs entre CPUs\n");
+        printf("8. 📶 Dispositivos multicola (MSI-X y RSS)\n");
+        printf("9. 💽 Modelos de dispositivo (anillos DMA)\n");
+        printf("10. 💾 Captura de traza a disco\n");
+        printf("11. 🔬 Perfil de fases del despacho\n");
+        printf("12. 🎬 Grabación y reproducción de cargas\n");
+        printf("13. 📈 Generador de carga sintética\n");
+        printf("14. 🧪 Estrés concurrente con invariantes\n");
+        printf("15. ⏲️  Tiempo real (afinidad, SCHED_FIFO, jitter)\n");
+        printf("0. Volver al menú principal\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+        
+        option = get_valid_input(0, 15);
+        
+        switch (option) {
+            case 1:
+                fd_sources_submenu();
+                break;
+            case 2:
+                plugins_submenu();
+                break;
+            case 3:
+                irq_storm_submenu();
+                break;
+            case 4:
+                irq_budget_submenu();
+                break;
+            case 5:
+                irq_coro_submenu();
+                break;
+            case 6:
+                irq_workpool_submenu();
+                break;
+            case 7:
+                irq_balance_submenu();
+                break;
+            case 8:
+                irq_msix_submenu();
+                break;
+            case 9:
+                irq_device_submenu();
+                break;
+            case 10:
+                capture_submenu();
+                break;
+            case 11:
+                profile_submenu();
+                break;
+            case 12:
+                replay_submenu();
+                break;
+            case 13:
+                loadgen_submenu();
+                break;
+            case 14:
+                stress_submenu();
+                break;
+            case 15:
+                rt_submenu();
+                break;
+            case 0:
+                return;
+        }
     }
-    
-    printf("Prueba de concurrencia completada.\n");
 }
 
-void test_stress_interrupts() {
-    printf("Ejecutando prueba de stress...\n");
+// Despacho, registro y lectura de la traza a la vez desde varios hilos
+static void run_stress(int threads, int readers, double seconds) {
+    irq_stress_config_t config = { threads, readers, 1, seconds };
+    irq_stress_result_t result;
     
-    for (int i = 0; i < 20; i++) {
-        dispatch_interrupt(i % MAX_INTERRUPTS);
-        usleep(50000); // 50ms
+    if (irq_stress_run(&config, &result) != SUCCESS) {
+        printf("✗ No se pudo ejecutar (¿sin vectores libres? ¿otra prueba en curso?)\n");
+        return;
     }
-    
-    printf("Prueba de stress completada.\n");
-}
-
-// Función para limpiar entrada inválida del buffer
-void clear_input_buffer() {
-    int c;
-    while ((c = getchar()) != '\n' && c != EOF);
+    show_stress_result(&result);
 }
 
-// Función para obtener entrada numérica válida
-int get_valid_input(int min, int max) {
-    int input;
-    char buffer[256];
-    char *endptr;
-    
-    while (1) {
-        memset(buffer, 0, sizeof(buffer));
-        
-        if (fgets(buffer, sizeof(buffer), stdin) == NULL) {
-            printf("Error leyendo entrada. Intente de nuevo: ");
-            continue;
-        }
-        
-        size_t len = strlen(buffer);
-        if (len > 0 && buffer[len-1] == '\n') {
-            buffer[len-1] = '\0';
-        }
-        
-        char *trimmed = buffer;
-        while (*trimmed == ' ' || *trimmed == '\t') {
-            trimmed++;
-        }
-        
-        if (*trimmed == '\0') {
-            printf("Entrada inválida. Ingrese un número entre %d y %d: ", min, max);
-            continue;
-        }
-        
-        input = (int)strtol(trimmed, &endptr, 10);
-        
-        if (*endptr != '\0') {
-            printf("Entrada inválida. Ingrese un número entre %d y %d: ", min, max);
-            continue;
-        }
-        
-        if (input >= min && input <= max) {
-            return input;
-        }
-        
-        printf("Número fuera de rango. Ingrese un número entre %d y %d: ", min, max);
-    }
+void test_concurrent_interrupts() {
+    printf("Probando interrupciones concurrentes...\n");
+    run_stress(4, 1, 1.0);
+    printf("Prueba de concurrencia completada.\n");
 }
 
-// Función simple para esperar Enter
-void wait_for_enter() {
-    printf("\nPresione Enter para continuar...");
-    fflush(stdout);
-    
-    char buffer[10];
-    fgets(buffer, sizeof(buffer), stdin);
+void test_stress_interrupts() {
+    printf("Ejecutando prueba de stress...\n");
+    run_stress(IRQ_STRESS_MAX_THREADS, IRQ_STRESS_MAX_READERS, 5.0);
+    printf("Prueba de stress completada.\n");
 }
 
 void improved_main_initialization() {
@@ -992,30 +560,7 @@ void improved_main_initialization() {
     printf("\n🔧 FASE DE INICIALIZACIÓN DEL KERNEL:\n");
     printf("════════════════════════════════════════\n");
     
-    // Inicializar sistema
-    printf("📋 Inicializando IDT (Interrupt Descriptor Table)...\n");
-    fflush(stdout);
-    init_idt();
-    
-    printf("📈 Configurando sistema de estadísticas...\n");
-    fflush(stdout);
-    init_system_stats();
-    
-    // Registrar ISRs predeterminadas
-    printf("⏰ Registrando handler del Timer PIT (IRQ0)...\n");
-    fflush(stdout);
-    register_isr(IRQ_TIMER, timer_isr, "Timer PIT - Reloj del sistema");
-    
-    printf("⌨️  Registrando handler del teclado (IRQ1)...\n");
-    fflush(stdout);
-    register_isr(IRQ_KEYBOARD, keyboard_isr, "Controlador de teclado 8042");
-    
-    // Iniciar hilo del timer
-    printf("🕐 Iniciando hilo del timer automático...\n");
-    fflush(stdout);
-    if (pthread_create(&timer_thread, NULL, timer_thread_func, NULL) != 0) {
-        add_trace("❌ KERNEL PANIC: Error creando hilo del timer");
-        printf("❌ ERROR CRÍTICO: No se pudo iniciar el timer del sistema\n");
+    if (sim_system_start() != SUCCESS) {
         return;
     }
     
@@ -1029,76 +574,6 @@ void improved_main_initialization() {
     wait_for_enter();
 }
 
-// Función para guardar el estado actual de la IDT
-void save_idt_state(irq_descriptor_t *backup) {
-    LOCK_IDT();
-    
-    for (int i = 0; i < MAX_INTERRUPTS; i++) {
-        backup[i].isr = idt[i].isr;
-        backup[i].state = idt[i].state;
-        backup[i].call_count = idt[i].call_count;
-        backup[i].last_call = idt[i].last_call;
-        backup[i].total_execution_time = idt[i].total_execution_time;
-        strncpy(backup[i].description, idt[i].description, sizeof(backup[i].description) - 1);
-        backup[i].description[sizeof(backup[i].description) - 1] = '\0';
-    }
-    
-    UNLOCK_IDT();
-    
-    add_trace("💾 KERNEL: Estado de IDT guardado para respaldo");
-}
-
-// Función para restaurar el estado previo de la IDT
-void restore_idt_state(const irq_descriptor_t *backup) {
-    LOCK_IDT();
-    
-    for (int i = 0; i < MAX_INTERRUPTS; i++) {
-        idt[i].isr = backup[i].isr;
-        idt[i].state = backup[i].state;
-        idt[i].call_count = backup[i].call_count;
-        idt[i].last_call = backup[i].last_call;
-        idt[i].total_execution_time = backup[i].total_execution_time;
-        strncpy(idt[i].description, backup[i].description, sizeof(idt[i].description) - 1);
-        idt[i].description[sizeof(idt[i].description) - 1] = '\0';
-    }
-    
-    UNLOCK_IDT();
-    
-    add_trace("🧹 KERNEL: Estado de IDT restaurado tras pruebas");
-}
-
-// Función para limpiar ISRs de prueba (mantiene solo las del sistema)
-void cleanup_test_isrs(void) {
-    int cleaned_count = 0;
-    
-    LOCK_IDT();
-    
-    for (int i = 0; i < MAX_INTERRUPTS; i++) {
-        // Preservar ISRs del sistema (IRQ0 Timer e IRQ1 Keyboard)
-        if (i == IRQ_TIMER || i == IRQ_KEYBOARD) {
-            continue;
-        }
-        
-        // Limpiar cualquier otra ISR registrada
-        if (idt[i].state != IRQ_STATE_FREE && idt[i].isr != NULL) {
-            idt[i].isr = NULL;
-            idt[i].state = IRQ_STATE_FREE;
-            idt[i].call_count = 0;
-            idt[i].total_execution_time = 0;
-            snprintf(idt[i].description, sizeof(idt[i].description), 
-                "IRQ %d - Disponible para asignación", i);
-            cleaned_count++;
-        }
-    }
-    
-    UNLOCK_IDT();
-    
-    char trace_msg[MAX_TRACE_MSG_LEN];
-    snprintf(trace_msg, sizeof(trace_msg), 
-        "🧼 KERNEL: %d ISRs de prueba limpiadas - Solo ISRs del sistema preservadas", 
-        cleaned_count);
-    add_trace(trace_msg);
-}
 const char *get_irq_description(int irq_num) {
     for (size_t i = 0; i < sizeof(irq_table) / sizeof(irq_table[0]); ++i) {
         if (irq_table[i].irq == irq_num)
@@ -1109,6 +584,13 @@ const char *get_irq_description(int irq_num) {
 
 // Versión modificada de run_interrupt_test_suite()
 void run_interrupt_test_suite(void) {
+    run_interrupt_test_suite_seeded(irq_rand_clock_seed());
+}
+
+// La secuencia sólo depende de la semilla (ver irq_suite.h)
+void run_interrupt_test_suite_seeded(uint64_t seed) {
+    irq_replay_source_t saved_source = irq_replay_get_source();
+    irq_replay_set_source(IRQ_REPLAY_SRC_TEST);
     printf("\n🧪 INICIANDO SUITE DE PRUEBAS DE INTERRUPCIONES ALEATORIAS\n");
     printf("═══════════════════════════════════════════════════════════════\n");
 
@@ -1123,33 +605,25 @@ void run_interrupt_test_suite(void) {
         register_isr(irq_table[i].irq, custom_isr, irq_table[i].desc);
     }
 
-    // 2) Preparar generador de números aleatorios
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    unsigned int seed = (unsigned int)(tv.tv_sec ^ tv.tv_usec ^ getpid());
-    srand(seed);
-    printf("🔢 Semilla aleatoria usada: %u\n", seed);
+    // 2) Plan de la suite a partir de la semilla (repetible con --seed)
+    irq_suite_plan_t plan;
+    irq_suite_plan(IRQ_SUITE_BASIC, seed, &plan);
+    printf("🔢 Semilla aleatoria usada: %llu\n", (unsigned long long)seed);
 
-    // 3) Calcular cuántas interrupciones se dispararán (entre 3 y 8)
-    int total_events = 3 + rand() % 6; // 3, 4, 5, 6, 7 o 8
+    // 3) Entre 3 y 8 interrupciones
+    int total_events = plan.num_events;
     printf("\n🔥 Fase 2: Generando %d interrupciones aleatorias...\n\n", total_events);
 
-    // 4) CORRECCIÓN PRINCIPAL: Disparar interrupciones seleccionando aleatoriamente de la tabla
+    // 4) Disparar las interrupciones del plan, elegidas de irq_table
     for (int ev = 1; ev <= total_events; ++ev) {
-        // AQUÍ ESTÁ EL PROBLEMA CORREGIDO:
-        // Seleccionar un índice aleatorio directamente de irq_table
-        int table_idx = rand() % (sizeof(irq_table) / sizeof(irq_table[0]));
-        int irq_num = irq_table[table_idx].irq;
-        const char *irq_desc = irq_table[table_idx].desc;
-
+        const irq_suite_event_t *event = &plan.events[ev - 1];
         printf("\n🔔 Evento %d/%d → IRQ%d: %s\n",
-               ev, total_events, irq_num, irq_desc);
+               ev, total_events, event->irq, irq_table[event->table_idx].desc);
         
-        dispatch_interrupt(irq_num);
+        dispatch_interrupt(event->irq);
         
         // Esperar entre 100 ms y 800 ms para emular tiempos reales variables
-        useconds_t delay_us = 100000 + (rand() % 701000); // 100,000–800,999 µs
-        usleep(delay_us);
+        usleep((useconds_t)event->delay_us);
     }
 
     // ✅ Mostrar estado modificado de la IDT antes de limpiar
@@ -1164,10 +638,23 @@ void run_interrupt_test_suite(void) {
     printf("\n🎉 SUITE DE PRUEBAS COMPLETADA CON ÉXITO\n");
     printf("📊 Revise los logs para las estadísticas de latencia y manejo\n");
     printf("🔄 Ejecute de nuevo para obtener una secuencia diferente\n");
+    irq_replay_set_source(saved_source);
+}
+
+// Despacho de una interrupción como trabajo del pool
+static void dispatch_work(void *arg) {
+    irq_replay_set_source(IRQ_REPLAY_SRC_TEST);
+    dispatch_interrupt((int)(intptr_t)arg);
 }
 
 // Función adicional para pruebas más avanzadas
 void run_advanced_interrupt_test_suite(void) {
+    run_advanced_interrupt_test_suite_seeded(irq_rand_clock_seed());
+}
+
+void run_advanced_interrupt_test_suite_seeded(uint64_t seed) {
+    irq_replay_source_t saved_source = irq_replay_get_source();
+    irq_replay_set_source(IRQ_REPLAY_SRC_TEST);
     printf("\n🚀 INICIANDO SUITE DE PRUEBAS AVANZADAS\n");
     printf("═══════════════════════════════════════════════════════════════\n");
 
@@ -1182,38 +669,41 @@ void run_advanced_interrupt_test_suite(void) {
         register_isr(irq_table[i].irq, custom_isr, irq_table[i].desc);
     }
 
-    // Preparar aleatoriedad
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    unsigned int seed = (unsigned int)(tv.tv_sec ^ tv.tv_usec ^ getpid());
-    srand(seed);
-    printf("🔢 Semilla aleatoria: %u\n", seed);
+    // Plan a partir de la semilla
+    irq_suite_plan_t plan;
+    irq_suite_plan(IRQ_SUITE_ADVANCED, seed, &plan);
+    printf("🔢 Semilla aleatoria: %llu\n", (unsigned long long)seed);
 
-    // Prueba 1: Ráfaga de interrupciones
+    // Prueba 1: Ráfaga de interrupciones, repartida entre los hilos del pool
     printf("\n🔥 Prueba 1: Ráfaga de interrupciones rápidas\n");
-    int burst_count = 2 + rand() % 4; // 2-5 interrupciones
-    for (int i = 0; i < burst_count; i++) {
-        int idx = rand() % (sizeof(irq_table) / sizeof(irq_table[0]));
-        printf("  💥 Ráfaga %d → IRQ%d: %s\n", i+1, irq_table[idx].irq, irq_table[idx].desc);
-        dispatch_interrupt(irq_table[idx].irq);
-        usleep(50000); // 50ms entre interrupciones
-    }
-
-    sleep(1); // Pausa entre pruebas
+    int ev = 0;
+    irq_work_group_t burst_group;
+    irq_work_group_init(&burst_group);
+    struct timeval burst_start, burst_end;
+    gettimeofday(&burst_start, NULL);
+    for (; ev < plan.num_events && plan.events[ev].pooled; ev++) {
+        const irq_suite_event_t *event = &plan.events[ev];
+        printf("  💥 Ráfaga %d → IRQ%d: %s\n", ev + 1, event->irq, irq_table[event->table_idx].desc);
+        irq_work_submit(dispatch_work, (void *)(intptr_t)event->irq, &burst_group);
+    }
+    irq_work_group_wait(&burst_group);
+    irq_work_group_destroy(&burst_group);
+    gettimeofday(&burst_end, NULL);
+    printf("  ⏱️  Ráfaga atendida en %.1f ms\n",
+           (burst_end.tv_sec - burst_start.tv_sec) * 1000.0 +
+           (burst_end.tv_usec - burst_start.tv_usec) / 1000.0);
+
+    usleep((useconds_t)plan.events[ev - 1].delay_us); // Pausa entre pruebas
 
     // Prueba 2: Interrupciones con patrones variables
     printf("\n🎯 Prueba 2: Patrón de interrupciones variables\n");
-    int pattern_count = 3 + rand() % 5; // 3-7 interrupciones
-    for (int i = 0; i < pattern_count; i++) {
-        int idx = rand() % (sizeof(irq_table) / sizeof(irq_table[0]));
-        printf("  🎪 Patrón %d → IRQ%d: %s\n", i+1, irq_table[idx].irq, irq_table[idx].desc);
-        dispatch_interrupt(irq_table[idx].irq);
+    for (int i = 1; ev < plan.num_events; ev++, i++) {
+        const irq_suite_event_t *event = &plan.events[ev];
+        printf("  🎪 Patrón %d → IRQ%d: %s\n", i, event->irq, irq_table[event->table_idx].desc);
+        dispatch_interrupt(event->irq);
         
         // Delay variable: corto, medio o largo
-        int delay_type = rand() % 3;
-        useconds_t delay = (delay_type == 0) ? 100000 : 
-                          (delay_type == 1) ? 300000 : 600000;
-        usleep(delay);
+        usleep((useconds_t)event->delay_us);
     }
     // ✅ Mostrar estado modificado de la IDT antes de limpiar
     printf("\n📋 Estado de la IDT tras ejecutar las interrupciones de prueba:\n");
@@ -1222,20 +712,32 @@ void run_advanced_interrupt_test_suite(void) {
     // ✅ Restaurar estado original
     restore_idt_state(idt_backup);
     printf("\n🎉 SUITE AVANZADA COMPLETADA\n");
+    irq_replay_set_source(saved_source);
 }
 
-
-
 // Función principal
-int main() {
+int main(int argc, char *argv[]) {
+    sim_context_t *sim = sim_default();
     int option, irq_num;
     
+    // --rt va antes que todo: los hilos que se creen ya entran en modo RT
+    if (irq_rt_take_args(&argc, &argv) != SUCCESS) {
+        return 2;
+    }
+    
+    // Modos sin menú: no arrancan el timer ni los subsistemas
+    int seed_rc = irq_suite_main(argc, argv);
+    if (seed_rc >= 0) {
+        return seed_rc;
+    }
+
+    irq_replay_set_source(IRQ_REPLAY_SRC_MENU);
     improved_main_initialization();
     
     // Bucle principal del menú
-   while (system_running) {
+   while (sim_is_running(sim)) {
     show_menu();
-    option = get_valid_input(0, 9);
+    option = get_valid_input(0, 10);
     printf("\n");
     
     switch (option) {
@@ -1327,9 +829,14 @@ int main() {
             wait_for_enter();
             break;
             
+        case 10:
+            printf("Abriendo herramientas avanzadas...\n");
+            advanced_submenu();
+            break;
+            
         case 0:
             printf("Finalizando simulador...\n");
-            system_running = 0;
+            sim_request_stop(sim);
             break;
             
         default:
@@ -1339,22 +846,14 @@ int main() {
             break;
     }
     
-    if (system_running) {
+    if (sim_is_running(sim)) {
         printf("\n");
     }
 }
     
     // Limpiar recursos
-    add_trace("Finalizando sistema de interrupciones");
-    
-    // Esperar a que termine el hilo del timer
-    if (pthread_join(timer_thread, NULL) != 0) {
-        printf("Advertencia: Error al finalizar hilo del timer\n");
-    }
-    
-    pthread_mutex_destroy(&idt_mutex);
-    pthread_mutex_destroy(&trace_mutex);
+    sim_system_shutdown();
     
     printf("Simulador finalizado correctamente.\n");
     return SUCCESS;
-}
\ No newline at end of file
+}
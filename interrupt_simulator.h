@@ -9,42 +9,44 @@
 #include <pthread.h>
 #include <errno.h>
 #include <sys/time.h>   // Para gettimeofday
+#include <sched.h>      // Para sched_getcpu
+#include <limits.h>     // Para ULONG_MAX
+#include <stdint.h>     // Para uint64_t
 #include <unistd.h>     // Para getpid
+#include "irqsim.h"     // API pública del motor
 
-// Configuración del simulador
-#define MAX_INTERRUPTS 16
-#define MAX_TRACE_LINES 100
-#define MAX_TRACE_MSG_LEN 256
-#define MAX_DESCRIPTION_LEN 64
+// Declaraciones internas de la biblioteca y del menú
 
-// Intervalos de tiempo (en segundos y microsegundos)
-#define TIMER_INTERVAL_SEC 3
-#define ISR_SIMULATION_DELAY_US 100000  // 100ms
-#define KEYBOARD_DELAY_US 50000         // 50ms
-#define CUSTOM_DELAY_US 75000           // 75ms
+typedef struct irq_trace_ring irq_trace_ring_t;
 
-// IRQs estándar del sistema
-#define IRQ_TIMER 0
-#define IRQ_KEYBOARD 1
-
-// Códigos de error
-#define SUCCESS 0
-#define ERROR_INVALID_IRQ -1
-#define ERROR_ISR_EXECUTING -2
-#define ERROR_NO_ISR -3
-
-// Macros para validación y acceso seguro
-#define IS_VALID_IRQ(irq) ((irq) >= 0 && (irq) < MAX_INTERRUPTS)
-#define LOCK_IDT() pthread_mutex_lock(&idt_mutex)
-#define UNLOCK_IDT() pthread_mutex_unlock(&idt_mutex)
+// Despachos estáticos aún sin volcar en la IDT (ver sim_account_dispatch)
+typedef struct {
+    unsigned long calls;
+    unsigned long time_us;
+    long last_call;
+} sim_static_pending_t;
+
+// Estado completo de una máquina simulada (opaco en irqsim.h)
+struct sim_context {
+    irq_descriptor_t idt[MAX_INTERRUPTS];   // Tabla de Descriptores de Interrupción
+    pthread_mutex_t idt_mutex;
+    system_stats_t stats;
+    pthread_mutex_t stats_mutex;
+    irq_trace_ring_t *trace;                // NULL = anillo del proceso
+    int system_running;
+    int timer_counter;
+    pthread_t timer_thread;
+    int timer_started;
+    log_level_t log_level;
+    int show_timer_logs;
+    int console;                            // Las trazas se imprimen en la terminal
+    int is_default;                         // Con los subsistemas de proceso
+    sim_static_pending_t pending[MAX_INTERRUPTS]; // Sólo con atómicos, sin idt_mutex
+};
 
-
-// Estados de IRQ
-typedef enum {
-    IRQ_STATE_FREE,
-    IRQ_STATE_REGISTERED,
-    IRQ_STATE_EXECUTING
-} irq_state_t;
+// Macros para acceso seguro
+#define LOCK_IDT() pthread_mutex_lock(&sim_current()->idt_mutex)
+#define UNLOCK_IDT() pthread_mutex_unlock(&sim_current()->idt_mutex)
 
 // Tipos de IRQ según propósito
 typedef enum {
@@ -53,40 +55,6 @@ typedef enum {
     IRQ_TYPE_INVALID   // Para valores fuera de rango (negativo o > 15)
 } irq_type_t;
 
-// Niveles de logging
-typedef enum {
-    LOG_LEVEL_SILENT,
-    LOG_LEVEL_USER_ONLY,
-    LOG_LEVEL_VERBOSE
-} log_level_t;
-
-// Descriptor de IRQ en la IDT
-typedef struct {
-    void (*isr)(int);                    // Puntero a la función ISR
-    irq_state_t state;                   // Estado actual del IRQ
-    int call_count;                      // Número de veces llamada
-    time_t last_call;                    // Timestamp de última llamada
-    unsigned long total_execution_time;  // Tiempo total de ejecución en μs
-    char description[MAX_DESCRIPTION_LEN]; // Descripción del handler
-} irq_descriptor_t;
-
-// Entrada de traza
-typedef struct {
-    char timestamp[16];
-    char event[MAX_TRACE_MSG_LEN];
-    int irq_num;
-} trace_entry_t;
-
-// Estadísticas del sistema
-typedef struct {
-    unsigned long total_interrupts;
-    unsigned long timer_interrupts;
-    unsigned long keyboard_interrupts;
-    unsigned long custom_interrupts;
-    double average_response_time;
-    time_t system_start_time;
-} system_stats_t;
-
 // Entrada para tabla de IRQs de prueba
 typedef struct {
     int irq;
@@ -107,52 +75,23 @@ static const irq_entry_t irq_table[] = {
     {11, "Controlador SCSI"}
 };
 
-// Variables globales
-extern irq_descriptor_t idt[MAX_INTERRUPTS];
-extern trace_entry_t trace_log[MAX_TRACE_LINES];
-extern int trace_index;
-extern int system_running;
-extern int timer_counter;
-extern pthread_t timer_thread;
-extern pthread_mutex_t idt_mutex;
-extern pthread_mutex_t trace_mutex;
-extern system_stats_t stats;
-extern log_level_t current_log_level;
-extern int show_timer_logs;
-
-// Funciones de utilidad
-void get_timestamp(char *buffer, size_t size);
-int validate_irq_num(int irq_num);
-int is_irq_available(int irq_num);
-const char* get_irq_state_string(irq_state_t state);
 irq_type_t get_irq_type(int irq_num);
-
-// Funciones de trazabilidad
-void add_trace(const char *event);
-void add_trace_with_irq(const char *event, int irq_num);
-void add_trace_silent(const char *event);
-void add_trace_with_irq_silent(const char *event, int irq_num);
-void add_trace_smart(const char *event, int irq_num, int is_timer_related);
-
-// Funciones de configuración
-void set_log_level(log_level_t level);
-void toggle_timer_logs(void);
-
-// Funciones de inicialización
-void init_idt(void);
-void init_system_stats(void);
 void update_stats(int irq_num, unsigned long execution_time);
 
-// Funciones de manejo de ISR
-int register_isr(int irq_num, void (*isr_function)(int), const char *description);
-int unregister_isr(int irq_num);
-void dispatch_interrupt(int irq_num);
+// Etapas del despacho (las usan el presupuesto y las corrutinas)
+void (*begin_isr_execution(int irq_num))(int);
+void execute_isr(int irq_num, void (*isr_function)(int), int is_timer_irq);
+void finish_isr_execution(int irq_num, unsigned long execution_time, uint64_t end_ns,
+                          int unhandled, int is_timer_irq, int restore_state);
+void get_last_isr_entry_time(struct timespec *ts);
 
-// ISRs predefinidas
-void timer_isr(int irq_num);
-void keyboard_isr(int irq_num);
-void custom_isr(int irq_num);
-void error_isr(int irq_num);
+// Qué hizo el último dispatch_interrupt() de este hilo
+typedef enum {
+    DISPATCH_DROPPED,                       // Fuera de rango, enmascarada, sin handler, reentrada...
+    DISPATCH_DEFERRED,                      // Entregada al hilo del handler o a una corrutina
+    DISPATCH_EXECUTED                       // La ISR corrió en este hilo
+} dispatch_outcome_t;
+dispatch_outcome_t get_last_dispatch_outcome(void);
 
 // Funciones de hilo
 void* timer_thread_func(void* arg);
@@ -167,9 +106,13 @@ void show_system_stats(void);
 void show_help(void);
 void show_menu(void);
 void logging_submenu(void);
+void advanced_submenu(void);
 
 // Funciones de pruebas
 void run_interrupt_test_suite(void);
+void run_interrupt_test_suite_seeded(uint64_t seed);
+void run_advanced_interrupt_test_suite(void);
+void run_advanced_interrupt_test_suite_seeded(uint64_t seed);
 void test_concurrent_interrupts(void);
 void test_stress_interrupts(void);
 
@@ -179,12 +122,8 @@ int get_valid_input(int min, int max);
 void wait_for_enter(void);
 void improved_main_initialization(void);
 
-// Funciones de backup/restore
-void save_idt_state(irq_descriptor_t *backup);
-void restore_idt_state(const irq_descriptor_t *backup);
-void cleanup_test_isrs(void);
-
 // Funciones auxiliares para detección de trazas
 int is_timer_related_trace(const trace_entry_t *entry);
+const char *get_irq_description(int irq_num);
 
-#endif // INTERRUPT_SIMULATOR_H
\ No newline at end of file
+#endif // INTERRUPT_SIMULATOR_H
@@ -0,0 +1,45 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stddef.h>
+
+// Sonda de reservas de heap para las pruebas (cargar con LD_PRELOAD)
+//
+// Intercepta las funciones de reserva, las cuenta y las pasa a glibc. El
+// simulador enlaza irq_alloc_probe_count() como símbolo débil: sin la sonda
+// cargada la función no existe y la comprobación se desactiva.
+
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+
+static unsigned long alloc_calls = 0;
+
+unsigned long irq_alloc_probe_count(void) {
+    return __atomic_load_n(&alloc_calls, __ATOMIC_RELAXED);
+}
+
+void *malloc(size_t size) {
+    __atomic_add_fetch(&alloc_calls, 1, __ATOMIC_RELAXED);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    __atomic_add_fetch(&alloc_calls, 1, __ATOMIC_RELAXED);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    __atomic_add_fetch(&alloc_calls, 1, __ATOMIC_RELAXED);
+    return __libc_realloc(ptr, size);
+}
+
+int posix_memalign(void **out, size_t alignment, size_t size) {
+    __atomic_add_fetch(&alloc_calls, 1, __ATOMIC_RELAXED);
+    void *ptr = __libc_memalign(alignment, size);
+    if (ptr == NULL) {
+        return ENOMEM;
+    }
+    *out = ptr;
+    return 0;
+}
@@ -0,0 +1,529 @@
+#define _GNU_SOURCE
+#include <math.h>
+#include "irq_balance.h"
+
+static pthread_t balance_thread;
+static int balance_running = 0;
+static int balance_enabled = 0;
+static pthread_mutex_t balance_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Configuración y estadísticas (balance_mutex)
+static int balance_cpus = IRQ_BALANCE_DEFAULT_CPUS;
+static int balance_interval_ms = IRQ_BALANCE_DEFAULT_INTERVAL_MS;
+static int balance_threshold_pct = IRQ_BALANCE_DEFAULT_THRESHOLD_PCT;
+static unsigned long balance_rounds = 0;
+static unsigned long balance_migrations = 0;
+static unsigned long balance_placements = 0;
+static double balance_cpu_load[IRQ_SHM_MAX_CPUS];
+static unsigned long balance_vector_migrations[MAX_INTERRUPTS];
+
+// Estado del muestreo (sólo el hilo balanceador)
+static unsigned long prev_exec_us[MAX_INTERRUPTS];
+static double vector_load[MAX_INTERRUPTS];
+static int vector_cooldown[MAX_INTERRUPTS];
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Media móvil para que un pico aislado no dispare migraciones
+static double smooth_load(double previous, double sample) {
+    return 0.5 * previous + 0.5 * sample;
+}
+
+int irq_balance_plan(const double *load, int *affinity, int *cooldown, int count,
+                     int cpus, double threshold, irq_balance_move_t *moves, int max_moves) {
+    double cpu_load[IRQ_SHM_MAX_CPUS] = {0};
+    int n = 0;
+
+    for (int v = 0; v < count; v++) {
+        if (cooldown[v] > 0) {
+            cooldown[v]--;
+        }
+        if (affinity[v] >= 0 && affinity[v] < cpus) {
+            cpu_load[affinity[v]] += load[v];
+        }
+    }
+
+    // Vectores con carga fuera del dominio: colocarlos en la CPU más libre
+    for (int v = 0; v < count; v++) {
+        if ((affinity[v] >= 0 && affinity[v] < cpus) || load[v] <= 0.0) {
+            continue;
+        }
+        int target = 0;
+        for (int c = 1; c < cpus; c++) {
+            if (cpu_load[c] < cpu_load[target]) {
+                target = c;
+            }
+        }
+        moves[n].irq = v;
+        moves[n].from = affinity[v];
+        moves[n].to = target;
+        moves[n].load = load[v];
+        n++;
+        affinity[v] = target;
+        cpu_load[target] += load[v];
+    }
+
+    // Migraciones de la CPU más cargada a la más libre
+    for (int m = 0; m < max_moves; m++) {
+        int hot = 0, cold = 0;
+        for (int c = 1; c < cpus; c++) {
+            if (cpu_load[c] > cpu_load[hot]) {
+                hot = c;
+            }
+            if (cpu_load[c] < cpu_load[cold]) {
+                cold = c;
+            }
+        }
+        if (cpu_load[hot] - cpu_load[cold] <= threshold) {
+            break;
+        }
+
+        // El vector que deja el par más equilibrado, si la mejora merece la pena
+        int best = -1;
+        double best_peak = cpu_load[hot] - threshold / 2.0;
+        for (int v = 0; v < count; v++) {
+            if (affinity[v] != hot || cooldown[v] > 0 || load[v] <= 0.0) {
+                continue;
+            }
+            double peak = fmax(cpu_load[hot] - load[v], cpu_load[cold] + load[v]);
+            if (peak < best_peak) {
+                best_peak = peak;
+                best = v;
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+
+        moves[n].irq = best;
+        moves[n].from = hot;
+        moves[n].to = cold;
+        moves[n].load = load[best];
+        n++;
+        affinity[best] = cold;
+        cooldown[best] = IRQ_BALANCE_COOLDOWN_ROUNDS;
+        cpu_load[hot] -= load[best];
+        cpu_load[cold] += load[best];
+    }
+    return n;
+}
+
+// Una ronda sobre la IDT real
+static void balance_round(double elapsed_us) {
+    irq_descriptor_t *idt = sim_default()->idt;
+    int affinity[MAX_INTERRUPTS];
+    irq_balance_move_t moves[MAX_INTERRUPTS + IRQ_BALANCE_MAX_MOVES];
+
+    pthread_mutex_lock(&balance_mutex);
+    int cpus = balance_cpus;
+    double threshold = balance_threshold_pct / 100.0;
+    pthread_mutex_unlock(&balance_mutex);
+
+    LOCK_IDT();
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        affinity[i] = idt[i].cpu_affinity;
+        if (idt[i].isr == NULL || idt[i].state == IRQ_STATE_FREE) {
+            prev_exec_us[i] = 0;
+            vector_load[i] = 0.0;
+            continue;
+        }
+        unsigned long total = idt[i].total_execution_time;
+        unsigned long delta = total >= prev_exec_us[i] ? total - prev_exec_us[i] : total;
+        prev_exec_us[i] = total;
+        vector_load[i] = smooth_load(vector_load[i], delta / elapsed_us);
+    }
+    UNLOCK_IDT();
+
+    if (!__atomic_load_n(&balance_enabled, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    int n = irq_balance_plan(vector_load, affinity, vector_cooldown, MAX_INTERRUPTS,
+                             cpus, threshold, moves, IRQ_BALANCE_MAX_MOVES);
+
+    LOCK_IDT();
+    for (int m = 0; m < n; m++) {
+        if (idt[moves[m].irq].isr != NULL) {
+            idt[moves[m].irq].cpu_affinity = moves[m].to;
+        }
+    }
+    UNLOCK_IDT();
+
+    pthread_mutex_lock(&balance_mutex);
+    balance_rounds++;
+    memset(balance_cpu_load, 0, sizeof(balance_cpu_load));
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        if (affinity[i] >= 0 && affinity[i] < cpus) {
+            balance_cpu_load[affinity[i]] += vector_load[i];
+        }
+    }
+    for (int m = 0; m < n; m++) {
+        if (moves[m].from < 0) {
+            balance_placements++;
+        } else {
+            balance_migrations++;
+            balance_vector_migrations[moves[m].irq]++;
+        }
+    }
+    pthread_mutex_unlock(&balance_mutex);
+
+    for (int m = 0; m < n; m++) {
+        char trace_msg[MAX_TRACE_MSG_LEN];
+        if (moves[m].from < 0) {
+            snprintf(trace_msg, sizeof(trace_msg),
+                "⚖️  BALANCE: IRQ %d colocada en CPU %d (carga %.1f%%)",
+                moves[m].irq, moves[m].to, moves[m].load * 100.0);
+        } else {
+            snprintf(trace_msg, sizeof(trace_msg),
+                "⚖️  BALANCE: IRQ %d migrada CPU %d → CPU %d (carga %.1f%%)",
+                moves[m].irq, moves[m].from, moves[m].to, moves[m].load * 100.0);
+        }
+        add_trace_smart(trace_msg, moves[m].irq, 0);
+    }
+}
+
+static void *balance_thread_func(void *arg) {
+    (void)arg;
+    uint64_t last = now_ns();
+
+    while (__atomic_load_n(&balance_running, __ATOMIC_ACQUIRE)) {
+        usleep(10000);
+
+        pthread_mutex_lock(&balance_mutex);
+        uint64_t interval_ns = (uint64_t)balance_interval_ms * 1000000ULL;
+        pthread_mutex_unlock(&balance_mutex);
+
+        uint64_t now = now_ns();
+        if (now - last < interval_ns) {
+            continue;
+        }
+        balance_round((now - last) / 1000.0);
+        last = now;
+    }
+    return NULL;
+}
+
+int irq_balance_start(void) {
+    if (__atomic_load_n(&balance_running, __ATOMIC_ACQUIRE)) {
+        return SUCCESS;
+    }
+    __atomic_store_n(&balance_running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&balance_thread, NULL, balance_thread_func, NULL) != 0) {
+        __atomic_store_n(&balance_running, 0, __ATOMIC_RELEASE);
+        return ERROR_INVALID_ARG;
+    }
+    add_trace_silent("⚖️  BALANCE: Hilo balanceador de IRQs iniciado (deshabilitado)");
+    return SUCCESS;
+}
+
+void irq_balance_stop(void) {
+    if (__atomic_load_n(&balance_running, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&balance_running, 0, __ATOMIC_RELEASE);
+        pthread_join(balance_thread, NULL);
+    }
+}
+
+int irq_balance_set_enabled(int enabled) {
+    __atomic_store_n(&balance_enabled, enabled ? 1 : 0, __ATOMIC_RELEASE);
+    add_trace(enabled ? "⚖️  BALANCE: Balanceo de IRQs habilitado" :
+                        "⚖️  BALANCE: Balanceo de IRQs deshabilitado");
+    return SUCCESS;
+}
+
+int irq_balance_configure(int cpus, int interval_ms, int threshold_pct) {
+    if (cpus < 1 || cpus > IRQ_SHM_MAX_CPUS || interval_ms < 10 ||
+        threshold_pct < 0 || threshold_pct > 100) {
+        return ERROR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&balance_mutex);
+    balance_cpus = cpus;
+    balance_interval_ms = interval_ms;
+    balance_threshold_pct = threshold_pct;
+    pthread_mutex_unlock(&balance_mutex);
+    return SUCCESS;
+}
+
+void irq_balance_get_stats(irq_balance_stats_t *out) {
+    pthread_mutex_lock(&balance_mutex);
+    out->running = __atomic_load_n(&balance_running, __ATOMIC_ACQUIRE);
+    out->enabled = __atomic_load_n(&balance_enabled, __ATOMIC_ACQUIRE);
+    out->cpus = balance_cpus;
+    out->interval_ms = balance_interval_ms;
+    out->threshold_pct = balance_threshold_pct;
+    out->rounds = balance_rounds;
+    out->migrations = balance_migrations;
+    out->placements = balance_placements;
+    memcpy(out->cpu_load, balance_cpu_load, sizeof(out->cpu_load));
+    memcpy(out->vector_migrations, balance_vector_migrations, sizeof(out->vector_migrations));
+    pthread_mutex_unlock(&balance_mutex);
+}
+
+// ---- Banco de pruebas: simulación de eventos discretos ----
+
+#define BENCH_VECTORS 16
+#define BENCH_SERVICE_US 20.0               // Coste medio de una ISR
+#define BENCH_UTILIZATION 0.55              // Carga total / capacidad total
+#define BENCH_ROUND_US 10000.0              // Ronda del balanceador simulado
+
+static uint64_t bench_rng_state;
+
+static double bench_uniform(void) {
+    // xorshift64*: determinista para que ambas pasadas vean las mismas llegadas
+    bench_rng_state ^= bench_rng_state >> 12;
+    bench_rng_state ^= bench_rng_state << 25;
+    bench_rng_state ^= bench_rng_state >> 27;
+    return ((bench_rng_state * 2685821657736338717ULL) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static double bench_exponential(double rate) {
+    return -log(1.0 - bench_uniform()) / rate;
+}
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// Tasas Zipf(1) sobre los vectores; 'shift' rota qué vector está caliente
+static void bench_rates(int cpus, int shift, double *rate) {
+    double harmonic = 0.0;
+    for (int r = 0; r < BENCH_VECTORS; r++) {
+        harmonic += 1.0 / (r + 1);
+    }
+    double total = BENCH_UTILIZATION * cpus / BENCH_SERVICE_US;
+    for (int v = 0; v < BENCH_VECTORS; v++) {
+        int rank = (v - shift + BENCH_VECTORS) % BENCH_VECTORS;
+        rate[v] = total * (1.0 / (rank + 1)) / harmonic;
+    }
+}
+
+static int simulate(int cpus, double seconds, int balance, double threshold, irq_balance_bench_t *res) {
+    double rate[BENCH_VECTORS], next_arrival[BENCH_VECTORS];
+    double window_busy[BENCH_VECTORS], load[BENCH_VECTORS];
+    int affinity[BENCH_VECTORS], cooldown[BENCH_VECTORS];
+    double free_at[IRQ_SHM_MAX_CPUS] = {0}, cpu_busy[IRQ_SHM_MAX_CPUS] = {0};
+    irq_balance_move_t moves[BENCH_VECTORS + IRQ_BALANCE_MAX_MOVES];
+    double horizon = seconds * 1e6;
+    size_t capacity = (size_t)(BENCH_UTILIZATION * cpus / BENCH_SERVICE_US * horizon * 1.2) + 1024;
+    double *latency = malloc(capacity * sizeof(double));
+    size_t samples = 0;
+
+    if (latency == NULL) {
+        return ERROR_INVALID_ARG;
+    }
+    memset(res, 0, sizeof(*res));
+    bench_rng_state = 0x9e3779b97f4a7c15ULL;
+
+    // Colocación estática inicial: round-robin, como sin irqbalance
+    bench_rates(cpus, 0, rate);
+    for (int v = 0; v < BENCH_VECTORS; v++) {
+        affinity[v] = v % cpus;
+        cooldown[v] = 0;
+        window_busy[v] = 0.0;
+        load[v] = 0.0;
+        next_arrival[v] = bench_exponential(rate[v]);
+    }
+
+    double next_round = BENCH_ROUND_US;
+    int shifted = 0;
+    for (;;) {
+        int v = 0;
+        for (int i = 1; i < BENCH_VECTORS; i++) {
+            if (next_arrival[i] < next_arrival[v]) {
+                v = i;
+            }
+        }
+        double t = next_arrival[v];
+        if (t > horizon) {
+            break;
+        }
+
+        // A mitad del ensayo cambia el dispositivo caliente
+        if (!shifted && t >= horizon / 2) {
+            shifted = 1;
+            bench_rates(cpus, BENCH_VECTORS / 4 + 1, rate);
+            for (int i = 0; i < BENCH_VECTORS; i++) {
+                next_arrival[i] = t + bench_exponential(rate[i]);
+            }
+            continue;
+        }
+
+        while (t >= next_round) {
+            for (int i = 0; i < BENCH_VECTORS; i++) {
+                load[i] = smooth_load(load[i], window_busy[i] / BENCH_ROUND_US);
+                window_busy[i] = 0.0;
+            }
+            if (balance) {
+                int n = irq_balance_plan(load, affinity, cooldown, BENCH_VECTORS, cpus,
+                                         threshold, moves, IRQ_BALANCE_MAX_MOVES);
+                for (int m = 0; m < n; m++) {
+                    if (moves[m].from >= 0) {
+                        res->migrations++;
+                    }
+                }
+            }
+            next_round += BENCH_ROUND_US;
+        }
+
+        // Cada CPU atiende su cola en orden de llegada
+        int cpu = affinity[v];
+        double service = BENCH_SERVICE_US * (0.5 + bench_uniform());
+        double start = t > free_at[cpu] ? t : free_at[cpu];
+        free_at[cpu] = start + service;
+        cpu_busy[cpu] += service;
+        window_busy[v] += service;
+        if (samples < capacity) {
+            latency[samples++] = free_at[cpu] - t;
+        }
+        next_arrival[v] = t + bench_exponential(rate[v]);
+    }
+
+    qsort(latency, samples, sizeof(double), compare_double);
+    double sum = 0.0;
+    for (size_t i = 0; i < samples; i++) {
+        sum += latency[i];
+    }
+    res->samples = samples;
+    if (samples > 0) {
+        res->mean_us = sum / samples;
+        res->p50_us = latency[samples / 2];
+        res->p99_us = latency[(size_t)(samples * 0.99)];
+        res->p999_us = latency[(size_t)(samples * 0.999)];
+        res->max_us = latency[samples - 1];
+    }
+    for (int c = 0; c < cpus; c++) {
+        if (cpu_busy[c] / horizon > res->max_cpu_util) {
+            res->max_cpu_util = cpu_busy[c] / horizon;
+        }
+    }
+    free(latency);
+    return SUCCESS;
+}
+
+int irq_balance_benchmark(double seconds, irq_balance_bench_t *off, irq_balance_bench_t *on) {
+    if (seconds <= 0.0 || seconds > 60.0) {
+        return ERROR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&balance_mutex);
+    int cpus = balance_cpus;
+    double threshold = balance_threshold_pct / 100.0;
+    pthread_mutex_unlock(&balance_mutex);
+
+    if (cpus < 2) {
+        return ERROR_INVALID_ARG;
+    }
+    int result = simulate(cpus, seconds, 0, threshold, off);
+    if (result == SUCCESS) {
+        result = simulate(cpus, seconds, 1, threshold, on);
+    }
+    return result;
+}
+
+void show_irq_balance(void) {
+    irq_descriptor_t *idt = sim_default()->idt;
+    irq_balance_stats_t st;
+    irq_balance_get_stats(&st);
+
+    printf("\n=== BALANCEADOR DE IRQs ===\n");
+    printf("Hilo: %s │ Balanceo: %s │ CPUs simuladas: %d │ Intervalo: %d ms │ Umbral: %d%%\n",
+           st.running ? "ACTIVO" : "DETENIDO", st.enabled ? "HABILITADO" : "DESHABILITADO",
+           st.cpus, st.interval_ms, st.threshold_pct);
+    printf("Rondas: %lu │ Migraciones: %lu │ Colocaciones iniciales: %lu\n\n",
+           st.rounds, st.migrations, st.placements);
+
+    printf("CPU │ Carga  │ Vectores\n");
+    for (int c = 0; c < st.cpus; c++) {
+        printf("%3d │ %5.1f%% │", c, st.cpu_load[c] * 100.0);
+        LOCK_IDT();
+        for (int i = 0; i < MAX_INTERRUPTS; i++) {
+            if (idt[i].isr != NULL && idt[i].cpu_affinity == c) {
+                printf(" %d", i);
+            }
+        }
+        UNLOCK_IDT();
+        printf("\n");
+    }
+
+    int shown = 0;
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        if (st.vector_migrations[i] > 0) {
+            if (!shown) {
+                printf("\nMigraciones por vector:");
+                shown = 1;
+            }
+            printf(" IRQ%d=%lu", i, st.vector_migrations[i]);
+        }
+    }
+    printf("\n\n");
+}
+
+static void print_bench_row(const char *label, const irq_balance_bench_t *r) {
+    printf("%-12s │ %8.1f │ %8.1f │ %8.1f │ %9.1f │ %9.1f │ %6.1f%% │ %lu\n",
+           label, r->mean_us, r->p50_us, r->p99_us, r->p999_us, r->max_us,
+           r->max_cpu_util * 100.0, r->migrations);
+}
+
+void irq_balance_submenu(void) {
+    int option;
+
+    while (1) {
+        printf("\n=== BALANCEADOR DE IRQs ===\n");
+        printf("1. Mostrar estado y carga por CPU\n");
+        printf("2. Habilitar / deshabilitar el balanceo\n");
+        printf("3. Configurar CPUs, intervalo y umbral\n");
+        printf("4. Comparar latencia con y sin balanceo (carga sesgada)\n");
+        printf("0. Volver\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+
+        option = get_valid_input(0, 4);
+        switch (option) {
+            case 0:
+                return;
+            case 1:
+                show_irq_balance();
+                break;
+            case 2:
+                printf("Balanceo (1 = habilitado, 0 = deshabilitado): ");
+                fflush(stdout);
+                irq_balance_set_enabled(get_valid_input(0, 1));
+                break;
+            case 3: {
+                printf("CPUs simuladas (1-%d): ", IRQ_SHM_MAX_CPUS);
+                fflush(stdout);
+                int cpus = get_valid_input(1, IRQ_SHM_MAX_CPUS);
+                printf("Intervalo en ms (10-60000): ");
+                fflush(stdout);
+                int interval = get_valid_input(10, 60000);
+                printf("Umbral de desequilibrio en %% de CPU (0-100): ");
+                fflush(stdout);
+                int threshold = get_valid_input(0, 100);
+                irq_balance_configure(cpus, interval, threshold);
+                printf("✓ Balanceador configurado.\n");
+                break;
+            }
+            case 4: {
+                irq_balance_bench_t off, on;
+                printf("Segundos simulados (1-60): ");
+                fflush(stdout);
+                int seconds = get_valid_input(1, 60);
+                if (irq_balance_benchmark(seconds, &off, &on) != SUCCESS) {
+                    printf("✗ Se necesitan al menos 2 CPUs simuladas.\n");
+                    break;
+                }
+                printf("\n%d vectores Zipf(1), ISR de %.0f μs, %.0f%% de carga total, "
+                       "el vector caliente cambia a mitad del ensayo\n",
+                       BENCH_VECTORS, BENCH_SERVICE_US, BENCH_UTILIZATION * 100.0);
+                printf("Modo         │ Media μs │  p50 μs  │  p99 μs  │ p99.9 μs  │  Máx. μs  │ CPU máx │ Migraciones\n");
+                print_bench_row("Estático", &off);
+                print_bench_row("Balanceado", &on);
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef IRQ_BALANCE_H
+#define IRQ_BALANCE_H
+
+#include "interrupt_simulator.h"
+#include "irq_shm.h"
+
+// Balanceador de IRQs entre CPUs simuladas (al estilo de irqbalance)
+//
+// Un hilo muestrea cada intervalo el tiempo de handler acumulado por vector en
+// idt[], lo suaviza con una media móvil y reescribe cpu_affinity para igualar
+// la carga de las CPUs. La histéresis evita el vaivén: sólo se migra cuando la
+// diferencia entre la CPU más cargada y la más libre supera un umbral, cada
+// migración debe reducir el pico de forma apreciable y un vector recién
+// migrado queda fijo durante unas rondas.
+
+#define IRQ_BALANCE_DEFAULT_CPUS 4
+#define IRQ_BALANCE_DEFAULT_INTERVAL_MS 1000
+#define IRQ_BALANCE_DEFAULT_THRESHOLD_PCT 10    // % de una CPU
+#define IRQ_BALANCE_COOLDOWN_ROUNDS 3
+#define IRQ_BALANCE_MAX_MOVES 2                 // Migraciones por ronda
+
+typedef struct {
+    int irq;
+    int from;                               // -1 = colocación inicial
+    int to;
+    double load;                            // Fracción de CPU del vector
+} irq_balance_move_t;
+
+typedef struct {
+    int running;
+    int enabled;
+    int cpus;
+    int interval_ms;
+    int threshold_pct;
+    unsigned long rounds;
+    unsigned long migrations;
+    unsigned long placements;
+    double cpu_load[IRQ_SHM_MAX_CPUS];      // Última ronda, fracción de CPU
+    unsigned long vector_migrations[MAX_INTERRUPTS];
+} irq_balance_stats_t;
+
+// Resultado de una pasada del banco de pruebas
+typedef struct {
+    unsigned long samples;
+    double mean_us;
+    double p50_us;
+    double p99_us;
+    double p999_us;
+    double max_us;
+    double max_cpu_util;                    // CPU más cargada, promedio del ensayo
+    unsigned long migrations;
+} irq_balance_bench_t;
+
+// Una ronda de balanceo sobre cargas ya medidas (capacidad = 1.0 por CPU).
+// Actualiza affinity[] y cooldown[] y devuelve el número de movimientos.
+int irq_balance_plan(const double *load, int *affinity, int *cooldown, int count,
+                     int cpus, double threshold, irq_balance_move_t *moves, int max_moves);
+
+// Hilo balanceador (arranca deshabilitado)
+int irq_balance_start(void);
+void irq_balance_stop(void);
+int irq_balance_set_enabled(int enabled);
+int irq_balance_configure(int cpus, int interval_ms, int threshold_pct);
+void irq_balance_get_stats(irq_balance_stats_t *out);
+
+// Simulación de eventos discretos con llegadas sesgadas (Zipf) sobre las CPUs
+// configuradas; compara la latencia con y sin balanceo
+int irq_balance_benchmark(double seconds, irq_balance_bench_t *off, irq_balance_bench_t *on);
+
+void show_irq_balance(void);
+void irq_balance_submenu(void);
+
+#endif // IRQ_BALANCE_H
@@ -0,0 +1,341 @@
+#define _GNU_SOURCE
+#include <stdint.h>
+#include "irq_budget.h"
+#include "irq_storm.h"
+#include "irq_rt.h"
+
+// Estado interno de un vector (protegido por idt_mutex)
+typedef struct {
+    irq_budget_info_t info;
+    uint64_t exec_start_ns;             // 0 = no está en ejecución
+    int stall_reported;                 // El watchdog ya avisó de esta ejecución
+    int worker_started;
+    pthread_t worker;
+    pthread_cond_t cond;
+} budget_state_t;
+
+static budget_state_t budget[MAX_INTERRUPTS];
+static int workers_running = 0;
+static int watchdog_running = 0;
+static pthread_t watchdog_thread;
+
+// Hilo irq/N: ejecuta la ISR de un vector degradado fuera de la mitad superior
+static void *threaded_handler_func(void *arg) {
+    int irq_num = (int)(intptr_t)arg;
+    budget_state_t *b = &budget[irq_num];
+    sim_context_t *sim = sim_default();
+    irq_descriptor_t *idt = sim->idt;
+
+    irq_rt_enter_thread();
+    LOCK_IDT();
+    while (workers_running) {
+        if (b->info.pending == 0) {
+            pthread_cond_wait(&b->cond, &sim->idt_mutex);
+            continue;
+        }
+        b->info.pending--;
+        if (idt[irq_num].state != IRQ_STATE_REGISTERED || idt[irq_num].isr == NULL) {
+            continue;
+        }
+
+        void (*isr_function)(int) = begin_isr_execution(irq_num);
+        UNLOCK_IDT();
+        execute_isr(irq_num, isr_function, irq_num == IRQ_TIMER);
+        LOCK_IDT();
+    }
+    UNLOCK_IDT();
+    return NULL;
+}
+
+// Con idt_mutex tomado
+static void start_worker(int irq_num) {
+    budget_state_t *b = &budget[irq_num];
+    if (b->worker_started || !workers_running) {
+        return;
+    }
+    if (pthread_create(&b->worker, NULL, threaded_handler_func, (void *)(intptr_t)irq_num) == 0) {
+        b->worker_started = 1;
+    } else {
+        b->info.threaded = 0;
+        add_trace("❌ KERNEL: No se pudo crear el hilo del handler");
+    }
+}
+
+void irq_budget_begin(int irq_num, uint64_t now_ns) {
+    budget[irq_num].exec_start_ns = now_ns;
+    budget[irq_num].stall_reported = 0;
+}
+
+void irq_budget_end(int irq_num, unsigned long execution_us) {
+    budget_state_t *b = &budget[irq_num];
+    char trace_msg[MAX_TRACE_MSG_LEN];
+
+    b->exec_start_ns = 0;
+    b->info.runs++;
+    if (execution_us > b->info.max_us) {
+        b->info.max_us = execution_us;
+    }
+
+    if (b->info.budget_us == 0 || execution_us <= b->info.budget_us) {
+        b->info.consecutive = 0;
+        return;
+    }
+
+    b->info.violations++;
+    b->info.consecutive++;
+
+    // Guardar como muestra atípica (las más recientes al final)
+    if (b->info.outlier_count == IRQ_BUDGET_OUTLIERS) {
+        memmove(&b->info.outliers[0], &b->info.outliers[1],
+                sizeof(b->info.outliers[0]) * (IRQ_BUDGET_OUTLIERS - 1));
+        b->info.outlier_count--;
+    }
+    irq_budget_outlier_t *o = &b->info.outliers[b->info.outlier_count++];
+    o->when = time(NULL);
+    o->duration_us = execution_us;
+    o->threaded = b->info.threaded;
+
+    // Sólo se avisa al empezar cada racha para no inundar la traza
+    if (b->info.consecutive == 1) {
+        snprintf(trace_msg, sizeof(trace_msg),
+            "⏱️  KERNEL: ISR de IRQ %d excedió su presupuesto (%lu μs > %lu μs)",
+            irq_num, execution_us, b->info.budget_us);
+        add_trace_smart(trace_msg, irq_num, irq_num == IRQ_TIMER);
+    }
+
+    if (b->info.auto_demote && !b->info.threaded &&
+        b->info.consecutive >= IRQ_BUDGET_DEMOTE_AFTER) {
+        b->info.threaded = 1;
+        start_worker(irq_num);
+        snprintf(trace_msg, sizeof(trace_msg),
+            "⬇️  KERNEL: IRQ %d degradada a handler en hilo (irq/%d) tras %lu violaciones seguidas",
+            irq_num, irq_num, b->info.consecutive);
+        add_trace_smart(trace_msg, irq_num, 0);
+    }
+}
+
+int irq_budget_defer(int irq_num) {
+    budget_state_t *b = &budget[irq_num];
+    if (!b->info.threaded) {
+        return 0;
+    }
+    if (b->info.pending >= IRQ_BUDGET_MAX_PENDING) {
+        b->info.dropped++;
+        irq_storm_account(irq_num, irq_storm_now_ns(), IRQ_STORM_OVERRUN);
+        return 1;
+    }
+    b->info.pending++;
+    b->info.deferred++;
+    pthread_cond_signal(&b->cond);
+    return 1;
+}
+
+void irq_budget_init(void) {
+    LOCK_IDT();
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        memset(&budget[i].info, 0, sizeof(budget[i].info));
+        budget[i].info.budget_us = IRQ_BUDGET_DEFAULT_US;
+        budget[i].info.deadline_us = IRQ_BUDGET_DEFAULT_DEADLINE_US;
+        budget[i].exec_start_ns = 0;
+        budget[i].stall_reported = 0;
+        budget[i].worker_started = 0;
+        pthread_cond_init(&budget[i].cond, NULL);
+    }
+    workers_running = 1;
+    UNLOCK_IDT();
+}
+
+int irq_budget_configure(int irq_num, unsigned long budget_us,
+                         unsigned long deadline_us, int auto_demote) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+    LOCK_IDT();
+    budget[irq_num].info.budget_us = budget_us;
+    budget[irq_num].info.deadline_us = deadline_us;
+    budget[irq_num].info.auto_demote = auto_demote ? 1 : 0;
+    budget[irq_num].info.consecutive = 0;
+    UNLOCK_IDT();
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg),
+        "⚙️  KERNEL: Presupuesto de IRQ %d: %lu μs, watchdog %lu μs, degradación %s",
+        irq_num, budget_us, deadline_us, auto_demote ? "automática" : "desactivada");
+    add_trace_smart(trace_msg, irq_num, 0);
+    return SUCCESS;
+}
+
+int irq_budget_set_threaded(int irq_num, int threaded) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+    LOCK_IDT();
+    budget[irq_num].info.threaded = threaded ? 1 : 0;
+    budget[irq_num].info.consecutive = 0;
+    if (threaded) {
+        start_worker(irq_num);
+    }
+    threaded = budget[irq_num].info.threaded;
+    UNLOCK_IDT();
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg), "🧵 KERNEL: IRQ %d atendida %s",
+             irq_num, threaded ? "por su hilo irq/N" : "en la mitad superior");
+    add_trace_smart(trace_msg, irq_num, 0);
+    return SUCCESS;
+}
+
+int irq_budget_get_info(int irq_num, irq_budget_info_t *out) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+    LOCK_IDT();
+    *out = budget[irq_num].info;
+    UNLOCK_IDT();
+    return SUCCESS;
+}
+
+// Watchdog: vectores que llevan demasiado tiempo en IRQ_STATE_EXECUTING
+static void *watchdog_func(void *arg) {
+    irq_descriptor_t *idt = sim_default()->idt;
+    (void)arg;
+
+    while (__atomic_load_n(&watchdog_running, __ATOMIC_ACQUIRE)) {
+        usleep(IRQ_WATCHDOG_PERIOD_US);
+
+        uint64_t now_ns = irq_storm_now_ns();
+        LOCK_IDT();
+        for (int i = 0; i < MAX_INTERRUPTS; i++) {
+            budget_state_t *b = &budget[i];
+            if (idt[i].state != IRQ_STATE_EXECUTING || b->exec_start_ns == 0 ||
+                b->info.deadline_us == 0 || b->stall_reported) {
+                continue;
+            }
+            uint64_t elapsed_us = (now_ns - b->exec_start_ns) / 1000;
+            if (elapsed_us <= b->info.deadline_us) {
+                continue;
+            }
+            b->stall_reported = 1;
+            b->info.stalls++;
+
+            char trace_msg[MAX_TRACE_MSG_LEN];
+            snprintf(trace_msg, sizeof(trace_msg),
+                "🐕 WATCHDOG: IRQ %d lleva %lu ms en EJECUTANDO (límite %lu ms) - Handler posiblemente colgado",
+                i, (unsigned long)(elapsed_us / 1000), b->info.deadline_us / 1000);
+            add_trace_smart(trace_msg, i, i == IRQ_TIMER);
+        }
+        UNLOCK_IDT();
+    }
+    return NULL;
+}
+
+int irq_watchdog_start(void) {
+    if (__atomic_load_n(&watchdog_running, __ATOMIC_ACQUIRE)) {
+        return SUCCESS;
+    }
+    __atomic_store_n(&watchdog_running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&watchdog_thread, NULL, watchdog_func, NULL) != 0) {
+        __atomic_store_n(&watchdog_running, 0, __ATOMIC_RELEASE);
+        return ERROR_INVALID_ARG;
+    }
+    add_trace_silent("🐕 WATCHDOG: Vigilancia de ISRs colgadas iniciada");
+    return SUCCESS;
+}
+
+void irq_budget_shutdown(void) {
+    if (__atomic_load_n(&watchdog_running, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&watchdog_running, 0, __ATOMIC_RELEASE);
+        pthread_join(watchdog_thread, NULL);
+    }
+
+    LOCK_IDT();
+    workers_running = 0;
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        pthread_cond_broadcast(&budget[i].cond);
+    }
+    UNLOCK_IDT();
+
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        if (budget[i].worker_started) {
+            pthread_join(budget[i].worker, NULL);
+            budget[i].worker_started = 0;
+        }
+    }
+}
+
+void show_irq_budgets(void) {
+    printf("\n=== PRESUPUESTOS DE EJECUCIÓN Y WATCHDOG ===\n");
+    printf("Watchdog: %s (cada %d ms)\n\n",
+           __atomic_load_n(&watchdog_running, __ATOMIC_ACQUIRE) ? "ACTIVO" : "DETENIDO",
+           IRQ_WATCHDOG_PERIOD_US / 1000);
+    printf("IRQ │ Presup. μs │ Límite ms │ Modo   │ Ejecuc. │ Violac. │ Colgadas │ En hilo  │ Máx. μs\n");
+
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        irq_budget_info_t info;
+        irq_budget_get_info(i, &info);
+        if (info.runs == 0 && !info.threaded && !info.auto_demote) {
+            continue;
+        }
+        printf("%3d │ %10lu │ %9lu │ %-6s │ %7lu │ %7lu │ %8lu │ %8lu │ %lu\n",
+               i, info.budget_us, info.deadline_us / 1000,
+               info.threaded ? "hilo" : (info.auto_demote ? "auto" : "inline"),
+               info.runs, info.violations, info.stalls, info.deferred, info.max_us);
+        if (info.outlier_count > 0) {
+            printf("    └─ Atípicas recientes (μs):");
+            for (int j = 0; j < info.outlier_count; j++) {
+                printf(" %lu%s", info.outliers[j].duration_us, info.outliers[j].threaded ? "h" : "");
+            }
+            printf("\n");
+        }
+        if (info.dropped > 0) {
+            printf("    └─ %lu interrupciones perdidas por cola del hilo llena\n", info.dropped);
+        }
+    }
+    printf("(h = ejecución en hilo; se omiten vectores sin ejecuciones)\n\n");
+}
+
+void irq_budget_submenu(void) {
+    int option, irq_num;
+
+    while (1) {
+        printf("\n=== PRESUPUESTOS Y WATCHDOG ===\n");
+        printf("1. Mostrar presupuestos, violaciones y atípicas\n");
+        printf("2. Configurar presupuesto, límite del watchdog y degradación\n");
+        printf("3. Atender un IRQ en hilo / en mitad superior\n");
+        printf("0. Volver\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+
+        option = get_valid_input(0, 3);
+        if (option == 0) {
+            return;
+        }
+        if (option == 1) {
+            show_irq_budgets();
+            continue;
+        }
+
+        printf("Ingrese el número de IRQ (0-%d): ", MAX_INTERRUPTS - 1);
+        fflush(stdout);
+        irq_num = get_valid_input(0, MAX_INTERRUPTS - 1);
+
+        if (option == 2) {
+            printf("Presupuesto en μs (0 = sin presupuesto, máx. 10000000): ");
+            fflush(stdout);
+            int budget_us = get_valid_input(0, 10000000);
+            printf("Límite del watchdog en ms (0 = desactivado, máx. 60000): ");
+            fflush(stdout);
+            int deadline_ms = get_valid_input(0, 60000);
+            printf("¿Degradar a hilo automáticamente? (1 = sí, 0 = no): ");
+            fflush(stdout);
+            int demote = get_valid_input(0, 1);
+            irq_budget_configure(irq_num, (unsigned long)budget_us,
+                                 (unsigned long)deadline_ms * 1000, demote);
+        } else {
+            printf("Modo (1 = hilo irq/%d, 0 = mitad superior): ", irq_num);
+            fflush(stdout);
+            irq_budget_set_threaded(irq_num, get_valid_input(0, 1));
+        }
+        printf("✓ Configuración actualizada para IRQ %d.\n", irq_num);
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef IRQ_BUDGET_H
+#define IRQ_BUDGET_H
+
+#include <stdint.h>
+#include "interrupt_simulator.h"
+
+// Presupuestos de ejecución por handler y watchdog de ISRs colgadas
+//
+// Cada ejecución de una ISR se compara con el presupuesto de su vector. Las
+// violaciones se cuentan y se guardan como muestras atípicas. Con la
+// degradación automática activa, tras IRQ_BUDGET_DEMOTE_AFTER violaciones
+// seguidas el vector pasa a un handler en hilo (como request_threaded_irq):
+// la mitad superior sólo encola y un hilo irq/N ejecuta la ISR, de modo que
+// quien dispara la interrupción ya no queda bloqueado.
+//
+// El watchdog revisa periódicamente los vectores en IRQ_STATE_EXECUTING y
+// avisa una vez por ejecución cuando superan su plazo límite.
+
+#define IRQ_BUDGET_DEFAULT_US 1000              // 1 ms para una mitad superior
+#define IRQ_BUDGET_DEFAULT_DEADLINE_US 500000   // 500 ms para el watchdog
+#define IRQ_BUDGET_DEMOTE_AFTER 3               // Violaciones seguidas
+#define IRQ_BUDGET_OUTLIERS 8                   // Muestras atípicas por vector
+#define IRQ_BUDGET_MAX_PENDING 1024             // Cola del handler en hilo
+#define IRQ_WATCHDOG_PERIOD_US 10000            // 10 ms
+
+// Ejecución que violó el presupuesto
+typedef struct {
+    time_t when;
+    unsigned long duration_us;
+    int threaded;
+} irq_budget_outlier_t;
+
+typedef struct {
+    unsigned long budget_us;                // 0 = sin presupuesto
+    unsigned long deadline_us;              // 0 = watchdog desactivado
+    int auto_demote;
+    int threaded;                           // Handler degradado a hilo
+    unsigned long runs;
+    unsigned long violations;
+    unsigned long consecutive;
+    unsigned long stalls;                   // Avisos del watchdog
+    unsigned long deferred;                 // Interrupciones encoladas al hilo
+    unsigned long dropped;                  // Cola del hilo llena
+    unsigned long pending;
+    unsigned long max_us;
+    int outlier_count;
+    irq_budget_outlier_t outliers[IRQ_BUDGET_OUTLIERS];  // Más reciente al final
+} irq_budget_info_t;
+
+// Llamadas desde el despacho con idt_mutex tomado
+void irq_budget_begin(int irq_num, uint64_t now_ns);
+void irq_budget_end(int irq_num, unsigned long execution_us);
+int irq_budget_defer(int irq_num);      // 1 = encolada al hilo del handler
+
+// Configuración y consulta (toman idt_mutex)
+void irq_budget_init(void);
+int irq_budget_configure(int irq_num, unsigned long budget_us,
+                         unsigned long deadline_us, int auto_demote);
+int irq_budget_set_threaded(int irq_num, int threaded);
+int irq_budget_get_info(int irq_num, irq_budget_info_t *out);
+
+// Watchdog e hilos de handler
+int irq_watchdog_start(void);
+void irq_budget_shutdown(void);
+
+void show_irq_budgets(void);
+void irq_budget_submenu(void);
+
+#endif // IRQ_BUDGET_H
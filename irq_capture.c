@@ -0,0 +1,317 @@
+#define _GNU_SOURCE
+#include "irq_capture.h"
+#include "irq_trace.h"
+#include "irq_tracefile.h"
+
+_Static_assert(IRQ_TRACEFILE_FLAG_TIMER == IRQ_TRACE_TIMER, "flags de traza y de captura deben coincidir");
+
+// Entrada del anillo: longitud del texto, registro y texto
+#define ENTRY_HEADER (sizeof(uint32_t) + sizeof(irq_trace_record_t))
+
+static uint8_t *ring = NULL;
+static uint64_t ring_head = 0;              // Productor (con el mutex de la traza)
+static uint64_t ring_tail = 0;              // Hilo escritor
+static unsigned long captured = 0;
+static unsigned long dropped = 0;
+
+static pthread_mutex_t capture_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t writer_thread;
+static int capture_active = 0;
+static int writer_running = 0;
+static int writer_error = 0;
+static irq_tracefile_writer_t *writer = NULL;
+static char capture_dir[256];
+static struct timespec capture_started;
+static double capture_elapsed_s = 0.0;
+static double writer_cpu_ms = 0.0;
+static irq_tracefile_stats_t file_stats;    // Copia publicada por el escritor
+
+static void ring_put(uint64_t pos, const void *src, size_t len) {
+    size_t offset = (size_t)(pos & (IRQ_CAPTURE_RING_SIZE - 1));
+    size_t first = IRQ_CAPTURE_RING_SIZE - offset < len ? IRQ_CAPTURE_RING_SIZE - offset : len;
+    memcpy(ring + offset, src, first);
+    memcpy(ring, (const uint8_t *)src + first, len - first);
+}
+
+static void ring_get(uint64_t pos, void *dst, size_t len) {
+    size_t offset = (size_t)(pos & (IRQ_CAPTURE_RING_SIZE - 1));
+    size_t first = IRQ_CAPTURE_RING_SIZE - offset < len ? IRQ_CAPTURE_RING_SIZE - offset : len;
+    memcpy(dst, ring + offset, first);
+    memcpy((uint8_t *)dst + first, ring, len - first);
+}
+
+// Receptor de la traza: el mutex del anillo serializa a los productores
+static void capture_sink(const irq_trace_record_t *r, const char *payload, size_t len) {
+    uint64_t head = ring_head;
+    uint64_t tail = __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE);
+    if (head - tail + ENTRY_HEADER + len > IRQ_CAPTURE_RING_SIZE) {
+        __atomic_store_n(&dropped, dropped + 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    uint32_t text_len = (uint32_t)len;
+    ring_put(head, &text_len, sizeof(text_len));
+    ring_put(head + sizeof(text_len), r, sizeof(*r));
+    ring_put(head + ENTRY_HEADER, payload, len);
+    __atomic_store_n(&ring_head, head + ENTRY_HEADER + len, __ATOMIC_RELEASE);
+    __atomic_store_n(&captured, captured + 1, __ATOMIC_RELAXED);
+}
+
+static double elapsed_since(const struct timespec *start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+static uint64_t realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Codificar una entrada del anillo
+static void write_entry(uint64_t pos, uint32_t text_len) {
+    irq_trace_record_t r;
+    char text[IRQ_TRACE_SINK_PAYLOAD];
+    irq_tracefile_event_t ev;
+
+    ring_get(pos + sizeof(uint32_t), &r, sizeof(r));
+    ring_get(pos + ENTRY_HEADER, text, text_len);
+    if (irq_trace_template_info(r.template_id, &ev.fmt, &ev.argc) != SUCCESS) {
+        return;
+    }
+    ev.timestamp_ns = r.timestamp_ns;
+    ev.template_id = r.template_id;
+    ev.irq = r.irq;
+    ev.cpu = r.cpu != IRQ_TRACE_NO_CPU ? r.cpu : -1;
+    ev.flags = r.flags;
+    memcpy(ev.args, r.args, sizeof(ev.args));
+    ev.text = text;
+    ev.text_len = text_len;
+    if (irq_tracefile_write(writer, &ev) < 0) {
+        writer_error = 1;
+    }
+}
+
+static void publish_stats(void) {
+    struct timespec cpu;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpu);
+    pthread_mutex_lock(&capture_mutex);
+    irq_tracefile_writer_stats(writer, &file_stats);
+    writer_cpu_ms = (double)cpu.tv_sec * 1000.0 + (double)cpu.tv_nsec / 1e6;
+    pthread_mutex_unlock(&capture_mutex);
+}
+
+static void *capture_writer(void *arg) {
+    (void)arg;
+    struct timespec idle = {0, 2000000};    // 2 ms
+
+    while (1) {
+        // Leer el aviso de parada antes que head: lo publicado antes se vacía
+        int stopping = !__atomic_load_n(&writer_running, __ATOMIC_ACQUIRE);
+        uint64_t head = __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE);
+        uint64_t tail = ring_tail;
+        if (head == tail) {
+            if (stopping) {
+                break;
+            }
+            uint64_t pending = irq_tracefile_pending_since(writer);
+            if (pending != 0 && realtime_ns() - pending >= IRQ_CAPTURE_FLUSH_MS * 1000000ULL) {
+                if (irq_tracefile_flush(writer) < 0) {
+                    writer_error = 1;
+                }
+            }
+            publish_stats();
+            nanosleep(&idle, NULL);
+            continue;
+        }
+
+        // Vaciar todo lo publicado antes de liberar el espacio de una vez
+        while (tail != head) {
+            uint32_t text_len;
+            ring_get(tail, &text_len, sizeof(text_len));
+            write_entry(tail, text_len);
+            tail += ENTRY_HEADER + text_len;
+        }
+        __atomic_store_n(&ring_tail, tail, __ATOMIC_RELEASE);
+    }
+
+    publish_stats();
+    return NULL;
+}
+
+int irq_capture_start(const char *dir, unsigned long chunk_kb) {
+    if (dir == NULL || dir[0] == '\0' || strlen(dir) >= sizeof(capture_dir)) {
+        return ERROR_INVALID_ARG;
+    }
+    if (chunk_kb == 0) {
+        chunk_kb = IRQ_CAPTURE_DEFAULT_CHUNK_KB;
+    }
+    if (chunk_kb < IRQ_CAPTURE_MIN_CHUNK_KB) {
+        return ERROR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&capture_mutex);
+    if (capture_active) {
+        pthread_mutex_unlock(&capture_mutex);
+        return ERROR_CAPTURE;
+    }
+    ring = malloc(IRQ_CAPTURE_RING_SIZE);
+    writer = ring != NULL ? irq_tracefile_writer_open(dir, (uint64_t)chunk_kb * 1024) : NULL;
+    if (writer == NULL) {
+        free(ring);
+        ring = NULL;
+        pthread_mutex_unlock(&capture_mutex);
+        return ERROR_CAPTURE;
+    }
+    snprintf(capture_dir, sizeof(capture_dir), "%s", dir);
+    ring_head = ring_tail = 0;
+    captured = dropped = 0;
+    writer_error = 0;
+    writer_cpu_ms = 0.0;
+    irq_tracefile_writer_stats(writer, &file_stats);
+    clock_gettime(CLOCK_MONOTONIC, &capture_started);
+
+    writer_running = 1;
+    if (pthread_create(&writer_thread, NULL, capture_writer, NULL) != 0) {
+        writer_running = 0;
+        irq_tracefile_writer_close(writer, NULL);
+        writer = NULL;
+        free(ring);
+        ring = NULL;
+        pthread_mutex_unlock(&capture_mutex);
+        return ERROR_CAPTURE;
+    }
+    capture_active = 1;
+    pthread_mutex_unlock(&capture_mutex);
+
+    irq_trace_set_sink(capture_sink);
+    add_trace_with_irqf(-1, "💾 Captura de traza iniciada en %s", dir);
+    return SUCCESS;
+}
+
+int irq_capture_stop(void) {
+    pthread_mutex_lock(&capture_mutex);
+    if (!capture_active) {
+        pthread_mutex_unlock(&capture_mutex);
+        return ERROR_CAPTURE;
+    }
+    capture_active = 0;
+    pthread_mutex_unlock(&capture_mutex);
+
+    // Tras desconectar el receptor nadie más escribe en el anillo
+    irq_trace_set_sink(NULL);
+    __atomic_store_n(&writer_running, 0, __ATOMIC_RELEASE);
+    pthread_join(writer_thread, NULL);
+
+    pthread_mutex_lock(&capture_mutex);
+    // Las cifras finales incluyen el último bloque y el índice
+    int result = irq_tracefile_writer_close(writer, &file_stats) < 0 || writer_error ? ERROR_CAPTURE : SUCCESS;
+    writer = NULL;
+    free(ring);
+    ring = NULL;
+    capture_elapsed_s = elapsed_since(&capture_started);
+    pthread_mutex_unlock(&capture_mutex);
+
+    add_trace_with_irqf(-1, "💾 Captura de traza detenida (%lu registros, %lu descartados)",
+                        captured, dropped);
+    return result;
+}
+
+void irq_capture_get_stats(irq_capture_stats_t *out) {
+    pthread_mutex_lock(&capture_mutex);
+    out->active = capture_active;
+    snprintf(out->dir, sizeof(out->dir), "%s", capture_dir);
+    out->captured = __atomic_load_n(&captured, __ATOMIC_RELAXED);
+    out->dropped = __atomic_load_n(&dropped, __ATOMIC_RELAXED);
+    out->events = file_stats.events;
+    out->blocks = file_stats.blocks;
+    out->chunks = file_stats.chunks;
+    out->raw_bytes = file_stats.raw_bytes;
+    out->file_bytes = file_stats.file_bytes;
+    out->bytes_per_event = file_stats.events > 0 ? (double)file_stats.file_bytes / file_stats.events : 0.0;
+    out->elapsed_s = capture_active ? elapsed_since(&capture_started) : capture_elapsed_s;
+    out->writer_cpu_ms = writer_cpu_ms;
+    pthread_mutex_unlock(&capture_mutex);
+}
+
+void irq_capture_shutdown(void) {
+    irq_capture_stop();
+}
+
+void show_capture(void) {
+    irq_capture_stats_t st;
+    irq_capture_get_stats(&st);
+
+    printf("\n=== CAPTURA DE TRAZA A DISCO ===\n");
+    if (st.dir[0] == '\0') {
+        printf("No se ha iniciado ninguna captura.\n\n");
+        return;
+    }
+    printf("Directorio: %s │ Estado: %s │ %.1f s\n", st.dir, st.active ? "ACTIVA" : "detenida", st.elapsed_s);
+    printf("Registros: %lu capturados │ %lu codificados │ %lu descartados\n",
+           st.captured, st.events, st.dropped);
+    printf("Disco: %lu chunks │ %lu bloques │ %.1f KB (%.1f KB sin comprimir)\n",
+           st.chunks, st.blocks, st.file_bytes / 1024.0, st.raw_bytes / 1024.0);
+    printf("Densidad: %.2f bytes/evento (registro en memoria: %zu bytes)\n",
+           st.bytes_per_event, sizeof(irq_trace_record_t));
+    printf("CPU del escritor: %.1f ms (%.2f%% de un núcleo)\n\n", st.writer_cpu_ms,
+           st.elapsed_s > 0 ? st.writer_cpu_ms / 10.0 / st.elapsed_s : 0.0);
+}
+
+// Leer una línea de texto sin el salto final
+static int read_line(const char *prompt, char *buf, size_t size) {
+    printf("%s", prompt);
+    fflush(stdout);
+    if (fgets(buf, (int)size, stdin) == NULL) {
+        return 0;
+    }
+    buf[strcspn(buf, "\n")] = '\0';
+    return buf[0] != '\0';
+}
+
+void capture_submenu(void) {
+    char dir[256];
+    int option;
+
+    while (1) {
+        printf("\n=== CAPTURA DE TRAZA A DISCO ===\n");
+        printf("1. Mostrar estado de la captura\n");
+        printf("2. Iniciar captura\n");
+        printf("3. Detener captura\n");
+        printf("0. Volver\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+
+        option = get_valid_input(0, 3);
+        switch (option) {
+            case 0:
+                return;
+            case 1:
+                show_capture();
+                break;
+            case 2: {
+                if (!read_line("Directorio de captura: ", dir, sizeof(dir))) {
+                    break;
+                }
+                printf("Tamaño de chunk en KB (0 = %d): ", IRQ_CAPTURE_DEFAULT_CHUNK_KB);
+                fflush(stdout);
+                int chunk_kb = get_valid_input(0, 4 * 1024 * 1024);
+                if (irq_capture_start(dir, (unsigned long)chunk_kb) == SUCCESS) {
+                    printf("✓ Capturando en %s (leer con ./irqtrace %s).\n", dir, dir);
+                } else {
+                    printf("✗ No se pudo iniciar (¿ya activa? ¿directorio accesible? ¿chunk >= %d KB?).\n",
+                           IRQ_CAPTURE_MIN_CHUNK_KB);
+                }
+                break;
+            }
+            case 3:
+                if (irq_capture_stop() == SUCCESS) {
+                    show_capture();
+                } else {
+                    printf("✗ No hay ninguna captura activa.\n");
+                }
+                break;
+        }
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef IRQ_CAPTURE_H
+#define IRQ_CAPTURE_H
+
+#include <stdint.h>
+#include "interrupt_simulator.h"
+
+// Captura continua de la traza a disco para sesiones largas
+//
+// Mientras está activa, cada registro de la traza compacta se copia (con
+// mutex de la traza ya tomado por quien lo emite) a un anillo de bytes de un
+// productor y un consumidor. Un hilo escritor lo vacía, codifica los eventos
+// con irq_tracefile (deltas y varints en bloques comprimidos) y los escribe en
+// ficheros de chunk dentro del directorio de captura. Si el escritor no da
+// abasto el registro se descarta y se cuenta; el despacho nunca espera al
+// disco. Los bloques incompletos se escriben cada IRQ_CAPTURE_FLUSH_MS para
+// que un lector vea la actividad reciente. Los ficheros se leen con irqtrace.
+
+#define IRQ_CAPTURE_RING_SIZE (1u << 22)    // Bytes, potencia de 2
+#define IRQ_CAPTURE_FLUSH_MS 1000
+#define IRQ_CAPTURE_DEFAULT_CHUNK_KB (64 * 1024)
+#define IRQ_CAPTURE_MIN_CHUNK_KB 4
+
+typedef struct {
+    int active;
+    char dir[256];
+    unsigned long captured;                 // Registros que entraron en el anillo
+    unsigned long dropped;                  // Anillo lleno
+    unsigned long events;                   // Eventos ya codificados
+    unsigned long blocks;
+    unsigned long chunks;
+    uint64_t raw_bytes;                     // Codificados, antes de comprimir
+    uint64_t file_bytes;
+    double bytes_per_event;
+    double elapsed_s;
+    double writer_cpu_ms;                   // CPU del hilo escritor
+} irq_capture_stats_t;
+
+// chunk_kb = 0: IRQ_CAPTURE_DEFAULT_CHUNK_KB
+int irq_capture_start(const char *dir, unsigned long chunk_kb);
+// Vacía el anillo, escribe el último bloque y el índice del chunk
+int irq_capture_stop(void);
+void irq_capture_get_stats(irq_capture_stats_t *out);
+void irq_capture_shutdown(void);
+
+void show_capture(void);
+void capture_submenu(void);
+
+#endif // IRQ_CAPTURE_H
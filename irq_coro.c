@@ -0,0 +1,570 @@
+#define _GNU_SOURCE
+#include <ucontext.h>
+#include <sys/mman.h>
+#include "irq_coro.h"
+#include "irq_storm.h"
+#include "irq_rt.h"
+
+// Instancia de handler en vuelo
+typedef struct coro {
+    ucontext_t ctx;
+    void *stack;
+    struct coro *next;                  // Lista libre o cola de listos
+    int irq_num;
+    void (*isr_function)(int);
+    uint64_t spawn_ns;
+    uint64_t resume_ns;                 // Inicio del tramo de ejecución actual
+    uint64_t wake_ns;                   // Fin de la espera al dispositivo
+    uint64_t active_ns;
+    int done;
+} coro_t;
+
+// Hilo del planificador con su cola de listas y su montículo de dormidas
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    ucontext_t sched_ctx;
+    coro_t *ready_head;
+    coro_t *ready_tail;
+    coro_t **sleepers;                  // Montículo mínimo por wake_ns
+    int num_sleepers;
+    unsigned long live;                 // Corrutinas asignadas sin terminar
+} coro_worker_t;
+
+#define IRQ_CORO_MAX_WORKERS 16
+
+static coro_worker_t workers[IRQ_CORO_MAX_WORKERS];
+static int num_workers = 0;
+static int coro_running = 0;
+static int coro_draining = 0;
+static unsigned int next_worker = 0;
+
+// Reserva de corrutinas (pila incluida) reutilizadas entre interrupciones.
+// El despacho sólo toma de la lista libre; calloc y mmap se hacen en
+// irq_coro_refill(), fuera del lock de la IDT
+static coro_t *coro_all[IRQ_CORO_MAX_IN_FLIGHT];
+static int coro_allocated = 0;
+static int coro_growing = 0;                // Reservadas por un refill en curso
+static int free_count = 0;
+static coro_t *free_list = NULL;
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int coro_enabled[MAX_INTERRUPTS];
+static irq_coro_stats_t coro_stats[MAX_INTERRUPTS];
+static pthread_mutex_t coro_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static __thread coro_t *current_coro = NULL;
+static __thread coro_worker_t *current_worker = NULL;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Montículo de corrutinas dormidas (con el mutex del hilo tomado)
+static void heap_push(coro_worker_t *w, coro_t *c) {
+    int i = w->num_sleepers++;
+    while (i > 0) {
+        int parent = (i - 1) / 2;
+        if (w->sleepers[parent]->wake_ns <= c->wake_ns) {
+            break;
+        }
+        w->sleepers[i] = w->sleepers[parent];
+        i = parent;
+    }
+    w->sleepers[i] = c;
+}
+
+static coro_t *heap_pop(coro_worker_t *w) {
+    coro_t *top = w->sleepers[0];
+    coro_t *last = w->sleepers[--w->num_sleepers];
+    int i = 0;
+    for (;;) {
+        int child = 2 * i + 1;
+        if (child >= w->num_sleepers) {
+            break;
+        }
+        if (child + 1 < w->num_sleepers &&
+            w->sleepers[child + 1]->wake_ns < w->sleepers[child]->wake_ns) {
+            child++;
+        }
+        if (last->wake_ns <= w->sleepers[child]->wake_ns) {
+            break;
+        }
+        w->sleepers[i] = w->sleepers[child];
+        i = child;
+    }
+    if (w->num_sleepers > 0) {
+        w->sleepers[i] = last;
+    }
+    return top;
+}
+
+static void enqueue_ready(coro_worker_t *w, coro_t *c) {
+    c->next = NULL;
+    if (w->ready_tail != NULL) {
+        w->ready_tail->next = c;
+    } else {
+        w->ready_head = c;
+    }
+    w->ready_tail = c;
+}
+
+// Con idt_mutex tomado: sólo la lista libre, sin llamadas al sistema
+static coro_t *coro_alloc(void) {
+    pthread_mutex_lock(&pool_mutex);
+    coro_t *c = free_list;
+    if (c != NULL) {
+        free_list = c->next;
+        free_count--;
+    }
+    pthread_mutex_unlock(&pool_mutex);
+    return c;
+}
+
+static void coro_release(coro_t *c) {
+    pthread_mutex_lock(&pool_mutex);
+    c->next = free_list;
+    free_list = c;
+    free_count++;
+    pthread_mutex_unlock(&pool_mutex);
+}
+
+static coro_t *coro_create(void) {
+    coro_t *c = calloc(1, sizeof(*c));
+    void *stack = mmap(NULL, IRQ_CORO_STACK_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+    if (c == NULL || stack == MAP_FAILED) {
+        free(c);
+        if (stack != MAP_FAILED) {
+            munmap(stack, IRQ_CORO_STACK_SIZE);
+        }
+        return NULL;
+    }
+    // Página de guarda: un desbordamiento de pila falla en lugar de corromper
+    mprotect(stack, (size_t)sysconf(_SC_PAGESIZE), PROT_NONE);
+    c->stack = stack;
+    return c;
+}
+
+void irq_coro_refill(void) {
+    pthread_mutex_lock(&pool_mutex);
+    int need = IRQ_CORO_SPARE - free_count - coro_growing;
+    int room = IRQ_CORO_MAX_IN_FLIGHT - coro_allocated - coro_growing;
+    need = need < room ? need : room;
+    if (need <= 0) {
+        pthread_mutex_unlock(&pool_mutex);
+        return;
+    }
+    coro_growing += need;
+    pthread_mutex_unlock(&pool_mutex);
+
+    for (int i = 0; i < need; i++) {
+        coro_t *c = coro_create();
+        pthread_mutex_lock(&pool_mutex);
+        coro_growing--;
+        if (c != NULL) {
+            coro_all[coro_allocated++] = c;
+            c->next = free_list;
+            free_list = c;
+            free_count++;
+        }
+        pthread_mutex_unlock(&pool_mutex);
+    }
+}
+
+// Cuerpo de la corrutina: la ISR y su contabilidad
+static void coro_main(unsigned int hi, unsigned int lo) {
+    coro_t *c = (coro_t *)(((uintptr_t)hi << 32) | (uintptr_t)lo);
+
+    irq_storm_take_unhandled();
+    c->isr_function(c->irq_num);
+    int unhandled = irq_storm_take_unhandled();
+
+    uint64_t end = now_ns();
+    c->active_ns += end - c->resume_ns;
+    unsigned long active_us = (unsigned long)(c->active_ns / 1000);
+    unsigned long latency_us = (unsigned long)((end - c->spawn_ns) / 1000);
+
+    // El tiempo contabilizado es el de CPU del handler, sin las esperas
+    finish_isr_execution(c->irq_num, active_us, end, unhandled, c->irq_num == IRQ_TIMER, 0);
+
+    pthread_mutex_lock(&coro_stats_mutex);
+    irq_coro_stats_t *st = &coro_stats[c->irq_num];
+    st->completed++;
+    st->in_flight--;
+    st->active_total_us += active_us;
+    st->latency_total_us += latency_us;
+    if (latency_us > st->latency_max_us) {
+        st->latency_max_us = latency_us;
+    }
+    pthread_mutex_unlock(&coro_stats_mutex);
+
+    c->done = 1;
+    // Al volver, uc_link reanuda el planificador
+}
+
+static void *coro_worker_func(void *arg) {
+    coro_worker_t *w = (coro_worker_t *)arg;
+    current_worker = w;
+    irq_rt_enter_thread();
+
+    pthread_mutex_lock(&w->mutex);
+    for (;;) {
+        uint64_t now = now_ns();
+        int draining = __atomic_load_n(&coro_draining, __ATOMIC_ACQUIRE);
+
+        while (w->num_sleepers > 0 && (draining || w->sleepers[0]->wake_ns <= now)) {
+            enqueue_ready(w, heap_pop(w));
+        }
+
+        coro_t *c = w->ready_head;
+        if (c != NULL) {
+            w->ready_head = c->next;
+            if (w->ready_head == NULL) {
+                w->ready_tail = NULL;
+            }
+            pthread_mutex_unlock(&w->mutex);
+
+            current_coro = c;
+            c->resume_ns = now_ns();
+            swapcontext(&w->sched_ctx, &c->ctx);
+            current_coro = NULL;
+
+            if (c->done) {
+                coro_release(c);
+                pthread_mutex_lock(&w->mutex);
+                w->live--;
+            } else {
+                pthread_mutex_lock(&w->mutex);
+                heap_push(w, c);
+            }
+            continue;
+        }
+
+        if (draining && w->live == 0) {
+            break;
+        }
+        if (w->num_sleepers > 0) {
+            uint64_t wake = w->sleepers[0]->wake_ns;
+            struct timespec deadline = {(time_t)(wake / 1000000000ULL), (long)(wake % 1000000000ULL)};
+            pthread_cond_timedwait(&w->cond, &w->mutex, &deadline);
+        } else {
+            pthread_cond_wait(&w->cond, &w->mutex);
+        }
+    }
+    pthread_mutex_unlock(&w->mutex);
+    return NULL;
+}
+
+void irq_await_us(unsigned long us) {
+    coro_t *c = current_coro;
+    if (c == NULL) {
+        usleep(us);
+        return;
+    }
+
+    uint64_t now = now_ns();
+    c->active_ns += now - c->resume_ns;
+    c->wake_ns = now + (uint64_t)us * 1000ULL;
+    __atomic_add_fetch(&coro_stats[c->irq_num].yields, 1, __ATOMIC_RELAXED);
+
+    // Volver al planificador; la corrutina se reanuda en este mismo hilo
+    swapcontext(&c->ctx, &current_worker->sched_ctx);
+}
+
+int irq_coro_spawn(int irq_num, void (*isr_function)(int)) {
+    if (!__atomic_load_n(&coro_running, __ATOMIC_ACQUIRE)) {
+        return 0;
+    }
+
+    coro_t *c = coro_alloc();
+    if (c == NULL) {
+        pthread_mutex_lock(&coro_stats_mutex);
+        coro_stats[irq_num].rejected++;
+        pthread_mutex_unlock(&coro_stats_mutex);
+        return -1;
+    }
+
+    coro_worker_t *w = &workers[__atomic_fetch_add(&next_worker, 1, __ATOMIC_RELAXED) % (unsigned int)num_workers];
+    c->irq_num = irq_num;
+    c->isr_function = isr_function;
+    c->spawn_ns = now_ns();
+    c->active_ns = 0;
+    c->done = 0;
+
+    getcontext(&c->ctx);
+    c->ctx.uc_stack.ss_sp = c->stack;
+    c->ctx.uc_stack.ss_size = IRQ_CORO_STACK_SIZE;
+    c->ctx.uc_link = &w->sched_ctx;
+    uintptr_t ptr = (uintptr_t)c;
+    makecontext(&c->ctx, (void (*)(void))coro_main, 2,
+                (unsigned int)(ptr >> 32), (unsigned int)(ptr & 0xffffffffu));
+
+    pthread_mutex_lock(&coro_stats_mutex);
+    irq_coro_stats_t *st = &coro_stats[irq_num];
+    st->spawned++;
+    st->in_flight++;
+    if (st->in_flight > st->max_in_flight) {
+        st->max_in_flight = st->in_flight;
+    }
+    pthread_mutex_unlock(&coro_stats_mutex);
+
+    pthread_mutex_lock(&w->mutex);
+    enqueue_ready(w, c);
+    w->live++;
+    pthread_cond_signal(&w->cond);
+    pthread_mutex_unlock(&w->mutex);
+    return 1;
+}
+
+int irq_coro_start(int count) {
+    if (__atomic_load_n(&coro_running, __ATOMIC_ACQUIRE)) {
+        return SUCCESS;
+    }
+    if (count <= 0 || count > IRQ_CORO_MAX_WORKERS) {
+        return ERROR_INVALID_ARG;
+    }
+
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+
+    coro_draining = 0;
+    num_workers = 0;
+    for (int i = 0; i < count; i++) {
+        coro_worker_t *w = &workers[i];
+        memset(w, 0, sizeof(*w));
+        w->sleepers = malloc(sizeof(coro_t *) * IRQ_CORO_MAX_IN_FLIGHT);
+        if (w->sleepers == NULL) {
+            break;
+        }
+        pthread_mutex_init(&w->mutex, NULL);
+        pthread_cond_init(&w->cond, &attr);
+        if (pthread_create(&w->thread, NULL, coro_worker_func, w) != 0) {
+            free(w->sleepers);
+            break;
+        }
+        num_workers++;
+    }
+    pthread_condattr_destroy(&attr);
+
+    if (num_workers == 0) {
+        return ERROR_INVALID_ARG;
+    }
+    // Las primeras llegadas ya encuentran corrutinas con su pila
+    irq_coro_refill();
+    __atomic_store_n(&coro_running, 1, __ATOMIC_RELEASE);
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg),
+        "🌀 KERNEL: Planificador de corrutinas iniciado (%d hilos, hasta %d ISRs en vuelo)",
+        num_workers, IRQ_CORO_MAX_IN_FLIGHT);
+    add_trace_silent(trace_msg);
+    return SUCCESS;
+}
+
+void irq_coro_stop(void) {
+    if (!__atomic_load_n(&coro_running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    // Las instancias dormidas se despiertan ya y terminan su ISR
+    __atomic_store_n(&coro_running, 0, __ATOMIC_RELEASE);
+    __atomic_store_n(&coro_draining, 1, __ATOMIC_RELEASE);
+    for (int i = 0; i < num_workers; i++) {
+        pthread_mutex_lock(&workers[i].mutex);
+        pthread_cond_broadcast(&workers[i].cond);
+        pthread_mutex_unlock(&workers[i].mutex);
+    }
+    for (int i = 0; i < num_workers; i++) {
+        pthread_join(workers[i].thread, NULL);
+        pthread_mutex_destroy(&workers[i].mutex);
+        pthread_cond_destroy(&workers[i].cond);
+        free(workers[i].sleepers);
+    }
+    num_workers = 0;
+
+    pthread_mutex_lock(&pool_mutex);
+    for (int i = 0; i < coro_allocated; i++) {
+        munmap(coro_all[i]->stack, IRQ_CORO_STACK_SIZE);
+        free(coro_all[i]);
+    }
+    coro_allocated = 0;
+    free_count = 0;
+    free_list = NULL;
+    pthread_mutex_unlock(&pool_mutex);
+}
+
+int irq_coro_is_running(void) {
+    return __atomic_load_n(&coro_running, __ATOMIC_ACQUIRE);
+}
+
+int irq_coro_set_enabled(int irq_num, int enabled) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+    __atomic_store_n(&coro_enabled[irq_num], enabled ? 1 : 0, __ATOMIC_RELEASE);
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg), "🌀 KERNEL: IRQ %d atendida %s", irq_num,
+             enabled ? "por corrutinas cooperativas" : "por la ISR bloqueante");
+    add_trace_smart(trace_msg, irq_num, 0);
+    return SUCCESS;
+}
+
+int irq_coro_is_enabled(int irq_num) {
+    return IS_VALID_IRQ(irq_num) && __atomic_load_n(&coro_enabled[irq_num], __ATOMIC_ACQUIRE);
+}
+
+unsigned long irq_coro_in_flight(int irq_num) {
+    pthread_mutex_lock(&coro_stats_mutex);
+    unsigned long in_flight = coro_stats[irq_num].in_flight;
+    pthread_mutex_unlock(&coro_stats_mutex);
+    return in_flight;
+}
+
+int irq_coro_get_stats(int irq_num, irq_coro_stats_t *out) {
+    if (irq_num != -1 && validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+
+    pthread_mutex_lock(&coro_stats_mutex);
+    if (irq_num >= 0) {
+        *out = coro_stats[irq_num];
+        out->yields = __atomic_load_n(&coro_stats[irq_num].yields, __ATOMIC_RELAXED);
+    } else {
+        memset(out, 0, sizeof(*out));
+        for (int i = 0; i < MAX_INTERRUPTS; i++) {
+            out->spawned += coro_stats[i].spawned;
+            out->completed += coro_stats[i].completed;
+            out->rejected += coro_stats[i].rejected;
+            out->yields += __atomic_load_n(&coro_stats[i].yields, __ATOMIC_RELAXED);
+            out->in_flight += coro_stats[i].in_flight;
+            out->max_in_flight += coro_stats[i].max_in_flight;
+            out->active_total_us += coro_stats[i].active_total_us;
+            out->latency_total_us += coro_stats[i].latency_total_us;
+            if (coro_stats[i].latency_max_us > out->latency_max_us) {
+                out->latency_max_us = coro_stats[i].latency_max_us;
+            }
+        }
+    }
+    pthread_mutex_unlock(&coro_stats_mutex);
+    return SUCCESS;
+}
+
+void show_irq_coro(void) {
+    printf("\n=== HANDLERS COOPERATIVOS (corrutinas) ===\n");
+    printf("Planificador: %s (%d hilos, pila de %d KiB, máx. %d en vuelo)\n\n",
+           irq_coro_is_running() ? "ACTIVO" : "DETENIDO", num_workers,
+           IRQ_CORO_STACK_SIZE / 1024, IRQ_CORO_MAX_IN_FLIGHT);
+    printf("IRQ │ Modo    │ Creadas  │ Completas │ En vuelo │ Máx. vuelo │ Esperas  │ CPU prom μs │ Lat. prom μs │ Rechazadas\n");
+
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        irq_coro_stats_t st;
+        irq_coro_get_stats(i, &st);
+        if (!irq_coro_is_enabled(i) && st.spawned == 0) {
+            continue;
+        }
+        double cpu_avg = st.completed > 0 ? (double)st.active_total_us / st.completed : 0.0;
+        double lat_avg = st.completed > 0 ? (double)st.latency_total_us / st.completed : 0.0;
+        printf("%3d │ %-7s │ %8lu │ %9lu │ %8lu │ %10lu │ %8lu │ %11.1f │ %12.1f │ %lu\n",
+               i, irq_coro_is_enabled(i) ? "corrut." : "bloq.", st.spawned, st.completed,
+               st.in_flight, st.max_in_flight, st.yields, cpu_avg, lat_avg, st.rejected);
+    }
+    printf("\n");
+}
+
+// ISR de prueba: sólo espera al dispositivo simulado, sin trazas
+static void coro_bench_isr(int irq_num) {
+    (void)irq_num;
+    irq_await_us(CUSTOM_DELAY_US);
+}
+
+// Disparar una ráfaga sobre un vector libre con una ISR que sólo espera
+static void run_coro_burst(int count) {
+    int irq_num = -1;
+    for (int i = 2; i < MAX_INTERRUPTS; i++) {
+        if (is_irq_available(i)) {
+            irq_num = i;
+            break;
+        }
+    }
+    if (irq_num < 0) {
+        printf("✗ No hay vectores libres para la prueba.\n");
+        return;
+    }
+
+    int was_enabled = irq_coro_is_enabled(irq_num);
+    register_isr(irq_num, coro_bench_isr, "Prueba de corrutinas");
+    irq_coro_set_enabled(irq_num, 1);
+
+    irq_coro_stats_t before;
+    irq_coro_get_stats(irq_num, &before);
+    log_level_t saved = swap_log_level(LOG_LEVEL_SILENT);
+
+    uint64_t start = now_ns();
+    for (int i = 0; i < count; i++) {
+        dispatch_interrupt(irq_num);
+    }
+    while (irq_coro_in_flight(irq_num) > 0) {
+        usleep(1000);
+    }
+    double elapsed_ms = (now_ns() - start) / 1e6;
+    swap_log_level(saved);
+
+    irq_coro_stats_t after;
+    irq_coro_get_stats(irq_num, &after);
+    irq_coro_set_enabled(irq_num, was_enabled);
+    unregister_isr(irq_num);
+
+    unsigned long done = after.completed - before.completed;
+    printf("\n✓ %lu ISRs de %d ms completadas en %.1f ms con %d hilos (%.0f IRQs/s)\n",
+           done, CUSTOM_DELAY_US / 1000, elapsed_ms, num_workers,
+           elapsed_ms > 0 ? done * 1000.0 / elapsed_ms : 0.0);
+    printf("  En modo bloqueante habrían tardado ~%.1f s en un solo hilo\n",
+           done * (CUSTOM_DELAY_US / 1e6));
+    if (after.rejected > before.rejected) {
+        printf("  %lu interrupciones rechazadas por falta de corrutinas libres\n",
+               after.rejected - before.rejected);
+    }
+}
+
+void irq_coro_submenu(void) {
+    int option, irq_num;
+
+    while (1) {
+        printf("\n=== HANDLERS COOPERATIVOS (corrutinas) ===\n");
+        printf("1. Mostrar estado y estadísticas\n");
+        printf("2. Atender un IRQ con corrutinas / con la ISR bloqueante\n");
+        printf("3. Ráfaga de prueba (ISRs de %d ms en un vector libre)\n", CUSTOM_DELAY_US / 1000);
+        printf("0. Volver\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+
+        option = get_valid_input(0, 3);
+        switch (option) {
+            case 0:
+                return;
+            case 1:
+                show_irq_coro();
+                break;
+            case 2:
+                printf("Ingrese el número de IRQ (0-%d): ", MAX_INTERRUPTS - 1);
+                fflush(stdout);
+                irq_num = get_valid_input(0, MAX_INTERRUPTS - 1);
+                printf("Modo (1 = corrutinas, 0 = bloqueante): ");
+                fflush(stdout);
+                irq_coro_set_enabled(irq_num, get_valid_input(0, 1));
+                printf("✓ Modo actualizado para IRQ %d.\n", irq_num);
+                break;
+            case 3:
+                printf("Cantidad de interrupciones (1-%d): ", IRQ_CORO_MAX_IN_FLIGHT);
+                fflush(stdout);
+                run_coro_burst(get_valid_input(1, IRQ_CORO_MAX_IN_FLIGHT));
+                break;
+        }
+    }
+}
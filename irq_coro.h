@@ -0,0 +1,58 @@
+#ifndef IRQ_CORO_H
+#define IRQ_CORO_H
+
+#include <stdint.h>
+#include "interrupt_simulator.h"
+
+// Handlers cooperativos: cada interrupción de un vector en modo corrutina se
+// ejecuta en su propia corrutina con pila (ucontext). Cuando el handler espera
+// al dispositivo con irq_await_us() cede el hilo en lugar de bloquearlo, y unos
+// pocos hilos del sistema multiplexan miles de instancias en vuelo. Fuera de
+// una corrutina irq_await_us() equivale a usleep(), así que las mismas ISRs
+// sirven en ambos modos.
+//
+// Cada corrutina queda fijada al hilo que la creó (los datos por hilo de las
+// ISRs siguen siendo válidos). Un handler no debe esperar con un mutex tomado.
+
+#define IRQ_CORO_WORKERS 2                  // Hilos del planificador
+#define IRQ_CORO_MAX_IN_FLIGHT 4096         // Instancias simultáneas
+#define IRQ_CORO_STACK_SIZE (64 * 1024)
+#define IRQ_CORO_SPARE 64                   // Corrutinas libres preparadas fuera del lock de la IDT
+
+typedef struct {
+    unsigned long spawned;
+    unsigned long completed;
+    unsigned long rejected;                 // Sin corrutinas libres
+    unsigned long yields;
+    unsigned long in_flight;
+    unsigned long max_in_flight;
+    unsigned long active_total_us;          // Tiempo de CPU del handler (sin esperas)
+    unsigned long latency_total_us;         // Llegada -> fin, esperas incluidas
+    unsigned long latency_max_us;
+} irq_coro_stats_t;
+
+// Ciclo de vida del planificador
+int irq_coro_start(int workers);
+void irq_coro_stop(void);               // Termina las instancias en vuelo antes de salir
+int irq_coro_is_running(void);
+
+// Modo por vector
+int irq_coro_set_enabled(int irq_num, int enabled);
+int irq_coro_is_enabled(int irq_num);
+unsigned long irq_coro_in_flight(int irq_num);
+
+// Desde dispatch_interrupt() con idt_mutex tomado: 1 = corrutina creada,
+// 0 = planificador detenido (ejecutar en línea), -1 = sin corrutinas libres
+int irq_coro_spawn(int irq_num, void (*isr_function)(int));
+// Reponer la reserva libre hasta IRQ_CORO_SPARE (sin el lock de la IDT)
+void irq_coro_refill(void);
+
+// Esperar al dispositivo simulado (cede la corrutina o duerme el hilo)
+void irq_await_us(unsigned long us);
+
+// Estadísticas de un vector o globales (irq_num = -1)
+int irq_coro_get_stats(int irq_num, irq_coro_stats_t *out);
+void show_irq_coro(void);
+void irq_coro_submenu(void);
+
+#endif // IRQ_CORO_H
@@ -0,0 +1,1532 @@
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "irq_ctl.h"
+#include "irq_plugin.h"
+#include "irq_storm.h"
+#include "irq_budget.h"
+#include "irq_coro.h"
+#include "irq_workpool.h"
+#include "irq_balance.h"
+#include "irq_msix.h"
+#include "irq_device.h"
+#include "irq_slab.h"
+#include "irq_trace.h"
+#include "irq_capture.h"
+#include "irq_profile.h"
+#include "irq_replay.h"
+#include "irq_loadgen.h"
+#include "irq_stress.h"
+#include "irq_rt.h"
+
+// Conexión de un cliente del plano de control
+typedef struct {
+    int fd;
+    int active;
+    pthread_t thread;
+} ctl_client_t;
+
+static int listen_fd = -1;
+static int server_running = 0;
+static pthread_t accept_thread;
+static char socket_path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+static ctl_client_t clients[CTL_MAX_CLIENTS];
+static pthread_mutex_t ctl_mutex = PTHREAD_MUTEX_INITIALIZER;
+static ctl_stats_t ctl_stats;
+
+// Handlers seleccionables por nombre desde el protocolo
+typedef struct {
+    const char *name;
+    void (*isr)(int);
+} ctl_handler_entry_t;
+
+static const ctl_handler_entry_t ctl_handlers[] = {
+    {"custom", custom_isr},
+    {"keyboard", keyboard_isr},
+    {"timer", timer_isr},
+    {"error", error_isr}
+};
+
+// Añadir texto formateado al buffer de respuestas
+static void ctl_appendf(ctl_buffer_t *out, const char *fmt, ...) {
+    va_list args;
+
+    for (;;) {
+        size_t avail = out->cap - out->len;
+        va_start(args, fmt);
+        int n = vsnprintf(out->data + out->len, avail, fmt, args);
+        va_end(args);
+
+        if (n < 0) {
+            return;
+        }
+        if ((size_t)n < avail) {
+            out->len += (size_t)n;
+            return;
+        }
+
+        size_t new_cap = out->cap * 2 + (size_t)n + 1;
+        char *grown = realloc(out->data, new_cap);
+        if (grown == NULL) {
+            return;
+        }
+        out->data = grown;
+        out->cap = new_cap;
+    }
+}
+
+static int parse_int(const char *tok, int *value) {
+    char *endptr;
+    if (tok == NULL) {
+        return 0;
+    }
+    long v = strtol(tok, &endptr, 10);
+    if (*endptr != '\0') {
+        return 0;
+    }
+    *value = (int)v;
+    return 1;
+}
+
+static int parse_double(const char *tok, double *value) {
+    char *endptr;
+    if (tok == NULL || *tok == '\0') {
+        return 0;
+    }
+    double v = strtod(tok, &endptr);
+    if (*endptr != '\0') {
+        return 0;
+    }
+    *value = v;
+    return 1;
+}
+
+static int ctl_error(ctl_buffer_t *out, int code, const char *msg) {
+    ctl_appendf(out, "ERR %d %s\n", code, msg);
+    return 0;
+}
+
+// REG <irq> [handler] [descripción...]
+static int cmd_register(char **saveptr, ctl_buffer_t *out) {
+    int irq;
+    if (!parse_int(strtok_r(NULL, " \t", saveptr), &irq)) {
+        return ctl_error(out, ERROR_INVALID_ARG, "uso: REG <irq> [handler] [desc]");
+    }
+
+    void (*isr)(int) = custom_isr;
+    const char *handler = strtok_r(NULL, " \t", saveptr);
+    if (handler != NULL) {
+        isr = NULL;
+        for (size_t i = 0; i < sizeof(ctl_handlers) / sizeof(ctl_handlers[0]); i++) {
+            if (strcmp(handler, ctl_handlers[i].name) == 0) {
+                isr = ctl_handlers[i].isr;
+            }
+        }
+        if (isr == NULL) {
+            return ctl_error(out, ERROR_NO_ISR, "handler desconocido");
+        }
+    }
+
+    char desc[MAX_DESCRIPTION_LEN];
+    const char *rest = strtok_r(NULL, "", saveptr);
+    if (rest != NULL) {
+        snprintf(desc, sizeof(desc), "%s", rest);
+    } else {
+        snprintf(desc, sizeof(desc), "ISR remota %d", irq);
+    }
+
+    int result = register_isr(irq, isr, desc);
+    if (result != SUCCESS) {
+        return ctl_error(out, result, "registro rechazado");
+    }
+    ctl_appendf(out, "OK\n");
+    return 0;
+}
+
+// RAISE <irq> [count] y BURST <count> <lista>
+static int cmd_raise(int irq, int count, ctl_buffer_t *out) {
+    if (!IS_VALID_IRQ(irq)) {
+        return ctl_error(out, ERROR_INVALID_IRQ, "IRQ fuera de rango");
+    }
+    if (count <= 0 || count > CTL_MAX_RAISE_COUNT) {
+        return ctl_error(out, ERROR_INVALID_ARG, "count fuera de rango");
+    }
+    for (int i = 0; i < count; i++) {
+        dispatch_interrupt(irq);
+    }
+    ctl_appendf(out, "OK raised=%d\n", count);
+    return 0;
+}
+
+static int cmd_burst(char **saveptr, ctl_buffer_t *out) {
+    int count;
+    int irqs[MAX_INTERRUPTS];
+    int num_irqs = 0;
+
+    if (!parse_int(strtok_r(NULL, " \t", saveptr), &count) ||
+        count <= 0 || count > CTL_MAX_RAISE_COUNT) {
+        return ctl_error(out, ERROR_INVALID_ARG, "uso: BURST <count> <irq,irq,...>");
+    }
+
+    char *list = strtok_r(NULL, " \t", saveptr);
+    char *list_save = NULL;
+    for (char *tok = list != NULL ? strtok_r(list, ",", &list_save) : NULL;
+         tok != NULL && num_irqs < MAX_INTERRUPTS; tok = strtok_r(NULL, ",", &list_save)) {
+        if (!parse_int(tok, &irqs[num_irqs]) || !IS_VALID_IRQ(irqs[num_irqs])) {
+            return ctl_error(out, ERROR_INVALID_IRQ, "IRQ fuera de rango en la lista");
+        }
+        num_irqs++;
+    }
+    if (num_irqs == 0) {
+        return ctl_error(out, ERROR_INVALID_ARG, "lista de IRQs vacía");
+    }
+
+    for (int i = 0; i < count; i++) {
+        dispatch_interrupt(irqs[i % num_irqs]);
+    }
+    ctl_appendf(out, "OK raised=%d\n", count);
+    return 0;
+}
+
+// STATS [irq]
+static int cmd_stats(char **saveptr, ctl_buffer_t *out) {
+    const char *tok = strtok_r(NULL, " \t", saveptr);
+
+    if (tok == NULL) {
+        system_stats_t stats;
+        sim_get_stats(sim_current(), &stats);
+        ctl_appendf(out, "OK total=%lu timer=%lu keyboard=%lu custom=%lu avg_us=%.2f uptime=%ld\n",
+                    stats.total_interrupts, stats.timer_interrupts,
+                    stats.keyboard_interrupts, stats.custom_interrupts,
+                    stats.average_response_time, (long)(time(NULL) - stats.system_start_time));
+        return 0;
+    }
+
+    int irq;
+    if (!parse_int(tok, &irq) || !IS_VALID_IRQ(irq)) {
+        return ctl_error(out, ERROR_INVALID_IRQ, "IRQ fuera de rango");
+    }
+
+    irq_descriptor_t desc;
+    sim_get_descriptor(sim_current(), irq, &desc);
+
+    ctl_appendf(out, "OK irq=%d state=%s calls=%d total_us=%lu affinity=%d priority=%d desc=%s\n",
+                irq, get_irq_state_string(desc.state), desc.call_count,
+                desc.total_execution_time, desc.cpu_affinity, desc.priority, desc.description);
+    return 0;
+}
+
+// TRACE [n] | TRACE STATS
+static int cmd_trace(char **saveptr, ctl_buffer_t *out) {
+    int n = 10;
+    const char *tok = strtok_r(NULL, " \t", saveptr);
+    if (tok != NULL && strcmp(tok, "STATS") == 0) {
+        irq_trace_stats_t st;
+        irq_trace_get_stats(&st);
+        ctl_appendf(out, "OK emitted=%lu records=%d capacity=%d record_bytes=%d legacy_bytes=%zu "
+                    "templates=%d names=%d payload_bytes=%lu payload_lost=%lu memory_bytes=%zu\n",
+                    st.emitted, st.records, st.capacity, st.record_size, st.legacy_entry_size,
+                    st.templates, st.names, st.payload_bytes, st.payload_lost, st.memory_bytes);
+        return 0;
+    }
+    if (tok != NULL && (!parse_int(tok, &n) || n <= 0)) {
+        return ctl_error(out, ERROR_INVALID_ARG, "uso: TRACE [n] | TRACE STATS");
+    }
+    if (n > MAX_TRACE_LINES) {
+        n = MAX_TRACE_LINES;
+    }
+
+    // Las entradas reconstruidas ocupan mucho más que los registros compactos
+    trace_entry_t *entries = malloc(sizeof(trace_entry_t) * (size_t)n);
+    if (entries == NULL) {
+        return ctl_error(out, ERROR_INVALID_ARG, "sin memoria");
+    }
+    int count = copy_recent_traces(entries, n);
+
+    ctl_appendf(out, "OK %d\n", count);
+    for (int i = 0; i < count; i++) {
+        ctl_appendf(out, "[%s] [IRQ%d] %s\n",
+                    entries[i].timestamp, entries[i].irq_num, entries[i].event);
+    }
+    free(entries);
+    return 0;
+}
+
+// PLUGIN LOAD <ruta> | ATTACH <irq> <handler> | DETACH <irq> | STATS <irq>
+static int cmd_plugin(char **saveptr, ctl_buffer_t *out) {
+    const char *sub = strtok_r(NULL, " \t", saveptr);
+    int irq, result;
+
+    if (sub != NULL && strcmp(sub, "LOAD") == 0) {
+        const char *path = strtok_r(NULL, "", saveptr);
+        if (path == NULL) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: PLUGIN LOAD <ruta>");
+        }
+        if ((result = irq_plugin_load(path)) < 0) {
+            return ctl_error(out, result, "no se pudo cargar el plugin");
+        }
+        ctl_appendf(out, "OK id=%d\n", result);
+        return 0;
+    }
+
+    if (sub == NULL || !parse_int(strtok_r(NULL, " \t", saveptr), &irq)) {
+        return ctl_error(out, ERROR_INVALID_ARG, "uso: PLUGIN LOAD|ATTACH|DETACH|STATS ...");
+    }
+
+    if (strcmp(sub, "ATTACH") == 0) {
+        const char *handler = strtok_r(NULL, " \t", saveptr);
+        if (handler == NULL) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: PLUGIN ATTACH <irq> <handler>");
+        }
+        result = irq_plugin_attach(irq, handler);
+    } else if (strcmp(sub, "DETACH") == 0) {
+        result = irq_plugin_detach(irq);
+    } else if (strcmp(sub, "STATS") == 0) {
+        irq_plugin_binding_info_t info;
+        if ((result = irq_plugin_get_binding(irq, &info)) != SUCCESS) {
+            return ctl_error(out, result, "vector sin plugin");
+        }
+        ctl_appendf(out, "OK irq=%d handler=%s/%s calls=%lu unhandled=%lu top_avg_ns=%lu "
+                    "top_max_ns=%lu bh_runs=%lu bh_avg_ns=%lu\n",
+                    irq, info.plugin_name, info.handler_name, info.stats.calls,
+                    info.stats.unhandled,
+                    info.stats.calls > 0 ? info.stats.top_total_ns / info.stats.calls : 0,
+                    info.stats.top_max_ns, info.stats.bh_runs,
+                    info.stats.bh_runs > 0 ? info.stats.bh_total_ns / info.stats.bh_runs : 0);
+        return 0;
+    } else {
+        return ctl_error(out, ERROR_INVALID_ARG, "subcomando PLUGIN desconocido");
+    }
+
+    if (result != SUCCESS) {
+        return ctl_error(out, result, "operación de plugin rechazada");
+    }
+    ctl_appendf(out, "OK\n");
+    return 0;
+}
+
+// STORM <irq> [límite]
+static int cmd_storm(char **saveptr, ctl_buffer_t *out) {
+    int irq, limit;
+    irq_storm_info_t info;
+
+    if (!parse_int(strtok_r(NULL, " \t", saveptr), &irq) || !IS_VALID_IRQ(irq)) {
+        return ctl_error(out, ERROR_INVALID_IRQ, "uso: STORM <irq> [límite]");
+    }
+    const char *tok = strtok_r(NULL, " \t", saveptr);
+    if (tok != NULL) {
+        if (!parse_int(tok, &limit) || limit < 0) {
+            return ctl_error(out, ERROR_INVALID_ARG, "límite inválido");
+        }
+        irq_storm_set_rate_limit(irq, (unsigned long)limit);
+    }
+
+    irq_storm_tick();
+    irq_storm_get_info(irq, &info);
+    ctl_appendf(out, "OK irq=%d limit=%lu masked=%d storms=%lu episodes=%lu shed=%lu "
+                "reason=%s last_episode_ms=%.1f\n",
+                irq, info.rate_limit, info.masked, info.storms, info.episodes, info.shed,
+                irq_storm_reason_string(info.reason), info.last_episode_ns / 1e6);
+    return 0;
+}
+
+// BUDGET <irq> [presupuesto_us límite_us degradar] y THREAD <irq> 0|1
+static int cmd_budget(char **saveptr, ctl_buffer_t *out, int set_thread) {
+    int irq, values[3];
+    int given = 0;
+    irq_budget_info_t info;
+
+    if (!parse_int(strtok_r(NULL, " \t", saveptr), &irq) || !IS_VALID_IRQ(irq)) {
+        return ctl_error(out, ERROR_INVALID_IRQ, "IRQ fuera de rango");
+    }
+    for (const char *tok; given < 3 && (tok = strtok_r(NULL, " \t", saveptr)) != NULL; given++) {
+        if (!parse_int(tok, &values[given]) || values[given] < 0) {
+            return ctl_error(out, ERROR_INVALID_ARG, "valor inválido");
+        }
+    }
+
+    if (set_thread) {
+        if (given != 1) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: THREAD <irq> 0|1");
+        }
+        irq_budget_set_threaded(irq, values[0]);
+    } else if (given == 3) {
+        irq_budget_configure(irq, (unsigned long)values[0], (unsigned long)values[1], values[2]);
+    } else if (given != 0) {
+        return ctl_error(out, ERROR_INVALID_ARG, "uso: BUDGET <irq> [presupuesto_us límite_us degradar]");
+    }
+
+    irq_budget_get_info(irq, &info);
+    ctl_appendf(out, "OK irq=%d budget_us=%lu deadline_us=%lu demote=%d threaded=%d runs=%lu "
+                "violations=%lu stalls=%lu deferred=%lu max_us=%lu\n",
+                irq, info.budget_us, info.deadline_us, info.auto_demote, info.threaded,
+                info.runs, info.violations, info.stalls, info.deferred, info.max_us);
+    return 0;
+}
+
+// CORO <irq> [0|1]
+static int cmd_coro(char **saveptr, ctl_buffer_t *out) {
+    int irq, enabled;
+    irq_coro_stats_t st;
+
+    if (!parse_int(strtok_r(NULL, " \t", saveptr), &irq) || !IS_VALID_IRQ(irq)) {
+        return ctl_error(out, ERROR_INVALID_IRQ, "uso: CORO <irq> [0|1]");
+    }
+    const char *tok = strtok_r(NULL, " \t", saveptr);
+    if (tok != NULL) {
+        if (!parse_int(tok, &enabled) || (enabled != 0 && enabled != 1)) {
+            return ctl_error(out, ERROR_INVALID_ARG, "modo inválido");
+        }
+        irq_coro_set_enabled(irq, enabled);
+    }
+
+    irq_coro_get_stats(irq, &st);
+    ctl_appendf(out, "OK irq=%d coro=%d spawned=%lu completed=%lu in_flight=%lu max_in_flight=%lu "
+                "yields=%lu rejected=%lu cpu_avg_us=%lu latency_max_us=%lu\n",
+                irq, irq_coro_is_enabled(irq), st.spawned, st.completed, st.in_flight,
+                st.max_in_flight, st.yields, st.rejected,
+                st.completed > 0 ? st.active_total_us / st.completed : 0, st.latency_max_us);
+    return 0;
+}
+
+// WORKQ [hilos [fijar]] | WORKQ BENCH <trabajos>
+static int cmd_workq(char **saveptr, ctl_buffer_t *out) {
+    int workers, pin = 0, items;
+    irq_workpool_stats_t st;
+
+    const char *tok = strtok_r(NULL, " \t", saveptr);
+    if (tok != NULL && strcmp(tok, "BENCH") == 0) {
+        double elapsed_ms = 0.0;
+        if (!parse_int(strtok_r(NULL, " \t", saveptr), &items) || items <= 0) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: WORKQ BENCH <trabajos>");
+        }
+        int done = irq_workpool_benchmark(items, &elapsed_ms);
+        ctl_appendf(out, "OK items=%d ms=%.1f per_s=%.0f\n",
+                    done, elapsed_ms, elapsed_ms > 0 ? done * 1000.0 / elapsed_ms : 0.0);
+        return 0;
+    }
+    if (tok != NULL) {
+        const char *pin_tok = strtok_r(NULL, " \t", saveptr);
+        if (!parse_int(tok, &workers) || workers < 1 || workers > IRQ_WORKPOOL_MAX_WORKERS ||
+            (pin_tok != NULL && !parse_int(pin_tok, &pin))) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: WORKQ [hilos [fijar]]");
+        }
+        irq_workpool_stop();
+        if (irq_workpool_start(workers, pin) != SUCCESS) {
+            return ctl_error(out, ERROR_INVALID_ARG, "no se pudo reiniciar el pool");
+        }
+    }
+
+    irq_workpool_get_stats(&st);
+    unsigned long stolen = 0, attempts = 0, idle = 0, depth = 0;
+    for (int i = 0; i < st.workers; i++) {
+        stolen += st.worker[i].stolen;
+        attempts += st.worker[i].steal_attempts;
+        idle += st.worker[i].idle_sleeps;
+        depth += st.worker[i].queue_depth;
+    }
+    ctl_appendf(out, "OK workers=%d pinned=%d submitted=%lu executed=%lu inline=%lu pending=%lu "
+                "max_pending=%lu depth=%lu stolen=%lu steal_attempts=%lu idle=%lu overflows=%lu\n",
+                st.workers, st.pinned, st.submitted, st.executed, st.inline_runs, st.pending,
+                st.max_pending, depth, stolen, attempts, idle, st.overflows);
+    return 0;
+}
+
+// BALANCE [0|1] | BALANCE CONFIG <cpus> <ms> <umbral%> | BALANCE BENCH [segundos]
+static int cmd_balance(char **saveptr, ctl_buffer_t *out) {
+    int values[3];
+    irq_balance_stats_t st;
+
+    const char *tok = strtok_r(NULL, " \t", saveptr);
+    if (tok != NULL && strcmp(tok, "BENCH") == 0) {
+        irq_balance_bench_t off, on;
+        int seconds = 2;
+        const char *sec_tok = strtok_r(NULL, " \t", saveptr);
+        if (sec_tok != NULL && !parse_int(sec_tok, &seconds)) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: BALANCE BENCH [segundos]");
+        }
+        if (irq_balance_benchmark(seconds, &off, &on) != SUCCESS) {
+            return ctl_error(out, ERROR_INVALID_ARG, "se necesitan 2+ CPUs y 1-60 segundos");
+        }
+        ctl_appendf(out, "OK off_p50_us=%.1f off_p99_us=%.1f off_p999_us=%.1f off_max_cpu=%.2f "
+                    "on_p50_us=%.1f on_p99_us=%.1f on_p999_us=%.1f on_max_cpu=%.2f migrations=%lu\n",
+                    off.p50_us, off.p99_us, off.p999_us, off.max_cpu_util,
+                    on.p50_us, on.p99_us, on.p999_us, on.max_cpu_util, on.migrations);
+        return 0;
+    }
+    if (tok != NULL && strcmp(tok, "CONFIG") == 0) {
+        for (int i = 0; i < 3; i++) {
+            if (!parse_int(strtok_r(NULL, " \t", saveptr), &values[i])) {
+                return ctl_error(out, ERROR_INVALID_ARG, "uso: BALANCE CONFIG <cpus> <ms> <umbral%>");
+            }
+        }
+        if (irq_balance_configure(values[0], values[1], values[2]) != SUCCESS) {
+            return ctl_error(out, ERROR_INVALID_ARG, "configuración rechazada");
+        }
+    } else if (tok != NULL) {
+        if (!parse_int(tok, &values[0]) || (values[0] != 0 && values[0] != 1)) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: BALANCE [0|1]");
+        }
+        irq_balance_set_enabled(values[0]);
+    }
+
+    irq_balance_get_stats(&st);
+    ctl_appendf(out, "OK enabled=%d cpus=%d interval_ms=%d threshold_pct=%d rounds=%lu "
+                "migrations=%lu placements=%lu load=",
+                st.enabled, st.cpus, st.interval_ms, st.threshold_pct, st.rounds,
+                st.migrations, st.placements);
+    for (int c = 0; c < st.cpus; c++) {
+        ctl_appendf(out, "%s%.2f", c > 0 ? "," : "", st.cpu_load[c]);
+    }
+    ctl_appendf(out, "\n");
+    return 0;
+}
+
+// MSIX CREATE <nombre> <colas> | DESTROY <dev> | SEND <dev> <paquetes> [flujos]
+//      | STATS <dev> | HASH <origen> <destino> <puerto_o> <puerto_d> | BENCH
+static int cmd_msix(char **saveptr, ctl_buffer_t *out) {
+    int dev, value, flows;
+    irq_msix_device_info_t info;
+
+    const char *sub = strtok_r(NULL, " \t", saveptr);
+    if (sub == NULL) {
+        return ctl_error(out, ERROR_INVALID_ARG, "uso: MSIX CREATE|DESTROY|SEND|STATS|HASH|BENCH ...");
+    }
+
+    if (strcmp(sub, "CREATE") == 0) {
+        const char *name = strtok_r(NULL, " \t", saveptr);
+        if (name == NULL || !parse_int(strtok_r(NULL, " \t", saveptr), &value)) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: MSIX CREATE <nombre> <colas>");
+        }
+        dev = irq_msix_create(name, value);
+        if (dev < 0) {
+            return ctl_error(out, dev, "no se pudo crear el dispositivo");
+        }
+        irq_msix_get_info(dev, &info);
+        ctl_appendf(out, "OK dev=%d vectors=", dev);
+        for (int q = 0; q < info.queues; q++) {
+            ctl_appendf(out, "%s%d", q > 0 ? "," : "", info.queue[q].irq);
+        }
+        ctl_appendf(out, "\n");
+        return 0;
+    } else if (strcmp(sub, "DESTROY") == 0) {
+        if (!parse_int(strtok_r(NULL, " \t", saveptr), &dev)) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: MSIX DESTROY <dev>");
+        }
+        if ((value = irq_msix_destroy(dev)) != SUCCESS) {
+            return ctl_error(out, value, "no se pudo eliminar el dispositivo");
+        }
+        ctl_appendf(out, "OK\n");
+        return 0;
+    } else if (strcmp(sub, "SEND") == 0) {
+        if (!parse_int(strtok_r(NULL, " \t", saveptr), &dev) ||
+            !parse_int(strtok_r(NULL, " \t", saveptr), &value) ||
+            value < 1 || value > CTL_MAX_RAISE_COUNT) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: MSIX SEND <dev> <paquetes> [flujos]");
+        }
+        const char *flows_tok = strtok_r(NULL, " \t", saveptr);
+        flows = 64;
+        if (flows_tok != NULL && (!parse_int(flows_tok, &flows) || flows < 1)) {
+            return ctl_error(out, ERROR_INVALID_ARG, "flujos inválidos");
+        }
+        for (int i = 0; i < value; i++) {
+            irq_msix_flow_t flow;
+            irq_msix_synthetic_flow((unsigned int)(i % flows), &flow);
+            if (irq_msix_deliver(dev, &flow) < 0) {
+                return ctl_error(out, ERROR_INVALID_ARG, "dispositivo inexistente");
+            }
+        }
+        ctl_appendf(out, "OK sent=%d\n", value);
+        return 0;
+    } else if (strcmp(sub, "STATS") == 0) {
+        if (!parse_int(strtok_r(NULL, " \t", saveptr), &dev) || irq_msix_get_info(dev, &info) != SUCCESS) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: MSIX STATS <dev>");
+        }
+        ctl_appendf(out, "OK dev=%d name=%s queues=%d\n", dev, info.name, info.queues);
+        for (int q = 0; q < info.queues; q++) {
+            ctl_appendf(out, "OK q=%d irq=%d cpu=%d steered=%lu interrupts=%lu busy_us=%lu\n",
+                        q, info.queue[q].irq, info.queue[q].cpu, info.queue[q].steered,
+                        info.queue[q].interrupts, info.queue[q].busy_us);
+        }
+        return 0;
+    } else if (strcmp(sub, "HASH") == 0) {
+        unsigned int a[4], b[4];
+        int sport, dport;
+        const char *src = strtok_r(NULL, " \t", saveptr);
+        const char *dst = strtok_r(NULL, " \t", saveptr);
+        if (src == NULL || dst == NULL ||
+            sscanf(src, "%u.%u.%u.%u", &a[0], &a[1], &a[2], &a[3]) != 4 ||
+            sscanf(dst, "%u.%u.%u.%u", &b[0], &b[1], &b[2], &b[3]) != 4 ||
+            !parse_int(strtok_r(NULL, " \t", saveptr), &sport) ||
+            !parse_int(strtok_r(NULL, " \t", saveptr), &dport)) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: MSIX HASH <a.b.c.d> <a.b.c.d> <puerto> <puerto>");
+        }
+        irq_msix_flow_t flow = {
+            (a[0] << 24) | ((a[1] & 0xff) << 16) | ((a[2] & 0xff) << 8) | (a[3] & 0xff),
+            (b[0] << 24) | ((b[1] & 0xff) << 16) | ((b[2] & 0xff) << 8) | (b[3] & 0xff),
+            (uint16_t)sport, (uint16_t)dport
+        };
+        ctl_appendf(out, "OK hash=0x%08x\n", irq_msix_hash(&flow));
+        return 0;
+    } else if (strcmp(sub, "BENCH") == 0) {
+        irq_msix_bench_row_t rows[8];
+        int count = irq_msix_benchmark(IRQ_MSIX_MAX_QUEUES * 2, rows);
+        for (int i = 0; i < count; i++) {
+            ctl_appendf(out, "OK queues=%d max_share=%.3f max_cpu=%.2f p99_us=%.1f mpps=%.3f\n",
+                        rows[i].queues, rows[i].max_queue_share, rows[i].max_cpu_util,
+                        rows[i].p99_us, rows[i].mpps);
+        }
+        return 0;
+    }
+    return ctl_error(out, ERROR_INVALID_ARG, "subcomando MSIX desconocido");
+}
+
+// DEV CREATE <modelo> <eventos/s> [profundidad] | RATE <dev> <eventos/s>
+//     | STATS <dev> | DESTROY <dev>
+static int cmd_dev(char **saveptr, ctl_buffer_t *out) {
+    int dev, value, depth;
+    irq_device_stats_t st;
+
+    const char *sub = strtok_r(NULL, " \t", saveptr);
+    if (sub == NULL) {
+        return ctl_error(out, ERROR_INVALID_ARG, "uso: DEV CREATE|RATE|STATS|DESTROY ...");
+    }
+
+    if (strcmp(sub, "CREATE") == 0) {
+        const char *model = strtok_r(NULL, " \t", saveptr);
+        if (model == NULL || !parse_int(strtok_r(NULL, " \t", saveptr), &value) || value < 0) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: DEV CREATE <nic|block|serial> <eventos/s> [profundidad]");
+        }
+        const char *depth_tok = strtok_r(NULL, " \t", saveptr);
+        depth = IRQ_DEVICE_DEFAULT_DEPTH;
+        if (depth_tok != NULL && !parse_int(depth_tok, &depth)) {
+            return ctl_error(out, ERROR_INVALID_ARG, "profundidad inválida");
+        }
+        dev = irq_device_create(model, -1, (unsigned long)value, depth);
+        if (dev < 0) {
+            return ctl_error(out, dev, "no se pudo crear el dispositivo");
+        }
+        irq_device_get_stats(dev, &st);
+        ctl_appendf(out, "OK dev=%d irq=%d depth=%d buffer=%zu\n", dev, st.irq, st.depth, st.buffer_size);
+        return 0;
+    } else if (strcmp(sub, "RATE") == 0) {
+        if (!parse_int(strtok_r(NULL, " \t", saveptr), &dev) ||
+            !parse_int(strtok_r(NULL, " \t", saveptr), &value) || value < 0) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: DEV RATE <dev> <eventos/s>");
+        }
+        if (irq_device_set_rate(dev, (unsigned long)value) != SUCCESS) {
+            return ctl_error(out, ERROR_INVALID_ARG, "dispositivo inexistente");
+        }
+        ctl_appendf(out, "OK\n");
+        return 0;
+    } else if (strcmp(sub, "STATS") == 0) {
+        if (!parse_int(strtok_r(NULL, " \t", saveptr), &dev) || irq_device_get_stats(dev, &st) != SUCCESS) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: DEV STATS <dev>");
+        }
+        ctl_appendf(out, "OK dev=%d model=%s irq=%d produced=%lu consumed=%lu bytes=%lu no_buffer=%lu "
+                    "invalid=%lu interrupts=%lu isr_runs=%lu max_batch=%lu avg_latency_us=%.1f "
+                    "events_per_s=%.0f\n",
+                    dev, st.model, st.irq, st.produced, st.consumed, st.bytes, st.no_buffer,
+                    st.invalid, st.interrupts, st.isr_runs, st.max_batch,
+                    st.consumed > 0 ? st.latency_total_ns / 1000.0 / st.consumed : 0.0,
+                    st.events_per_s);
+        return 0;
+    } else if (strcmp(sub, "DESTROY") == 0) {
+        if (!parse_int(strtok_r(NULL, " \t", saveptr), &dev)) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: DEV DESTROY <dev>");
+        }
+        if ((value = irq_device_destroy(dev)) != SUCCESS) {
+            return ctl_error(out, value, "no se pudo eliminar el dispositivo");
+        }
+        ctl_appendf(out, "OK\n");
+        return 0;
+    }
+    return ctl_error(out, ERROR_INVALID_ARG, "subcomando DEV desconocido");
+}
+
+static void capture_stats_line(ctl_buffer_t *out) {
+    irq_capture_stats_t st;
+    irq_capture_get_stats(&st);
+    ctl_appendf(out, "OK active=%d captured=%lu dropped=%lu events=%lu blocks=%lu chunks=%lu "
+                "raw_bytes=%llu file_bytes=%llu bytes_per_event=%.2f seconds=%.1f writer_cpu_ms=%.1f\n",
+                st.active, st.captured, st.dropped, st.events, st.blocks, st.chunks,
+                (unsigned long long)st.raw_bytes, (unsigned long long)st.file_bytes,
+                st.bytes_per_event, st.elapsed_s, st.writer_cpu_ms);
+}
+
+// CAPTURE [STATS] | START <directorio> [chunk_kb] | STOP
+static int cmd_capture(char **saveptr, ctl_buffer_t *out) {
+    int value;
+    const char *sub = strtok_r(NULL, " \t", saveptr);
+
+    if (sub != NULL && strcmp(sub, "START") == 0) {
+        const char *dir = strtok_r(NULL, " \t", saveptr);
+        const char *chunk_tok = strtok_r(NULL, " \t", saveptr);
+        int chunk_kb = 0;
+        if (dir == NULL || (chunk_tok != NULL && (!parse_int(chunk_tok, &chunk_kb) || chunk_kb < 0))) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: CAPTURE START <directorio> [chunk_kb]");
+        }
+        if ((value = irq_capture_start(dir, (unsigned long)chunk_kb)) != SUCCESS) {
+            return ctl_error(out, value, "no se pudo iniciar la captura");
+        }
+        ctl_appendf(out, "OK dir=%s\n", dir);
+        return 0;
+    } else if (sub != NULL && strcmp(sub, "STOP") == 0) {
+        if ((value = irq_capture_stop()) != SUCCESS) {
+            return ctl_error(out, value, "no hay captura activa o falló la escritura");
+        }
+    } else if (sub != NULL && strcmp(sub, "STATS") != 0) {
+        return ctl_error(out, ERROR_INVALID_ARG, "uso: CAPTURE [STATS] | START <directorio> [chunk_kb] | STOP");
+    }
+    capture_stats_line(out);
+    return 0;
+}
+
+// Eventos de la captura a disco que cumplen q; out guarda los últimos max en
+// orden cronológico. Se puede consultar mientras el escritor sigue activo.
+static int query_capture(const char *dir, const irq_tracefile_query_t *q, trace_entry_t *out, int max,
+                         unsigned long *matched, unsigned long *decoded, unsigned long *blocks) {
+    int stored = 0, next = 0;
+    for (int n = 1;; n++) {
+        char path[512];
+        snprintf(path, sizeof(path), "%s/" IRQ_TRACEFILE_CHUNK_NAME, dir, n);
+        if (access(path, R_OK) != 0) {
+            break;
+        }
+        irq_tracefile_reader_t *r = irq_tracefile_reader_open(path, q);
+        if (r == NULL) {
+            continue;                       // Chunk recién creado, aún sin bloques
+        }
+        irq_tracefile_event_t ev;
+        while (irq_tracefile_next(r, &ev) > 0) {
+            trace_entry_t *e = &out[next];
+            time_t seconds = (time_t)(ev.timestamp_ns / 1000000000ULL);
+            struct tm timeinfo;
+            localtime_r(&seconds, &timeinfo);
+            strftime(e->timestamp, sizeof(e->timestamp), "%H:%M:%S", &timeinfo);
+            e->irq_num = ev.irq;
+            irq_tracefile_render(&ev, e->event, sizeof(e->event));
+            next = (next + 1) % max;
+            stored += stored < max;
+            (*matched)++;
+        }
+        unsigned long chunk_decoded, chunk_skipped;
+        irq_tracefile_stats_t st;
+        irq_tracefile_reader_stats(r, &chunk_decoded, &chunk_skipped, &st);
+        *decoded += chunk_decoded;
+        *blocks += st.blocks;
+        irq_tracefile_reader_close(r);
+    }
+
+    // Rotar el anillo para dejar lo más antiguo al principio
+    if (stored == max && next != 0) {
+        trace_entry_t *tmp = malloc(sizeof(trace_entry_t) * (size_t)next);
+        if (tmp == NULL) {
+            return ERROR_INVALID_ARG;
+        }
+        memcpy(tmp, out, sizeof(trace_entry_t) * (size_t)next);
+        memmove(out, out + next, sizeof(trace_entry_t) * (size_t)(max - next));
+        memcpy(out + (max - next), tmp, sizeof(trace_entry_t) * (size_t)next);
+        free(tmp);
+    }
+    return stored;
+}
+
+// QUERY [irq=a,b] [cpu=a,b] [cat=X] [type=texto] [last=s] [limit=n] [notimer] [src=live|capture]
+static int cmd_query(char **saveptr, ctl_buffer_t *out) {
+    static const char *usage =
+        "uso: QUERY [irq=a,b] [cpu=a,b] [cat=X] [type=texto] [last=s] [limit=n] [notimer] [src=live|capture]";
+    irq_tracefile_query_t q;
+    int limit = 20, last_s = 0, from_capture = 0;
+    const char *tok;
+
+    memset(&q, 0, sizeof(q));
+    while ((tok = strtok_r(NULL, " 	", saveptr)) != NULL) {
+        const char *value = strchr(tok, '=');
+        value = value != NULL ? value + 1 : "";
+        if (strncmp(tok, "irq=", 4) == 0 || strncmp(tok, "cpu=", 4) == 0) {
+            int cpus = tok[0] == 'c';
+            if (irq_tracefile_parse_mask(value, cpus, cpus ? &q.cpu_mask : &q.irq_mask) < 0) {
+                return ctl_error(out, ERROR_INVALID_ARG, usage);
+            }
+        } else if (strncmp(tok, "cat=", 4) == 0) {
+            snprintf(q.category, sizeof(q.category), "%s", value);
+        } else if (strncmp(tok, "type=", 5) == 0) {
+            // El tipo no puede llevar espacios en el protocolo: '_' hace de espacio
+            snprintf(q.type, sizeof(q.type), "%s", value);
+            for (char *p = q.type; *p != '\0'; p++) {
+                if (*p == '_') {
+                    *p = ' ';
+                }
+            }
+        } else if (strncmp(tok, "last=", 5) == 0) {
+            if (!parse_int(value, &last_s) || last_s <= 0) {
+                return ctl_error(out, ERROR_INVALID_ARG, usage);
+            }
+        } else if (strncmp(tok, "limit=", 6) == 0) {
+            if (!parse_int(value, &limit) || limit <= 0) {
+                return ctl_error(out, ERROR_INVALID_ARG, usage);
+            }
+        } else if (strcmp(tok, "notimer") == 0) {
+            q.exclude_flags = IRQ_TRACEFILE_FLAG_TIMER;
+        } else if (strcmp(tok, "src=live") == 0 || strcmp(tok, "src=capture") == 0) {
+            from_capture = tok[4] == 'c';
+        } else {
+            return ctl_error(out, ERROR_INVALID_ARG, usage);
+        }
+    }
+    if (limit > MAX_TRACE_LINES) {
+        limit = MAX_TRACE_LINES;
+    }
+    if (last_s > 0) {
+        struct timespec now;
+        clock_gettime(CLOCK_REALTIME, &now);
+        q.from_ns = (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec - (uint64_t)last_s * 1000000000ULL;
+    }
+
+    trace_entry_t *entries = malloc(sizeof(trace_entry_t) * (size_t)limit);
+    if (entries == NULL) {
+        return ctl_error(out, ERROR_INVALID_ARG, "sin memoria");
+    }
+    struct timespec started, finished;
+    unsigned long matched = 0, scanned = 0, decoded = 0, blocks = 0;
+    int count;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    if (from_capture) {
+        irq_capture_stats_t st;
+        irq_capture_get_stats(&st);
+        if (st.dir[0] == '\0') {
+            free(entries);
+            return ctl_error(out, ERROR_CAPTURE, "no hay captura (CAPTURE START <dir>)");
+        }
+        count = query_capture(st.dir, &q, entries, limit, &matched, &decoded, &blocks);
+        scanned = st.events;
+    } else {
+        count = irq_trace_query(&q, entries, limit, &scanned);
+        matched = (unsigned long)count;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+    if (count < 0) {
+        free(entries);
+        return ctl_error(out, count, "sin memoria");
+    }
+
+    ctl_appendf(out, "OK %d matched=%lu scanned=%lu blocks=%lu/%lu us=%ld\n", count, matched, scanned,
+                decoded, blocks,
+                (long)((finished.tv_sec - started.tv_sec) * 1000000L + (finished.tv_nsec - started.tv_nsec) / 1000));
+    for (int i = 0; i < count; i++) {
+        ctl_appendf(out, "[%s] [IRQ%d] %s\n", entries[i].timestamp, entries[i].irq_num, entries[i].event);
+    }
+    free(entries);
+    return 0;
+}
+
+// RECORD START <fichero> | RECORD STOP | RECORD [STATS]
+static int cmd_record(char **saveptr, ctl_buffer_t *out) {
+    const char *sub = strtok_r(NULL, " \t", saveptr);
+    irq_record_stats_t st;
+    int result;
+
+    if (sub != NULL && strcmp(sub, "START") == 0) {
+        const char *path = strtok_r(NULL, " \t", saveptr);
+        if (path == NULL) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: RECORD START <fichero>");
+        }
+        if ((result = irq_record_start(path)) != SUCCESS) {
+            return ctl_error(out, result, "no se pudo iniciar la grabación");
+        }
+        ctl_appendf(out, "OK file=%s\n", path);
+        return 0;
+    } else if (sub != NULL && strcmp(sub, "STOP") == 0) {
+        if ((result = irq_record_stop()) != SUCCESS) {
+            return ctl_error(out, result, "no hay grabación activa o falló la escritura");
+        }
+    } else if (sub != NULL && strcmp(sub, "STATS") != 0) {
+        return ctl_error(out, ERROR_INVALID_ARG, "uso: RECORD START <fichero> | STOP | [STATS]");
+    }
+
+    irq_record_get_stats(&st);
+    ctl_appendf(out, "OK recording=%d events=%lu bytes=%llu seconds=%.2f", st.recording, st.events,
+                (unsigned long long)st.bytes, st.elapsed_s);
+    for (int s = 0; s < IRQ_REPLAY_SOURCES; s++) {
+        if (st.by_source[s] > 0) {
+            ctl_appendf(out, " %s=%lu", irq_replay_source_name(s), st.by_source[s]);
+        }
+    }
+    ctl_appendf(out, "\n");
+    return 0;
+}
+
+// REPLAY START <fichero> [velocidad|afap] | REPLAY STOP | REPLAY [STATS]
+static int cmd_replay(char **saveptr, ctl_buffer_t *out) {
+    const char *sub = strtok_r(NULL, " \t", saveptr);
+    irq_replay_stats_t st;
+    int result;
+
+    if (sub != NULL && strcmp(sub, "START") == 0) {
+        const char *path = strtok_r(NULL, " \t", saveptr);
+        const char *speed_tok = strtok_r(NULL, " \t", saveptr);
+        double speed = 1.0;
+        char *end = NULL;
+        if (speed_tok != NULL && strcmp(speed_tok, "afap") == 0) {
+            speed = 0.0;
+        } else if (speed_tok != NULL) {
+            speed = strtod(speed_tok, &end);
+        }
+        if (path == NULL || (end != NULL && (*end != '\0' || speed <= 0))) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: REPLAY START <fichero> [velocidad|afap]");
+        }
+        if ((result = irq_replay_start(path, speed)) != SUCCESS) {
+            return ctl_error(out, result, "no se pudo reproducir (¿fichero válido? ¿otra en curso?)");
+        }
+    } else if (sub != NULL && strcmp(sub, "STOP") == 0) {
+        if ((result = irq_replay_stop()) != SUCCESS) {
+            return ctl_error(out, result, "no hay reproducción");
+        }
+    } else if (sub != NULL && strcmp(sub, "STATS") != 0) {
+        return ctl_error(out, ERROR_INVALID_ARG, "uso: REPLAY START <fichero> [velocidad|afap] | STOP | [STATS]");
+    }
+
+    irq_replay_get_stats(&st);
+    ctl_appendf(out, "OK active=%d events=%lu replayed=%lu speed=%.2f recorded_s=%.3f seconds=%.3f "
+                "rate=%.0f avg_lag_us=%.1f max_lag_us=%.1f\n", st.active, st.events, st.replayed, st.speed,
+                st.recorded_s, st.elapsed_s, st.rate, st.avg_lag_us, st.max_lag_us);
+    return 0;
+}
+
+// Lista de vectores en orden ("8,9,12-15"): el orden fija el rango Zipf
+static int parse_vector_list(const char *list, int *vectors) {
+    char buf[256];
+    char *save = NULL;
+    int count = 0;
+
+    snprintf(buf, sizeof(buf), "%s", list);
+    for (char *item = strtok_r(buf, ",", &save); item != NULL; item = strtok_r(NULL, ",", &save)) {
+        char *dash = strchr(item, '-');
+        int first, last;
+        if (dash != NULL) {
+            *dash = '\0';
+        }
+        if (!parse_int(item, &first) || !parse_int(dash != NULL ? dash + 1 : item, &last) || last < first) {
+            return -1;
+        }
+        for (int irq = first; irq <= last; irq++) {
+            if (count >= MAX_INTERRUPTS) {
+                return -1;
+            }
+            vectors[count++] = irq;
+        }
+    }
+    return count;
+}
+
+// LOADGEN ADD irq=a,b rate=N [proc=const|poisson|onoff] [on=ms off=ms] [zipf=s] | LOADGEN CLEAR
+// LOADGEN START [threads=n] [seconds=s] | LOADGEN STOP | LOADGEN [STATS]
+static int cmd_loadgen(char **saveptr, ctl_buffer_t *out) {
+    static const char *usage =
+        "uso: LOADGEN ADD irq=a,b rate=N [proc=const|poisson|onoff] [on=ms off=ms] [zipf=s] | CLEAR | "
+        "START [threads=n] [seconds=s] | STOP | [STATS]";
+    const char *sub = strtok_r(NULL, " \t", saveptr);
+    const char *tok;
+    irq_loadgen_stats_t st;
+    int result;
+
+    if (sub != NULL && strcmp(sub, "ADD") == 0) {
+        irq_loadgen_stream_t stream;
+        memset(&stream, 0, sizeof(stream));
+        while ((tok = strtok_r(NULL, " \t", saveptr)) != NULL) {
+            const char *value = strchr(tok, '=');
+            int ok = 1;
+            value = value != NULL ? value + 1 : "";
+            if (strncmp(tok, "irq=", 4) == 0) {
+                ok = (stream.num_vectors = parse_vector_list(value, stream.vectors)) > 0;
+            } else if (strncmp(tok, "rate=", 5) == 0) {
+                ok = parse_double(value, &stream.rate);
+            } else if (strncmp(tok, "on=", 3) == 0) {
+                ok = parse_double(value, &stream.on_ms);
+            } else if (strncmp(tok, "off=", 4) == 0) {
+                ok = parse_double(value, &stream.off_ms);
+            } else if (strncmp(tok, "zipf=", 5) == 0) {
+                ok = parse_double(value, &stream.zipf_s);
+            } else if (strcmp(tok, "proc=const") == 0 || strcmp(tok, "proc=poisson") == 0 ||
+                       strcmp(tok, "proc=onoff") == 0) {
+                stream.process = tok[5] == 'c' ? IRQ_LOADGEN_CONSTANT :
+                                 tok[5] == 'p' ? IRQ_LOADGEN_POISSON : IRQ_LOADGEN_ONOFF;
+            } else {
+                ok = 0;
+            }
+            if (!ok) {
+                return ctl_error(out, ERROR_INVALID_ARG, usage);
+            }
+        }
+        if ((result = irq_loadgen_add_stream(&stream)) < 0) {
+            return ctl_error(out, result, "flujo no válido o carga en curso");
+        }
+        ctl_appendf(out, "OK stream=%d vectors=%d rate=%.0f proc=%s\n", result, stream.num_vectors,
+                    stream.rate, irq_loadgen_process_name(stream.process));
+        return 0;
+    } else if (sub != NULL && strcmp(sub, "CLEAR") == 0) {
+        if ((result = irq_loadgen_clear()) != SUCCESS) {
+            return ctl_error(out, result, "carga en curso (LOADGEN STOP)");
+        }
+    } else if (sub != NULL && strcmp(sub, "START") == 0) {
+        int threads = 1, seconds = 0;
+        while ((tok = strtok_r(NULL, " \t", saveptr)) != NULL) {
+            if (!(strncmp(tok, "threads=", 8) == 0 && parse_int(tok + 8, &threads)) &&
+                !(strncmp(tok, "seconds=", 8) == 0 && parse_int(tok + 8, &seconds))) {
+                return ctl_error(out, ERROR_INVALID_ARG, usage);
+            }
+        }
+        if ((result = irq_loadgen_start(threads, seconds)) != SUCCESS) {
+            return ctl_error(out, result, "no se pudo iniciar (¿sin flujos? ¿ya en marcha?)");
+        }
+    } else if (sub != NULL && strcmp(sub, "STOP") == 0) {
+        if ((result = irq_loadgen_stop()) != SUCCESS) {
+            return ctl_error(out, result, "no hay carga en marcha");
+        }
+    } else if (sub != NULL && strcmp(sub, "STATS") != 0) {
+        return ctl_error(out, ERROR_INVALID_ARG, usage);
+    }
+
+    irq_loadgen_get_stats(&st);
+    ctl_appendf(out, "OK active=%d threads=%d streams=%d offered_rate=%.0f seconds=%.3f sent=%lu serviced=%lu "
+                "deferred=%lu shed=%lu rate=%.0f "
+                "p50_us=%.1f p90_us=%.1f p99_us=%.1f p999_us=%.1f max_us=%.1f service_p50_us=%.1f "
+                "service_p99_us=%.1f behind_us=%.1f max_behind_us=%.1f\n", st.active, st.threads, st.streams,
+                st.offered_rate, st.elapsed_s, st.sent, st.serviced, st.deferred, st.shed, st.achieved_rate,
+                st.p50_ns / 1e3, st.p90_ns / 1e3,
+                st.p99_ns / 1e3, st.p999_ns / 1e3, st.max_ns / 1e3, st.service_p50_ns / 1e3,
+                st.service_p99_ns / 1e3, st.behind_ns / 1e3, st.max_behind_ns / 1e3);
+    return 0;
+}
+
+// STRESS [threads=n] [readers=n] [seconds=s] [nochurn]
+static int cmd_stress(char **saveptr, ctl_buffer_t *out) {
+    irq_stress_config_t config = { 4, 1, 1, 1.0 };
+    irq_stress_result_t r;
+    const char *tok;
+    int result;
+
+    while ((tok = strtok_r(NULL, " \t", saveptr)) != NULL) {
+        if (!(strncmp(tok, "threads=", 8) == 0 && parse_int(tok + 8, &config.threads)) &&
+            !(strncmp(tok, "readers=", 8) == 0 && parse_int(tok + 8, &config.readers)) &&
+            !(strncmp(tok, "seconds=", 8) == 0 && parse_double(tok + 8, &config.seconds))) {
+            if (strcmp(tok, "nochurn") != 0) {
+                return ctl_error(out, ERROR_INVALID_ARG,
+                                 "uso: STRESS [threads=n] [readers=n] [seconds=s] [nochurn]");
+            }
+            config.churn = 0;
+        }
+    }
+    if ((result = irq_stress_run(&config, &r)) != SUCCESS) {
+        return ctl_error(out, result, "no se pudo ejecutar (¿sin vectores libres? ¿otra en curso?)");
+    }
+    ctl_appendf(out, "OK threads=%d readers=%d seconds=%.3f ops_per_s=%.0f dispatches=%lu executed=%lu "
+                "rejected=%lu registrations=%lu unregister_busy=%lu reads=%lu violations=%lu%s%s\n",
+                r.threads, r.readers, r.elapsed_s, r.ops_per_s, r.dispatches, r.executed, r.rejected,
+                r.registrations, r.unregister_busy, r.reads, r.violations,
+                r.violations > 0 ? " first=" : "", r.first_violation);
+    return 0;
+}
+
+// PROFILE [ON|OFF|RESET] | PROFILE <irq>
+static int cmd_profile(char **saveptr, ctl_buffer_t *out) {
+    const char *sub = strtok_r(NULL, " \t", saveptr);
+    irq_profile_stats_t st;
+    int irq;
+
+    if (sub != NULL && (strcmp(sub, "ON") == 0 || strcmp(sub, "OFF") == 0)) {
+        irq_profile_enable(sub[1] == 'N');
+    } else if (sub != NULL && strcmp(sub, "RESET") == 0) {
+        irq_profile_reset();
+    } else if (sub != NULL) {
+        // Desglose de un vector: una línea por fase
+        if (!parse_int(sub, &irq) || irq_profile_get_stats(irq, &st) != SUCCESS) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: PROFILE [ON|OFF|RESET] | PROFILE <irq>");
+        }
+        ctl_appendf(out, "OK irq=%d dispatches=%lu avg_ns=%.0f p99_ns=%llu top=%s\n", irq, st.dispatches,
+                    st.dispatches > 0 ? (double)st.total.total_ns / st.dispatches : 0.0,
+                    (unsigned long long)irq_profile_percentile(&st.total, 0.99),
+                    irq_profile_phase_name(irq_profile_top_overhead(&st)));
+        for (int p = 0; p < IRQ_PROFILE_PHASES; p++) {
+            const irq_profile_hist_t *h = &st.phases[p];
+            ctl_appendf(out, "OK phase=%s avg_ns=%.0f p50_ns=%llu p99_ns=%llu max_ns=%llu share_pct=%.1f\n",
+                        irq_profile_phase_name(p), st.dispatches > 0 ? (double)h->total_ns / st.dispatches : 0.0,
+                        (unsigned long long)irq_profile_percentile(h, 0.50),
+                        (unsigned long long)irq_profile_percentile(h, 0.99),
+                        (unsigned long long)h->max_ns,
+                        st.total.total_ns > 0 ? 100.0 * h->total_ns / st.total.total_ns : 0.0);
+        }
+        return 0;
+    }
+
+    ctl_appendf(out, "OK enabled=%d clock_ns=%.0f\n", irq_profile_is_enabled(), irq_profile_clock_cost_ns());
+    for (irq = 0; irq < MAX_INTERRUPTS; irq++) {
+        irq_profile_get_stats(irq, &st);
+        if (st.dispatches == 0) {
+            continue;
+        }
+        double avg = (double)st.total.total_ns / st.dispatches;
+        double handler = (double)st.phases[IRQ_PROFILE_HANDLER].total_ns / st.dispatches;
+        ctl_appendf(out, "OK irq=%d dispatches=%lu avg_ns=%.0f overhead_pct=%.1f top=%s", irq, st.dispatches,
+                    avg, avg > 0 ? 100.0 * (avg - handler) / avg : 0.0,
+                    irq_profile_phase_name(irq_profile_top_overhead(&st)));
+        for (int p = 0; p < IRQ_PROFILE_PHASES; p++) {
+            ctl_appendf(out, " %s=%.0f", irq_profile_phase_name(p), (double)st.phases[p].total_ns / st.dispatches);
+        }
+        ctl_appendf(out, "\n");
+    }
+    return 0;
+}
+
+static void rt_hist_line(ctl_buffer_t *out, const char *name, const irq_profile_hist_t *h) {
+    ctl_appendf(out, "OK hist=%s count=%lu avg_ns=%.0f p50_ns=%llu p99_ns=%llu max_ns=%llu\n", name, h->count,
+                h->count > 0 ? (double)h->total_ns / h->count : 0.0,
+                (unsigned long long)irq_profile_percentile(h, 0.50),
+                (unsigned long long)irq_profile_percentile(h, 0.99), (unsigned long long)h->max_ns);
+}
+
+// RT [RESET] | RT JITTER [seconds=s] [period_us=n]
+static int cmd_rt(char **saveptr, ctl_buffer_t *out) {
+    const char *sub = strtok_r(NULL, " \t", saveptr);
+    irq_rt_status_t st;
+    int result;
+
+    if (sub != NULL && strcmp(sub, "JITTER") == 0) {
+        irq_rt_jitter_t j;
+        double seconds = 1.0;
+        int period_us = 1000;
+        const char *tok;
+        while ((tok = strtok_r(NULL, " \t", saveptr)) != NULL) {
+            if (!(strncmp(tok, "seconds=", 8) == 0 && parse_double(tok + 8, &seconds)) &&
+                !(strncmp(tok, "period_us=", 10) == 0 && parse_int(tok + 10, &period_us))) {
+                return ctl_error(out, ERROR_INVALID_ARG, "uso: RT JITTER [seconds=s] [period_us=n]");
+            }
+        }
+        if ((result = irq_rt_measure_jitter(seconds, period_us, &j)) != SUCCESS) {
+            return ctl_error(out, result, "no se pudo medir (¿valores fuera de rango? ¿otra en curso?)");
+        }
+        ctl_appendf(out, "OK samples=%lu period_us=%d seconds=%.3f fifo=%d cpu=%d overruns=%lu\n", j.samples,
+                    j.period_us, j.seconds, j.fifo, j.cpu, j.overruns);
+        rt_hist_line(out, "wakeup", &j.wakeup);
+        rt_hist_line(out, "dispatch", &j.dispatch);
+        return 0;
+    } else if (sub != NULL && strcmp(sub, "RESET") == 0) {
+        irq_rt_reset_timer_stats();
+    } else if (sub != NULL) {
+        return ctl_error(out, ERROR_INVALID_ARG, "uso: RT [RESET] | RT JITTER [seconds=s] [period_us=n]");
+    }
+
+    irq_rt_get_status(&st);
+    ctl_appendf(out, "OK enabled=%d cpu_mask=0x%llx prio=%d lock=%d locked=%d threads=%lu fifo=%lu pinned=%lu "
+                "sched_errno=%d ticks=%lu overruns=%lu\n", st.enabled, (unsigned long long)st.config.cpu_mask,
+                st.config.priority, st.config.lock_memory, st.memory_locked, st.threads, st.fifo_threads,
+                st.pinned_threads, st.sched_errno, st.timer_ticks, st.timer_overruns);
+    rt_hist_line(out, "timer_wakeup", &st.timer_wakeup);
+    rt_hist_line(out, "timer_dispatch", &st.timer_dispatch);
+    return 0;
+}
+
+// ALLOC [CHECK <despachos>]
+static int cmd_alloc(char **saveptr, ctl_buffer_t *out) {
+    int value;
+    const char *sub = strtok_r(NULL, " \t", saveptr);
+
+    if (sub != NULL && strcmp(sub, "CHECK") == 0) {
+        if (!parse_int(strtok_r(NULL, " \t", saveptr), &value) ||
+            value < 1 || value > CTL_MAX_RAISE_COUNT) {
+            return ctl_error(out, ERROR_INVALID_ARG, "uso: ALLOC CHECK <despachos>");
+        }
+        long mallocs = irq_slab_dispatch_check(value);
+        if (mallocs == -1) {
+            return ctl_error(out, ERROR_INVALID_ARG, "sonda no cargada (LD_PRELOAD=./irq_alloc_probe.so)");
+        } else if (mallocs < 0) {
+            return ctl_error(out, (int)mallocs, "no hay vectores libres o se ocupó al registrar");
+        }
+        ctl_appendf(out, "OK dispatches=%d mallocs=%ld\n", value, mallocs);
+        return 0;
+    } else if (sub != NULL) {
+        return ctl_error(out, ERROR_INVALID_ARG, "uso: ALLOC [CHECK <despachos>]");
+    }
+
+    for (int i = 0; i < irq_slab_count(); i++) {
+        irq_slab_stats_t st;
+        irq_slab_get_stats(i, &st);
+        ctl_appendf(out, "OK slab=%s size=%zu caches=%d chunks=%lu allocs=%lu frees=%lu "
+                    "cross_frees=%lu live=%lu high_water=%lu\n",
+                    st.name, st.object_size, st.caches, st.chunks, st.allocs, st.frees,
+                    st.cross_frees, st.live, st.high_water);
+    }
+    ctl_appendf(out, "OK probe=%d\n", irq_alloc_probe_count != NULL);
+    return 0;
+}
+
+// Ejecutar una línea del protocolo
+int ctl_execute_line(const char *line, ctl_buffer_t *out) {
+    char buf[CTL_MAX_LINE];
+    char *saveptr = NULL;
+    int irq, value;
+
+    snprintf(buf, sizeof(buf), "%s", line);
+    size_t len = strlen(buf);
+    if (len > 0 && buf[len - 1] == '\r') {
+        buf[len - 1] = '\0';
+    }
+
+    char *cmd = strtok_r(buf, " \t", &saveptr);
+    if (cmd == NULL) {
+        return 0;  // Línea vacía: sin respuesta
+    }
+
+    if (strcmp(cmd, "PING") == 0) {
+        ctl_appendf(out, "OK PONG\n");
+    } else if (strcmp(cmd, "REG") == 0) {
+        cmd_register(&saveptr, out);
+    } else if (strcmp(cmd, "UNREG") == 0) {
+        if (!parse_int(strtok_r(NULL, " \t", &saveptr), &irq)) {
+            ctl_error(out, ERROR_INVALID_ARG, "uso: UNREG <irq>");
+        } else if ((value = unregister_isr(irq)) != SUCCESS) {
+            ctl_error(out, value, "desregistro rechazado");
+        } else {
+            ctl_appendf(out, "OK\n");
+        }
+    } else if (strcmp(cmd, "RAISE") == 0) {
+        const char *count_tok;
+        if (!parse_int(strtok_r(NULL, " \t", &saveptr), &irq)) {
+            ctl_error(out, ERROR_INVALID_ARG, "uso: RAISE <irq> [count]");
+        } else if ((count_tok = strtok_r(NULL, " \t", &saveptr)) == NULL) {
+            cmd_raise(irq, 1, out);
+        } else if (!parse_int(count_tok, &value)) {
+            ctl_error(out, ERROR_INVALID_ARG, "count inválido");
+        } else {
+            cmd_raise(irq, value, out);
+        }
+    } else if (strcmp(cmd, "BURST") == 0) {
+        cmd_burst(&saveptr, out);
+    } else if (strcmp(cmd, "AFFINITY") == 0 || strcmp(cmd, "PRIO") == 0) {
+        if (!parse_int(strtok_r(NULL, " \t", &saveptr), &irq) ||
+            !parse_int(strtok_r(NULL, " \t", &saveptr), &value)) {
+            ctl_error(out, ERROR_INVALID_ARG, "uso: AFFINITY|PRIO <irq> <valor>");
+        } else {
+            int result = cmd[0] == 'A' ? set_irq_affinity(irq, value) : set_irq_priority(irq, value);
+            if (result != SUCCESS) {
+                ctl_error(out, result, "valor rechazado");
+            } else {
+                ctl_appendf(out, "OK\n");
+            }
+        }
+    } else if (strcmp(cmd, "STATS") == 0) {
+        cmd_stats(&saveptr, out);
+    } else if (strcmp(cmd, "TRACE") == 0) {
+        cmd_trace(&saveptr, out);
+    } else if (strcmp(cmd, "BUDGET") == 0 || strcmp(cmd, "THREAD") == 0) {
+        cmd_budget(&saveptr, out, cmd[0] == 'T');
+    } else if (strcmp(cmd, "ALLOC") == 0) {
+        cmd_alloc(&saveptr, out);
+    } else if (strcmp(cmd, "RECORD") == 0) {
+        cmd_record(&saveptr, out);
+    } else if (strcmp(cmd, "REPLAY") == 0) {
+        cmd_replay(&saveptr, out);
+    } else if (strcmp(cmd, "LOADGEN") == 0) {
+        cmd_loadgen(&saveptr, out);
+    } else if (strcmp(cmd, "STRESS") == 0) {
+        cmd_stress(&saveptr, out);
+    } else if (strcmp(cmd, "PROFILE") == 0) {
+        cmd_profile(&saveptr, out);
+    } else if (strcmp(cmd, "RT") == 0) {
+        cmd_rt(&saveptr, out);
+    } else if (strcmp(cmd, "QUERY") == 0) {
+        cmd_query(&saveptr, out);
+    } else if (strcmp(cmd, "CAPTURE") == 0) {
+        cmd_capture(&saveptr, out);
+    } else if (strcmp(cmd, "DEV") == 0) {
+        cmd_dev(&saveptr, out);
+    } else if (strcmp(cmd, "MSIX") == 0) {
+        cmd_msix(&saveptr, out);
+    } else if (strcmp(cmd, "BALANCE") == 0) {
+        cmd_balance(&saveptr, out);
+    } else if (strcmp(cmd, "WORKQ") == 0) {
+        cmd_workq(&saveptr, out);
+    } else if (strcmp(cmd, "CORO") == 0) {
+        cmd_coro(&saveptr, out);
+    } else if (strcmp(cmd, "STORM") == 0) {
+        cmd_storm(&saveptr, out);
+    } else if (strcmp(cmd, "PLUGIN") == 0) {
+        cmd_plugin(&saveptr, out);
+    } else if (strcmp(cmd, "LOG") == 0) {
+        const char *level = strtok_r(NULL, " \t", &saveptr);
+        if (level != NULL && strcmp(level, "silent") == 0) {
+            swap_log_level(LOG_LEVEL_SILENT);
+        } else if (level != NULL && strcmp(level, "user") == 0) {
+            swap_log_level(LOG_LEVEL_USER_ONLY);
+        } else if (level != NULL && strcmp(level, "verbose") == 0) {
+            swap_log_level(LOG_LEVEL_VERBOSE);
+        } else {
+            ctl_error(out, ERROR_INVALID_ARG, "uso: LOG silent|user|verbose");
+            return 0;
+        }
+        ctl_appendf(out, "OK\n");
+    } else if (strcmp(cmd, "QUIT") == 0) {
+        ctl_appendf(out, "OK BYE\n");
+        return 1;
+    } else {
+        ctl_error(out, ERROR_INVALID_ARG, "comando desconocido");
+    }
+    return 0;
+}
+
+// Escribir todo el buffer aunque el socket acepte escrituras parciales
+static int write_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// Hilo por cliente: procesa todas las líneas completas de cada lectura
+static void *ctl_client_func(void *arg) {
+    ctl_client_t *client = (ctl_client_t *)arg;
+    char *in = malloc(CTL_READ_BUFFER);
+    ctl_buffer_t out = {malloc(CTL_READ_BUFFER), 0, CTL_READ_BUFFER};
+    size_t in_len = 0;
+    int quit = 0;
+
+    irq_replay_set_source(IRQ_REPLAY_SRC_CTL);
+    if (in == NULL || out.data == NULL) {
+        free(in);
+        free(out.data);
+        // El fd lo cierra reap_finished_clients(), como al terminar normalmente
+        shutdown(client->fd, SHUT_RDWR);
+        return NULL;
+    }
+
+    while (!quit) {
+        ssize_t n = recv(client->fd, in + in_len, CTL_READ_BUFFER - in_len - 1, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        in_len += (size_t)n;
+        in[in_len] = '\0';
+
+        unsigned long batch = 0;
+        unsigned long errors = 0;
+        char *start = in;
+        char *newline;
+        out.len = 0;
+
+        while (!quit && (newline = memchr(start, '\n', in_len - (size_t)(start - in))) != NULL) {
+            *newline = '\0';
+            size_t before = out.len;
+            quit = ctl_execute_line(start, &out);
+            if (out.len > before && strncmp(out.data + before, "ERR", 3) == 0) {
+                errors++;
+            }
+            batch++;
+            start = newline + 1;
+        }
+
+        // Conservar la línea incompleta para la próxima lectura
+        size_t remaining = in_len - (size_t)(start - in);
+        if (remaining == CTL_READ_BUFFER - 1) {
+            ctl_appendf(&out, "ERR %d línea demasiado larga\n", ERROR_INVALID_ARG);
+            remaining = 0;
+            errors++;
+        }
+        memmove(in, start, remaining);
+        in_len = remaining;
+
+        if (out.len > 0 && write_all(client->fd, out.data, out.len) != 0) {
+            break;
+        }
+
+        pthread_mutex_lock(&ctl_mutex);
+        ctl_stats.commands += batch;
+        ctl_stats.errors += errors;
+        if (batch > 0) {
+            ctl_stats.round_trips++;
+        }
+        if (batch > ctl_stats.max_batch) {
+            ctl_stats.max_batch = batch;
+        }
+        pthread_mutex_unlock(&ctl_mutex);
+    }
+
+    free(in);
+    free(out.data);
+    shutdown(client->fd, SHUT_RDWR);
+    return NULL;
+}
+
+// Liberar los clientes que ya terminaron (con ctl_mutex tomado)
+static void reap_finished_clients(int wait_all) {
+    for (int i = 0; i < CTL_MAX_CLIENTS; i++) {
+        if (!clients[i].active) {
+            continue;
+        }
+        if (wait_all) {
+            shutdown(clients[i].fd, SHUT_RDWR);
+        } else if (pthread_tryjoin_np(clients[i].thread, NULL) != 0) {
+            continue;
+        }
+        if (wait_all) {
+            pthread_join(clients[i].thread, NULL);
+        }
+        close(clients[i].fd);
+        clients[i].active = 0;
+    }
+}
+
+// Hilo aceptador de conexiones
+static void *ctl_accept_func(void *arg) {
+    (void)arg;
+
+    while (__atomic_load_n(&server_running, __ATOMIC_ACQUIRE)) {
+        int fd = accept4(listen_fd, NULL, NULL, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            break;  // shutdown() del socket de escucha al detener el servidor
+        }
+
+        pthread_mutex_lock(&ctl_mutex);
+        reap_finished_clients(0);
+
+        int slot = -1;
+        for (int i = 0; i < CTL_MAX_CLIENTS; i++) {
+            if (!clients[i].active) {
+                slot = i;
+                break;
+            }
+        }
+
+        if (slot < 0) {
+            pthread_mutex_unlock(&ctl_mutex);
+            const char *busy = "ERR -6 demasiados clientes\n";
+            write_all(fd, busy, strlen(busy));
+            close(fd);
+            continue;
+        }
+
+        clients[slot].fd = fd;
+        clients[slot].active = 1;
+        if (pthread_create(&clients[slot].thread, NULL, ctl_client_func, &clients[slot]) != 0) {
+            clients[slot].active = 0;
+            close(fd);
+        } else {
+            ctl_stats.connections++;
+        }
+        pthread_mutex_unlock(&ctl_mutex);
+    }
+    return NULL;
+}
+
+// ¿Hay otra instancia escuchando en la ruta? Un socket huérfano rechaza la conexión
+static int socket_in_use(const struct sockaddr_un *addr) {
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return 0;
+    }
+    int in_use = connect(fd, (const struct sockaddr *)addr, sizeof(*addr)) == 0;
+    close(fd);
+    return in_use;
+}
+
+// Crear el socket de control y arrancar el hilo aceptador
+int ctl_server_start(const char *path) {
+    if (__atomic_load_n(&server_running, __ATOMIC_ACQUIRE)) {
+        return SUCCESS;
+    }
+    if (path == NULL) {
+        path = CTL_DEFAULT_SOCKET_PATH;
+    }
+    if (strlen(path) >= sizeof(socket_path)) {
+        return ERROR_INVALID_ARG;
+    }
+    snprintf(socket_path, sizeof(socket_path), "%s", path);
+
+    listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listen_fd < 0) {
+        return ERROR_INVALID_ARG;
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, socket_path, strlen(socket_path) + 1);
+
+    // Nunca quitar el socket a otro simulador en marcha (acepta PLUGIN LOAD)
+    if (socket_in_use(&addr)) {
+        close(listen_fd);
+        listen_fd = -1;
+        char trace_msg[MAX_TRACE_MSG_LEN];
+        snprintf(trace_msg, sizeof(trace_msg),
+            "⚠️  KERNEL: %s ya lo usa otra instancia - Plano de control desactivado", socket_path);
+        add_trace(trace_msg);
+        return ERROR_INVALID_ARG;
+    }
+    unlink(socket_path);
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+        listen(listen_fd, CTL_MAX_CLIENTS) != 0) {
+        close(listen_fd);
+        listen_fd = -1;
+        add_trace("❌ KERNEL: No se pudo crear el socket de control");
+        return ERROR_INVALID_ARG;
+    }
+
+    memset(&ctl_stats, 0, sizeof(ctl_stats));
+    __atomic_store_n(&server_running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&accept_thread, NULL, ctl_accept_func, NULL) != 0) {
+        __atomic_store_n(&server_running, 0, __ATOMIC_RELEASE);
+        close(listen_fd);
+        listen_fd = -1;
+        unlink(socket_path);
+        return ERROR_INVALID_ARG;
+    }
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg),
+        "🎛️  KERNEL: Plano de control escuchando en %s", socket_path);
+    add_trace_silent(trace_msg);
+    return SUCCESS;
+}
+
+// Cerrar el socket, desconectar a los clientes y esperar a sus hilos
+void ctl_server_stop(void) {
+    if (!__atomic_load_n(&server_running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    __atomic_store_n(&server_running, 0, __ATOMIC_RELEASE);
+    shutdown(listen_fd, SHUT_RDWR);
+    pthread_join(accept_thread, NULL);
+    close(listen_fd);
+    listen_fd = -1;
+    unlink(socket_path);
+
+    pthread_mutex_lock(&ctl_mutex);
+    reap_finished_clients(1);
+    pthread_mutex_unlock(&ctl_mutex);
+}
+
+int ctl_server_is_running(void) {
+    return __atomic_load_n(&server_running, __ATOMIC_ACQUIRE);
+}
+
+void ctl_get_stats(ctl_stats_t *out) {
+    pthread_mutex_lock(&ctl_mutex);
+    *out = ctl_stats;
+    pthread_mutex_unlock(&ctl_mutex);
+}
@@ -0,0 +1,106 @@
+#ifndef IRQ_CTL_H
+#define IRQ_CTL_H
+
+#include "interrupt_simulator.h"
+
+// Plano de control local por socket Unix
+//
+// Protocolo de líneas: cada comando termina en '\n' y produce exactamente una
+// respuesta que empieza por "OK" o "ERR <código>". Las respuestas con varias
+// líneas (TRACE) anuncian cuántas siguen ("OK <n>"). Los comandos se pueden
+// encadenar sin esperar respuesta: el servidor procesa todas las líneas
+// completas de cada lectura y devuelve todas las respuestas en una sola
+// escritura, de modo que un arnés puede enviar miles de operaciones por viaje.
+//
+// Comandos:
+//   PING                          -> OK PONG
+//   REG <irq> [handler] [desc]    handler: custom|keyboard|timer|error
+//   UNREG <irq>
+//   RAISE <irq> [count]           dispara <count> veces (por defecto 1)
+//   BURST <count> <irq,irq,...>   <count> disparos repartidos round-robin
+//   AFFINITY <irq> <cpu>          cpu = -1 para cualquiera
+//   PRIO <irq> <prioridad>
+//   STATS [irq]                   estadísticas globales o de un vector
+//   TRACE [n]                     últimas n entradas de la traza
+//   TRACE STATS                   registros, plantillas y memoria de la traza
+//   PLUGIN LOAD <ruta>            carga un .so de ISRs (-> OK id=<n>)
+//   PLUGIN ATTACH <irq> <handler> handler: nombre o plugin/nombre
+//   PLUGIN DETACH <irq>
+//   PLUGIN STATS <irq>            tiempos de mitad superior e inferior
+//   STORM <irq> [límite]          estado de tormentas (y límite en IRQs/s)
+//   BUDGET <irq> [us límite_us 0|1] presupuesto, watchdog y degradación a hilo
+//   THREAD <irq> 0|1              atender el vector en su hilo irq/N
+//   CORO <irq> [0|1]              atender el vector con corrutinas cooperativas
+//   WORKQ [hilos [fijar]]         métricas del pool diferido (o reiniciarlo)
+//   WORKQ BENCH <trabajos>        carga mixta en ráfagas sobre el pool
+//   BALANCE [0|1]                 estado del balanceador (o habilitarlo)
+//   BALANCE CONFIG <cpus> <ms> <umbral%>
+//   BALANCE BENCH [segundos]      latencia con y sin balanceo, carga sesgada
+//   MSIX CREATE <nombre> <colas>  dispositivo multicola (-> OK dev=<n> vectors=...)
+//   MSIX DESTROY <dev>
+//   MSIX SEND <dev> <n> [flujos]  tráfico sintético repartido por RSS
+//   MSIX STATS <dev>              una línea por cola
+//   MSIX HASH <ip> <ip> <p> <p>   hash Toeplitz de un flujo
+//   MSIX BENCH                    escalado con 1..16 colas (simulado)
+//   DEV CREATE <modelo> <ev/s> [prof]  nic|block|serial con anillos DMA (-> OK dev=<n> irq=...)
+//   DEV RATE <dev> <ev/s>         0 = tan rápido como se pueda
+//   DEV STATS <dev>               producidos, consumidos, latencia y eventos/s
+//   DEV DESTROY <dev>
+//   ALLOC                         una línea por slab (vivos, máximo, liberados remotos)
+//   ALLOC CHECK <n>               reservas de heap en n despachos (requiere la sonda)
+//   CAPTURE START <dir> [chunk_kb] captura continua de la traza a disco (leer con irqtrace)
+//   CAPTURE [STATS]               eventos, descartados, bytes por evento y CPU del escritor
+//   CAPTURE STOP                  vacía, escribe el índice del chunk y devuelve las cifras
+//   RECORD START <fichero>        graba cada interrupción (vector, tiempo, fuente)
+//   RECORD [STATS] | RECORD STOP  eventos, bytes y reparto por fuente
+//   REPLAY START <fichero> [velocidad|afap]
+//                                 reproduce una grabación (1 = tiempos originales)
+//   REPLAY [STATS] | REPLAY STOP  progreso, IRQ/s y retraso respecto al plan
+//   LOADGEN ADD irq=a,b rate=N [proc=const|poisson|onoff] [on=ms off=ms] [zipf=s]
+//                                 añade un flujo de carga sintética (vectores en orden Zipf)
+//   LOADGEN START [threads=n] [seconds=s] | LOADGEN STOP | LOADGEN CLEAR
+//   LOADGEN [STATS]               tasa conseguida, latencia desde el instante previsto y servicio
+//   STRESS [threads=n] [readers=n] [seconds=s] [nochurn]
+//                                 despacho, registro y lecturas concurrentes; ops/s e invariantes
+//   PROFILE [ON|OFF|RESET]        perfilado de fases del despacho; media por fase de cada vector
+//   PROFILE <irq>                 media, p50, p99, máximo y peso de cada fase del vector
+//   RT [RESET]                    modo tiempo real: hilos FIFO/fijados e histogramas del timer
+//   RT JITTER [seconds=s] [period_us=n]
+//                                 despertares periódicos: retraso (SO) y despacho (simulador)
+//   QUERY [irq=a,b] [cpu=a,b] [cat=X] [type=texto] [last=s] [limit=n] [notimer] [src=live|capture]
+//                                 últimos eventos que cumplen el filtro (type: '_' = espacio);
+//                                 src=capture consulta los chunks en disco usando su índice
+//   LOG silent|user|verbose
+//   QUIT                          cierra la conexión
+
+#define CTL_DEFAULT_SOCKET_PATH "/tmp/irqsim.sock"
+#define CTL_MAX_CLIENTS 16
+#define CTL_READ_BUFFER 65536
+#define CTL_MAX_LINE 1024
+#define CTL_MAX_RAISE_COUNT 1000000
+
+// Buffer de respuestas acumuladas para una ráfaga de comandos
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} ctl_buffer_t;
+
+// Estadísticas del plano de control
+typedef struct {
+    unsigned long connections;
+    unsigned long commands;
+    unsigned long errors;
+    unsigned long round_trips;          // Lecturas que produjeron respuestas
+    unsigned long max_batch;            // Máximo de comandos por lectura
+} ctl_stats_t;
+
+int ctl_server_start(const char *path);
+void ctl_server_stop(void);
+int ctl_server_is_running(void);
+void ctl_get_stats(ctl_stats_t *out);
+
+// Ejecutar una línea y añadir su respuesta a `out`. Devuelve 1 si pidió QUIT.
+int ctl_execute_line(const char *line, ctl_buffer_t *out);
+
+#endif // IRQ_CTL_H
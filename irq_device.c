@@ -0,0 +1,588 @@
+#define _GNU_SOURCE
+#include "irq_device.h"
+#include "irq_replay.h"
+#include "irq_rt.h"
+
+// Contadores escritos por un solo lado del anillo y leídos desde fuera
+#define STAT_ADD(field, value) \
+    __atomic_store_n(&(field), __atomic_load_n(&(field), __ATOMIC_RELAXED) + (value), __ATOMIC_RELAXED)
+#define STAT_GET(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+
+#define DEVICE_REASSERT_NS 1000000ULL       // Re-disparar una interrupción no atendida
+
+// Descriptor del anillo de completado
+typedef struct {
+    uint32_t buffer;                        // Índice en el pool
+    uint32_t len;
+    uint64_t seq;
+    uint64_t timestamp_ns;
+} device_desc_t;
+
+typedef struct {
+    int active;
+    int irq;
+    const irq_device_model_t *model;
+    unsigned long rate;
+    int depth;
+    uint32_t mask;
+    size_t buffer_size;
+    uint8_t *pool;                          // depth buffers contiguos
+
+    // Anillo de llenado: la ISR produce, el dispositivo consume
+    uint32_t fill_head __attribute__((aligned(64)));
+    uint32_t fill_tail __attribute__((aligned(64)));
+    uint32_t *fill;
+
+    // Anillo de completado: el dispositivo produce, la ISR consume
+    uint32_t comp_head __attribute__((aligned(64)));
+    uint32_t comp_tail __attribute__((aligned(64)));
+    device_desc_t *comp;
+
+    int irq_pending;
+    int in_isr;                             // Un solo consumidor a la vez
+    uint64_t expected_seq;
+    pthread_t thread;
+    int running;
+    uint64_t start_ns;
+
+    // Lado productor
+    unsigned long produced;
+    unsigned long no_buffer;
+    unsigned long interrupts;
+    // Lado consumidor
+    unsigned long consumed;
+    unsigned long bytes;
+    unsigned long invalid;
+    unsigned long isr_runs;
+    unsigned long max_batch;
+    unsigned long latency_total_ns;
+    unsigned long latency_max_ns;
+} device_t;
+
+static device_t devices[IRQ_DEVICE_MAX];
+static int irq_owner[MAX_INTERRUPTS];       // id + 1 del dispositivo, 0 = ninguno
+static pthread_mutex_t device_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint32_t next_random(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+// ---- Modelos ----
+
+// Suma de comprobación de Internet (complemento a uno de 16 bits)
+static uint16_t inet_checksum(const uint8_t *data, size_t len) {
+    uint32_t sum = 0;
+    for (size_t i = 0; i + 1 < len; i += 2) {
+        sum += (uint32_t)(data[i] << 8 | data[i + 1]);
+    }
+    if (len & 1) {
+        sum += (uint32_t)data[len - 1] << 8;
+    }
+    while (sum >> 16) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return (uint16_t)~sum;
+}
+
+// NIC: trama Ethernet de 64 a 1514 bytes con secuencia y checksum del payload
+static size_t nic_produce(uint8_t *buf, size_t capacity, uint64_t seq, uint32_t *rng) {
+    size_t len = 64 + next_random(rng) % (1514 - 64 + 1);
+    if (len > capacity) {
+        len = capacity;
+    }
+    static const uint8_t header[14] = {
+        0x02, 0x00, 0x00, 0x00, 0x00, 0x01, 0x02, 0x00, 0x00, 0x00, 0x00, 0x02, 0x08, 0x00
+    };
+    memcpy(buf, header, sizeof(header));
+    memcpy(buf + 14, &seq, sizeof(seq));
+    for (size_t i = 24; i < len; i++) {
+        buf[i] = (uint8_t)(seq + i);
+    }
+    uint16_t csum = inet_checksum(buf + 24, len - 24);
+    buf[22] = (uint8_t)(csum >> 8);
+    buf[23] = (uint8_t)csum;
+    return len;
+}
+
+static int nic_consume(const uint8_t *buf, size_t len, uint64_t seq) {
+    uint64_t frame_seq;
+    memcpy(&frame_seq, buf + 14, sizeof(frame_seq));
+    uint16_t csum = (uint16_t)(buf[22] << 8 | buf[23]);
+    return (len < 64 || buf[12] != 0x08 || frame_seq != seq ||
+            inet_checksum(buf + 24, len - 24) != csum) ? -1 : 0;
+}
+
+// Bloque: sector de 4 KiB con el LBA y un patrón verificable por palabra
+static size_t block_produce(uint8_t *buf, size_t capacity, uint64_t seq, uint32_t *rng) {
+    (void)rng;
+    uint64_t *words = (uint64_t *)buf;
+    size_t count = capacity / sizeof(uint64_t);
+    words[0] = seq;
+    for (size_t i = 1; i < count; i++) {
+        words[i] = seq ^ (i * 0x9e3779b97f4a7c15ULL);
+    }
+    return count * sizeof(uint64_t);
+}
+
+static int block_consume(const uint8_t *buf, size_t len, uint64_t seq) {
+    const uint64_t *words = (const uint64_t *)buf;
+    size_t count = len / sizeof(uint64_t);
+    uint64_t diff = words[0] ^ seq;
+    for (size_t i = 1; i < count; i++) {
+        diff |= words[i] ^ (seq ^ (i * 0x9e3779b97f4a7c15ULL));
+    }
+    return diff != 0 ? -1 : 0;
+}
+
+// Serie: de 1 a 16 caracteres por interrupción, como una UART con FIFO
+static size_t serial_produce(uint8_t *buf, size_t capacity, uint64_t seq, uint32_t *rng) {
+    size_t len = 1 + next_random(rng) % 16;
+    if (len > capacity) {
+        len = capacity;
+    }
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = (uint8_t)('a' + (seq + i) % 26);
+    }
+    return len;
+}
+
+static int serial_consume(const uint8_t *buf, size_t len, uint64_t seq) {
+    for (size_t i = 0; i < len; i++) {
+        if (buf[i] != (uint8_t)('a' + (seq + i) % 26)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static const irq_device_model_t device_models[] = {
+    {"nic", "Tarjeta de red (tramas Ethernet)", 2048, nic_produce, nic_consume},
+    {"block", "Disco (sectores de 4 KiB)", 4096, block_produce, block_consume},
+    {"serial", "Puerto serie (UART con FIFO)", 64, serial_produce, serial_consume},
+};
+
+const irq_device_model_t *irq_device_find_model(const char *name) {
+    for (size_t i = 0; i < sizeof(device_models) / sizeof(device_models[0]); i++) {
+        if (strcmp(device_models[i].name, name) == 0) {
+            return &device_models[i];
+        }
+    }
+    return NULL;
+}
+
+// ---- Driver: ISR que vacía el anillo de completado ----
+
+static void device_isr(int irq_num) {
+    int id = irq_owner[irq_num] - 1;
+    if (id < 0) {
+        return;
+    }
+    device_t *d = &devices[id];
+
+    // En modo corrutina o en hilo puede haber dos instancias: la segunda sale
+    if (__atomic_exchange_n(&d->in_isr, 1, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    __atomic_store_n(&d->irq_pending, 0, __ATOMIC_RELEASE);
+
+    unsigned long batch = 0, bytes = 0, invalid = 0, latency_total = 0, latency_max = 0;
+    uint64_t now = now_ns();
+    for (;;) {
+        uint32_t tail = d->comp_tail;
+        if (tail == __atomic_load_n(&d->comp_head, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+        device_desc_t desc = d->comp[tail & d->mask];
+
+        // Los datos se procesan en el buffer del pool, sin copiarlos
+        const uint8_t *data = d->pool + (size_t)desc.buffer * d->buffer_size;
+        if (desc.seq != d->expected_seq || d->model->consume(data, desc.len, desc.seq) != 0) {
+            invalid++;
+        }
+        d->expected_seq = desc.seq + 1;
+        __atomic_store_n(&d->comp_tail, tail + 1, __ATOMIC_RELEASE);
+
+        // Devolver el buffer al dispositivo
+        uint32_t head = d->fill_head;
+        d->fill[head & d->mask] = desc.buffer;
+        __atomic_store_n(&d->fill_head, head + 1, __ATOMIC_RELEASE);
+
+        unsigned long latency = now > desc.timestamp_ns ? (unsigned long)(now - desc.timestamp_ns) : 0;
+        latency_total += latency;
+        if (latency > latency_max) {
+            latency_max = latency;
+        }
+        bytes += desc.len;
+        batch++;
+    }
+
+    STAT_ADD(d->consumed, batch);
+    STAT_ADD(d->bytes, bytes);
+    STAT_ADD(d->invalid, invalid);
+    STAT_ADD(d->isr_runs, 1);
+    STAT_ADD(d->latency_total_ns, latency_total);
+    if (latency_max > STAT_GET(d->latency_max_ns)) {
+        __atomic_store_n(&d->latency_max_ns, latency_max, __ATOMIC_RELAXED);
+    }
+    if (batch > STAT_GET(d->max_batch)) {
+        __atomic_store_n(&d->max_batch, batch, __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&d->in_isr, 0, __ATOMIC_RELEASE);
+}
+
+// ---- Hardware: hilo que genera eventos al ritmo configurado ----
+
+static void *device_thread_func(void *arg) {
+    device_t *d = (device_t *)arg;
+    irq_rt_enter_thread();
+    irq_replay_set_source(IRQ_REPLAY_SRC_DEVICE);
+    uint32_t rng = 0x12345678u ^ (uint32_t)d->irq;
+    uint64_t seq = 0, emitted = 0, raised_ns = 0;
+    unsigned long rate = 0;
+    uint64_t epoch = now_ns();
+
+    while (__atomic_load_n(&d->running, __ATOMIC_ACQUIRE)) {
+        uint64_t now = now_ns();
+        unsigned long current_rate = __atomic_load_n(&d->rate, __ATOMIC_RELAXED);
+        if (current_rate != rate) {
+            rate = current_rate;
+            epoch = now;
+            emitted = 0;
+        }
+
+        uint64_t due = (uint64_t)d->depth;
+        if (rate > 0) {
+            uint64_t target = (now - epoch) * rate / 1000000000ULL;
+            due = target > emitted ? target - emitted : 0;
+            if (due > (uint64_t)d->depth) {
+                due = (uint64_t)d->depth;
+            }
+        }
+
+        uint32_t produced = 0;
+        for (uint64_t i = 0; i < due; i++) {
+            uint32_t tail = d->fill_tail;
+            if (tail == __atomic_load_n(&d->fill_head, __ATOMIC_ACQUIRE)) {
+                if (rate > 0) {
+                    STAT_ADD(d->no_buffer, 1);  // El evento llega igual y se pierde
+                    emitted++;
+                    continue;
+                }
+                break;
+            }
+            uint32_t buffer = d->fill[tail & d->mask];
+            __atomic_store_n(&d->fill_tail, tail + 1, __ATOMIC_RELEASE);
+
+            // "DMA": escribir directamente en el buffer que entregó el driver
+            uint8_t *data = d->pool + (size_t)buffer * d->buffer_size;
+            device_desc_t desc;
+            desc.buffer = buffer;
+            desc.len = (uint32_t)d->model->produce(data, d->buffer_size, seq, &rng);
+            desc.seq = seq++;
+            desc.timestamp_ns = now;
+
+            uint32_t head = d->comp_head;
+            d->comp[head & d->mask] = desc;
+            __atomic_store_n(&d->comp_head, head + 1, __ATOMIC_RELEASE);
+            produced++;
+            emitted++;
+        }
+        STAT_ADD(d->produced, produced);
+
+        // Línea por nivel: se vuelve a disparar si la anterior no se atendió
+        int work = __atomic_load_n(&d->comp_head, __ATOMIC_ACQUIRE) !=
+                   __atomic_load_n(&d->comp_tail, __ATOMIC_ACQUIRE);
+        if (work) {
+            int expected = 0;
+            if (__atomic_compare_exchange_n(&d->irq_pending, &expected, 1, 0,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE) ||
+                now - raised_ns > DEVICE_REASSERT_NS) {
+                raised_ns = now;
+                STAT_ADD(d->interrupts, 1);
+                dispatch_interrupt(d->irq);
+                continue;
+            }
+        }
+
+        if (rate > 0) {
+            // Dormir hasta el siguiente evento (como mucho 1 ms)
+            uint64_t next = epoch + (emitted + 1) * 1000000000ULL / rate;
+            now = now_ns();
+            if (next > now) {
+                uint64_t wait = next - now;
+                usleep((useconds_t)((wait > 1000000ULL ? 1000000ULL : wait) / 1000));
+            }
+        } else if (produced == 0) {
+            usleep(50);  // Sin buffers: esperar a que la ISR los devuelva
+        }
+    }
+    return NULL;
+}
+
+int irq_device_create(const char *model_name, int irq, unsigned long rate, int depth) {
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    char description[MAX_DESCRIPTION_LEN];
+    const irq_device_model_t *model = irq_device_find_model(model_name);
+
+    if (model == NULL || depth < 2 || depth > IRQ_DEVICE_MAX_DEPTH || (depth & (depth - 1)) != 0) {
+        return ERROR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&device_mutex);
+    if (irq < 0) {
+        for (int i = 2; i < MAX_INTERRUPTS; i++) {
+            if (is_irq_available(i)) {
+                irq = i;
+                break;
+            }
+        }
+    }
+    if (validate_irq_num(irq) != SUCCESS || !is_irq_available(irq)) {
+        pthread_mutex_unlock(&device_mutex);
+        return ERROR_INVALID_IRQ;
+    }
+    int id = -1;
+    for (int i = 0; i < IRQ_DEVICE_MAX; i++) {
+        if (!devices[i].active) {
+            id = i;
+            break;
+        }
+    }
+    if (id < 0) {
+        pthread_mutex_unlock(&device_mutex);
+        return ERROR_INVALID_ARG;
+    }
+
+    device_t *d = &devices[id];
+    memset(d, 0, sizeof(*d));
+    d->irq = irq;
+    d->model = model;
+    d->rate = rate;
+    d->depth = depth;
+    d->mask = (uint32_t)depth - 1;
+    d->buffer_size = model->buffer_size;
+    d->fill = calloc((size_t)depth, sizeof(uint32_t));
+    d->comp = calloc((size_t)depth, sizeof(device_desc_t));
+    if (posix_memalign((void **)&d->pool, 64, (size_t)depth * d->buffer_size) != 0) {
+        d->pool = NULL;
+    }
+    if (d->fill == NULL || d->comp == NULL || d->pool == NULL) {
+        free(d->fill);
+        free(d->comp);
+        free(d->pool);
+        pthread_mutex_unlock(&device_mutex);
+        return ERROR_INVALID_ARG;
+    }
+
+    // Al arrancar el driver entrega todos los buffers al dispositivo
+    for (int i = 0; i < depth; i++) {
+        d->fill[i] = (uint32_t)i;
+    }
+    d->fill_head = (uint32_t)depth;
+
+    snprintf(description, sizeof(description), "Dispositivo %s%d", model->name, id);
+    register_isr(irq, device_isr, description);
+    irq_owner[irq] = id + 1;
+    d->active = 1;
+    d->running = 1;
+    d->start_ns = now_ns();
+    if (pthread_create(&d->thread, NULL, device_thread_func, d) != 0) {
+        irq_owner[irq] = 0;
+        d->active = 0;
+        pthread_mutex_unlock(&device_mutex);
+        unregister_isr(irq);
+        free(d->fill);
+        free(d->comp);
+        free(d->pool);
+        return ERROR_INVALID_ARG;
+    }
+    pthread_mutex_unlock(&device_mutex);
+
+    snprintf(trace_msg, sizeof(trace_msg),
+        "💽 DEVICE: %s%d en IRQ %d (%lu eventos/s, anillos de %d, pool de %d × %zu bytes)",
+        model->name, id, irq, rate, depth, depth, d->buffer_size);
+    add_trace(trace_msg);
+    return id;
+}
+
+int irq_device_destroy(int dev) {
+    pthread_mutex_lock(&device_mutex);
+    if (dev < 0 || dev >= IRQ_DEVICE_MAX || !devices[dev].active) {
+        pthread_mutex_unlock(&device_mutex);
+        return ERROR_INVALID_ARG;
+    }
+    device_t *d = &devices[dev];
+    d->active = 0;
+    pthread_mutex_unlock(&device_mutex);
+
+    __atomic_store_n(&d->running, 0, __ATOMIC_RELEASE);
+    pthread_join(d->thread, NULL);
+
+    // Esperar a que termine cualquier ISR en curso antes de liberar el pool
+    while (unregister_isr(d->irq) == ERROR_ISR_EXECUTING) {
+        usleep(1000);
+    }
+    irq_owner[d->irq] = 0;
+    while (__atomic_load_n(&d->in_isr, __ATOMIC_ACQUIRE)) {
+        usleep(1000);
+    }
+    free(d->fill);
+    free(d->comp);
+    free(d->pool);
+    d->fill = NULL;
+    d->comp = NULL;
+    d->pool = NULL;
+    return SUCCESS;
+}
+
+int irq_device_set_rate(int dev, unsigned long rate) {
+    if (dev < 0 || dev >= IRQ_DEVICE_MAX || !devices[dev].active) {
+        return ERROR_INVALID_ARG;
+    }
+    __atomic_store_n(&devices[dev].rate, rate, __ATOMIC_RELAXED);
+    return SUCCESS;
+}
+
+int irq_device_get_stats(int dev, irq_device_stats_t *out) {
+    pthread_mutex_lock(&device_mutex);
+    if (dev < 0 || dev >= IRQ_DEVICE_MAX || !devices[dev].active) {
+        pthread_mutex_unlock(&device_mutex);
+        return ERROR_INVALID_ARG;
+    }
+    device_t *d = &devices[dev];
+    memset(out, 0, sizeof(*out));
+    out->active = 1;
+    out->irq = d->irq;
+    out->model = d->model->name;
+    out->rate = __atomic_load_n(&d->rate, __ATOMIC_RELAXED);
+    out->depth = d->depth;
+    out->buffer_size = d->buffer_size;
+    out->produced = STAT_GET(d->produced);
+    out->consumed = STAT_GET(d->consumed);
+    out->bytes = STAT_GET(d->bytes);
+    out->no_buffer = STAT_GET(d->no_buffer);
+    out->invalid = STAT_GET(d->invalid);
+    out->interrupts = STAT_GET(d->interrupts);
+    out->isr_runs = STAT_GET(d->isr_runs);
+    out->max_batch = STAT_GET(d->max_batch);
+    out->latency_total_ns = STAT_GET(d->latency_total_ns);
+    out->latency_max_ns = STAT_GET(d->latency_max_ns);
+    out->elapsed_s = (now_ns() - d->start_ns) / 1e9;
+    out->events_per_s = out->elapsed_s > 0 ? out->consumed / out->elapsed_s : 0.0;
+    pthread_mutex_unlock(&device_mutex);
+    return SUCCESS;
+}
+
+void irq_device_shutdown(void) {
+    for (int i = 0; i < IRQ_DEVICE_MAX; i++) {
+        if (devices[i].active) {
+            irq_device_destroy(i);
+        }
+    }
+}
+
+void show_irq_devices(void) {
+    printf("\n=== MODELOS DE DISPOSITIVO ===\n");
+    printf("Modelos:");
+    for (size_t i = 0; i < sizeof(device_models) / sizeof(device_models[0]); i++) {
+        printf(" %s (%s)%s", device_models[i].name, device_models[i].description,
+               i + 1 < sizeof(device_models) / sizeof(device_models[0]) ? "," : "");
+    }
+    printf("\n\n");
+
+    int shown = 0;
+    for (int i = 0; i < IRQ_DEVICE_MAX; i++) {
+        irq_device_stats_t st;
+        if (irq_device_get_stats(i, &st) != SUCCESS) {
+            continue;
+        }
+        shown = 1;
+        printf("[%d] %s en IRQ %d │ %lu eventos/s objetivo │ anillos de %d │ buffers de %zu bytes\n",
+               i, st.model, st.irq, st.rate, st.depth, st.buffer_size);
+        printf("    Producidos: %lu │ Consumidos: %lu │ %.0f eventos/s │ %.1f MB/s\n",
+               st.produced, st.consumed, st.events_per_s,
+               st.elapsed_s > 0 ? st.bytes / st.elapsed_s / 1e6 : 0.0);
+        printf("    Interrupciones: %lu │ ISRs: %lu │ Lote máx.: %lu │ Sin buffer: %lu │ Inválidos: %lu\n",
+               st.interrupts, st.isr_runs, st.max_batch, st.no_buffer, st.invalid);
+        printf("    Latencia dispositivo→ISR: %.1f μs prom. / %.1f μs máx.\n\n",
+               st.consumed > 0 ? st.latency_total_ns / 1000.0 / st.consumed : 0.0,
+               st.latency_max_ns / 1000.0);
+    }
+    if (!shown) {
+        printf("No hay dispositivos activos.\n\n");
+    }
+}
+
+void irq_device_submenu(void) {
+    int option, dev;
+
+    while (1) {
+        printf("\n=== MODELOS DE DISPOSITIVO ===\n");
+        printf("1. Mostrar dispositivos y rendimiento\n");
+        printf("2. Crear dispositivo\n");
+        printf("3. Cambiar tasa de eventos\n");
+        printf("4. Eliminar dispositivo\n");
+        printf("0. Volver\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+
+        option = get_valid_input(0, 4);
+        switch (option) {
+            case 0:
+                return;
+            case 1:
+                show_irq_devices();
+                break;
+            case 2: {
+                printf("Modelo (0 = nic, 1 = block, 2 = serial): ");
+                fflush(stdout);
+                int model = get_valid_input(0, 2);
+                printf("Eventos por segundo (0 = sin límite, máx. 10000000): ");
+                fflush(stdout);
+                int rate = get_valid_input(0, 10000000);
+                printf("Profundidad de los anillos (2-%d, potencia de 2): ", IRQ_DEVICE_MAX_DEPTH);
+                fflush(stdout);
+                int depth = get_valid_input(2, IRQ_DEVICE_MAX_DEPTH);
+                dev = irq_device_create(device_models[model].name, -1, (unsigned long)rate, depth);
+                if (dev >= 0) {
+                    printf("✓ Dispositivo %d creado.\n", dev);
+                } else {
+                    printf("✗ No se pudo crear (¿profundidad potencia de 2? ¿vectores libres?).\n");
+                }
+                break;
+            }
+            case 3:
+                printf("Id del dispositivo (0-%d): ", IRQ_DEVICE_MAX - 1);
+                fflush(stdout);
+                dev = get_valid_input(0, IRQ_DEVICE_MAX - 1);
+                printf("Eventos por segundo (0 = sin límite): ");
+                fflush(stdout);
+                if (irq_device_set_rate(dev, (unsigned long)get_valid_input(0, 10000000)) == SUCCESS) {
+                    printf("✓ Tasa actualizada.\n");
+                } else {
+                    printf("✗ Dispositivo inexistente.\n");
+                }
+                break;
+            case 4:
+                printf("Id del dispositivo (0-%d): ", IRQ_DEVICE_MAX - 1);
+                fflush(stdout);
+                dev = get_valid_input(0, IRQ_DEVICE_MAX - 1);
+                if (irq_device_destroy(dev) == SUCCESS) {
+                    printf("✓ Dispositivo eliminado.\n");
+                } else {
+                    printf("✗ Dispositivo inexistente.\n");
+                }
+                break;
+        }
+    }
+}
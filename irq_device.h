@@ -0,0 +1,68 @@
+#ifndef IRQ_DEVICE_H
+#define IRQ_DEVICE_H
+
+#include <stdint.h>
+#include "interrupt_simulator.h"
+
+// Modelos de dispositivo que generan interrupciones a partir de trabajo real
+//
+// Cada dispositivo tiene un hilo que hace de hardware y dos anillos de
+// descriptores de un productor y un consumidor, como en una NIC con DMA:
+//   - anillo de llenado: el driver (la ISR) entrega buffers libres al
+//     dispositivo;
+//   - anillo de completado: el dispositivo escribe los datos en uno de esos
+//     buffers y publica un descriptor con su índice y longitud.
+// Los buffers salen de un pool preasignado de tamaño fijo y la ISR los
+// consume por referencia, sin copiarlos, antes de devolverlos al anillo de
+// llenado. El dispositivo sólo dispara el vector cuando no hay otra
+// interrupción pendiente; la ISR vacía el anillo entero en cada ejecución.
+
+#define IRQ_DEVICE_MAX 4
+#define IRQ_DEVICE_MAX_DEPTH 4096           // Potencia de 2
+#define IRQ_DEVICE_DEFAULT_DEPTH 256
+
+// Modelo de dispositivo: produce datos en un buffer del pool y los valida
+typedef struct {
+    const char *name;
+    const char *description;
+    size_t buffer_size;
+    // Escribe un evento en buf y devuelve su longitud
+    size_t (*produce)(uint8_t *buf, size_t capacity, uint64_t seq, uint32_t *rng);
+    // Procesa el evento por referencia; devuelve 0 si los datos son válidos
+    int (*consume)(const uint8_t *buf, size_t len, uint64_t seq);
+} irq_device_model_t;
+
+typedef struct {
+    int active;
+    int irq;
+    const char *model;
+    unsigned long rate;                     // Eventos/s (0 = tan rápido como se pueda)
+    int depth;
+    size_t buffer_size;
+    unsigned long produced;
+    unsigned long consumed;
+    unsigned long bytes;
+    unsigned long no_buffer;                // Sin buffers libres: evento perdido
+    unsigned long invalid;                  // Datos o secuencia incorrectos
+    unsigned long interrupts;               // Vectores disparados
+    unsigned long isr_runs;
+    unsigned long max_batch;
+    unsigned long latency_total_ns;         // Productor -> ISR
+    unsigned long latency_max_ns;
+    double elapsed_s;
+    double events_per_s;
+} irq_device_stats_t;
+
+const irq_device_model_t *irq_device_find_model(const char *name);
+
+// Devuelve el id del dispositivo o un código de error (irq = -1: primer libre)
+int irq_device_create(const char *model, int irq, unsigned long rate, int depth);
+int irq_device_destroy(int dev);
+int irq_device_set_rate(int dev, unsigned long rate);
+int irq_device_get_stats(int dev, irq_device_stats_t *out);
+void irq_device_shutdown(void);
+
+void show_irq_devices(void);
+void irq_device_submenu(void);
+
+#endif // IRQ_DEVICE_H
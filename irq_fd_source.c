@@ -0,0 +1,521 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <sys/socket.h>
+#include "irq_fd_source.h"
+#include "irq_replay.h"
+
+// Marca del eventfd interno usado para despertar al controlador al detenerlo
+#define FD_CONTROLLER_STOP_TAG 0xffffffffu
+
+// Disparo pendiente dentro de un lote de epoll
+typedef struct {
+    int irq_num;
+    unsigned long count;
+} pending_raise_t;
+
+static fd_source_info_t sources[MAX_INTERRUPTS];
+static pthread_mutex_t sources_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_t controller_thread;
+static int epoll_fd = -1;
+static int stop_fd = -1;
+static int controller_running = 0;
+
+const char *fd_source_kind_string(fd_source_kind_t kind) {
+    switch (kind) {
+        case FD_SOURCE_EVENTFD: return "eventfd";
+        case FD_SOURCE_TIMERFD: return "timerfd";
+        case FD_SOURCE_STREAM:  return "socket/pipe";
+        default:                return "ninguna";
+    }
+}
+
+static long elapsed_us(const struct timespec *from, const struct timespec *to) {
+    return (to->tv_sec - from->tv_sec) * 1000000L + (to->tv_nsec - from->tv_nsec) / 1000;
+}
+
+// Consumir la disponibilidad de una fuente y calcular cuántos IRQs genera.
+// *closed = 1 si el otro extremo de un flujo cerró (EOF) o el fd dio error
+static unsigned long consume_source(fd_source_info_t *src, int *closed) {
+    uint64_t counter = 0;
+    unsigned long raises = 0;
+
+    switch (src->kind) {
+        case FD_SOURCE_EVENTFD:
+        case FD_SOURCE_TIMERFD:
+            if (read(src->fd, &counter, sizeof(counter)) == (ssize_t)sizeof(counter)) {
+                raises = (unsigned long)counter;
+            }
+            break;
+
+        case FD_SOURCE_STREAM: {
+            char buffer[FD_SOURCE_READ_CHUNK];
+            ssize_t n = read(src->fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                src->bytes += (unsigned long)n;
+                raises = 1;
+            } else if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+                *closed = 1;
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    if (raises > FD_SOURCE_MAX_RAISES) {
+        src->coalesced += raises - FD_SOURCE_MAX_RAISES;
+        raises = FD_SOURCE_MAX_RAISES;
+    }
+    return raises;
+}
+
+// Hilo controlador de interrupciones: epoll -> lote -> dispatch_interrupt()
+static void *fd_controller_func(void *arg) {
+    (void)arg;
+    irq_replay_set_source(IRQ_REPLAY_SRC_FD);
+    struct epoll_event events[FD_SOURCE_MAX_EVENTS];
+    pending_raise_t pending[FD_SOURCE_MAX_EVENTS];
+    int closed_irqs[FD_SOURCE_MAX_EVENTS];
+
+    add_trace_silent("🔌 HARDWARE: Controlador epoll de fuentes reales iniciado");
+
+    while (__atomic_load_n(&controller_running, __ATOMIC_ACQUIRE)) {
+        int ready = epoll_wait(epoll_fd, events, FD_SOURCE_MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+
+        struct timespec wake_time;
+        clock_gettime(CLOCK_MONOTONIC, &wake_time);
+
+        // Fase 1: drenar todos los fds listos
+        int num_pending = 0;
+        int num_closed = 0;
+        pthread_mutex_lock(&sources_mutex);
+        for (int i = 0; i < ready; i++) {
+            uint32_t tag = (uint32_t)events[i].data.u32;
+            if (tag == FD_CONTROLLER_STOP_TAG || !IS_VALID_IRQ((int)tag)) {
+                continue;
+            }
+            fd_source_info_t *src = &sources[tag];
+            if (src->kind == FD_SOURCE_NONE) {
+                continue;
+            }
+            src->wakeups++;
+            // Con HUP y datos pendientes se drenan primero; el EOF llega en la
+            // siguiente vuelta. Un fd cerrado sigue listo para siempre en epoll
+            int closed = (events[i].events & EPOLLERR) ||
+                         ((events[i].events & EPOLLHUP) && !(events[i].events & EPOLLIN));
+            unsigned long count = closed ? 0 : consume_source(src, &closed);
+            if (count > 0) {
+                pending[num_pending].irq_num = (int)tag;
+                pending[num_pending].count = count;
+                num_pending++;
+            }
+            if (closed) {
+                closed_irqs[num_closed++] = (int)tag;
+            }
+        }
+        pthread_mutex_unlock(&sources_mutex);
+
+        for (int i = 0; i < num_closed; i++) {
+            char trace_msg[MAX_TRACE_MSG_LEN];
+            snprintf(trace_msg, sizeof(trace_msg),
+                "🔌 HARDWARE: El otro extremo de la fuente del IRQ %d cerró", closed_irqs[i]);
+            add_trace_with_irq(trace_msg, closed_irqs[i]);
+            fd_source_detach(closed_irqs[i]);
+        }
+
+        // Fase 2: disparar los IRQs fuera del lock de las fuentes
+        for (int i = 0; i < num_pending; i++) {
+            unsigned long lat_sum = 0;
+            unsigned long lat_max = 0;
+            unsigned long lat_samples = 0;
+
+            for (unsigned long r = 0; r < pending[i].count; r++) {
+                struct timespec before, isr_entry;
+                get_last_isr_entry_time(&before);
+                dispatch_interrupt(pending[i].irq_num);
+
+                // Sólo cuentan los disparos que entraron en la ISR: los rechazados
+                // (enmascarado, en ejecución, sin ISR) o diferidos no la marcan
+                get_last_isr_entry_time(&isr_entry);
+                if (isr_entry.tv_sec == before.tv_sec && isr_entry.tv_nsec == before.tv_nsec) {
+                    continue;
+                }
+                long lat = elapsed_us(&wake_time, &isr_entry);
+                if (lat >= 0) {
+                    lat_samples++;
+                    lat_sum += (unsigned long)lat;
+                    if ((unsigned long)lat > lat_max) {
+                        lat_max = (unsigned long)lat;
+                    }
+                }
+            }
+
+            pthread_mutex_lock(&sources_mutex);
+            fd_source_info_t *src = &sources[pending[i].irq_num];
+            src->raises += pending[i].count;
+            src->latency_samples += lat_samples;
+            src->latency_total_us += lat_sum;
+            if (lat_max > src->latency_max_us) {
+                src->latency_max_us = lat_max;
+            }
+            pthread_mutex_unlock(&sources_mutex);
+        }
+    }
+
+    add_trace_silent("🛑 HARDWARE: Controlador epoll de fuentes reales detenido");
+    return NULL;
+}
+
+// Arrancar el hilo controlador (idempotente)
+int fd_controller_start(void) {
+    if (__atomic_load_n(&controller_running, __ATOMIC_ACQUIRE)) {
+        return SUCCESS;
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    stop_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (epoll_fd < 0 || stop_fd < 0) {
+        if (epoll_fd >= 0) close(epoll_fd);
+        if (stop_fd >= 0) close(stop_fd);
+        epoll_fd = stop_fd = -1;
+        add_trace("❌ KERNEL: No se pudo crear el controlador epoll");
+        return ERROR_FD_SOURCE;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = FD_CONTROLLER_STOP_TAG;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, stop_fd, &ev);
+
+    __atomic_store_n(&controller_running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&controller_thread, NULL, fd_controller_func, NULL) != 0) {
+        __atomic_store_n(&controller_running, 0, __ATOMIC_RELEASE);
+        close(epoll_fd);
+        close(stop_fd);
+        epoll_fd = stop_fd = -1;
+        add_trace("❌ KERNEL: Error creando hilo del controlador epoll");
+        return ERROR_FD_SOURCE;
+    }
+    return SUCCESS;
+}
+
+// Detener el controlador y desconectar todas las fuentes
+void fd_controller_stop(void) {
+    if (!__atomic_load_n(&controller_running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
+    __atomic_store_n(&controller_running, 0, __ATOMIC_RELEASE);
+    uint64_t one = 1;
+    if (write(stop_fd, &one, sizeof(one)) < 0) {
+        // El hilo despertará igualmente en el próximo evento
+    }
+    pthread_join(controller_thread, NULL);
+
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        fd_source_detach(i);
+    }
+    close(epoll_fd);
+    close(stop_fd);
+    epoll_fd = stop_fd = -1;
+}
+
+int fd_controller_is_running(void) {
+    return __atomic_load_n(&controller_running, __ATOMIC_ACQUIRE);
+}
+
+// Conectar un fd a un vector de la IDT
+int fd_source_attach(int irq_num, int fd, fd_source_kind_t kind, int owned, const char *name) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+    if (fd < 0 || kind == FD_SOURCE_NONE) {
+        return ERROR_FD_SOURCE;
+    }
+    if (fd_controller_start() != SUCCESS) {
+        return ERROR_FD_SOURCE;
+    }
+
+    pthread_mutex_lock(&sources_mutex);
+    if (sources[irq_num].kind != FD_SOURCE_NONE) {
+        pthread_mutex_unlock(&sources_mutex);
+        add_trace("⚠️  KERNEL: El IRQ ya tiene una fuente de hardware conectada");
+        return ERROR_FD_SOURCE;
+    }
+
+    // Lecturas no bloqueantes: el controlador nunca debe quedarse dormido en read()
+    int flags = fcntl(fd, F_GETFL);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = (uint32_t)irq_num;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        pthread_mutex_unlock(&sources_mutex);
+        add_trace("❌ KERNEL: epoll_ctl rechazó el descriptor de la fuente");
+        return ERROR_FD_SOURCE;
+    }
+
+    fd_source_info_t *src = &sources[irq_num];
+    memset(src, 0, sizeof(*src));
+    src->kind = kind;
+    src->fd = fd;
+    src->owned = owned;
+    src->peer_fd = -1;
+    snprintf(src->name, sizeof(src->name), "%s", name != NULL ? name : fd_source_kind_string(kind));
+    pthread_mutex_unlock(&sources_mutex);
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg),
+        "🔌 HARDWARE: IRQ %d conectada a fd %d (%s) - Disparo por epoll",
+        irq_num, fd, fd_source_kind_string(kind));
+    add_trace_with_irq(trace_msg, irq_num);
+    return SUCCESS;
+}
+
+// Desconectar la fuente de un vector
+int fd_source_detach(int irq_num) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+
+    pthread_mutex_lock(&sources_mutex);
+    fd_source_info_t *src = &sources[irq_num];
+    if (src->kind == FD_SOURCE_NONE) {
+        pthread_mutex_unlock(&sources_mutex);
+        return ERROR_FD_SOURCE;
+    }
+
+    if (epoll_fd >= 0) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, src->fd, NULL);
+    }
+    if (src->owned) {
+        close(src->fd);
+    }
+    if (src->peer_fd >= 0) {
+        close(src->peer_fd);
+    }
+    src->kind = FD_SOURCE_NONE;
+    src->fd = -1;
+    src->peer_fd = -1;
+    pthread_mutex_unlock(&sources_mutex);
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg),
+        "🔌 HARDWARE: Fuente real desconectada del IRQ %d", irq_num);
+    add_trace_with_irq(trace_msg, irq_num);
+    return SUCCESS;
+}
+
+// eventfd: pokes externos (cualquier hilo o proceso con el fd)
+int fd_source_create_eventfd(int irq_num) {
+    int fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (fd < 0) {
+        return ERROR_FD_SOURCE;
+    }
+    int result = fd_source_attach(irq_num, fd, FD_SOURCE_EVENTFD, 1, "eventfd");
+    if (result != SUCCESS) {
+        close(fd);
+    }
+    return result;
+}
+
+// timerfd: timer periódico de alta frecuencia
+int fd_source_create_timerfd(int irq_num, long period_us) {
+    if (period_us <= 0) {
+        return ERROR_FD_SOURCE;
+    }
+
+    int fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK);
+    if (fd < 0) {
+        return ERROR_FD_SOURCE;
+    }
+
+    struct itimerspec spec;
+    spec.it_interval.tv_sec = period_us / 1000000;
+    spec.it_interval.tv_nsec = (period_us % 1000000) * 1000;
+    spec.it_value = spec.it_interval;
+
+    int result = fd_source_attach(irq_num, fd, FD_SOURCE_TIMERFD, 1, "timerfd");
+    if (result != SUCCESS) {
+        close(fd);
+        return result;
+    }
+    if (timerfd_settime(fd, 0, &spec, NULL) != 0) {
+        fd_source_detach(irq_num);
+        return ERROR_FD_SOURCE;
+    }
+    return SUCCESS;
+}
+
+// Par de sockets Unix: el extremo peer simula el tráfico de una NIC
+int fd_source_create_socketpair(int irq_num) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0, fds) != 0) {
+        return ERROR_FD_SOURCE;
+    }
+
+    int result = fd_source_attach(irq_num, fds[0], FD_SOURCE_STREAM, 1, "socket unix");
+    if (result != SUCCESS) {
+        close(fds[0]);
+        close(fds[1]);
+        return result;
+    }
+
+    pthread_mutex_lock(&sources_mutex);
+    sources[irq_num].peer_fd = fds[1];
+    pthread_mutex_unlock(&sources_mutex);
+    return SUCCESS;
+}
+
+// Generar actividad en la fuente desde el propio simulador
+int fd_source_poke(int irq_num, unsigned long count) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+
+    // Escribir fuera del lock: el controlador necesita tomarlo para drenar
+    pthread_mutex_lock(&sources_mutex);
+    fd_source_kind_t kind = sources[irq_num].kind;
+    int fd = sources[irq_num].fd;
+    int peer_fd = sources[irq_num].peer_fd;
+    pthread_mutex_unlock(&sources_mutex);
+
+    if (kind == FD_SOURCE_EVENTFD) {
+        uint64_t value = count;
+        if (write(fd, &value, sizeof(value)) != (ssize_t)sizeof(value)) {
+            return ERROR_FD_SOURCE;
+        }
+        return SUCCESS;
+    }
+
+    if (kind == FD_SOURCE_STREAM && peer_fd >= 0) {
+        // Cada datagrama es un "paquete" que produce una lectura independiente
+        char packet[64];
+        memset(packet, 0xab, sizeof(packet));
+        for (unsigned long i = 0; i < count; i++) {
+            if (write(peer_fd, packet, sizeof(packet)) < 0) {
+                return ERROR_FD_SOURCE;
+            }
+        }
+        return SUCCESS;
+    }
+
+    return ERROR_FD_SOURCE;
+}
+
+int fd_source_get_info(int irq_num, fd_source_info_t *out) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+    pthread_mutex_lock(&sources_mutex);
+    *out = sources[irq_num];
+    pthread_mutex_unlock(&sources_mutex);
+    return out->kind == FD_SOURCE_NONE ? ERROR_FD_SOURCE : SUCCESS;
+}
+
+// Tabla de fuentes conectadas con su latencia epoll -> ISR
+void show_fd_sources(void) {
+    fd_source_info_t snapshot[MAX_INTERRUPTS];
+    pthread_mutex_lock(&sources_mutex);
+    memcpy(snapshot, sources, sizeof(snapshot));
+    pthread_mutex_unlock(&sources_mutex);
+
+    printf("\n=== FUENTES DE HARDWARE REALES (epoll) ===\n");
+    printf("Controlador: %s\n\n", fd_controller_is_running() ? "ACTIVO" : "DETENIDO");
+    printf("IRQ │ Tipo         │ fd  │ Eventos  │ IRQs     │ Bytes      │ Lat. prom μs │ Lat. máx μs\n");
+
+    int shown = 0;
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        if (snapshot[i].kind == FD_SOURCE_NONE) {
+            continue;
+        }
+        double avg = snapshot[i].latency_samples > 0 ?
+            (double)snapshot[i].latency_total_us / snapshot[i].latency_samples : 0.0;
+        printf("%3d │ %-12s │ %3d │ %8lu │ %8lu │ %10lu │ %12.1f │ %lu\n",
+               i, snapshot[i].name, snapshot[i].fd, snapshot[i].wakeups,
+               snapshot[i].raises, snapshot[i].bytes, avg, snapshot[i].latency_max_us);
+        if (snapshot[i].coalesced > 0) {
+            printf("    └─ %lu eventos recortados por el tope de %d IRQs por evento\n",
+                   snapshot[i].coalesced, FD_SOURCE_MAX_RAISES);
+        }
+        shown++;
+    }
+    if (shown == 0) {
+        printf("(ninguna fuente conectada)\n");
+    }
+    printf("\n");
+}
+
+// Submenú para conectar fuentes desde la interfaz interactiva
+void fd_sources_submenu(void) {
+    int option, irq_num;
+
+    while (1) {
+        printf("\n=== FUENTES DE HARDWARE REALES (epoll) ===\n");
+        printf("1. Mostrar fuentes conectadas\n");
+        printf("2. Conectar eventfd a un IRQ\n");
+        printf("3. Conectar timerfd periódico a un IRQ\n");
+        printf("4. Conectar socket Unix (tráfico tipo NIC) a un IRQ\n");
+        printf("5. Generar eventos en una fuente (poke / paquetes)\n");
+        printf("6. Desconectar fuente de un IRQ\n");
+        printf("0. Volver\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+
+        option = get_valid_input(0, 6);
+        if (option == 0) {
+            return;
+        }
+        if (option == 1) {
+            show_fd_sources();
+            continue;
+        }
+
+        printf("Ingrese el número de IRQ (0-%d): ", MAX_INTERRUPTS - 1);
+        fflush(stdout);
+        irq_num = get_valid_input(0, MAX_INTERRUPTS - 1);
+
+        int result = SUCCESS;
+        switch (option) {
+            case 2:
+                result = fd_source_create_eventfd(irq_num);
+                break;
+            case 3:
+                printf("Periodo en microsegundos (100-10000000): ");
+                fflush(stdout);
+                result = fd_source_create_timerfd(irq_num, get_valid_input(100, 10000000));
+                break;
+            case 4:
+                result = fd_source_create_socketpair(irq_num);
+                break;
+            case 5:
+                printf("Cantidad de eventos (1-100000): ");
+                fflush(stdout);
+                result = fd_source_poke(irq_num, (unsigned long)get_valid_input(1, 100000));
+                break;
+            case 6:
+                result = fd_source_detach(irq_num);
+                break;
+        }
+        if (result == SUCCESS) {
+            printf("✓ Operación completada para IRQ %d.\n", irq_num);
+        } else {
+            printf("✗ Operación fallida para IRQ %d.\n", irq_num);
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#ifndef IRQ_FD_SOURCE_H
+#define IRQ_FD_SOURCE_H
+
+#include "interrupt_simulator.h"
+
+// Capa de "hardware real": vectores de la IDT conectados a descriptores de Linux
+//
+// Un único hilo controlador (epoll) espera la disponibilidad de todos los fds
+// registrados, agrupa los eventos listos y dispara el IRQ asociado a cada uno.
+// Así la simulación recibe tasas de eventos reales (eventfd, timerfd, pipes,
+// sockets) y se puede medir la latencia epoll -> ISR.
+
+#define FD_SOURCE_MAX_EVENTS 64          // Eventos procesados por epoll_wait
+#define FD_SOURCE_MAX_RAISES 1024        // Tope de IRQs por evento (contadores)
+#define FD_SOURCE_READ_CHUNK 4096        // Bytes leídos por evento en pipes/sockets
+
+// Tipo de fuente: determina cómo se consume la disponibilidad
+typedef enum {
+    FD_SOURCE_NONE,
+    FD_SOURCE_EVENTFD,      // Contador: un IRQ por cada poke acumulado
+    FD_SOURCE_TIMERFD,      // Expiraciones: un IRQ por expiración
+    FD_SOURCE_STREAM        // Pipe/socket: un IRQ por lectura, como una NIC
+} fd_source_kind_t;
+
+// Estadísticas por fuente
+typedef struct {
+    fd_source_kind_t kind;
+    int fd;
+    int owned;                          // El controlador cierra el fd al desconectar
+    int peer_fd;                        // Extremo de escritura (sockets/pipes creados aquí)
+    unsigned long wakeups;              // Eventos entregados por epoll
+    unsigned long raises;               // IRQs disparados
+    unsigned long bytes;                // Bytes consumidos (fuentes de flujo)
+    unsigned long coalesced;            // Eventos recortados por FD_SOURCE_MAX_RAISES
+    unsigned long latency_samples;      // IRQs que llegaron a entrar en la ISR
+    unsigned long latency_total_us;     // Suma de latencias epoll -> entrada a la ISR
+    unsigned long latency_max_us;
+    char name[32];
+} fd_source_info_t;
+
+// Ciclo de vida del controlador
+int fd_controller_start(void);
+void fd_controller_stop(void);
+int fd_controller_is_running(void);
+
+// Conectar un fd arbitrario a un IRQ (owned = cerrar al desconectar)
+int fd_source_attach(int irq_num, int fd, fd_source_kind_t kind, int owned, const char *name);
+int fd_source_detach(int irq_num);
+
+// Fuentes de ejemplo creadas por el controlador
+int fd_source_create_eventfd(int irq_num);
+int fd_source_create_timerfd(int irq_num, long period_us);
+int fd_source_create_socketpair(int irq_num);
+
+// Escribir en la fuente (poke al eventfd o tráfico al socket)
+int fd_source_poke(int irq_num, unsigned long count);
+
+// Consulta y visualización
+int fd_source_get_info(int irq_num, fd_source_info_t *out);
+const char *fd_source_kind_string(fd_source_kind_t kind);
+void show_fd_sources(void);
+void fd_sources_submenu(void);
+
+#endif // IRQ_FD_SOURCE_H
@@ -0,0 +1,251 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <signal.h>
+#include <stddef.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "interrupt_simulator.h"
+#include "irq_inject.h"
+#include "irq_replay.h"
+#include "irq_rt.h"
+
+// Espera del poller cuando el anillo está vacío (backoff exponencial)
+#define INJECT_IDLE_SPINS 64
+#define INJECT_MIN_SLEEP_NS 20000       // 20 μs
+#define INJECT_MAX_SLEEP_NS 1000000     // 1 ms
+
+static irq_inject_ring_t *inject_ring = NULL;
+static char inject_name[64] = IRQ_INJECT_DEFAULT_NAME;
+static pthread_t inject_thread;
+static int inject_running = 0;
+static pthread_mutex_t inject_stats_mutex = PTHREAD_MUTEX_INITIALIZER;
+static irq_inject_stats_t inject_stats;
+
+// Payload del registro que se está despachando en este hilo
+static __thread uint64_t current_payload = 0;
+
+uint64_t irq_inject_current_payload(void) {
+    return current_payload;
+}
+
+int irq_inject_is_active(void) {
+    return inject_ring != NULL;
+}
+
+// Drenar hasta IRQ_INJECT_BATCH registros publicados. Devuelve cuántos copió.
+static int drain_batch(uint64_t *tail, irq_inject_record_t *batch) {
+    uint64_t mask = IRQ_INJECT_CAPACITY - 1;
+    uint64_t pos = *tail;
+    int count = 0;
+
+    while (count < IRQ_INJECT_BATCH) {
+        irq_inject_slot_t *slot = &inject_ring->slots[pos & mask];
+        uint64_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+        if (seq != pos + 1) {
+            break;  // Vacío o productor aún escribiendo
+        }
+        batch[count++] = slot->rec;
+        // Liberar la ranura para la siguiente vuelta antes de despachar
+        __atomic_store_n(&slot->seq, pos + IRQ_INJECT_CAPACITY, __ATOMIC_RELEASE);
+        pos++;
+    }
+
+    *tail = pos;
+    __atomic_store_n(&inject_ring->tail, pos, __ATOMIC_RELAXED);
+    return count;
+}
+
+// Hilo poller: drena el anillo en lotes y despacha cada registro
+static void *inject_poller_func(void *arg) {
+    (void)arg;
+    irq_rt_enter_thread();
+    irq_replay_set_source(IRQ_REPLAY_SRC_INJECT);
+    irq_inject_record_t batch[IRQ_INJECT_BATCH];
+    uint64_t tail = __atomic_load_n(&inject_ring->tail, __ATOMIC_RELAXED);
+    long sleep_ns = INJECT_MIN_SLEEP_NS;
+    int idle_spins = 0;
+
+    add_trace_silent("📥 HARDWARE: Poller del anillo de inyección iniciado");
+
+    while (__atomic_load_n(&inject_running, __ATOMIC_ACQUIRE)) {
+        int count = drain_batch(&tail, batch);
+
+        if (count == 0) {
+            // Sin trabajo: girar un poco y después dormir con backoff
+            if (++idle_spins < INJECT_IDLE_SPINS) {
+                continue;
+            }
+            struct timespec delay = {0, sleep_ns};
+            nanosleep(&delay, NULL);
+            if (sleep_ns < INJECT_MAX_SLEEP_NS) {
+                sleep_ns *= 2;
+            }
+            continue;
+        }
+        idle_spins = 0;
+        sleep_ns = INJECT_MIN_SLEEP_NS;
+
+        unsigned long dispatched = 0;
+        unsigned long invalid = 0;
+        unsigned long delay_sum = 0;
+        unsigned long delay_max = 0;
+
+        for (int i = 0; i < count; i++) {
+            if (!IS_VALID_IRQ(batch[i].irq)) {
+                invalid++;
+                continue;
+            }
+
+            uint64_t now = irq_inject_now_ns();
+            unsigned long delay_us = now > batch[i].timestamp_ns ?
+                (unsigned long)((now - batch[i].timestamp_ns) / 1000) : 0;
+            delay_sum += delay_us;
+            if (delay_us > delay_max) {
+                delay_max = delay_us;
+            }
+
+            current_payload = batch[i].payload;
+            dispatch_interrupt(batch[i].irq);
+            dispatched++;
+        }
+        current_payload = 0;
+
+        pthread_mutex_lock(&inject_stats_mutex);
+        inject_stats.consumed += count;
+        inject_stats.invalid += invalid;
+        inject_stats.batches++;
+        if ((unsigned long)count > inject_stats.max_batch) {
+            inject_stats.max_batch = count;
+        }
+        if (dispatched > 0) {
+            inject_stats.average_delay_us =
+                (inject_stats.average_delay_us * inject_stats.dispatched + delay_sum) /
+                (inject_stats.dispatched + dispatched);
+            inject_stats.dispatched += dispatched;
+        }
+        if (delay_max > inject_stats.max_delay_us) {
+            inject_stats.max_delay_us = delay_max;
+        }
+        pthread_mutex_unlock(&inject_stats_mutex);
+    }
+
+    add_trace_silent("🛑 HARDWARE: Poller del anillo de inyección detenido");
+    return NULL;
+}
+
+// ¿Consume ya el anillo otra instancia viva? Solo se lee la cabecera.
+static int ring_in_use(const char *name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return 0;
+    }
+
+    int in_use = 0;
+    size_t header = offsetof(irq_inject_ring_t, slots);
+    struct stat st;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= header) {
+        void *mem = mmap(NULL, header, PROT_READ, MAP_SHARED, fd, 0);
+        if (mem != MAP_FAILED) {
+            irq_inject_ring_t *ring = (irq_inject_ring_t *)mem;
+            pid_t owner = (pid_t)ring->consumer_pid;
+            in_use = __atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) == IRQ_INJECT_MAGIC &&
+                     owner > 0 && owner != getpid() &&
+                     (kill(owner, 0) == 0 || errno == EPERM);
+            munmap(mem, header);
+        }
+    }
+    close(fd);
+    return in_use;
+}
+
+// Crear el anillo compartido y arrancar el poller
+int irq_inject_init(const char *name) {
+    if (inject_ring != NULL) {
+        return SUCCESS;
+    }
+
+    if (name != NULL) {
+        strncpy(inject_name, name, sizeof(inject_name) - 1);
+        inject_name[sizeof(inject_name) - 1] = '\0';
+    }
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    if (ring_in_use(inject_name)) {
+        snprintf(trace_msg, sizeof(trace_msg),
+            "⚠️  KERNEL: %s ya lo usa otra instancia - Anillo de inyección desactivado", inject_name);
+        add_trace(trace_msg);
+        return ERROR_SHM;
+    }
+
+    // Segmento huérfano de una instancia que terminó sin limpiar
+    shm_unlink(inject_name);
+    int fd = shm_open(inject_name, O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        add_trace_silent("⚠️  KERNEL: No se pudo crear el anillo de inyección compartido");
+        return ERROR_SHM;
+    }
+
+    void *mem = MAP_FAILED;
+    if (ftruncate(fd, sizeof(irq_inject_ring_t)) == 0) {
+        mem = mmap(NULL, sizeof(irq_inject_ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mem == MAP_FAILED) {
+        shm_unlink(inject_name);
+        add_trace_silent("⚠️  KERNEL: No se pudo mapear el anillo de inyección compartido");
+        return ERROR_SHM;
+    }
+
+    irq_inject_ring_t *ring = (irq_inject_ring_t *)mem;
+    memset(ring, 0, sizeof(*ring));
+    ring->version = IRQ_INJECT_VERSION;
+    ring->capacity = IRQ_INJECT_CAPACITY;
+    ring->consumer_pid = (int32_t)getpid();
+    for (uint64_t i = 0; i < IRQ_INJECT_CAPACITY; i++) {
+        ring->slots[i].seq = i;
+    }
+    __atomic_store_n(&ring->magic, IRQ_INJECT_MAGIC, __ATOMIC_RELEASE);
+
+    memset(&inject_stats, 0, sizeof(inject_stats));
+    inject_ring = ring;
+    __atomic_store_n(&inject_running, 1, __ATOMIC_RELEASE);
+
+    if (pthread_create(&inject_thread, NULL, inject_poller_func, NULL) != 0) {
+        __atomic_store_n(&inject_running, 0, __ATOMIC_RELEASE);
+        inject_ring = NULL;
+        munmap(ring, sizeof(*ring));
+        shm_unlink(inject_name);
+        add_trace("❌ KERNEL: Error creando hilo poller de inyección");
+        return ERROR_SHM;
+    }
+
+    snprintf(trace_msg, sizeof(trace_msg),
+        "📥 KERNEL: Anillo de inyección %s listo (%d ranuras)", inject_name, IRQ_INJECT_CAPACITY);
+    add_trace_silent(trace_msg);
+    return SUCCESS;
+}
+
+// Detener el poller y eliminar el segmento
+void irq_inject_shutdown(void) {
+    if (inject_ring == NULL) {
+        return;
+    }
+
+    __atomic_store_n(&inject_running, 0, __ATOMIC_RELEASE);
+    pthread_join(inject_thread, NULL);
+
+    irq_inject_ring_t *ring = inject_ring;
+    inject_ring = NULL;
+    __atomic_store_n(&ring->magic, 0, __ATOMIC_RELEASE);
+    munmap(ring, sizeof(*ring));
+    shm_unlink(inject_name);
+}
+
+// Copia de las estadísticas del poller
+void irq_inject_get_stats(irq_inject_stats_t *out) {
+    pthread_mutex_lock(&inject_stats_mutex);
+    *out = inject_stats;
+    pthread_mutex_unlock(&inject_stats_mutex);
+    out->full_events = inject_ring != NULL ?
+        (unsigned long)__atomic_load_n(&inject_ring->full_events, __ATOMIC_RELAXED) : 0;
+}
@@ -0,0 +1,135 @@
+#ifndef IRQ_INJECT_H
+#define IRQ_INJECT_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Anillo de inyección de IRQs en memoria compartida POSIX
+//
+// Procesos externos (generadores de carga) escriben registros
+// {irq, payload, timestamp} directamente en el segmento sin ninguna llamada
+// al sistema por evento. El anillo es MPSC acotado con un número de
+// secuencia por ranura: varios productores reservan posiciones con CAS sobre
+// `head` y el hilo poller del simulador las consume en lotes y las entrega a
+// dispatch_interrupt().
+
+#define IRQ_INJECT_DEFAULT_NAME "/irqsim_inject"
+#define IRQ_INJECT_MAGIC 0x4a4e4949u    // "IINJ"
+#define IRQ_INJECT_VERSION 1
+#define IRQ_INJECT_CAPACITY 65536       // Potencia de 2
+#define IRQ_INJECT_BATCH 256            // Máximo de registros drenados por lote
+
+// Registro inyectado
+typedef struct {
+    int32_t irq;
+    uint32_t flags;
+    uint64_t payload;
+    uint64_t timestamp_ns;              // CLOCK_MONOTONIC del productor
+} irq_inject_record_t;
+
+// Ranura del anillo: seq == pos (libre), pos + 1 (publicada)
+typedef struct {
+    uint64_t seq;
+    irq_inject_record_t rec;
+} irq_inject_slot_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t capacity;
+    int32_t consumer_pid;
+    uint64_t head __attribute__((aligned(64)));     // Próxima posición de los productores
+    uint64_t full_events __attribute__((aligned(64))); // Intentos con el anillo lleno
+    uint64_t tail __attribute__((aligned(64)));     // Posición del consumidor (solo informativa)
+    irq_inject_slot_t slots[IRQ_INJECT_CAPACITY] __attribute__((aligned(64)));
+} irq_inject_ring_t;
+
+// Reloj usado para los timestamps de los registros
+static inline uint64_t irq_inject_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Productor: reservar `count` ranuras consecutivas. Devuelve 0 y la posición
+// inicial en *pos, o -1 si el anillo no tiene espacio suficiente.
+static inline int irq_inject_reserve(irq_inject_ring_t *ring, uint32_t count, uint64_t *pos) {
+    uint64_t mask = IRQ_INJECT_CAPACITY - 1;
+    uint64_t p = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+
+    if (count == 0 || count > IRQ_INJECT_CAPACITY) {
+        return -1;
+    }
+
+    for (;;) {
+        // El consumidor libera en orden: si la última ranura está libre, todas lo están
+        irq_inject_slot_t *last = &ring->slots[(p + count - 1) & mask];
+        uint64_t seq = __atomic_load_n(&last->seq, __ATOMIC_ACQUIRE);
+        int64_t diff = (int64_t)seq - (int64_t)(p + count - 1);
+
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&ring->head, &p, p + count, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                *pos = p;
+                return 0;
+            }
+        } else if (diff < 0) {
+            __atomic_fetch_add(&ring->full_events, 1, __ATOMIC_RELAXED);
+            return -1;
+        } else {
+            p = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+// Productor: publicar un registro en una posición reservada
+static inline void irq_inject_commit(irq_inject_ring_t *ring, uint64_t pos,
+                                     const irq_inject_record_t *rec) {
+    irq_inject_slot_t *slot = &ring->slots[pos & (IRQ_INJECT_CAPACITY - 1)];
+    slot->rec = *rec;
+    __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+}
+
+// Productor: inyectar un lote de registros. Devuelve 0 o -1 si no hay espacio.
+static inline int irq_inject_push_batch(irq_inject_ring_t *ring,
+                                        const irq_inject_record_t *recs, uint32_t count) {
+    uint64_t pos;
+    if (irq_inject_reserve(ring, count, &pos) != 0) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        irq_inject_commit(ring, pos + i, &recs[i]);
+    }
+    return 0;
+}
+
+// Productor: inyectar un único IRQ
+static inline int irq_inject_raise(irq_inject_ring_t *ring, int irq, uint64_t payload) {
+    irq_inject_record_t rec;
+    rec.irq = irq;
+    rec.flags = 0;
+    rec.payload = payload;
+    rec.timestamp_ns = irq_inject_now_ns();
+    return irq_inject_push_batch(ring, &rec, 1);
+}
+
+// Estadísticas del poller del simulador
+typedef struct {
+    unsigned long consumed;             // Registros drenados del anillo
+    unsigned long dispatched;           // Registros entregados a dispatch_interrupt()
+    unsigned long invalid;              // Registros con IRQ fuera de rango
+    unsigned long batches;              // Lotes no vacíos procesados
+    unsigned long full_events;          // Reintentos de productores con anillo lleno
+    unsigned long max_batch;            // Lote más grande observado
+    double average_delay_us;            // Retardo medio productor -> despacho
+    unsigned long max_delay_us;         // Retardo máximo productor -> despacho
+} irq_inject_stats_t;
+
+// API del consumidor (implementada en irq_inject.c, solo la usa el simulador)
+int irq_inject_init(const char *name);
+void irq_inject_shutdown(void);
+int irq_inject_is_active(void);
+void irq_inject_get_stats(irq_inject_stats_t *out);
+uint64_t irq_inject_current_payload(void);
+
+#endif // IRQ_INJECT_H
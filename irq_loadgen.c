@@ -0,0 +1,553 @@
+#define _GNU_SOURCE
+#include <math.h>
+#include "irq_loadgen.h"
+#include "irq_rand.h"
+#include "irq_replay.h"
+#include "irq_rt.h"
+
+// Contadores escritos sólo por su hilo generador y leídos desde fuera
+#define STAT_ADD(field, value) \
+    __atomic_store_n(&(field), __atomic_load_n(&(field), __ATOMIC_RELAXED) + (value), __ATOMIC_RELAXED)
+#define STAT_SET(field, value) __atomic_store_n(&(field), (value), __ATOMIC_RELAXED)
+
+#define LOADGEN_SPIN_NS 20000ULL            // El final de cada espera es activo
+#define LOADGEN_MAX_SLEEP_NS 100000000ULL   // Trozos de espera para atender STOP
+#define LOADGEN_START_DELAY_NS 1000000ULL   // Margen para que arranquen todos los hilos
+
+typedef struct {
+    irq_loadgen_stream_t config;
+    double cdf[MAX_INTERRUPTS];             // Distribución acumulada de los vectores
+} loadgen_stream_t;
+
+typedef struct {
+    pthread_t thread;
+    int index;
+    unsigned long sent;
+    unsigned long deferred;
+    unsigned long shed;
+    uint64_t behind_ns;
+    uint64_t max_behind_ns;
+    uint64_t max_ns;
+    uint64_t latency[IRQ_LOADGEN_BUCKETS];  // Desde el instante previsto (ISR ejecutada)
+    uint64_t service[IRQ_LOADGEN_BUCKETS];  // Desde el envío real (ISR ejecutada)
+} __attribute__((aligned(64))) loadgen_thread_t;
+
+static loadgen_stream_t streams[IRQ_LOADGEN_MAX_STREAMS];
+static int stream_count = 0;
+static loadgen_thread_t workers[IRQ_LOADGEN_MAX_THREADS];
+static int worker_count = 0;
+static int workers_joinable = 0;
+static int workers_alive = 0;
+static int loadgen_running = 0;
+static int owned[MAX_INTERRUPTS];           // Vectores con la ISR vacía del generador
+static uint64_t start_ns = 0;
+static uint64_t end_ns = 0;                 // 0 = sin límite
+static uint64_t finished_ns = 0;
+static pthread_mutex_t loadgen_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t loadgen_ctl_mutex = PTHREAD_MUTEX_INITIALIZER;  // START/STOP
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int hist_index(uint64_t ns) {
+    if (ns < IRQ_LOADGEN_SUB_BUCKETS) {
+        return (int)ns;
+    }
+    int e = 63 - __builtin_clzll(ns);
+    int index = (e - 3) * IRQ_LOADGEN_SUB_BUCKETS + (int)((ns >> (e - 4)) & (IRQ_LOADGEN_SUB_BUCKETS - 1));
+    return index < IRQ_LOADGEN_BUCKETS ? index : IRQ_LOADGEN_BUCKETS - 1;
+}
+
+static uint64_t hist_lower(int index) {
+    if (index < IRQ_LOADGEN_SUB_BUCKETS) {
+        return (uint64_t)index;
+    }
+    int e = index / IRQ_LOADGEN_SUB_BUCKETS + 3;
+    return (1ULL << e) | ((uint64_t)(index % IRQ_LOADGEN_SUB_BUCKETS) << (e - 4));
+}
+
+// Cota superior del percentil q de un histograma ya sumado
+static uint64_t hist_percentile(const uint64_t *hist, uint64_t total, double q, uint64_t max) {
+    uint64_t target = (uint64_t)ceil(q * (double)total), seen = 0;
+    if (total == 0) {
+        return 0;
+    }
+    for (int i = 0; i < IRQ_LOADGEN_BUCKETS; i++) {
+        seen += hist[i];
+        if (seen >= target) {
+            uint64_t upper = i + 1 < IRQ_LOADGEN_BUCKETS ? hist_lower(i + 1) - 1 : max;
+            return upper < max ? upper : max;
+        }
+    }
+    return max;
+}
+
+static void loadgen_isr(int irq_num) {
+    (void)irq_num;
+}
+
+// Devolver los vectores prestados (el último hilo, o quien para)
+static void release_vectors(void) {
+    for (int irq = 0; irq < MAX_INTERRUPTS; irq++) {
+        if (owned[irq]) {
+            while (unregister_isr(irq) == ERROR_ISR_EXECUTING) {
+                usleep(1000);
+            }
+            owned[irq] = 0;
+        }
+    }
+}
+
+// Siguiente llegada de un flujo después de t para un hilo con tasa rate
+static uint64_t next_arrival(const irq_loadgen_stream_t *s, uint64_t t, double rate, irq_rand_t *rng) {
+    switch (s->process) {
+        case IRQ_LOADGEN_CONSTANT:
+            return t + (uint64_t)(1e9 / rate);
+        case IRQ_LOADGEN_POISSON:
+            return t + (uint64_t)(-log(1.0 - irq_rand_double(rng)) * 1e9 / rate);
+        case IRQ_LOADGEN_ONOFF: {
+            // Poisson más denso dentro de la ráfaga para mantener la media
+            uint64_t on = (uint64_t)(s->on_ms * 1e6), period = on + (uint64_t)(s->off_ms * 1e6);
+            double burst_rate = rate * (double)period / (double)on;
+            t += (uint64_t)(-log(1.0 - irq_rand_double(rng)) * 1e9 / burst_rate);
+            uint64_t phase = (t - start_ns) % period;
+            return phase < on ? t : t + (period - phase);
+        }
+    }
+    return t;
+}
+
+static int pick_vector(const loadgen_stream_t *s, irq_rand_t *rng) {
+    if (s->config.num_vectors == 1) {
+        return s->config.vectors[0];
+    }
+    double u = irq_rand_double(rng);
+    int lo = 0, hi = s->config.num_vectors - 1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (s->cdf[mid] < u) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return s->config.vectors[lo];
+}
+
+// Esperar hasta target; 0 si se pidió parar
+static int wait_until(uint64_t target) {
+    uint64_t now;
+    while ((now = now_ns()) < target) {
+        if (!__atomic_load_n(&loadgen_running, __ATOMIC_RELAXED)) {
+            return 0;
+        }
+        if (target - now > LOADGEN_SPIN_NS) {
+            uint64_t wake = target - now - LOADGEN_SPIN_NS > LOADGEN_MAX_SLEEP_NS ?
+                            now + LOADGEN_MAX_SLEEP_NS : target - LOADGEN_SPIN_NS;
+            struct timespec ts = { (time_t)(wake / 1000000000ULL), (long)(wake % 1000000000ULL) };
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        }
+    }
+    return 1;
+}
+
+static void *loadgen_thread_func(void *arg) {
+    loadgen_thread_t *t = (loadgen_thread_t *)arg;
+    uint64_t next[IRQ_LOADGEN_MAX_STREAMS];
+    double rate[IRQ_LOADGEN_MAX_STREAMS];
+    irq_rand_t rng;
+
+    irq_rt_enter_thread();
+    irq_rand_seed(&rng, (uint64_t)t->index + 1);            // Secuencia fija por hilo
+    irq_replay_set_source(IRQ_REPLAY_SRC_LOADGEN);
+    // irq_loadgen_start() suelta el cerrojo cuando ya están creados todos
+    pthread_mutex_lock(&loadgen_mutex);
+    int threads = worker_count;
+    pthread_mutex_unlock(&loadgen_mutex);
+    for (int s = 0; s < stream_count; s++) {
+        rate[s] = streams[s].config.rate / threads;
+        // Los hilos de un flujo constante se intercalan en vez de coincidir
+        uint64_t offset = streams[s].config.process == IRQ_LOADGEN_CONSTANT ?
+                          (uint64_t)(1e9 / rate[s] * t->index / threads) : 0;
+        next[s] = next_arrival(&streams[s].config, start_ns + offset, rate[s], &rng);
+    }
+
+    while (__atomic_load_n(&loadgen_running, __ATOMIC_RELAXED)) {
+        int s = 0;
+        for (int i = 1; i < stream_count; i++) {
+            if (next[i] < next[s]) {
+                s = i;
+            }
+        }
+        uint64_t intended = next[s];
+        if ((end_ns != 0 && intended > end_ns) || !wait_until(intended)) {
+            break;
+        }
+
+        // Lazo abierto: si vamos tarde se envía ya, sin mover el plan
+        uint64_t sent_at = now_ns();
+        dispatch_interrupt(pick_vector(&streams[s], &rng));
+        uint64_t done = now_ns();
+
+        uint64_t latency = done - intended;
+        dispatch_outcome_t outcome = get_last_dispatch_outcome();
+        if (outcome == DISPATCH_EXECUTED) {
+            STAT_ADD(t->latency[hist_index(latency)], 1);
+            STAT_ADD(t->service[hist_index(done - sent_at)], 1);
+            if (latency > t->max_ns) {
+                STAT_SET(t->max_ns, latency);
+            }
+        } else if (outcome == DISPATCH_DEFERRED) {
+            STAT_ADD(t->deferred, 1);
+        } else {
+            STAT_ADD(t->shed, 1);
+        }
+        STAT_ADD(t->sent, 1);
+        STAT_SET(t->behind_ns, sent_at - intended);
+        if (sent_at - intended > t->max_behind_ns) {
+            STAT_SET(t->max_behind_ns, sent_at - intended);
+        }
+        next[s] = next_arrival(&streams[s].config, intended, rate[s], &rng);
+    }
+    STAT_SET(t->behind_ns, 0);
+
+    pthread_mutex_lock(&loadgen_mutex);
+    if (--workers_alive == 0) {
+        finished_ns = now_ns();
+        release_vectors();
+    }
+    pthread_mutex_unlock(&loadgen_mutex);
+    return NULL;
+}
+
+int irq_loadgen_add_stream(const irq_loadgen_stream_t *stream) {
+    if (stream->num_vectors <= 0 || stream->num_vectors > MAX_INTERRUPTS || stream->rate <= 0 ||
+        stream->zipf_s < 0 ||
+        (stream->process == IRQ_LOADGEN_ONOFF && (stream->on_ms <= 0 || stream->off_ms < 0))) {
+        return ERROR_INVALID_ARG;
+    }
+    for (int i = 0; i < stream->num_vectors; i++) {
+        if (validate_irq_num(stream->vectors[i]) != SUCCESS) {
+            return ERROR_INVALID_IRQ;
+        }
+    }
+
+    pthread_mutex_lock(&loadgen_mutex);
+    if (workers_alive > 0 || stream_count >= IRQ_LOADGEN_MAX_STREAMS) {
+        pthread_mutex_unlock(&loadgen_mutex);
+        return ERROR_INVALID_ARG;
+    }
+    loadgen_stream_t *s = &streams[stream_count];
+    s->config = *stream;
+    double total = 0.0;
+    for (int i = 0; i < stream->num_vectors; i++) {
+        total += 1.0 / pow(i + 1, stream->zipf_s);
+        s->cdf[i] = total;
+    }
+    for (int i = 0; i < stream->num_vectors; i++) {
+        s->cdf[i] /= total;
+    }
+    int index = stream_count++;
+    pthread_mutex_unlock(&loadgen_mutex);
+    return index;
+}
+
+int irq_loadgen_clear(void) {
+    pthread_mutex_lock(&loadgen_mutex);
+    if (workers_alive > 0) {
+        pthread_mutex_unlock(&loadgen_mutex);
+        return ERROR_INVALID_ARG;
+    }
+    stream_count = 0;
+    pthread_mutex_unlock(&loadgen_mutex);
+    return SUCCESS;
+}
+
+// Parar y esperar a los hilos (con loadgen_ctl_mutex); los hilos toman
+// loadgen_mutex al salir, así que se espera sin tenerlo
+static int stop_workers(void) {
+    pthread_mutex_lock(&loadgen_mutex);
+    int joinable = workers_joinable;
+    __atomic_store_n(&loadgen_running, 0, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&loadgen_mutex);
+    if (!joinable) {
+        return ERROR_INVALID_ARG;
+    }
+
+    for (int i = 0; i < worker_count; i++) {
+        pthread_join(workers[i].thread, NULL);
+    }
+    pthread_mutex_lock(&loadgen_mutex);
+    workers_joinable = 0;
+    pthread_mutex_unlock(&loadgen_mutex);
+    return SUCCESS;
+}
+
+int irq_loadgen_start(int threads, double seconds) {
+    if (threads < 1 || threads > IRQ_LOADGEN_MAX_THREADS || seconds < 0) {
+        return ERROR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&loadgen_ctl_mutex);
+    pthread_mutex_lock(&loadgen_mutex);
+    int busy = workers_alive > 0 || stream_count == 0;
+    pthread_mutex_unlock(&loadgen_mutex);
+    if (busy) {
+        pthread_mutex_unlock(&loadgen_ctl_mutex);
+        return ERROR_INVALID_ARG;
+    }
+    // Hilos de una carga con duración que ya terminó
+    stop_workers();
+
+    pthread_mutex_lock(&loadgen_mutex);
+    for (int s = 0; s < stream_count; s++) {
+        for (int i = 0; i < streams[s].config.num_vectors; i++) {
+            int irq = streams[s].config.vectors[i];
+            if (!owned[irq] && is_irq_available(irq) &&
+                register_isr(irq, loadgen_isr, "Carga sintética") == SUCCESS) {
+                owned[irq] = 1;
+            }
+        }
+    }
+    memset(workers, 0, sizeof(workers));
+    worker_count = threads;
+    start_ns = now_ns() + LOADGEN_START_DELAY_NS;
+    end_ns = seconds > 0 ? start_ns + (uint64_t)(seconds * 1e9) : 0;
+    finished_ns = 0;
+    __atomic_store_n(&loadgen_running, 1, __ATOMIC_RELAXED);
+    workers_alive = 0;
+    for (int i = 0; i < threads; i++) {
+        workers[i].index = i;
+        if (pthread_create(&workers[i].thread, NULL, loadgen_thread_func, &workers[i]) != 0) {
+            break;
+        }
+        workers_alive++;
+    }
+    // Si no se crearon todos, se paran los que hay
+    int started = workers_alive;
+    worker_count = started;
+    workers_joinable = started > 0;
+    if (started < threads) {
+        __atomic_store_n(&loadgen_running, 0, __ATOMIC_RELAXED);
+    }
+    if (started == 0) {
+        release_vectors();
+    }
+    pthread_mutex_unlock(&loadgen_mutex);
+
+    if (started < threads) {
+        stop_workers();
+        pthread_mutex_unlock(&loadgen_ctl_mutex);
+        return ERROR_INVALID_ARG;
+    }
+    pthread_mutex_unlock(&loadgen_ctl_mutex);
+    add_trace_with_irqf(-1, "🚀 Generador de carga: %d flujos en %d hilos", stream_count, threads);
+    return SUCCESS;
+}
+
+int irq_loadgen_stop(void) {
+    pthread_mutex_lock(&loadgen_ctl_mutex);
+    int result = stop_workers();
+    pthread_mutex_unlock(&loadgen_ctl_mutex);
+    return result;
+}
+
+void irq_loadgen_get_stats(irq_loadgen_stats_t *out) {
+    static uint64_t latency[IRQ_LOADGEN_BUCKETS], service[IRQ_LOADGEN_BUCKETS];
+    uint64_t max = 0;
+
+    memset(out, 0, sizeof(*out));
+    pthread_mutex_lock(&loadgen_mutex);
+    memset(latency, 0, sizeof(latency));
+    memset(service, 0, sizeof(service));
+    out->active = workers_alive > 0;
+    out->threads = worker_count;
+    out->streams = stream_count;
+    for (int s = 0; s < stream_count; s++) {
+        out->offered_rate += streams[s].config.rate;
+    }
+    for (int i = 0; i < worker_count; i++) {
+        const loadgen_thread_t *t = &workers[i];
+        out->sent += __atomic_load_n(&t->sent, __ATOMIC_RELAXED);
+        out->deferred += __atomic_load_n(&t->deferred, __ATOMIC_RELAXED);
+        out->shed += __atomic_load_n(&t->shed, __ATOMIC_RELAXED);
+        uint64_t behind = __atomic_load_n(&t->behind_ns, __ATOMIC_RELAXED);
+        uint64_t max_behind = __atomic_load_n(&t->max_behind_ns, __ATOMIC_RELAXED);
+        uint64_t t_max = __atomic_load_n(&t->max_ns, __ATOMIC_RELAXED);
+        out->behind_ns = behind > out->behind_ns ? behind : out->behind_ns;
+        out->max_behind_ns = max_behind > out->max_behind_ns ? max_behind : out->max_behind_ns;
+        max = t_max > max ? t_max : max;
+        for (int b = 0; b < IRQ_LOADGEN_BUCKETS; b++) {
+            latency[b] += __atomic_load_n(&t->latency[b], __ATOMIC_RELAXED);
+            service[b] += __atomic_load_n(&t->service[b], __ATOMIC_RELAXED);
+        }
+    }
+    if (start_ns != 0) {
+        uint64_t now = finished_ns != 0 ? finished_ns : now_ns();
+        out->elapsed_s = now > start_ns ? (now - start_ns) / 1e9 : 0.0;
+    }
+    // Los contadores se leen por separado: con la carga en marcha la suma
+    // de las ISR ejecutadas se toma de los histogramas
+    for (int b = 0; b < IRQ_LOADGEN_BUCKETS; b++) {
+        out->serviced += latency[b];
+    }
+    out->achieved_rate = out->elapsed_s > 0 ? out->serviced / out->elapsed_s : 0.0;
+    out->max_ns = max;
+    out->p50_ns = hist_percentile(latency, out->serviced, 0.50, max);
+    out->p90_ns = hist_percentile(latency, out->serviced, 0.90, max);
+    out->p99_ns = hist_percentile(latency, out->serviced, 0.99, max);
+    out->p999_ns = hist_percentile(latency, out->serviced, 0.999, max);
+    out->service_p50_ns = hist_percentile(service, out->serviced, 0.50, max);
+    out->service_p99_ns = hist_percentile(service, out->serviced, 0.99, max);
+    pthread_mutex_unlock(&loadgen_mutex);
+}
+
+int irq_loadgen_get_stream(int index, irq_loadgen_stream_t *out) {
+    pthread_mutex_lock(&loadgen_mutex);
+    if (index < 0 || index >= stream_count) {
+        pthread_mutex_unlock(&loadgen_mutex);
+        return ERROR_INVALID_ARG;
+    }
+    *out = streams[index].config;
+    pthread_mutex_unlock(&loadgen_mutex);
+    return SUCCESS;
+}
+
+const char *irq_loadgen_process_name(irq_loadgen_process_t process) {
+    switch (process) {
+        case IRQ_LOADGEN_CONSTANT: return "const";
+        case IRQ_LOADGEN_POISSON:  return "poisson";
+        case IRQ_LOADGEN_ONOFF:    return "onoff";
+    }
+    return "?";
+}
+
+void irq_loadgen_shutdown(void) {
+    irq_loadgen_stop();
+}
+
+void show_loadgen(void) {
+    irq_loadgen_stats_t st;
+    irq_loadgen_get_stats(&st);
+
+    printf("\n=== GENERADOR DE CARGA ===\n");
+    for (int i = 0; i < st.streams; i++) {
+        irq_loadgen_stream_t s;
+        if (irq_loadgen_get_stream(i, &s) != SUCCESS) {
+            continue;
+        }
+        printf("Flujo %d: %.0f IRQ/s │ %s", i, s.rate, irq_loadgen_process_name(s.process));
+        if (s.process == IRQ_LOADGEN_ONOFF) {
+            printf(" (%.1f ms ON / %.1f ms OFF)", s.on_ms, s.off_ms);
+        }
+        printf(" │ vectores");
+        for (int v = 0; v < s.num_vectors; v++) {
+            printf("%s%d", v == 0 ? " " : ",", s.vectors[v]);
+        }
+        printf(s.zipf_s > 0 ? " (Zipf s=%.2f)\n" : " (uniforme)\n", s.zipf_s);
+    }
+    if (st.streams == 0) {
+        printf("Sin flujos definidos.\n\n");
+        return;
+    }
+    printf("Estado: %s │ %d hilos │ %.2f s\n", st.active ? "GENERANDO" : "detenido", st.threads, st.elapsed_s);
+    printf("Ofrecido: %.0f IRQ/s │ Atendido: %.0f IRQ/s (%lu enviadas, %lu atendidas, %lu diferidas, %lu descartadas)\n",
+           st.offered_rate, st.achieved_rate, st.sent, st.serviced, st.deferred, st.shed);
+    printf("Latencia desde el instante previsto: p50 %.1f μs │ p90 %.1f │ p99 %.1f │ p99.9 %.1f │ máx %.1f\n",
+           st.p50_ns / 1e3, st.p90_ns / 1e3, st.p99_ns / 1e3, st.p999_ns / 1e3, st.max_ns / 1e3);
+    printf("Tiempo de servicio (envío real):     p50 %.1f μs │ p99 %.1f\n",
+           st.service_p50_ns / 1e3, st.service_p99_ns / 1e3);
+    printf("Retraso del generador: actual %.1f μs │ máximo %.1f μs%s\n\n",
+           st.behind_ns / 1e3, st.max_behind_ns / 1e3,
+           st.max_behind_ns > 1000000 ? " (el simulador no sostiene la tasa ofrecida)" : "");
+}
+
+void loadgen_submenu(void) {
+    int option;
+
+    while (1) {
+        printf("\n=== GENERADOR DE CARGA ===\n");
+        printf("1. Mostrar flujos y resultados\n");
+        printf("2. Añadir flujo\n");
+        printf("3. Borrar flujos\n");
+        printf("4. Iniciar carga\n");
+        printf("5. Detener carga\n");
+        printf("0. Volver\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+
+        option = get_valid_input(0, 5);
+        switch (option) {
+            case 0:
+                return;
+            case 1:
+                show_loadgen();
+                break;
+            case 2: {
+                irq_loadgen_stream_t s;
+                memset(&s, 0, sizeof(s));
+                printf("Primer vector (0-%d): ", MAX_INTERRUPTS - 1);
+                fflush(stdout);
+                int first = get_valid_input(0, MAX_INTERRUPTS - 1);
+                printf("Número de vectores consecutivos (1-%d): ", MAX_INTERRUPTS - first);
+                fflush(stdout);
+                s.num_vectors = get_valid_input(1, MAX_INTERRUPTS - first);
+                for (int i = 0; i < s.num_vectors; i++) {
+                    s.vectors[i] = first + i;
+                }
+                printf("Tasa en IRQ/s (1-10000000): ");
+                fflush(stdout);
+                s.rate = get_valid_input(1, 10000000);
+                printf("Proceso (0 = constante, 1 = Poisson, 2 = ráfagas ON/OFF): ");
+                fflush(stdout);
+                s.process = (irq_loadgen_process_t)get_valid_input(0, 2);
+                if (s.process == IRQ_LOADGEN_ONOFF) {
+                    printf("Milisegundos ON (1-10000): ");
+                    fflush(stdout);
+                    s.on_ms = get_valid_input(1, 10000);
+                    printf("Milisegundos OFF (0-10000): ");
+                    fflush(stdout);
+                    s.off_ms = get_valid_input(0, 10000);
+                }
+                printf("Sesgo Zipf en centésimas (0 = uniforme, 100 = s 1.0): ");
+                fflush(stdout);
+                s.zipf_s = get_valid_input(0, 1000) / 100.0;
+                int index = irq_loadgen_add_stream(&s);
+                if (index >= 0) {
+                    printf("✓ Flujo %d añadido.\n", index);
+                } else {
+                    printf("✗ No se pudo añadir (¿carga en curso? ¿máximo %d flujos?).\n",
+                           IRQ_LOADGEN_MAX_STREAMS);
+                }
+                break;
+            }
+            case 3:
+                printf(irq_loadgen_clear() == SUCCESS ? "✓ Flujos borrados.\n" :
+                       "✗ Detenga la carga antes de borrar los flujos.\n");
+                break;
+            case 4: {
+                printf("Hilos generadores (1-%d): ", IRQ_LOADGEN_MAX_THREADS);
+                fflush(stdout);
+                int threads = get_valid_input(1, IRQ_LOADGEN_MAX_THREADS);
+                printf("Duración en segundos (0 = hasta detenerla): ");
+                fflush(stdout);
+                int seconds = get_valid_input(0, 3600);
+                if (irq_loadgen_start(threads, seconds) == SUCCESS) {
+                    printf("✓ Carga en marcha.\n");
+                } else {
+                    printf("✗ No se pudo iniciar (¿hay flujos? ¿ya en marcha?).\n");
+                }
+                break;
+            }
+            case 5:
+                if (irq_loadgen_stop() == SUCCESS) {
+                    show_loadgen();
+                } else {
+                    printf("✗ No hay ninguna carga en marcha.\n");
+                }
+                break;
+        }
+    }
+}
@@ -0,0 +1,526 @@
+#define _GNU_SOURCE
+#include <math.h>
+#include "irq_msix.h"
+#include "irq_balance.h"
+#include "irq_coro.h"
+
+// Clave RSS por defecto de Microsoft (la que usan la mayoría de las NICs)
+static const uint8_t default_rss_key[IRQ_MSIX_KEY_SIZE] = {
+    0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2,
+    0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0,
+    0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4,
+    0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30, 0xf2, 0x0c,
+    0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa
+};
+
+typedef struct {
+    int active;
+    char name[16];
+    int queues;
+    int indirection_queues;
+    int vectors[IRQ_MSIX_MAX_QUEUES];
+    unsigned long steered[IRQ_MSIX_MAX_QUEUES];
+    unsigned long interrupts[IRQ_MSIX_MAX_QUEUES];
+    uint8_t indirection[IRQ_MSIX_INDIRECTION_SIZE];
+} msix_device_t;
+
+// Dueño de cada vector (dispositivo y cola), -1 = no es MSI-X
+typedef struct {
+    int dev;
+    int queue;
+} msix_vector_owner_t;
+
+static msix_device_t devices[IRQ_MSIX_MAX_DEVICES];
+static msix_vector_owner_t vector_owner[MAX_INTERRUPTS];
+static pthread_mutex_t msix_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Toeplitz: por cada bit a 1 de la entrada se acumula la ventana de 32 bits
+// de la clave que empieza en esa posición
+static uint32_t toeplitz_hash(const uint8_t *key, const uint8_t *data, size_t len) {
+    uint32_t result = 0;
+    uint32_t window = ((uint32_t)key[0] << 24) | ((uint32_t)key[1] << 16) |
+                      ((uint32_t)key[2] << 8) | key[3];
+
+    for (size_t i = 0; i < len; i++) {
+        for (int bit = 7; bit >= 0; bit--) {
+            if (data[i] & (1u << bit)) {
+                result ^= window;
+            }
+            window <<= 1;
+            if (key[i + 4] & (1u << bit)) {
+                window |= 1;
+            }
+        }
+    }
+    return result;
+}
+
+uint32_t irq_msix_hash(const irq_msix_flow_t *flow) {
+    // Entrada en orden de red: origen, destino, puerto origen, puerto destino
+    uint8_t input[12] = {
+        (uint8_t)(flow->saddr >> 24), (uint8_t)(flow->saddr >> 16),
+        (uint8_t)(flow->saddr >> 8), (uint8_t)flow->saddr,
+        (uint8_t)(flow->daddr >> 24), (uint8_t)(flow->daddr >> 16),
+        (uint8_t)(flow->daddr >> 8), (uint8_t)flow->daddr,
+        (uint8_t)(flow->sport >> 8), (uint8_t)flow->sport,
+        (uint8_t)(flow->dport >> 8), (uint8_t)flow->dport
+    };
+    return toeplitz_hash(default_rss_key, input, sizeof(input));
+}
+
+void irq_msix_init(void) {
+    pthread_mutex_lock(&msix_mutex);
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        vector_owner[i].dev = -1;
+        vector_owner[i].queue = -1;
+    }
+    pthread_mutex_unlock(&msix_mutex);
+}
+
+static int valid_device(int dev) {
+    return dev >= 0 && dev < IRQ_MSIX_MAX_DEVICES && devices[dev].active;
+}
+
+// ISR de una cola: procesa lo pendiente en la cola (como un poll de NAPI)
+static void msix_queue_isr(int irq_num) {
+    char trace_msg[MAX_TRACE_MSG_LEN];
+
+    pthread_mutex_lock(&msix_mutex);
+    int dev = vector_owner[irq_num].dev;
+    int queue = vector_owner[irq_num].queue;
+    if (dev >= 0) {
+        devices[dev].interrupts[queue]++;
+        snprintf(trace_msg, sizeof(trace_msg), "📶 MSI-X: %s-q%d procesando su cola",
+                 devices[dev].name, queue);
+    }
+    pthread_mutex_unlock(&msix_mutex);
+
+    if (dev < 0) {
+        return;
+    }
+    add_trace_smart(trace_msg, irq_num, 0);
+    irq_await_us(IRQ_MSIX_QUEUE_DELAY_US);
+}
+
+int irq_msix_set_indirection(int dev, int active_queues) {
+    pthread_mutex_lock(&msix_mutex);
+    if (!valid_device(dev) || active_queues < 1 || active_queues > devices[dev].queues) {
+        pthread_mutex_unlock(&msix_mutex);
+        return ERROR_INVALID_ARG;
+    }
+    for (int i = 0; i < IRQ_MSIX_INDIRECTION_SIZE; i++) {
+        devices[dev].indirection[i] = (uint8_t)(i % active_queues);
+    }
+    devices[dev].indirection_queues = active_queues;
+    pthread_mutex_unlock(&msix_mutex);
+    return SUCCESS;
+}
+
+int irq_msix_create(const char *name, int queues) {
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    char description[MAX_DESCRIPTION_LEN];
+
+    if (name == NULL || name[0] == '\0' || queues < 1 || queues > IRQ_MSIX_MAX_QUEUES) {
+        return ERROR_INVALID_ARG;
+    }
+
+    irq_balance_stats_t balance;
+    irq_balance_get_stats(&balance);
+
+    pthread_mutex_lock(&msix_mutex);
+    int dev = -1;
+    for (int i = 0; i < IRQ_MSIX_MAX_DEVICES; i++) {
+        if (!devices[i].active) {
+            dev = i;
+            break;
+        }
+    }
+    if (dev < 0) {
+        pthread_mutex_unlock(&msix_mutex);
+        return ERROR_INVALID_ARG;
+    }
+
+    // Reservar un vector libre por cola (los vectores 0 y 1 son del sistema).
+    // vector_owner cubre a otro dispositivo creado en paralelo que aún no ha
+    // registrado sus ISRs
+    int vectors[IRQ_MSIX_MAX_QUEUES];
+    int found = 0;
+    for (int irq = 2; irq < MAX_INTERRUPTS && found < queues; irq++) {
+        if (vector_owner[irq].dev < 0 && is_irq_available(irq)) {
+            vectors[found++] = irq;
+        }
+    }
+    if (found < queues) {
+        pthread_mutex_unlock(&msix_mutex);
+        snprintf(trace_msg, sizeof(trace_msg),
+            "❌ MSI-X: %s necesita %d vectores y sólo hay %d libres", name, queues, found);
+        add_trace(trace_msg);
+        return ERROR_INVALID_IRQ;
+    }
+
+    msix_device_t *d = &devices[dev];
+    memset(d, 0, sizeof(*d));
+    snprintf(d->name, sizeof(d->name), "%s", name);
+    d->queues = queues;
+    d->active = 1;
+    for (int q = 0; q < queues; q++) {
+        d->vectors[q] = vectors[q];
+        vector_owner[vectors[q]].dev = dev;
+        vector_owner[vectors[q]].queue = q;
+    }
+    pthread_mutex_unlock(&msix_mutex);
+
+    // Sin msix_mutex otro camino (REG, PLUGIN ATTACH, DEV CREATE) puede
+    // quedarse un vector: entonces se deshace todo lo reservado
+    for (int q = 0; q < queues; q++) {
+        snprintf(description, sizeof(description), "MSI-X %s-q%d", name, q);
+        int result = register_isr(vectors[q], msix_queue_isr, description);
+        if (result != SUCCESS) {
+            for (int r = 0; r < q; r++) {
+                while (unregister_isr(vectors[r]) == ERROR_ISR_EXECUTING) {
+                    sched_yield();
+                }
+            }
+            pthread_mutex_lock(&msix_mutex);
+            for (int r = 0; r < queues; r++) {
+                vector_owner[vectors[r]].dev = -1;
+                vector_owner[vectors[r]].queue = -1;
+            }
+            d->active = 0;
+            pthread_mutex_unlock(&msix_mutex);
+            snprintf(trace_msg, sizeof(trace_msg),
+                "❌ MSI-X: %s no pudo registrar el vector %d (ocupado entre tanto)", name, vectors[q]);
+            add_trace(trace_msg);
+            return result;
+        }
+    }
+    for (int q = 0; q < queues; q++) {
+        set_irq_affinity(vectors[q], q % balance.cpus);
+    }
+    irq_msix_set_indirection(dev, queues);
+
+    snprintf(trace_msg, sizeof(trace_msg),
+        "📶 MSI-X: Dispositivo %s creado con %d colas (vectores %d-%d)",
+        name, queues, vectors[0], vectors[queues - 1]);
+    add_trace(trace_msg);
+    return dev;
+}
+
+int irq_msix_destroy(int dev) {
+    pthread_mutex_lock(&msix_mutex);
+    if (!valid_device(dev)) {
+        pthread_mutex_unlock(&msix_mutex);
+        return ERROR_INVALID_ARG;
+    }
+    int queues = devices[dev].queues;
+    int vectors[IRQ_MSIX_MAX_QUEUES];
+    memcpy(vectors, devices[dev].vectors, sizeof(vectors));
+    pthread_mutex_unlock(&msix_mutex);
+
+    // Liberar primero los vectores: un vector en ejecución aborta la baja
+    for (int q = 0; q < queues; q++) {
+        int result = unregister_isr(vectors[q]);
+        if (result != SUCCESS) {
+            // Volver a dejar operativas las colas ya liberadas
+            for (int r = 0; r < q; r++) {
+                char description[MAX_DESCRIPTION_LEN];
+                snprintf(description, sizeof(description), "MSI-X %s-q%d", devices[dev].name, r);
+                register_isr(vectors[r], msix_queue_isr, description);
+            }
+            return result;
+        }
+    }
+
+    pthread_mutex_lock(&msix_mutex);
+    for (int q = 0; q < queues; q++) {
+        vector_owner[vectors[q]].dev = -1;
+        vector_owner[vectors[q]].queue = -1;
+    }
+    devices[dev].active = 0;
+    pthread_mutex_unlock(&msix_mutex);
+    return SUCCESS;
+}
+
+int irq_msix_steer(int dev, const irq_msix_flow_t *flow) {
+    uint32_t hash = irq_msix_hash(flow);
+
+    pthread_mutex_lock(&msix_mutex);
+    if (!valid_device(dev)) {
+        pthread_mutex_unlock(&msix_mutex);
+        return ERROR_INVALID_ARG;
+    }
+    int queue = devices[dev].indirection[hash & (IRQ_MSIX_INDIRECTION_SIZE - 1)];
+    pthread_mutex_unlock(&msix_mutex);
+    return queue;
+}
+
+int irq_msix_deliver(int dev, const irq_msix_flow_t *flow) {
+    uint32_t hash = irq_msix_hash(flow);
+
+    pthread_mutex_lock(&msix_mutex);
+    if (!valid_device(dev)) {
+        pthread_mutex_unlock(&msix_mutex);
+        return ERROR_INVALID_ARG;
+    }
+    int queue = devices[dev].indirection[hash & (IRQ_MSIX_INDIRECTION_SIZE - 1)];
+    int irq = devices[dev].vectors[queue];
+    devices[dev].steered[queue]++;
+    pthread_mutex_unlock(&msix_mutex);
+
+    dispatch_interrupt(irq);
+    return queue;
+}
+
+int irq_msix_get_info(int dev, irq_msix_device_info_t *out) {
+    irq_descriptor_t *idt = sim_default()->idt;
+    pthread_mutex_lock(&msix_mutex);
+    if (!valid_device(dev)) {
+        pthread_mutex_unlock(&msix_mutex);
+        return ERROR_INVALID_ARG;
+    }
+    msix_device_t *d = &devices[dev];
+    memset(out, 0, sizeof(*out));
+    out->active = 1;
+    snprintf(out->name, sizeof(out->name), "%s", d->name);
+    out->queues = d->queues;
+    out->indirection_queues = d->indirection_queues;
+    for (int q = 0; q < d->queues; q++) {
+        out->queue[q].irq = d->vectors[q];
+        out->queue[q].steered = d->steered[q];
+        out->queue[q].interrupts = d->interrupts[q];
+    }
+    pthread_mutex_unlock(&msix_mutex);
+
+    LOCK_IDT();
+    for (int q = 0; q < out->queues; q++) {
+        out->queue[q].cpu = idt[out->queue[q].irq].cpu_affinity;
+        out->queue[q].busy_us = idt[out->queue[q].irq].total_execution_time;
+    }
+    UNLOCK_IDT();
+    return SUCCESS;
+}
+
+void irq_msix_shutdown(void) {
+    for (int dev = 0; dev < IRQ_MSIX_MAX_DEVICES; dev++) {
+        if (devices[dev].active) {
+            irq_msix_destroy(dev);
+        }
+    }
+}
+
+void irq_msix_synthetic_flow(unsigned int index, irq_msix_flow_t *flow) {
+    // Clientes 10.0.x.y contra un servidor 192.168.1.1:443
+    uint32_t mix = index * 2654435761u;
+    flow->saddr = 0x0a000000u | (mix & 0x00ffffffu);
+    flow->daddr = 0xc0a80101u;
+    flow->sport = (uint16_t)(1024 + (index * 7919u) % 64000u);
+    flow->dport = 443;
+}
+
+// ---- Banco de escalado: simulación de eventos discretos ----
+
+#define BENCH_FLOWS 256
+#define BENCH_PACKET_US 2.0                 // Coste de procesar un paquete
+#define BENCH_OFFERED_CPUS 3.2              // Carga ofrecida en CPUs completas
+#define BENCH_HORIZON_US 100000.0           // 100 ms simulados
+
+static int compare_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static int bench_queues(int queues, const uint32_t *flow_hash, irq_msix_bench_row_t *row) {
+    double rate = BENCH_OFFERED_CPUS / BENCH_PACKET_US;
+    size_t capacity = (size_t)(rate * BENCH_HORIZON_US * 1.2) + 1024;
+    double *latency = malloc(capacity * sizeof(double));
+    double free_at[IRQ_MSIX_MAX_QUEUES * 2] = {0}, busy[IRQ_MSIX_MAX_QUEUES * 2] = {0};
+    unsigned long per_queue[IRQ_MSIX_MAX_QUEUES * 2] = {0};
+    uint8_t indirection[IRQ_MSIX_INDIRECTION_SIZE];
+    size_t samples = 0, completed = 0;
+    uint64_t rng = 0x243f6a8885a308d3ULL;
+
+    if (latency == NULL) {
+        return ERROR_INVALID_ARG;
+    }
+    for (int i = 0; i < IRQ_MSIX_INDIRECTION_SIZE; i++) {
+        indirection[i] = (uint8_t)(i % queues);
+    }
+
+    // Una cola por CPU; llegadas de Poisson de flujos elegidos al azar
+    double t = 0.0;
+    for (;;) {
+        rng ^= rng >> 12;
+        rng ^= rng << 25;
+        rng ^= rng >> 27;
+        uint64_t r = rng * 2685821657736338717ULL;
+        double u = ((r >> 11) + 1) * (1.0 / 9007199254740993.0);
+        t += -log(u) / rate;
+        if (t > BENCH_HORIZON_US) {
+            break;
+        }
+        int flow = (int)((r >> 3) % BENCH_FLOWS);
+        int q = indirection[flow_hash[flow] & (IRQ_MSIX_INDIRECTION_SIZE - 1)];
+        double start = t > free_at[q] ? t : free_at[q];
+        free_at[q] = start + BENCH_PACKET_US;
+        busy[q] += BENCH_PACKET_US;
+        per_queue[q]++;
+        if (free_at[q] <= BENCH_HORIZON_US) {
+            completed++;
+        }
+        if (samples < capacity) {
+            latency[samples++] = free_at[q] - t;
+        }
+    }
+
+    qsort(latency, samples, sizeof(double), compare_double);
+    memset(row, 0, sizeof(*row));
+    row->queues = queues;
+    row->p99_us = samples > 0 ? latency[(size_t)(samples * 0.99)] : 0.0;
+    row->mpps = completed / BENCH_HORIZON_US;
+    for (int q = 0; q < queues; q++) {
+        double share = samples > 0 ? (double)per_queue[q] / samples : 0.0;
+        double util = busy[q] / BENCH_HORIZON_US;
+        if (share > row->max_queue_share) {
+            row->max_queue_share = share;
+        }
+        if (util > row->max_cpu_util) {
+            row->max_cpu_util = util;
+        }
+    }
+    free(latency);
+    return SUCCESS;
+}
+
+int irq_msix_benchmark(int max_queues, irq_msix_bench_row_t *rows) {
+    uint32_t flow_hash[BENCH_FLOWS];
+    int count = 0;
+
+    if (max_queues < 1 || max_queues > IRQ_MSIX_MAX_QUEUES * 2) {
+        return ERROR_INVALID_ARG;
+    }
+    for (int f = 0; f < BENCH_FLOWS; f++) {
+        irq_msix_flow_t flow;
+        irq_msix_synthetic_flow((unsigned int)f, &flow);
+        flow_hash[f] = irq_msix_hash(&flow);
+    }
+    for (int q = 1; q <= max_queues; q *= 2) {
+        if (bench_queues(q, flow_hash, &rows[count]) == SUCCESS) {
+            count++;
+        }
+    }
+    return count;
+}
+
+void show_msix_devices(void) {
+    printf("\n=== DISPOSITIVOS MULTICOLA (MSI-X) ===\n");
+
+    int shown = 0;
+    for (int dev = 0; dev < IRQ_MSIX_MAX_DEVICES; dev++) {
+        irq_msix_device_info_t info;
+        if (irq_msix_get_info(dev, &info) != SUCCESS) {
+            continue;
+        }
+        shown = 1;
+        printf("\n[%d] %s: %d colas (%d en la tabla de indirección)\n",
+               dev, info.name, info.queues, info.indirection_queues);
+        printf("Cola │ IRQ │ CPU │ Dirigidos │ Interrupciones │ Tiempo ISR ms\n");
+        for (int q = 0; q < info.queues; q++) {
+            irq_msix_queue_stats_t *qs = &info.queue[q];
+            printf("%4d │ %3d │ %3d │ %9lu │ %14lu │ %.1f\n",
+                   q, qs->irq, qs->cpu, qs->steered, qs->interrupts, qs->busy_us / 1000.0);
+        }
+    }
+    if (!shown) {
+        printf("No hay dispositivos multicola.\n");
+    }
+    printf("\n");
+}
+
+void irq_msix_submenu(void) {
+    int option, dev;
+    char name[16];
+
+    while (1) {
+        printf("\n=== DISPOSITIVOS MULTICOLA (MSI-X) ===\n");
+        printf("1. Mostrar dispositivos y estadísticas por cola\n");
+        printf("2. Crear dispositivo\n");
+        printf("3. Eliminar dispositivo\n");
+        printf("4. Enviar tráfico sintético\n");
+        printf("5. Medir escalado con el número de colas\n");
+        printf("0. Volver\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+
+        option = get_valid_input(0, 5);
+        switch (option) {
+            case 0:
+                return;
+            case 1:
+                show_msix_devices();
+                break;
+            case 2: {
+                printf("Número de colas (1-%d): ", IRQ_MSIX_MAX_QUEUES);
+                fflush(stdout);
+                int queues = get_valid_input(1, IRQ_MSIX_MAX_QUEUES);
+                snprintf(name, sizeof(name), "nic%d", queues);
+                for (int i = 0; i < IRQ_MSIX_MAX_DEVICES; i++) {
+                    if (!devices[i].active) {
+                        snprintf(name, sizeof(name), "nic%d", i);
+                        break;
+                    }
+                }
+                dev = irq_msix_create(name, queues);
+                if (dev >= 0) {
+                    printf("✓ Dispositivo %s creado (id %d).\n", name, dev);
+                } else {
+                    printf("✗ No se pudo crear el dispositivo (¿vectores libres?).\n");
+                }
+                break;
+            }
+            case 3:
+                printf("Id del dispositivo (0-%d): ", IRQ_MSIX_MAX_DEVICES - 1);
+                fflush(stdout);
+                dev = get_valid_input(0, IRQ_MSIX_MAX_DEVICES - 1);
+                if (irq_msix_destroy(dev) == SUCCESS) {
+                    printf("✓ Dispositivo eliminado.\n");
+                } else {
+                    printf("✗ No se pudo eliminar el dispositivo.\n");
+                }
+                break;
+            case 4: {
+                printf("Id del dispositivo (0-%d): ", IRQ_MSIX_MAX_DEVICES - 1);
+                fflush(stdout);
+                dev = get_valid_input(0, IRQ_MSIX_MAX_DEVICES - 1);
+                printf("Paquetes (1-1000): ");
+                fflush(stdout);
+                int packets = get_valid_input(1, 1000);
+                printf("Flujos distintos (1-%d): ", BENCH_FLOWS);
+                fflush(stdout);
+                int flows = get_valid_input(1, BENCH_FLOWS);
+                for (int i = 0; i < packets; i++) {
+                    irq_msix_flow_t flow;
+                    irq_msix_synthetic_flow((unsigned int)(i % flows), &flow);
+                    if (irq_msix_deliver(dev, &flow) < 0) {
+                        printf("✗ Dispositivo inexistente.\n");
+                        break;
+                    }
+                }
+                show_msix_devices();
+                break;
+            }
+            case 5: {
+                irq_msix_bench_row_t rows[8];
+                int count = irq_msix_benchmark(IRQ_MSIX_MAX_QUEUES * 2, rows);
+                printf("\n%d flujos, %.0f μs por paquete, carga ofrecida de %.1f CPUs, una cola por CPU\n",
+                       BENCH_FLOWS, BENCH_PACKET_US, BENCH_OFFERED_CPUS);
+                printf("Colas │ Cola más cargada │ CPU máx │   p99 μs   │ Mpps\n");
+                for (int i = 0; i < count; i++) {
+                    printf("%5d │ %15.1f%% │ %6.0f%% │ %10.1f │ %.3f\n",
+                           rows[i].queues, rows[i].max_queue_share * 100.0,
+                           rows[i].max_cpu_util * 100.0, rows[i].p99_us, rows[i].mpps);
+                }
+                break;
+            }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef IRQ_MSIX_H
+#define IRQ_MSIX_H
+
+#include <stdint.h>
+#include "interrupt_simulator.h"
+
+// Dispositivos multicola con vectores estilo MSI-X y reparto RSS
+//
+// Un dispositivo reserva un vector libre de la IDT por cola ("nic0-q0",
+// "nic0-q1"...), cada uno con su afinidad a una CPU simulada. Cada paquete o
+// petición se dirige a una cola con un hash Toeplitz de su flujo (direcciones y
+// puertos, como RSS en una NIC) y una tabla de indirección de 128 entradas,
+// así que un mismo flujo siempre cae en la misma cola y en la misma CPU.
+
+#define IRQ_MSIX_MAX_DEVICES 4
+#define IRQ_MSIX_MAX_QUEUES 8
+#define IRQ_MSIX_INDIRECTION_SIZE 128
+#define IRQ_MSIX_KEY_SIZE 40
+#define IRQ_MSIX_QUEUE_DELAY_US 1000        // Procesado de una cola por interrupción
+
+// Flujo IPv4 de 4 tuplas (orden de entrada del hash RSS)
+typedef struct {
+    uint32_t saddr;
+    uint32_t daddr;
+    uint16_t sport;
+    uint16_t dport;
+} irq_msix_flow_t;
+
+typedef struct {
+    int irq;
+    int cpu;
+    unsigned long steered;                  // Paquetes dirigidos a la cola
+    unsigned long interrupts;               // Ejecuciones de la ISR de la cola
+    unsigned long busy_us;                  // Tiempo de ISR (de idt[])
+} irq_msix_queue_stats_t;
+
+typedef struct {
+    int active;
+    char name[16];
+    int queues;
+    int indirection_queues;                 // Colas que reciben tráfico
+    irq_msix_queue_stats_t queue[IRQ_MSIX_MAX_QUEUES];
+} irq_msix_device_info_t;
+
+// Una fila del banco de escalado
+typedef struct {
+    int queues;
+    double max_queue_share;                 // Fracción de paquetes en la cola más cargada
+    double max_cpu_util;
+    double p99_us;
+    double mpps;                            // Paquetes completados por μs simulado
+} irq_msix_bench_row_t;
+
+// Hash Toeplitz con la clave RSS por defecto
+uint32_t irq_msix_hash(const irq_msix_flow_t *flow);
+
+// Dispositivos (devuelven el id o un código de error)
+void irq_msix_init(void);
+int irq_msix_create(const char *name, int queues);
+int irq_msix_destroy(int dev);
+int irq_msix_set_indirection(int dev, int active_queues);   // Repartir la tabla
+int irq_msix_steer(int dev, const irq_msix_flow_t *flow);   // Cola del flujo
+int irq_msix_deliver(int dev, const irq_msix_flow_t *flow); // Dirigir y disparar
+int irq_msix_get_info(int dev, irq_msix_device_info_t *out);
+void irq_msix_shutdown(void);
+
+// Flujos sintéticos deterministas y banco de escalado (1..max_queues colas)
+void irq_msix_synthetic_flow(unsigned int index, irq_msix_flow_t *flow);
+int irq_msix_benchmark(int max_queues, irq_msix_bench_row_t *rows);
+
+void show_msix_devices(void);
+void irq_msix_submenu(void);
+
+#endif // IRQ_MSIX_H
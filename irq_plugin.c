@@ -0,0 +1,505 @@
+#define _GNU_SOURCE
+#include <dlfcn.h>
+#include "irq_plugin.h"
+#include "irq_storm.h"
+#include "irq_workpool.h"
+
+// Plugin cargado en memoria
+typedef struct {
+    int loaded;
+    void *handle;
+    const irq_plugin_descriptor_t *desc;
+    int bindings;                       // Vectores que usan alguno de sus handlers
+    char path[IRQ_PLUGIN_MAX_PATH];
+} loaded_plugin_t;
+
+// Estado de un enlace: reservado mientras attach llama a bind() sin el lock
+#define BINDING_FREE 0
+#define BINDING_ACTIVE 1
+#define BINDING_RESERVED -1
+
+// Enlace vector -> handler de plugin
+typedef struct {
+    int active;                         // BINDING_*
+    int plugin_id;
+    const irq_plugin_handler_t *handler;
+    void *ctx;
+    unsigned long bh_pending;           // Mitades inferiores encoladas
+    int bh_queued;                      // Trabajo del pool en curso o encolado
+    irq_plugin_stats_t stats;
+} plugin_binding_t;
+
+static loaded_plugin_t plugins[IRQ_PLUGIN_MAX_LOADED];
+static plugin_binding_t bindings[MAX_INTERRUPTS];
+static pthread_mutex_t plugin_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Aviso de que un enlace ya no tiene mitades inferiores en el pool
+static pthread_cond_t bh_idle_cond = PTHREAD_COND_INITIALIZER;
+
+static void bh_work(void *arg);
+
+static uint64_t host_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void host_trace(int irq, const char *msg) {
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg), "🧩 PLUGIN: %s", msg);
+    add_trace_smart(trace_msg, irq, 0);
+}
+
+static const irq_plugin_host_t plugin_host = {
+    IRQ_PLUGIN_ABI_VERSION,
+    sizeof(irq_plugin_host_t),
+    host_trace,
+    host_now_ns
+};
+
+// ISR trampolín: ejecuta la mitad superior del handler enlazado al vector.
+// La IDT garantiza que no hay dos instancias simultáneas en el mismo vector y
+// que el enlace no se desmonta mientras el vector está en ejecución.
+static void plugin_trampoline_isr(int irq_num) {
+    plugin_binding_t *b = &bindings[irq_num];
+    if (__atomic_load_n(&b->active, __ATOMIC_ACQUIRE) != BINDING_ACTIVE) {
+        return;
+    }
+
+    uint64_t start = host_now_ns();
+    int result = b->handler->top_half(irq_num, b->ctx);
+    unsigned long elapsed = (unsigned long)(host_now_ns() - start);
+
+    pthread_mutex_lock(&plugin_mutex);
+    b->stats.calls++;
+    b->stats.top_total_ns += elapsed;
+    if (elapsed < b->stats.top_min_ns) {
+        b->stats.top_min_ns = elapsed;
+    }
+    if (elapsed > b->stats.top_max_ns) {
+        b->stats.top_max_ns = elapsed;
+    }
+    if (result == IRQ_PLUGIN_NONE) {
+        b->stats.unhandled++;
+        irq_storm_mark_unhandled();
+    } else {
+        b->stats.handled++;
+    }
+    int queue_work = 0;
+    if (result == IRQ_PLUGIN_WAKE_THREAD && b->handler->bottom_half != NULL) {
+        b->bh_pending++;
+        b->stats.bh_scheduled++;
+        if (!b->bh_queued) {
+            b->bh_queued = 1;
+            queue_work = 1;
+        }
+    }
+    pthread_mutex_unlock(&plugin_mutex);
+
+    if (queue_work) {
+        irq_work_submit(bh_work, (void *)(intptr_t)irq_num, NULL);
+    }
+}
+
+// Trabajo del pool para un enlace: como un tasklet, las mitades inferiores de
+// un mismo vector nunca corren en paralelo, pero vectores distintos sí
+static void bh_work(void *arg) {
+    int irq_num = (int)(intptr_t)arg;
+    plugin_binding_t *b = &bindings[irq_num];
+
+    pthread_mutex_lock(&plugin_mutex);
+    while (b->active == BINDING_ACTIVE && b->bh_pending > 0) {
+        b->bh_pending--;
+        pthread_mutex_unlock(&plugin_mutex);
+
+        uint64_t start = host_now_ns();
+        b->handler->bottom_half(irq_num, b->ctx);
+        unsigned long elapsed = (unsigned long)(host_now_ns() - start);
+
+        pthread_mutex_lock(&plugin_mutex);
+        b->stats.bh_runs++;
+        b->stats.bh_total_ns += elapsed;
+        if (elapsed > b->stats.bh_max_ns) {
+            b->stats.bh_max_ns = elapsed;
+        }
+    }
+    b->bh_queued = 0;
+    pthread_cond_broadcast(&bh_idle_cond);
+    pthread_mutex_unlock(&plugin_mutex);
+}
+
+// Handler i de la tabla del plugin, con el tamaño de elemento con que se compiló
+static const irq_plugin_handler_t *plugin_handler(const irq_plugin_descriptor_t *desc, size_t i) {
+    return (const irq_plugin_handler_t *)((const char *)desc->handlers + i * desc->handlers[0].struct_size);
+}
+
+// Cargar una biblioteca y validar su descriptor
+int irq_plugin_load(const char *path) {
+    char trace_msg[MAX_TRACE_MSG_LEN];
+
+    void *handle = dlopen(path, RTLD_NOW | RTLD_LOCAL);
+    if (handle == NULL) {
+        snprintf(trace_msg, sizeof(trace_msg), "❌ KERNEL: dlopen falló: %s", dlerror());
+        add_trace(trace_msg);
+        return ERROR_PLUGIN;
+    }
+
+    const irq_plugin_descriptor_t *desc = dlsym(handle, IRQ_PLUGIN_SYMBOL);
+    if (desc == NULL ||
+        (desc->abi_version >> 16) != IRQ_PLUGIN_ABI_MAJOR ||
+        desc->struct_size < IRQ_PLUGIN_DESCRIPTOR_V1_SIZE ||
+        desc->handlers == NULL || desc->handler_count == 0 ||
+        desc->handlers[0].struct_size < IRQ_PLUGIN_HANDLER_V1_SIZE) {
+        snprintf(trace_msg, sizeof(trace_msg),
+            "❌ KERNEL: %s no exporta un descriptor compatible (ABI %d.x)",
+            path, IRQ_PLUGIN_ABI_MAJOR);
+        add_trace(trace_msg);
+        dlclose(handle);
+        return ERROR_PLUGIN;
+    }
+    for (size_t i = 0; i < desc->handler_count; i++) {
+        const irq_plugin_handler_t *h = plugin_handler(desc, i);
+        if (h->struct_size != desc->handlers[0].struct_size) {
+            add_trace("❌ KERNEL: Plugin con handlers de distinto tamaño");
+            dlclose(handle);
+            return ERROR_PLUGIN;
+        }
+        if (h->name == NULL || h->top_half == NULL) {
+            add_trace("❌ KERNEL: Plugin con handler sin nombre o sin mitad superior");
+            dlclose(handle);
+            return ERROR_PLUGIN;
+        }
+    }
+
+    if (desc->init != NULL && desc->init(&plugin_host) != 0) {
+        snprintf(trace_msg, sizeof(trace_msg), "❌ KERNEL: init() del plugin %s falló", desc->name);
+        add_trace(trace_msg);
+        dlclose(handle);
+        return ERROR_PLUGIN;
+    }
+
+    pthread_mutex_lock(&plugin_mutex);
+    int id = -1;
+    for (int i = 0; i < IRQ_PLUGIN_MAX_LOADED; i++) {
+        if (!plugins[i].loaded) {
+            id = i;
+            break;
+        }
+    }
+    if (id < 0) {
+        pthread_mutex_unlock(&plugin_mutex);
+        if (desc->fini != NULL) {
+            desc->fini();
+        }
+        dlclose(handle);
+        add_trace("❌ KERNEL: Tabla de plugins llena");
+        return ERROR_PLUGIN;
+    }
+
+    plugins[id].loaded = 1;
+    plugins[id].handle = handle;
+    plugins[id].desc = desc;
+    plugins[id].bindings = 0;
+    snprintf(plugins[id].path, sizeof(plugins[id].path), "%s", path);
+    pthread_mutex_unlock(&plugin_mutex);
+
+    snprintf(trace_msg, sizeof(trace_msg),
+        "🧩 KERNEL: Plugin \"%s\" cargado (%zu handlers, ABI %u.%u)",
+        desc->name, desc->handler_count, desc->abi_version >> 16, desc->abi_version & 0xffff);
+    add_trace(trace_msg);
+    return id;
+}
+
+int irq_plugin_unload(int plugin_id) {
+    if (plugin_id < 0 || plugin_id >= IRQ_PLUGIN_MAX_LOADED) {
+        return ERROR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&plugin_mutex);
+    if (!plugins[plugin_id].loaded || plugins[plugin_id].bindings > 0) {
+        pthread_mutex_unlock(&plugin_mutex);
+        add_trace("⚠️  KERNEL: Plugin inexistente o con vectores enlazados");
+        return ERROR_PLUGIN;
+    }
+    loaded_plugin_t plugin = plugins[plugin_id];
+    plugins[plugin_id].loaded = 0;
+    pthread_mutex_unlock(&plugin_mutex);
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg), "🧩 KERNEL: Plugin \"%s\" descargado", plugin.desc->name);
+    if (plugin.desc->fini != NULL) {
+        plugin.desc->fini();
+    }
+    dlclose(plugin.handle);
+    add_trace(trace_msg);
+    return SUCCESS;
+}
+
+// Buscar "handler" o "plugin/handler" entre los plugins cargados (con plugin_mutex)
+static const irq_plugin_handler_t *find_handler(const char *spec, int *plugin_id) {
+    const char *slash = strchr(spec, '/');
+    const char *handler_name = slash != NULL ? slash + 1 : spec;
+    size_t plugin_len = slash != NULL ? (size_t)(slash - spec) : 0;
+
+    for (int i = 0; i < IRQ_PLUGIN_MAX_LOADED; i++) {
+        if (!plugins[i].loaded) {
+            continue;
+        }
+        const irq_plugin_descriptor_t *desc = plugins[i].desc;
+        if (slash != NULL &&
+            (strlen(desc->name) != plugin_len || strncmp(desc->name, spec, plugin_len) != 0)) {
+            continue;
+        }
+        for (size_t h = 0; h < desc->handler_count; h++) {
+            if (strcmp(plugin_handler(desc, h)->name, handler_name) == 0) {
+                *plugin_id = i;
+                return plugin_handler(desc, h);
+            }
+        }
+    }
+    return NULL;
+}
+
+int irq_plugin_attach(int irq_num, const char *handler_name) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+    if (!is_irq_available(irq_num)) {
+        add_trace("⚠️  KERNEL: Enlace de plugin fallido - IRQ ya ocupada");
+        return ERROR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&plugin_mutex);
+    int plugin_id = -1;
+    const irq_plugin_handler_t *handler = find_handler(handler_name, &plugin_id);
+    if (handler == NULL) {
+        pthread_mutex_unlock(&plugin_mutex);
+        add_trace("❌ KERNEL: Handler de plugin no encontrado");
+        return ERROR_PLUGIN;
+    }
+    plugin_binding_t *b = &bindings[irq_num];
+    if (b->active != BINDING_FREE) {
+        pthread_mutex_unlock(&plugin_mutex);
+        add_trace("⚠️  KERNEL: Enlace de plugin fallido - vector ya enlazado");
+        return ERROR_PLUGIN;
+    }
+    // Reservado antes de soltar el lock: otro attach al mismo vector falla aquí
+    __atomic_store_n(&b->active, BINDING_RESERVED, __ATOMIC_RELEASE);
+    plugins[plugin_id].bindings++;
+    pthread_mutex_unlock(&plugin_mutex);
+
+    // bind() puede bloquear: se llama fuera del lock
+    void *ctx = handler->bind != NULL ? handler->bind(irq_num) : NULL;
+
+    pthread_mutex_lock(&plugin_mutex);
+    memset(b, 0, sizeof(*b));
+    b->plugin_id = plugin_id;
+    b->handler = handler;
+    b->ctx = ctx;
+    b->stats.top_min_ns = ULONG_MAX;
+    __atomic_store_n(&b->active, BINDING_ACTIVE, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&plugin_mutex);
+
+    char desc[MAX_DESCRIPTION_LEN];
+    snprintf(desc, sizeof(desc), "%s/%s", plugins[plugin_id].desc->name, handler->name);
+    int result = register_isr(irq_num, plugin_trampoline_isr, desc);
+    if (result != SUCCESS) {
+        // Sólo se deshace el enlace propio: la reserva impide que haya otro
+        pthread_mutex_lock(&plugin_mutex);
+        __atomic_store_n(&b->active, BINDING_FREE, __ATOMIC_RELEASE);
+        plugins[plugin_id].bindings--;
+        pthread_mutex_unlock(&plugin_mutex);
+        if (handler->unbind != NULL) {
+            handler->unbind(irq_num, ctx);
+        }
+    }
+    return result;
+}
+
+int irq_plugin_detach(int irq_num) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+
+    pthread_mutex_lock(&plugin_mutex);
+    int active = bindings[irq_num].active;
+    pthread_mutex_unlock(&plugin_mutex);
+    if (active != BINDING_ACTIVE) {
+        return ERROR_NO_ISR;
+    }
+
+    // Tras desregistrar, la IDT ya no puede entrar en el trampolín de este vector
+    int result = unregister_isr(irq_num);
+    if (result != SUCCESS) {
+        return result;
+    }
+
+    pthread_mutex_lock(&plugin_mutex);
+    plugin_binding_t *b = &bindings[irq_num];
+    __atomic_store_n(&b->active, BINDING_FREE, __ATOMIC_RELEASE);
+    b->bh_pending = 0;
+    while (b->bh_queued) {
+        pthread_cond_wait(&bh_idle_cond, &plugin_mutex);
+    }
+    const irq_plugin_handler_t *handler = b->handler;
+    void *ctx = b->ctx;
+    plugins[b->plugin_id].bindings--;
+    pthread_mutex_unlock(&plugin_mutex);
+
+    if (handler->unbind != NULL) {
+        handler->unbind(irq_num, ctx);
+    }
+    return SUCCESS;
+}
+
+int irq_plugin_get_binding(int irq_num, irq_plugin_binding_info_t *out) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+
+    pthread_mutex_lock(&plugin_mutex);
+    plugin_binding_t *b = &bindings[irq_num];
+    if (b->active != BINDING_ACTIVE) {
+        pthread_mutex_unlock(&plugin_mutex);
+        return ERROR_NO_ISR;
+    }
+    out->plugin_id = b->plugin_id;
+    snprintf(out->plugin_name, sizeof(out->plugin_name), "%s", plugins[b->plugin_id].desc->name);
+    snprintf(out->handler_name, sizeof(out->handler_name), "%s", b->handler->name);
+    out->stats = b->stats;
+    if (out->stats.calls == 0) {
+        out->stats.top_min_ns = 0;
+    }
+    pthread_mutex_unlock(&plugin_mutex);
+    return SUCCESS;
+}
+
+// Desenlazar todos los vectores (esperando sus mitades inferiores) y descargar
+void irq_plugin_shutdown(void) {
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        if (bindings[i].active == BINDING_ACTIVE) {
+            irq_plugin_detach(i);
+        }
+    }
+
+    for (int i = 0; i < IRQ_PLUGIN_MAX_LOADED; i++) {
+        if (plugins[i].loaded) {
+            irq_plugin_unload(i);
+        }
+    }
+}
+
+void show_plugins(void) {
+    printf("\n=== PLUGINS DE ISR (ABI %d.%d) ===\n", IRQ_PLUGIN_ABI_MAJOR, IRQ_PLUGIN_ABI_MINOR);
+
+    pthread_mutex_lock(&plugin_mutex);
+    int shown = 0;
+    for (int i = 0; i < IRQ_PLUGIN_MAX_LOADED; i++) {
+        if (!plugins[i].loaded) {
+            continue;
+        }
+        const irq_plugin_descriptor_t *desc = plugins[i].desc;
+        printf("[%d] %-16s %s (%d vectores enlazados)\n", i, desc->name, plugins[i].path,
+               plugins[i].bindings);
+        for (size_t h = 0; h < desc->handler_count; h++) {
+            const irq_plugin_handler_t *handler = plugin_handler(desc, h);
+            printf("      • %-14s %s%s\n", handler->name,
+                   handler->description != NULL ? handler->description : "",
+                   handler->bottom_half != NULL ? " [mitad inferior]" : "");
+        }
+        shown++;
+    }
+    pthread_mutex_unlock(&plugin_mutex);
+    if (shown == 0) {
+        printf("(ningún plugin cargado)\n");
+    }
+
+    printf("\nIRQ │ Handler                  │ Llamadas │ No atend. │ Sup. prom ns │ Sup. máx ns │ Inf. ejec. │ Inf. prom ns\n");
+    shown = 0;
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        irq_plugin_binding_info_t info;
+        if (irq_plugin_get_binding(i, &info) != SUCCESS) {
+            continue;
+        }
+        char name[MAX_DESCRIPTION_LEN];
+        snprintf(name, sizeof(name), "%s/%s", info.plugin_name, info.handler_name);
+        double top_avg = info.stats.calls > 0 ? (double)info.stats.top_total_ns / info.stats.calls : 0.0;
+        double bh_avg = info.stats.bh_runs > 0 ? (double)info.stats.bh_total_ns / info.stats.bh_runs : 0.0;
+        printf("%3d │ %-24s │ %8lu │ %9lu │ %12.0f │ %11lu │ %10lu │ %.0f\n",
+               i, name, info.stats.calls, info.stats.unhandled, top_avg,
+               info.stats.top_max_ns, info.stats.bh_runs, bh_avg);
+        shown++;
+    }
+    if (shown == 0) {
+        printf("(ningún vector enlazado)\n");
+    }
+    printf("\n");
+}
+
+// Leer una línea de texto sin el salto final
+static int read_line(const char *prompt, char *buf, size_t size) {
+    printf("%s", prompt);
+    fflush(stdout);
+    if (fgets(buf, (int)size, stdin) == NULL) {
+        return 0;
+    }
+    buf[strcspn(buf, "\n")] = '\0';
+    return buf[0] != '\0';
+}
+
+void plugins_submenu(void) {
+    char buf[IRQ_PLUGIN_MAX_PATH];
+    int option, irq_num, result;
+
+    while (1) {
+        printf("\n=== PLUGINS DE ISR ===\n");
+        printf("1. Mostrar plugins y estadísticas por handler\n");
+        printf("2. Cargar plugin (.so)\n");
+        printf("3. Enlazar handler de plugin a un IRQ\n");
+        printf("4. Desenlazar IRQ\n");
+        printf("5. Descargar plugin\n");
+        printf("0. Volver\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+
+        option = get_valid_input(0, 5);
+        result = SUCCESS;
+        switch (option) {
+            case 0:
+                return;
+            case 1:
+                show_plugins();
+                continue;
+            case 2:
+                if (!read_line("Ruta del plugin: ", buf, sizeof(buf))) {
+                    continue;
+                }
+                result = irq_plugin_load(buf);
+                break;
+            case 3:
+                printf("Ingrese el número de IRQ (0-%d): ", MAX_INTERRUPTS - 1);
+                fflush(stdout);
+                irq_num = get_valid_input(0, MAX_INTERRUPTS - 1);
+                if (!read_line("Handler (nombre o plugin/nombre): ", buf, sizeof(buf))) {
+                    continue;
+                }
+                result = irq_plugin_attach(irq_num, buf);
+                break;
+            case 4:
+                printf("Ingrese el número de IRQ (0-%d): ", MAX_INTERRUPTS - 1);
+                fflush(stdout);
+                result = irq_plugin_detach(get_valid_input(0, MAX_INTERRUPTS - 1));
+                break;
+            case 5:
+                printf("Id del plugin (0-%d): ", IRQ_PLUGIN_MAX_LOADED - 1);
+                fflush(stdout);
+                result = irq_plugin_unload(get_valid_input(0, IRQ_PLUGIN_MAX_LOADED - 1));
+                break;
+        }
+        if (result >= SUCCESS) {
+            printf("✓ Operación completada.\n");
+        } else {
+            printf("✗ Operación fallida (código %d).\n", result);
+        }
+    }
+}
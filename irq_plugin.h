@@ -0,0 +1,54 @@
+#ifndef IRQ_PLUGIN_H
+#define IRQ_PLUGIN_H
+
+#include "interrupt_simulator.h"
+#include "irq_plugin_abi.h"
+
+// Cargador de ISRs externas (dlopen)
+//
+// Cada vector enlazado a un plugin usa una ISR trampolín que llama a la mitad
+// superior del handler y, si lo pide, encola su mitad inferior en el pool de
+// trabajo diferido. Cada enlace lleva sus propias estadísticas de tiempo,
+// separadas para ambas mitades.
+
+#define IRQ_PLUGIN_MAX_LOADED 8
+#define IRQ_PLUGIN_MAX_PATH 256
+
+// Estadísticas por vector enlazado
+typedef struct {
+    unsigned long calls;
+    unsigned long handled;
+    unsigned long unhandled;            // Mitad superior devolvió IRQ_PLUGIN_NONE
+    unsigned long top_total_ns;
+    unsigned long top_min_ns;
+    unsigned long top_max_ns;
+    unsigned long bh_scheduled;
+    unsigned long bh_runs;
+    unsigned long bh_total_ns;
+    unsigned long bh_max_ns;
+} irq_plugin_stats_t;
+
+// Información de un enlace para mostrar o exportar
+typedef struct {
+    int plugin_id;
+    char plugin_name[32];
+    char handler_name[32];
+    irq_plugin_stats_t stats;
+} irq_plugin_binding_info_t;
+
+// Carga y descarga (devuelven el id del plugin o un código de error)
+int irq_plugin_load(const char *path);
+int irq_plugin_unload(int plugin_id);
+
+// Enlazar un handler ("nombre" o "plugin/nombre") a un vector libre
+int irq_plugin_attach(int irq_num, const char *handler_name);
+int irq_plugin_detach(int irq_num);
+
+int irq_plugin_get_binding(int irq_num, irq_plugin_binding_info_t *out);
+void irq_plugin_shutdown(void);
+
+// Visualización
+void show_plugins(void);
+void plugins_submenu(void);
+
+#endif // IRQ_PLUGIN_H
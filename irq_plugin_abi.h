@@ -0,0 +1,68 @@
+#ifndef IRQ_PLUGIN_ABI_H
+#define IRQ_PLUGIN_ABI_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ABI estable para ISRs cargables (.so)
+//
+// Un plugin es una biblioteca compartida que exporta el símbolo de datos
+// IRQ_PLUGIN_SYMBOL con un irq_plugin_descriptor_t. Este header no depende del
+// resto del simulador: es lo único que necesita incluir el autor del plugin.
+//
+// Compatibilidad: el simulador rechaza plugins con otra versión mayor. Las
+// estructuras sólo crecen por el final y llevan struct_size, de modo que una
+// versión menor nueva puede añadir campos sin romper plugins antiguos: el
+// simulador exige sólo el tamaño de la 1.0 (*_V1_SIZE), recorre la tabla de
+// handlers con el struct_size del plugin y no lee campos que éste no tenga.
+
+#define IRQ_PLUGIN_ABI_MAJOR 1
+#define IRQ_PLUGIN_ABI_MINOR 0
+#define IRQ_PLUGIN_ABI_VERSION ((IRQ_PLUGIN_ABI_MAJOR << 16) | IRQ_PLUGIN_ABI_MINOR)
+#define IRQ_PLUGIN_SYMBOL "irq_plugin_descriptor"
+
+// Resultado de la mitad superior
+#define IRQ_PLUGIN_NONE 0           // La interrupción no era de este dispositivo
+#define IRQ_PLUGIN_HANDLED 1        // Atendida por completo
+#define IRQ_PLUGIN_WAKE_THREAD 2    // Atendida; ejecutar la mitad inferior diferida
+
+// Servicios del simulador disponibles para el plugin
+typedef struct {
+    uint32_t abi_version;
+    uint32_t struct_size;
+    void (*trace)(int irq, const char *msg);
+    uint64_t (*now_ns)(void);
+} irq_plugin_host_t;
+
+// Un handler exportado por el plugin
+typedef struct {
+    uint32_t struct_size;                   // sizeof(irq_plugin_handler_t), igual en toda la tabla
+    const char *name;                       // Único dentro del plugin
+    const char *description;
+    int (*top_half)(int irq, void *ctx);    // Obligatorio: devuelve IRQ_PLUGIN_*
+    void (*bottom_half)(int irq, void *ctx);// Opcional: contexto de hilo, puede bloquear
+    void *(*bind)(int irq);                 // Opcional: crea el contexto por vector
+    void (*unbind)(int irq, void *ctx);     // Opcional: libera el contexto
+} irq_plugin_handler_t;
+
+// Descriptor exportado por el plugin
+typedef struct {
+    uint32_t abi_version;                   // IRQ_PLUGIN_ABI_VERSION al compilar
+    uint32_t struct_size;                   // sizeof(irq_plugin_descriptor_t)
+    const char *name;
+    int (*init)(const irq_plugin_host_t *host);  // Opcional: 0 = éxito
+    void (*fini)(void);                     // Opcional
+    size_t handler_count;
+    const irq_plugin_handler_t *handlers;
+} irq_plugin_descriptor_t;
+
+// Tamaños de la versión 1.0: fijos aunque las estructuras crezcan
+#define IRQ_PLUGIN_HANDLER_V1_SIZE \
+    (offsetof(irq_plugin_handler_t, unbind) + sizeof(void (*)(int, void *)))
+#define IRQ_PLUGIN_DESCRIPTOR_V1_SIZE \
+    (offsetof(irq_plugin_descriptor_t, handlers) + sizeof(const irq_plugin_handler_t *))
+
+// Declarar el descriptor dentro del plugin
+#define IRQ_PLUGIN_EXPORT __attribute__((visibility("default"))) const irq_plugin_descriptor_t
+
+#endif // IRQ_PLUGIN_ABI_H
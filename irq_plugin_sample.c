@@ -0,0 +1,112 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "irq_plugin_abi.h"
+
+// Plugin de ejemplo: se compila como irq_plugin_sample.so
+//
+//   checksum  - mitad superior corta (lee el "registro" del dispositivo) y
+//               mitad inferior que procesa un bloque de 64 KiB
+//   noop      - atiende y vuelve inmediatamente (mide el coste del trampolín)
+//   spurious  - nunca reconoce la interrupción (dispositivo que no es suyo)
+
+#define SAMPLE_BLOCK_SIZE 65536
+
+typedef struct {
+    unsigned char *block;
+    uint32_t status;
+    uint32_t checksum;
+    unsigned long completions;
+} sample_device_t;
+
+static const irq_plugin_host_t *host;
+
+static int sample_init(const irq_plugin_host_t *h) {
+    host = h;
+    return 0;
+}
+
+static void *checksum_bind(int irq) {
+    sample_device_t *dev = calloc(1, sizeof(*dev));
+    if (dev == NULL) {
+        return NULL;
+    }
+    dev->block = malloc(SAMPLE_BLOCK_SIZE);
+    if (dev->block == NULL) {
+        free(dev);
+        return NULL;
+    }
+    for (size_t i = 0; i < SAMPLE_BLOCK_SIZE; i++) {
+        dev->block[i] = (unsigned char)(i * 31u + (unsigned)irq);
+    }
+    return dev;
+}
+
+static void checksum_unbind(int irq, void *ctx) {
+    sample_device_t *dev = ctx;
+    (void)irq;
+    if (dev != NULL) {
+        free(dev->block);
+        free(dev);
+    }
+}
+
+static int checksum_top_half(int irq, void *ctx) {
+    sample_device_t *dev = ctx;
+    (void)irq;
+    if (dev == NULL) {
+        return IRQ_PLUGIN_NONE;
+    }
+    // Leer y reconocer el estado del dispositivo
+    dev->status = (dev->status + 1) | 1u;
+    return IRQ_PLUGIN_WAKE_THREAD;
+}
+
+static void checksum_bottom_half(int irq, void *ctx) {
+    sample_device_t *dev = ctx;
+    uint32_t a = 1, b = 0;
+
+    // Adler-32 sobre el bloque recibido
+    for (size_t i = 0; i < SAMPLE_BLOCK_SIZE; i++) {
+        a = (a + dev->block[i]) % 65521u;
+        b = (b + a) % 65521u;
+    }
+    dev->checksum = (b << 16) | a;
+    dev->completions++;
+
+    if (host != NULL && dev->completions % 1000 == 0) {
+        char msg[96];
+        snprintf(msg, sizeof(msg), "checksum IRQ %d: %lu bloques, último 0x%08x",
+                 irq, dev->completions, dev->checksum);
+        host->trace(irq, msg);
+    }
+}
+
+static int noop_top_half(int irq, void *ctx) {
+    (void)irq;
+    (void)ctx;
+    return IRQ_PLUGIN_HANDLED;
+}
+
+static int spurious_top_half(int irq, void *ctx) {
+    (void)irq;
+    (void)ctx;
+    return IRQ_PLUGIN_NONE;
+}
+
+static const irq_plugin_handler_t sample_handlers[] = {
+    {sizeof(irq_plugin_handler_t), "checksum", "Adler-32 diferido de 64 KiB", checksum_top_half,
+     checksum_bottom_half, checksum_bind, checksum_unbind},
+    {sizeof(irq_plugin_handler_t), "noop", "Atiende sin trabajo", noop_top_half, NULL, NULL, NULL},
+    {sizeof(irq_plugin_handler_t), "spurious", "Nunca reconoce la IRQ", spurious_top_half, NULL, NULL, NULL}
+};
+
+IRQ_PLUGIN_EXPORT irq_plugin_descriptor = {
+    IRQ_PLUGIN_ABI_VERSION,
+    sizeof(irq_plugin_descriptor_t),
+    "sample",
+    sample_init,
+    NULL,
+    sizeof(sample_handlers) / sizeof(sample_handlers[0]),
+    sample_handlers
+};
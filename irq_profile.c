@@ -0,0 +1,262 @@
+#define _GNU_SOURCE
+#include "irq_profile.h"
+
+typedef struct {
+    unsigned long dispatches;
+    irq_profile_hist_t total;
+    irq_profile_hist_t phases[IRQ_PROFILE_PHASES];
+} profile_vector_t;
+
+// Despacho en curso en este hilo (irq = -1: no se está midiendo)
+typedef struct {
+    int irq;
+    uint64_t started;
+    uint64_t last;
+    uint64_t phase_ns[IRQ_PROFILE_PHASES];
+} profile_current_t;
+
+static profile_vector_t vectors[MAX_INTERRUPTS];
+static int profile_enabled = 0;
+static double clock_cost_ns = 0.0;
+static __thread profile_current_t current = { .irq = -1 };
+
+static const char *phase_names[IRQ_PROFILE_PHASES] = {
+    "validate", "lock", "check", "trace", "state", "handler", "relock", "stats"
+};
+
+static const char *phase_labels[IRQ_PROFILE_PHASES] = {
+    "Validación", "Cerrojo IDT", "Comprobaciones", "Traza", "Cambio de estado",
+    "ISR", "Cerrojo al salir", "Estadísticas"
+};
+
+static inline uint64_t profile_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static int hist_bucket(uint64_t ns) {
+    int bucket = ns == 0 ? 0 : 64 - __builtin_clzll(ns);
+    return bucket < IRQ_PROFILE_BUCKETS ? bucket : IRQ_PROFILE_BUCKETS - 1;
+}
+
+void irq_profile_hist_add(irq_profile_hist_t *h, uint64_t ns) {
+    __atomic_fetch_add(&h->count, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->total_ns, ns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->hist[hist_bucket(ns)], 1, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&h->max_ns, __ATOMIC_RELAXED);
+    while (ns > max &&
+           !__atomic_compare_exchange_n(&h->max_ns, &max, ns, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void irq_profile_hist_load(const irq_profile_hist_t *h, irq_profile_hist_t *out) {
+    out->count = __atomic_load_n(&h->count, __ATOMIC_RELAXED);
+    out->total_ns = __atomic_load_n(&h->total_ns, __ATOMIC_RELAXED);
+    out->max_ns = __atomic_load_n(&h->max_ns, __ATOMIC_RELAXED);
+    for (int b = 0; b < IRQ_PROFILE_BUCKETS; b++) {
+        out->hist[b] = __atomic_load_n(&h->hist[b], __ATOMIC_RELAXED);
+    }
+}
+
+void irq_profile_hist_clear(irq_profile_hist_t *h) {
+    __atomic_store_n(&h->count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->total_ns, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&h->max_ns, 0, __ATOMIC_RELAXED);
+    for (int b = 0; b < IRQ_PROFILE_BUCKETS; b++) {
+        __atomic_store_n(&h->hist[b], 0, __ATOMIC_RELAXED);
+    }
+}
+
+void irq_profile_enable(int enabled) {
+    if (enabled) {
+        // Coste medio de una marca: lo que la medida añade a cada fase
+        const int samples = 10000;
+        uint64_t start = profile_now_ns(), now = start;
+        for (int i = 0; i < samples; i++) {
+            now = profile_now_ns();
+        }
+        clock_cost_ns = (double)(now - start) / samples;
+    }
+    __atomic_store_n(&profile_enabled, enabled ? 1 : 0, __ATOMIC_RELEASE);
+    add_trace_smartf(-1, 0, "🔬 KERNEL: Perfilado de fases del despacho %s",
+                     enabled ? "activado" : "desactivado");
+}
+
+int irq_profile_is_enabled(void) {
+    return __atomic_load_n(&profile_enabled, __ATOMIC_ACQUIRE);
+}
+
+void irq_profile_reset(void) {
+    for (int irq = 0; irq < MAX_INTERRUPTS; irq++) {
+        __atomic_store_n(&vectors[irq].dispatches, 0, __ATOMIC_RELAXED);
+        irq_profile_hist_clear(&vectors[irq].total);
+        for (int p = 0; p < IRQ_PROFILE_PHASES; p++) {
+            irq_profile_hist_clear(&vectors[irq].phases[p]);
+        }
+    }
+}
+
+double irq_profile_clock_cost_ns(void) {
+    return clock_cost_ns;
+}
+
+void irq_profile_begin(int irq_num) {
+    if (!__atomic_load_n(&profile_enabled, __ATOMIC_RELAXED)) {
+        current.irq = -1;
+        return;
+    }
+    current.irq = irq_num;
+    current.started = current.last = profile_now_ns();
+    memset(current.phase_ns, 0, sizeof(current.phase_ns));
+}
+
+void irq_profile_mark(irq_profile_phase_t phase) {
+    if (current.irq < 0) {
+        return;
+    }
+    uint64_t now = profile_now_ns();
+    current.phase_ns[phase] += now - current.last;
+    current.last = now;
+}
+
+void irq_profile_end(void) {
+    if (current.irq < 0 || current.irq >= MAX_INTERRUPTS) {
+        current.irq = -1;
+        return;
+    }
+    profile_vector_t *v = &vectors[current.irq];
+    __atomic_fetch_add(&v->dispatches, 1, __ATOMIC_RELAXED);
+    irq_profile_hist_add(&v->total, current.last - current.started);
+    for (int p = 0; p < IRQ_PROFILE_PHASES; p++) {
+        irq_profile_hist_add(&v->phases[p], current.phase_ns[p]);
+    }
+    current.irq = -1;
+}
+
+void irq_profile_discard(void) {
+    current.irq = -1;
+}
+
+int irq_profile_get_stats(int irq_num, irq_profile_stats_t *out) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+    const profile_vector_t *v = &vectors[irq_num];
+    out->dispatches = __atomic_load_n(&v->dispatches, __ATOMIC_RELAXED);
+    irq_profile_hist_load(&v->total, &out->total);
+    for (int p = 0; p < IRQ_PROFILE_PHASES; p++) {
+        irq_profile_hist_load(&v->phases[p], &out->phases[p]);
+    }
+    return SUCCESS;
+}
+
+uint64_t irq_profile_percentile(const irq_profile_hist_t *h, double q) {
+    uint64_t total = 0, seen = 0;
+    for (int b = 0; b < IRQ_PROFILE_BUCKETS; b++) {
+        total += h->hist[b];
+    }
+    if (total == 0) {
+        return 0;
+    }
+    uint64_t target = (uint64_t)(q * (double)total + 0.5);
+    for (int b = 0; b < IRQ_PROFILE_BUCKETS; b++) {
+        seen += h->hist[b];
+        if (seen >= target && seen > 0) {
+            uint64_t bound = b == 0 ? 0 : 1ULL << b;
+            return bound < h->max_ns ? bound : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+int irq_profile_top_overhead(const irq_profile_stats_t *st) {
+    int top = -1;
+    for (int p = 0; p < IRQ_PROFILE_PHASES; p++) {
+        if (p != IRQ_PROFILE_HANDLER && st->phases[p].total_ns > 0 &&
+            (top < 0 || st->phases[p].total_ns > st->phases[top].total_ns)) {
+            top = p;
+        }
+    }
+    return top;
+}
+
+const char *irq_profile_phase_name(int phase) {
+    return phase >= 0 && phase < IRQ_PROFILE_PHASES ? phase_names[phase] : "none";
+}
+
+void show_profile(void) {
+    int shown = 0;
+
+    printf("\n=== PERFIL DE FASES DEL DESPACHO ===\n");
+    printf("Estado: %s │ Coste de cada marca: %.0f ns\n",
+           irq_profile_is_enabled() ? "ACTIVO" : "inactivo", clock_cost_ns);
+    for (int irq = 0; irq < MAX_INTERRUPTS; irq++) {
+        irq_profile_stats_t st;
+        irq_profile_get_stats(irq, &st);
+        if (st.dispatches == 0) {
+            continue;
+        }
+        shown++;
+
+        double total_avg = (double)st.total.total_ns / st.dispatches;
+        double handler_avg = (double)st.phases[IRQ_PROFILE_HANDLER].total_ns / st.dispatches;
+        printf("\nIRQ %d: %lu despachos │ media %.0f ns │ fuera de la ISR %.0f ns (%.1f%%)\n",
+               irq, st.dispatches, total_avg, total_avg - handler_avg,
+               total_avg > 0 ? 100.0 * (total_avg - handler_avg) / total_avg : 0.0);
+        printf("  %-18s %10s %10s %10s %10s %7s\n", "FASE", "MEDIA ns", "P50 ns", "P99 ns", "MÁX ns", "%");
+        for (int p = 0; p < IRQ_PROFILE_PHASES; p++) {
+            const irq_profile_hist_t *h = &st.phases[p];
+            printf("  %-18s %10.0f %10lu %10lu %10lu %6.1f%%\n", phase_labels[p],
+                   (double)h->total_ns / st.dispatches,
+                   (unsigned long)irq_profile_percentile(h, 0.50),
+                   (unsigned long)irq_profile_percentile(h, 0.99),
+                   (unsigned long)h->max_ns,
+                   st.total.total_ns > 0 ? 100.0 * h->total_ns / st.total.total_ns : 0.0);
+        }
+        int top = irq_profile_top_overhead(&st);
+        if (top >= 0) {
+            double share = total_avg - handler_avg > 0 ?
+                100.0 * st.phases[top].total_ns / st.dispatches / (total_avg - handler_avg) : 0.0;
+            printf("  ➜ %s se lleva el %.0f%% del coste fuera de la ISR%s\n", phase_labels[top], share,
+                   st.phases[top].total_ns > st.phases[IRQ_PROFILE_HANDLER].total_ns ?
+                   " (más que la propia ISR)" : "");
+        }
+    }
+    if (shown == 0) {
+        printf("\nSin despachos medidos%s.\n",
+               irq_profile_is_enabled() ? " todavía" : " (active el perfilado)");
+    }
+    printf("\n");
+}
+
+void profile_submenu(void) {
+    int option;
+
+    while (1) {
+        printf("\n=== PERFIL DE FASES DEL DESPACHO ===\n");
+        printf("1. Mostrar desglose por vector\n");
+        printf("2. %s perfilado\n", irq_profile_is_enabled() ? "Desactivar" : "Activar");
+        printf("3. Reiniciar histogramas\n");
+        printf("0. Volver\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+
+        option = get_valid_input(0, 3);
+        switch (option) {
+            case 0:
+                return;
+            case 1:
+                show_profile();
+                break;
+            case 2:
+                irq_profile_enable(!irq_profile_is_enabled());
+                printf("✓ Perfilado %s.\n", irq_profile_is_enabled() ? "activado" : "desactivado");
+                break;
+            case 3:
+                irq_profile_reset();
+                printf("✓ Histogramas reiniciados.\n");
+                break;
+        }
+    }
+}
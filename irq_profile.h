@@ -0,0 +1,74 @@
+#ifndef IRQ_PROFILE_H
+#define IRQ_PROFILE_H
+
+#include <stdint.h>
+#include "interrupt_simulator.h"
+
+// Desglose del coste del despacho por fases
+//
+// Con el perfilado activo, dispatch_interrupt() marca el final de cada fase
+// (validación, cerrojo, comprobaciones, traza, cambio de estado, ISR,
+// recuperación del cerrojo y estadísticas) con CLOCK_MONOTONIC, que se lee en
+// el vDSO sin llamada al sistema. Las marcas se acumulan en una estructura
+// del hilo que despacha y, al terminar, cada fase se suma al histograma log2
+// de su vector con atómicos relajados. Desactivado, cada marca es una lectura
+// de una variable del hilo. Los despachos que acaban antes de la ISR
+// (enmascarados, sin handler, delegados...) no se cuentan.
+
+#define IRQ_PROFILE_BUCKETS 32              // Histograma log2 en ns
+
+typedef enum {
+    IRQ_PROFILE_VALIDATE,                   // Validación del número de IRQ
+    IRQ_PROFILE_LOCK,                       // Espera por idt_mutex
+    IRQ_PROFILE_CHECK,                      // Tormenta, hilo, estado, corrutina
+    IRQ_PROFILE_TRACE,                      // Las seis emisiones de traza
+    IRQ_PROFILE_STATE,                      // Paso a EJECUTANDO y mensaje de la ISR
+    IRQ_PROFILE_HANDLER,                    // La ISR
+    IRQ_PROFILE_RELOCK,                     // idt_mutex otra vez al terminar
+    IRQ_PROFILE_STATS,                      // Contadores, presupuesto, shm, update_stats
+    IRQ_PROFILE_PHASES
+} irq_profile_phase_t;
+
+typedef struct {
+    unsigned long count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t hist[IRQ_PROFILE_BUCKETS];     // hist[b]: duraciones < 2^b ns
+} irq_profile_hist_t;
+
+typedef struct {
+    unsigned long dispatches;
+    irq_profile_hist_t total;               // Despacho completo
+    irq_profile_hist_t phases[IRQ_PROFILE_PHASES];
+} irq_profile_stats_t;
+
+// Activar calibra el coste de una lectura del reloj
+void irq_profile_enable(int enabled);
+int irq_profile_is_enabled(void);
+void irq_profile_reset(void);
+// ns que cuesta cada marca (medido al activar)
+double irq_profile_clock_cost_ns(void);
+
+// Instrumentación de dispatch_interrupt()
+void irq_profile_begin(int irq_num);
+void irq_profile_mark(irq_profile_phase_t phase);
+void irq_profile_end(void);
+// El despacho acabó antes de la ISR: se descarta sin contarlo
+void irq_profile_discard(void);
+
+// Histogramas log2 con atómicos relajados (también los usa irq_rt)
+void irq_profile_hist_add(irq_profile_hist_t *h, uint64_t ns);
+void irq_profile_hist_load(const irq_profile_hist_t *h, irq_profile_hist_t *out);
+void irq_profile_hist_clear(irq_profile_hist_t *h);
+
+int irq_profile_get_stats(int irq_num, irq_profile_stats_t *out);
+// Cota superior del percentil q (0-1) según el histograma
+uint64_t irq_profile_percentile(const irq_profile_hist_t *h, double q);
+// Fase fuera de la ISR que más tiempo se lleva (-1 sin datos)
+int irq_profile_top_overhead(const irq_profile_stats_t *st);
+const char *irq_profile_phase_name(int phase);
+
+void show_profile(void);
+void profile_submenu(void);
+
+#endif // IRQ_PROFILE_H
@@ -0,0 +1,26 @@
+#define _GNU_SOURCE
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "irq_rand.h"
+
+static __thread irq_rand_t thread_state;
+static __thread int thread_seeded = 0;
+
+uint64_t irq_rand_clock_seed(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    uint64_t seed = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    seed ^= (uint64_t)getpid() << 32;
+    seed ^= (uint64_t)(uintptr_t)&thread_state;     // Distinto en cada hilo
+    // Una vuelta de splitmix para que semillas cercanas no se parezcan
+    return irq_rand_splitmix64(&seed);
+}
+
+irq_rand_t *irq_rand_thread(void) {
+    if (!thread_seeded) {
+        irq_rand_seed(&thread_state, irq_rand_clock_seed());
+        thread_seeded = 1;
+    }
+    return &thread_state;
+}
@@ -0,0 +1,73 @@
+#ifndef IRQ_RAND_H
+#define IRQ_RAND_H
+
+#include <stdint.h>
+
+// Generador pseudoaleatorio por hilo (xoshiro256**)
+//
+// Sustituye a rand()/srand(), que comparten un único estado global entre
+// hilos y no permiten reproducir una ejecución concreta. Cada usuario lleva
+// su propio irq_rand_t sembrado explícitamente: la misma semilla da siempre
+// la misma secuencia, en cualquier hilo o proceso. La semilla se expande con
+// splitmix64, así que semillas consecutivas (0, 1, 2...) dan secuencias
+// independientes. irq_rand_thread() ofrece un estado por hilo ya sembrado
+// para quien no necesita reproducibilidad.
+
+typedef struct {
+    uint64_t s[4];
+} irq_rand_t;
+
+static inline uint64_t irq_rand_splitmix64(uint64_t *x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static inline void irq_rand_seed(irq_rand_t *r, uint64_t seed) {
+    for (int i = 0; i < 4; i++) {
+        r->s[i] = irq_rand_splitmix64(&seed);
+    }
+}
+
+static inline uint64_t irq_rand_rotl(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t irq_rand_next(irq_rand_t *r) {
+    uint64_t *s = r->s;
+    uint64_t result = irq_rand_rotl(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = irq_rand_rotl(s[3], 45);
+    return result;
+}
+
+// Entero uniforme en [0, n) sin el sesgo del módulo (Lemire)
+static inline uint32_t irq_rand_below(irq_rand_t *r, uint32_t n) {
+    uint64_t m = (irq_rand_next(r) >> 32) * (uint64_t)n;
+    if ((uint32_t)m < n) {
+        uint32_t threshold = (uint32_t)-n % n;
+        while ((uint32_t)m < threshold) {
+            m = (irq_rand_next(r) >> 32) * (uint64_t)n;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+// Uniforme en [0, 1)
+static inline double irq_rand_double(irq_rand_t *r) {
+    return (double)(irq_rand_next(r) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Semilla de reloj, PID e hilo para ejecuciones no reproducibles
+uint64_t irq_rand_clock_seed(void);
+
+// Estado del hilo que llama, sembrado con irq_rand_clock_seed() la primera vez
+irq_rand_t *irq_rand_thread(void);
+
+#endif // IRQ_RAND_H
@@ -0,0 +1,482 @@
+#define _GNU_SOURCE
+#include "irq_replay.h"
+#include "irq_tracefile.h"
+#include "irq_rt.h"
+
+#define REPLAY_MAX_SLEEP_NS 100000000ULL   // Trozos de espera para atender STOP
+#define REPLAY_SPIN_NS 100000ULL            // El final de la espera se hace activo
+
+static __thread irq_replay_source_t current_source = IRQ_REPLAY_SRC_OTHER;
+
+static const char *source_names[IRQ_REPLAY_SOURCES] = {
+    "other", "menu", "timer", "ctl", "inject", "fd", "device", "test", "replay", "loadgen"
+};
+
+// Grabación
+static pthread_mutex_t record_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int recording = 0;
+static FILE *record_file = NULL;
+static uint64_t record_start_ns = 0;
+static uint64_t record_last_ns = 0;
+static irq_record_stats_t record_stats;
+
+// Reproducción
+static pthread_mutex_t replay_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t replay_ctl_mutex = PTHREAD_MUTEX_INITIALIZER;  // START/STOP
+static pthread_t replay_thread;
+static int replay_joinable = 0;
+static int replay_running = 0;
+static uint8_t *replay_data = NULL;
+static size_t replay_len = 0;
+static uint64_t replay_started_ns = 0;
+static uint64_t replay_finished_ns = 0;
+static double replay_lag_total_us = 0.0;
+static irq_replay_stats_t replay_stats;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void put_u32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void put_u64(uint8_t *out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint32_t get_u32(const uint8_t *in) {
+    uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+static uint64_t get_u64(const uint8_t *in) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) {
+        value = (value << 8) | in[i];
+    }
+    return value;
+}
+
+// Cabecera: magic, versión, eventos y duración (se reescribe al parar)
+static void build_header(uint8_t *out, uint64_t events, uint64_t duration_ns) {
+    put_u32(out, IRQ_REPLAY_MAGIC);
+    out[4] = IRQ_REPLAY_VERSION;
+    out[5] = out[6] = out[7] = 0;
+    put_u64(out + 8, events);
+    put_u64(out + 16, duration_ns);
+}
+
+void irq_replay_set_source(irq_replay_source_t source) {
+    current_source = source;
+}
+
+irq_replay_source_t irq_replay_get_source(void) {
+    return current_source;
+}
+
+const char *irq_replay_source_name(int source) {
+    return source >= 0 && source < IRQ_REPLAY_SOURCES ? source_names[source] : "?";
+}
+
+// ---- Grabación ----
+
+void irq_record_raise(int irq_num) {
+    if (!__atomic_load_n(&recording, __ATOMIC_RELAXED)) {
+        return;
+    }
+    uint8_t event[24];
+    pthread_mutex_lock(&record_mutex);
+    if (!recording) {
+        pthread_mutex_unlock(&record_mutex);
+        return;
+    }
+    // El reloj se lee con el cerrojo tomado: los deltas nunca son negativos
+    uint64_t now = now_ns();
+    size_t len = irq_tracefile_put_varint(event, now - record_last_ns);
+    len += irq_tracefile_put_varint(event + len,
+                                    ((uint64_t)(irq_num >= -1 ? irq_num + 1 : 0) << 4) | current_source);
+    record_last_ns = now;
+    if (fwrite(event, 1, len, record_file) == len) {
+        record_stats.events++;
+        record_stats.by_source[current_source]++;
+        record_stats.bytes += len;
+    }
+    pthread_mutex_unlock(&record_mutex);
+}
+
+int irq_record_start(const char *path) {
+    uint8_t header[IRQ_REPLAY_HEADER_SIZE];
+
+    if (path == NULL || path[0] == '\0' || strlen(path) >= sizeof(record_stats.path)) {
+        return ERROR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&record_mutex);
+    if (recording) {
+        pthread_mutex_unlock(&record_mutex);
+        return ERROR_REPLAY;
+    }
+    record_file = fopen(path, "wb");
+    build_header(header, 0, 0);
+    if (record_file == NULL || fwrite(header, 1, sizeof(header), record_file) != sizeof(header)) {
+        if (record_file != NULL) {
+            fclose(record_file);
+            record_file = NULL;
+        }
+        pthread_mutex_unlock(&record_mutex);
+        return ERROR_REPLAY;
+    }
+    memset(&record_stats, 0, sizeof(record_stats));
+    snprintf(record_stats.path, sizeof(record_stats.path), "%s", path);
+    record_stats.bytes = sizeof(header);
+    record_start_ns = record_last_ns = now_ns();
+    __atomic_store_n(&recording, 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&record_mutex);
+
+    add_trace_with_irqf(-1, "🎬 Grabación de la carga iniciada en %s", path);
+    return SUCCESS;
+}
+
+int irq_record_stop(void) {
+    uint8_t header[IRQ_REPLAY_HEADER_SIZE];
+
+    pthread_mutex_lock(&record_mutex);
+    if (!recording) {
+        pthread_mutex_unlock(&record_mutex);
+        return ERROR_REPLAY;
+    }
+    __atomic_store_n(&recording, 0, __ATOMIC_RELAXED);
+    record_stats.elapsed_s = (now_ns() - record_start_ns) / 1e9;
+
+    // La duración llega hasta el último evento, no hasta la parada
+    build_header(header, record_stats.events, record_last_ns - record_start_ns);
+    int ok = fseek(record_file, 0, SEEK_SET) == 0 &&
+             fwrite(header, 1, sizeof(header), record_file) == sizeof(header);
+    ok = fclose(record_file) == 0 && ok;
+    record_file = NULL;
+    unsigned long events = record_stats.events;
+    pthread_mutex_unlock(&record_mutex);
+
+    add_trace_with_irqf(-1, "🎬 Grabación detenida: %lu interrupciones", events);
+    return ok ? SUCCESS : ERROR_REPLAY;
+}
+
+void irq_record_get_stats(irq_record_stats_t *out) {
+    pthread_mutex_lock(&record_mutex);
+    *out = record_stats;
+    out->recording = recording;
+    if (recording) {
+        out->elapsed_s = (now_ns() - record_start_ns) / 1e9;
+    }
+    pthread_mutex_unlock(&record_mutex);
+}
+
+// ---- Reproducción ----
+
+// Esperar hasta target (CLOCK_MONOTONIC absoluto); 0 si se pidió parar.
+// El despertar del núcleo llega tarde unas decenas de μs: los últimos
+// REPLAY_SPIN_NS se esperan sin dormir.
+static int sleep_until(uint64_t target) {
+    while (__atomic_load_n(&replay_running, __ATOMIC_ACQUIRE)) {
+        uint64_t now = now_ns();
+        if (now >= target) {
+            return 1;
+        }
+        if (target - now <= REPLAY_SPIN_NS) {
+            continue;
+        }
+        uint64_t wake = target - now - REPLAY_SPIN_NS > REPLAY_MAX_SLEEP_NS ?
+                        now + REPLAY_MAX_SLEEP_NS : target - REPLAY_SPIN_NS;
+        struct timespec ts = { (time_t)(wake / 1000000000ULL), (long)(wake % 1000000000ULL) };
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+    }
+    return 0;
+}
+
+static void *replay_thread_func(void *arg) {
+    (void)arg;
+    size_t pos = IRQ_REPLAY_HEADER_SIZE;
+    uint64_t at = 0;
+
+    irq_rt_enter_thread();
+    irq_replay_set_source(IRQ_REPLAY_SRC_REPLAY);
+    pthread_mutex_lock(&replay_mutex);
+    double speed = replay_stats.speed;
+    uint64_t start = replay_started_ns;
+    pthread_mutex_unlock(&replay_mutex);
+
+    while (pos < replay_len && __atomic_load_n(&replay_running, __ATOMIC_ACQUIRE)) {
+        uint64_t delta, code;
+        size_t n = irq_tracefile_get_varint(replay_data + pos, replay_len - pos, &delta);
+        size_t m = n > 0 ? irq_tracefile_get_varint(replay_data + pos + n, replay_len - pos - n, &code) : 0;
+        if (m == 0) {
+            break;                          // Grabación truncada
+        }
+        pos += n + m;
+        at += delta;
+
+        double lag_us = 0.0;
+        if (speed > 0) {
+            uint64_t target = start + (uint64_t)((double)at / speed);
+            if (!sleep_until(target)) {
+                break;
+            }
+            lag_us = (now_ns() - target) / 1e3;
+        }
+        dispatch_interrupt((int)(code >> 4) - 1);
+
+        pthread_mutex_lock(&replay_mutex);
+        replay_stats.replayed++;
+        replay_lag_total_us += lag_us;
+        if (lag_us > replay_stats.max_lag_us) {
+            replay_stats.max_lag_us = lag_us;
+        }
+        pthread_mutex_unlock(&replay_mutex);
+    }
+
+    pthread_mutex_lock(&replay_mutex);
+    replay_finished_ns = now_ns();
+    replay_stats.active = 0;
+    unsigned long replayed = replay_stats.replayed;
+    pthread_mutex_unlock(&replay_mutex);
+    add_trace_with_irqf(-1, "▶️  Reproducción terminada: %lu interrupciones", replayed);
+    return NULL;
+}
+
+// Esperar al hilo anterior y liberar su grabación (con replay_ctl_mutex)
+static void replay_join(void) {
+    if (replay_joinable) {
+        __atomic_store_n(&replay_running, 0, __ATOMIC_RELEASE);
+        pthread_join(replay_thread, NULL);
+        replay_joinable = 0;
+    }
+    free(replay_data);
+    replay_data = NULL;
+    replay_len = 0;
+}
+
+// Cargar el fichero entero: los eventos ocupan pocos bytes
+static int load_recording(const char *path, uint8_t **data, size_t *len) {
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        return ERROR_REPLAY;
+    }
+    long size = fseek(f, 0, SEEK_END) == 0 ? ftell(f) : -1;
+    uint8_t *buffer = size >= IRQ_REPLAY_HEADER_SIZE ? malloc((size_t)size) : NULL;
+    int ok = buffer != NULL && fseek(f, 0, SEEK_SET) == 0 &&
+             fread(buffer, 1, (size_t)size, f) == (size_t)size &&
+             get_u32(buffer) == IRQ_REPLAY_MAGIC && buffer[4] == IRQ_REPLAY_VERSION;
+    fclose(f);
+    if (!ok) {
+        free(buffer);
+        return ERROR_REPLAY;
+    }
+    *data = buffer;
+    *len = (size_t)size;
+    return SUCCESS;
+}
+
+int irq_replay_start(const char *path, double speed) {
+    uint8_t *data;
+    size_t len;
+
+    if (path == NULL || strlen(path) >= sizeof(replay_stats.path) || speed < 0) {
+        return ERROR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&replay_ctl_mutex);
+    pthread_mutex_lock(&replay_mutex);
+    int busy = replay_stats.active;
+    pthread_mutex_unlock(&replay_mutex);
+    if (busy || load_recording(path, &data, &len) != SUCCESS) {
+        pthread_mutex_unlock(&replay_ctl_mutex);
+        return ERROR_REPLAY;
+    }
+    replay_join();
+
+    pthread_mutex_lock(&replay_mutex);
+    replay_data = data;
+    replay_len = len;
+    memset(&replay_stats, 0, sizeof(replay_stats));
+    snprintf(replay_stats.path, sizeof(replay_stats.path), "%s", path);
+    replay_stats.speed = speed;
+    replay_stats.events = (unsigned long)get_u64(data + 8);
+    replay_stats.recorded_s = get_u64(data + 16) / 1e9;
+    replay_stats.active = 1;
+    replay_lag_total_us = 0.0;
+    replay_started_ns = now_ns();
+    replay_finished_ns = 0;
+    pthread_mutex_unlock(&replay_mutex);
+
+    __atomic_store_n(&replay_running, 1, __ATOMIC_RELEASE);
+    if (pthread_create(&replay_thread, NULL, replay_thread_func, NULL) != 0) {
+        __atomic_store_n(&replay_running, 0, __ATOMIC_RELEASE);
+        pthread_mutex_lock(&replay_mutex);
+        replay_stats.active = 0;
+        pthread_mutex_unlock(&replay_mutex);
+        replay_join();
+        pthread_mutex_unlock(&replay_ctl_mutex);
+        return ERROR_REPLAY;
+    }
+    replay_joinable = 1;
+    pthread_mutex_unlock(&replay_ctl_mutex);
+    if (speed > 0) {
+        add_trace_with_irqf(-1, "▶️  Reproduciendo %s a velocidad x%.2f", path, speed);
+    } else {
+        add_trace_with_irqf(-1, "▶️  Reproduciendo %s lo más rápido posible", path);
+    }
+    return SUCCESS;
+}
+
+int irq_replay_stop(void) {
+    pthread_mutex_lock(&replay_ctl_mutex);
+    int result = replay_joinable ? SUCCESS : ERROR_REPLAY;
+    replay_join();
+    pthread_mutex_unlock(&replay_ctl_mutex);
+    return result;
+}
+
+void irq_replay_get_stats(irq_replay_stats_t *out) {
+    pthread_mutex_lock(&replay_mutex);
+    *out = replay_stats;
+    uint64_t end = replay_stats.active || replay_finished_ns == 0 ? now_ns() : replay_finished_ns;
+    out->elapsed_s = replay_started_ns != 0 ? (end - replay_started_ns) / 1e9 : 0.0;
+    out->rate = out->elapsed_s > 0 ? replay_stats.replayed / out->elapsed_s : 0.0;
+    out->avg_lag_us = replay_stats.replayed > 0 ? replay_lag_total_us / replay_stats.replayed : 0.0;
+    pthread_mutex_unlock(&replay_mutex);
+}
+
+void irq_replay_shutdown(void) {
+    irq_replay_stop();
+    pthread_mutex_lock(&record_mutex);
+    int active = recording;
+    pthread_mutex_unlock(&record_mutex);
+    if (active) {
+        irq_record_stop();
+    }
+}
+
+void show_replay(void) {
+    irq_record_stats_t rec;
+    irq_replay_stats_t rep;
+    irq_record_get_stats(&rec);
+    irq_replay_get_stats(&rep);
+
+    printf("\n=== GRABACIÓN Y REPRODUCCIÓN ===\n");
+    if (rec.path[0] != '\0') {
+        printf("Grabación: %s │ %s │ %lu interrupciones en %.1f s │ %lu bytes (%.2f bytes/evento)\n",
+               rec.path, rec.recording ? "GRABANDO" : "detenida", rec.events, rec.elapsed_s,
+               (unsigned long)rec.bytes,
+               rec.events > 0 ? (double)(rec.bytes - IRQ_REPLAY_HEADER_SIZE) / rec.events : 0.0);
+        printf("  Fuentes:");
+        for (int s = 0; s < IRQ_REPLAY_SOURCES; s++) {
+            if (rec.by_source[s] > 0) {
+                printf(" %s=%lu", source_names[s], rec.by_source[s]);
+            }
+        }
+        printf("\n");
+    } else {
+        printf("Grabación: ninguna\n");
+    }
+    if (rep.path[0] != '\0') {
+        if (rep.speed > 0) {
+            printf("Reproducción: %s │ %s │ velocidad x%.2f\n", rep.path,
+                   rep.active ? "EN CURSO" : "terminada", rep.speed);
+        } else {
+            printf("Reproducción: %s │ %s │ lo más rápido posible\n", rep.path,
+                   rep.active ? "EN CURSO" : "terminada");
+        }
+        printf("  %lu/%lu interrupciones │ %.2f s (grabadas en %.2f s) │ %.0f IRQ/s\n",
+               rep.replayed, rep.events, rep.elapsed_s, rep.recorded_s, rep.rate);
+        if (rep.speed > 0) {
+            printf("  Retraso respecto al plan: medio %.1f μs │ máximo %.1f μs\n",
+                   rep.avg_lag_us, rep.max_lag_us);
+        }
+    } else {
+        printf("Reproducción: ninguna\n");
+    }
+    printf("\n");
+}
+
+// Leer una línea de texto sin el salto final
+static int read_line(const char *prompt, char *buf, size_t size) {
+    printf("%s", prompt);
+    fflush(stdout);
+    if (fgets(buf, (int)size, stdin) == NULL) {
+        return 0;
+    }
+    buf[strcspn(buf, "\n")] = '\0';
+    return buf[0] != '\0';
+}
+
+void replay_submenu(void) {
+    char path[256];
+    int option;
+
+    while (1) {
+        printf("\n=== GRABACIÓN Y REPRODUCCIÓN DE CARGAS ===\n");
+        printf("1. Mostrar estado\n");
+        printf("2. Iniciar grabación\n");
+        printf("3. Detener grabación\n");
+        printf("4. Reproducir grabación\n");
+        printf("5. Detener reproducción\n");
+        printf("0. Volver\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+
+        option = get_valid_input(0, 5);
+        switch (option) {
+            case 0:
+                return;
+            case 1:
+                show_replay();
+                break;
+            case 2:
+                if (!read_line("Fichero de grabación: ", path, sizeof(path))) {
+                    break;
+                }
+                if (irq_record_start(path) == SUCCESS) {
+                    printf("✓ Grabando en %s.\n", path);
+                } else {
+                    printf("✗ No se pudo grabar en %s (¿ya hay una grabación?).\n", path);
+                }
+                break;
+            case 3:
+                if (irq_record_stop() == SUCCESS) {
+                    show_replay();
+                } else {
+                    printf("✗ No hay ninguna grabación activa.\n");
+                }
+                break;
+            case 4: {
+                if (!read_line("Fichero a reproducir: ", path, sizeof(path))) {
+                    break;
+                }
+                printf("Velocidad en %% (100 = tiempos originales, 0 = lo más rápido posible): ");
+                fflush(stdout);
+                int percent = get_valid_input(0, 100000);
+                if (irq_replay_start(path, percent / 100.0) == SUCCESS) {
+                    printf("✓ Reproduciendo %s.\n", path);
+                } else {
+                    printf("✗ No se pudo reproducir %s (¿existe? ¿otra reproducción en curso?).\n", path);
+                }
+                break;
+            }
+            case 5:
+                if (irq_replay_stop() == SUCCESS) {
+                    show_replay();
+                } else {
+                    printf("✗ No hay ninguna reproducción.\n");
+                }
+                break;
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef IRQ_REPLAY_H
+#define IRQ_REPLAY_H
+
+#include <stdint.h>
+#include "interrupt_simulator.h"
+
+// Grabación y reproducción de cargas de interrupciones
+//
+// Mientras se graba, cada llamada a dispatch_interrupt() añade al fichero el
+// vector, el tiempo desde el evento anterior y la fuente que lo generó (la
+// fija cada hilo al arrancar: timer, plano de control, inyección, fuentes fd,
+// dispositivos...). Los eventos son varints: 3-5 bytes por interrupción. El
+// reproductor vuelve a despachar la grabación desde un hilo propio, con los
+// tiempos originales, escalados (speed = 2 va el doble de rápido) o lo más
+// rápido posible (speed = 0) para comparar el rendimiento de dos versiones
+// con exactamente la misma carga. La espera es absoluta (clock_nanosleep),
+// así que los retrasos no se acumulan.
+
+#define IRQ_REPLAY_MAGIC 0x52515249u        // "IRQR"
+#define IRQ_REPLAY_VERSION 1
+#define IRQ_REPLAY_HEADER_SIZE 24
+
+typedef enum {
+    IRQ_REPLAY_SRC_OTHER,
+    IRQ_REPLAY_SRC_MENU,
+    IRQ_REPLAY_SRC_TIMER,
+    IRQ_REPLAY_SRC_CTL,
+    IRQ_REPLAY_SRC_INJECT,
+    IRQ_REPLAY_SRC_FD,
+    IRQ_REPLAY_SRC_DEVICE,
+    IRQ_REPLAY_SRC_TEST,
+    IRQ_REPLAY_SRC_REPLAY,
+    IRQ_REPLAY_SRC_LOADGEN,
+    IRQ_REPLAY_SOURCES
+} irq_replay_source_t;
+
+typedef struct {
+    int recording;
+    char path[256];
+    unsigned long events;
+    unsigned long by_source[IRQ_REPLAY_SOURCES];
+    uint64_t bytes;                         // Tamaño del fichero (con cabecera)
+    double elapsed_s;
+} irq_record_stats_t;
+
+typedef struct {
+    int active;
+    char path[256];
+    double speed;                           // 0 = lo más rápido posible
+    unsigned long events;                   // Eventos del fichero
+    unsigned long replayed;
+    double recorded_s;                      // Duración de la grabación
+    double elapsed_s;
+    double rate;                            // Interrupciones por segundo
+    double avg_lag_us;                      // Retraso medio respecto al plan
+    double max_lag_us;
+} irq_replay_stats_t;
+
+// Fuente de los despachos que haga el hilo que llama
+void irq_replay_set_source(irq_replay_source_t source);
+irq_replay_source_t irq_replay_get_source(void);
+const char *irq_replay_source_name(int source);
+
+// Llamada por dispatch_interrupt(); sin grabación es una lectura atómica
+void irq_record_raise(int irq_num);
+
+int irq_record_start(const char *path);
+int irq_record_stop(void);
+void irq_record_get_stats(irq_record_stats_t *out);
+
+// speed > 0 escala los tiempos; 0 = sin esperas
+int irq_replay_start(const char *path, double speed);
+int irq_replay_stop(void);
+void irq_replay_get_stats(irq_replay_stats_t *out);
+
+void irq_replay_shutdown(void);
+
+void show_replay(void);
+void replay_submenu(void);
+
+#endif // IRQ_REPLAY_H
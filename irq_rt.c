@@ -0,0 +1,473 @@
+#define _GNU_SOURCE
+#include <malloc.h>
+#include <sys/mman.h>
+#include "irq_rt.h"
+
+#define RT_PAGE_SIZE 4096
+#define RT_JITTER_VECTOR 2                  // En la máquina propia de la medida
+
+static irq_rt_config_t rt_config;
+static int rt_enabled = 0;
+static int rt_memory_locked = 0;
+static int rt_lock_errno = 0;
+static unsigned long rt_threads = 0;
+static unsigned long rt_fifo_threads = 0;
+static unsigned long rt_pinned_threads = 0;
+static int rt_sched_errno = 0;
+static int rt_affinity_errno = 0;
+static unsigned long rt_timer_ticks = 0;
+static unsigned long rt_timer_overruns = 0;
+static irq_profile_hist_t rt_timer_wakeup;
+static irq_profile_hist_t rt_timer_dispatch;
+static int jitter_busy = 0;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_until_ns(uint64_t deadline) {
+    struct timespec ts = { (time_t)(deadline / 1000000000ULL), (long)(deadline % 1000000000ULL) };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+}
+
+// Tocar la pila ahora para no pagar los fallos de página en el despacho
+static __attribute__((noinline)) void prefault_stack(void) {
+    volatile char stack[IRQ_RT_STACK_PREFAULT];
+    for (size_t i = 0; i < sizeof(stack); i += RT_PAGE_SIZE) {
+        stack[i] = 0;
+    }
+}
+
+// Sin recortes ni mmap, lo que se toca aquí se queda en el heap del proceso
+static void prefault_heap(void) {
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    volatile char *reserve = malloc(IRQ_RT_HEAP_PREFAULT);
+    if (reserve == NULL) {
+        return;
+    }
+    for (size_t i = 0; i < IRQ_RT_HEAP_PREFAULT; i += RT_PAGE_SIZE) {
+        reserve[i] = 0;
+    }
+    free((void *)reserve);
+}
+
+// mlockall puede aceptar MCL_FUTURE con lo que ya está mapeado y dejar que
+// falle la pila de cada hilo nuevo (RLIMIT_MEMLOCK): se prueba con una del
+// tamaño por defecto antes de dar la memoria por bloqueada
+static int probe_future_lock(void) {
+    pthread_attr_t attr;
+    size_t stack_size = 0;
+
+    pthread_attr_init(&attr);
+    pthread_attr_getstacksize(&attr, &stack_size);
+    pthread_attr_destroy(&attr);
+    void *probe = mmap(NULL, stack_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (probe == MAP_FAILED) {
+        return -1;
+    }
+    munmap(probe, stack_size);
+    return 0;
+}
+
+static int parse_cpus(const char *list, uint64_t *mask) {
+    char *end;
+    *mask = 0;
+    while (*list != '\0') {
+        long first = strtol(list, &end, 10), last = first;
+        if (end == list) {
+            return 0;
+        }
+        if (*end == '-') {
+            list = end + 1;
+            last = strtol(list, &end, 10);
+            if (end == list) {
+                return 0;
+            }
+        }
+        if (first < 0 || last < first || last >= IRQ_RT_MAX_CPUS) {
+            return 0;
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            *mask |= 1ULL << cpu;
+        }
+        if (*end == ',') {
+            end++;
+        } else if (*end != '\0') {
+            return 0;
+        }
+        list = end;
+    }
+    return *mask != 0;
+}
+
+int irq_rt_parse(const char *spec, irq_rt_config_t *out) {
+    char buf[256];
+    char *saveptr = NULL;
+
+    memset(out, 0, sizeof(*out));
+    out->priority = IRQ_RT_DEFAULT_PRIORITY;
+    if (spec == NULL || strlen(spec) >= sizeof(buf)) {
+        return ERROR_INVALID_ARG;
+    }
+    snprintf(buf, sizeof(buf), "%s", spec);
+    for (char *tok = strtok_r(buf, " \t", &saveptr); tok != NULL; tok = strtok_r(NULL, " \t", &saveptr)) {
+        char *end = NULL;
+        if (strncmp(tok, "cpus=", 5) == 0) {
+            if (!parse_cpus(tok + 5, &out->cpu_mask)) {
+                return ERROR_INVALID_ARG;
+            }
+        } else if (strncmp(tok, "prio=", 5) == 0) {
+            long prio = strtol(tok + 5, &end, 10);
+            if (end == tok + 5 || *end != '\0' || prio < 0 || prio > 99) {
+                return ERROR_INVALID_ARG;
+            }
+            out->priority = (int)prio;
+        } else if (strcmp(tok, "lock") == 0) {
+            out->lock_memory = 1;
+        } else {
+            return ERROR_INVALID_ARG;
+        }
+    }
+    return SUCCESS;
+}
+
+int irq_rt_enable(const irq_rt_config_t *config) {
+    if (__atomic_load_n(&rt_enabled, __ATOMIC_ACQUIRE)) {
+        return ERROR_INVALID_ARG;
+    }
+    rt_config = *config;
+    if (config->lock_memory) {
+        // Sin CAP_IPC_LOCK y con RLIMIT_MEMLOCK pequeño falla: se sigue sin bloquear
+        if (mlockall(MCL_CURRENT | MCL_FUTURE) == 0) {
+            if (probe_future_lock() == 0) {
+                rt_memory_locked = 1;
+            } else {
+                rt_lock_errno = errno;
+                munlockall();
+            }
+        } else {
+            rt_lock_errno = errno;
+        }
+        prefault_heap();
+        prefault_stack();
+    }
+    __atomic_store_n(&rt_enabled, 1, __ATOMIC_RELEASE);
+    return SUCCESS;
+}
+
+int irq_rt_take_args(int *argc, char ***argv) {
+    irq_rt_config_t config;
+
+    if (*argc < 2 || strcmp((*argv)[1], "--rt") != 0) {
+        return SUCCESS;
+    }
+    if (*argc < 3 || irq_rt_parse((*argv)[2], &config) != SUCCESS) {
+        fprintf(stderr, "Uso: %s --rt \"[cpus=0,2-3] [prio=1-99] [lock]\" ...\n", (*argv)[0]);
+        return ERROR_INVALID_ARG;
+    }
+    irq_rt_enable(&config);
+    // El resto de opciones ve la línea sin --rt SPEC
+    (*argv)[2] = (*argv)[0];
+    *argv += 2;
+    *argc -= 2;
+    return SUCCESS;
+}
+
+int irq_rt_is_enabled(void) {
+    return __atomic_load_n(&rt_enabled, __ATOMIC_ACQUIRE);
+}
+
+void irq_rt_describe(char *buf, size_t size) {
+    char cpus[IRQ_RT_MAX_CPUS * 4] = "todas";
+    size_t used = 0;
+
+    if (rt_config.cpu_mask != 0) {
+        for (int cpu = 0; cpu < IRQ_RT_MAX_CPUS && used < sizeof(cpus) - 4; cpu++) {
+            if (rt_config.cpu_mask & (1ULL << cpu)) {
+                used += (size_t)snprintf(cpus + used, sizeof(cpus) - used, "%s%d", used > 0 ? "," : "", cpu);
+            }
+        }
+    }
+    snprintf(buf, size, "CPUs %s │ %s │ memoria %s", cpus,
+             rt_config.priority > 0 ? "SCHED_FIFO" : "SCHED_OTHER",
+             !rt_config.lock_memory ? "sin bloquear" :
+             rt_memory_locked ? "bloqueada (mlockall)" : "sin bloquear (mlockall denegado)");
+    if (rt_config.priority > 0) {
+        size_t len = strlen(buf);
+        snprintf(buf + len, size - len, " │ prioridad %d", rt_config.priority);
+    }
+}
+
+void irq_rt_enter_thread(void) {
+    if (!__atomic_load_n(&rt_enabled, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    __atomic_fetch_add(&rt_threads, 1, __ATOMIC_RELAXED);
+
+    if (rt_config.cpu_mask != 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu = 0; cpu < IRQ_RT_MAX_CPUS; cpu++) {
+            if (rt_config.cpu_mask & (1ULL << cpu)) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        int rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (rc == 0) {
+            __atomic_fetch_add(&rt_pinned_threads, 1, __ATOMIC_RELAXED);
+        } else {
+            __atomic_store_n(&rt_affinity_errno, rc, __ATOMIC_RELAXED);
+        }
+    }
+
+    // Sin privilegios (EPERM) el hilo sigue en SCHED_OTHER
+    if (rt_config.priority > 0) {
+        struct sched_param param = { .sched_priority = rt_config.priority };
+        int rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (rc == 0) {
+            __atomic_fetch_add(&rt_fifo_threads, 1, __ATOMIC_RELAXED);
+        } else {
+            __atomic_store_n(&rt_sched_errno, rc, __ATOMIC_RELAXED);
+        }
+    }
+
+    if (rt_config.lock_memory) {
+        prefault_stack();
+    }
+}
+
+void irq_rt_timer_tick(uint64_t deadline_ns, uint64_t woke_ns, uint64_t done_ns, int overrun) {
+    __atomic_fetch_add(&rt_timer_ticks, 1, __ATOMIC_RELAXED);
+    if (overrun) {
+        __atomic_fetch_add(&rt_timer_overruns, 1, __ATOMIC_RELAXED);
+    }
+    irq_profile_hist_add(&rt_timer_wakeup, woke_ns > deadline_ns ? woke_ns - deadline_ns : 0);
+    irq_profile_hist_add(&rt_timer_dispatch, done_ns - woke_ns);
+}
+
+void irq_rt_get_status(irq_rt_status_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->enabled = irq_rt_is_enabled();
+    out->config = rt_config;
+    out->memory_locked = rt_memory_locked;
+    out->lock_errno = rt_lock_errno;
+    out->threads = __atomic_load_n(&rt_threads, __ATOMIC_RELAXED);
+    out->fifo_threads = __atomic_load_n(&rt_fifo_threads, __ATOMIC_RELAXED);
+    out->pinned_threads = __atomic_load_n(&rt_pinned_threads, __ATOMIC_RELAXED);
+    out->sched_errno = __atomic_load_n(&rt_sched_errno, __ATOMIC_RELAXED);
+    out->affinity_errno = __atomic_load_n(&rt_affinity_errno, __ATOMIC_RELAXED);
+    out->timer_ticks = __atomic_load_n(&rt_timer_ticks, __ATOMIC_RELAXED);
+    out->timer_overruns = __atomic_load_n(&rt_timer_overruns, __ATOMIC_RELAXED);
+    irq_profile_hist_load(&rt_timer_wakeup, &out->timer_wakeup);
+    irq_profile_hist_load(&rt_timer_dispatch, &out->timer_dispatch);
+}
+
+void irq_rt_reset_timer_stats(void) {
+    __atomic_store_n(&rt_timer_ticks, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&rt_timer_overruns, 0, __ATOMIC_RELAXED);
+    irq_profile_hist_clear(&rt_timer_wakeup);
+    irq_profile_hist_clear(&rt_timer_dispatch);
+}
+
+static void jitter_isr(int irq_num) {
+    (void)irq_num;
+}
+
+static void *jitter_thread_func(void *arg) {
+    irq_rt_jitter_t *j = (irq_rt_jitter_t *)arg;
+    int policy;
+    struct sched_param param;
+
+    irq_rt_enter_thread();
+    pthread_getschedparam(pthread_self(), &policy, &param);
+    j->fifo = policy == SCHED_FIFO;
+
+    sim_context_t *ctx = sim_context_create();
+    if (ctx == NULL) {
+        return NULL;
+    }
+    sim_register_isr(ctx, RT_JITTER_VECTOR, jitter_isr, "Medida de jitter");
+    sim_context_enter(ctx);
+
+    uint64_t period = (uint64_t)j->period_us * 1000ULL;
+    uint64_t start = now_ns();
+    uint64_t end = start + (uint64_t)(j->seconds * 1e9);
+    uint64_t deadline = start;
+    for (;;) {
+        deadline += period;
+        sleep_until_ns(deadline);
+        uint64_t woke = now_ns();
+        dispatch_interrupt(RT_JITTER_VECTOR);
+        uint64_t done = now_ns();
+
+        irq_profile_hist_add(&j->wakeup, woke > deadline ? woke - deadline : 0);
+        irq_profile_hist_add(&j->dispatch, done - woke);
+        j->samples++;
+        // Plazos ya vencidos: se saltan en lugar de encadenar despertares
+        if (done >= deadline + period) {
+            j->overruns++;
+            deadline += (done - deadline) / period * period;
+        }
+        if (done >= end) {
+            break;
+        }
+    }
+    j->cpu = sched_getcpu();
+
+    sim_context_enter(NULL);
+    sim_context_destroy(ctx);
+    return NULL;
+}
+
+int irq_rt_measure_jitter(double seconds, int period_us, irq_rt_jitter_t *out) {
+    pthread_t thread;
+    int expected = 0;
+
+    if (seconds <= 0 || seconds > IRQ_RT_MAX_JITTER_SECONDS || period_us < 10 || period_us > 1000000) {
+        return ERROR_INVALID_ARG;
+    }
+    if (!__atomic_compare_exchange_n(&jitter_busy, &expected, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return ERROR_INVALID_ARG;
+    }
+    memset(out, 0, sizeof(*out));
+    out->seconds = seconds;
+    out->period_us = period_us;
+    out->cpu = -1;
+
+    int result = SUCCESS;
+    if (pthread_create(&thread, NULL, jitter_thread_func, out) != 0) {
+        result = ERROR_INVALID_ARG;
+    } else {
+        pthread_join(thread, NULL);
+        if (out->samples == 0) {
+            result = ERROR_INVALID_ARG;
+        }
+    }
+    __atomic_store_n(&jitter_busy, 0, __ATOMIC_RELEASE);
+    return result;
+}
+
+static void format_ns(uint64_t ns, char *buf, size_t size) {
+    if (ns < 1000) {
+        snprintf(buf, size, "%lu ns", (unsigned long)ns);
+    } else if (ns < 1000000) {
+        snprintf(buf, size, "%.1f µs", ns / 1e3);
+    } else if (ns < 1000000000ULL) {
+        snprintf(buf, size, "%.1f ms", ns / 1e6);
+    } else {
+        snprintf(buf, size, "%.2f s", ns / 1e9);
+    }
+}
+
+static void print_hist(const char *title, const irq_profile_hist_t *h) {
+    char p50[24], p99[24], max[24], avg[24];
+    uint64_t peak = 0;
+
+    if (h->count == 0) {
+        printf("%s: sin muestras\n", title);
+        return;
+    }
+    format_ns(irq_profile_percentile(h, 0.50), p50, sizeof(p50));
+    format_ns(irq_profile_percentile(h, 0.99), p99, sizeof(p99));
+    format_ns(h->max_ns, max, sizeof(max));
+    format_ns(h->total_ns / h->count, avg, sizeof(avg));
+    printf("%s: %lu muestras │ media %s │ p50 %s │ p99 %s │ máx %s\n", title, h->count, avg, p50, p99, max);
+    for (int b = 0; b < IRQ_PROFILE_BUCKETS; b++) {
+        peak = h->hist[b] > peak ? h->hist[b] : peak;
+    }
+    for (int b = 0; b < IRQ_PROFILE_BUCKETS; b++) {
+        char bound[24];
+        if (h->hist[b] == 0) {
+            continue;
+        }
+        format_ns(1ULL << b, bound, sizeof(bound));
+        int width = (int)(40 * h->hist[b] / peak);
+        printf("  < %-10s │%-40.*s│ %lu\n", bound, width > 0 ? width : 1,
+               "########################################", (unsigned long)h->hist[b]);
+    }
+}
+
+void show_rt(void) {
+    irq_rt_status_t st;
+    char desc[256];
+
+    irq_rt_get_status(&st);
+    printf("\n=== MODO TIEMPO REAL ===\n");
+    if (st.enabled) {
+        irq_rt_describe(desc, sizeof(desc));
+        printf("Activo: %s\n", desc);
+        printf("Hilos: %lu │ con SCHED_FIFO %lu │ fijados %lu\n", st.threads, st.fifo_threads,
+               st.pinned_threads);
+        if (st.sched_errno != 0) {
+            printf("⚠️  SCHED_FIFO denegado (%s): esos hilos siguen en SCHED_OTHER\n", strerror(st.sched_errno));
+        }
+        if (st.affinity_errno != 0) {
+            printf("⚠️  Afinidad no aplicada (%s)\n", strerror(st.affinity_errno));
+        }
+        if (st.config.lock_memory && !st.memory_locked) {
+            printf("⚠️  mlockall denegado (%s): sólo prefault\n", strerror(st.lock_errno));
+        }
+    } else {
+        printf("Inactivo (arranque con --rt \"cpus=N prio=80 lock\")\n");
+    }
+    printf("\nTimer (IRQ0 cada %d s): %lu ticks │ %lu plazos perdidos\n", TIMER_INTERVAL_SEC,
+           st.timer_ticks, st.timer_overruns);
+    print_hist("Despertar - plazo (ruido del SO)", &st.timer_wakeup);
+    print_hist("Despacho del tick (simulador)", &st.timer_dispatch);
+    printf("\n");
+}
+
+static void show_jitter(const irq_rt_jitter_t *j) {
+    printf("\n%lu despertares cada %d µs en %.1f s │ SCHED_FIFO: %s │ CPU %d │ %lu plazos perdidos\n",
+           j->samples, j->period_us, j->seconds, j->fifo ? "sí" : "no", j->cpu, j->overruns);
+    print_hist("Despertar - plazo (ruido del SO)", &j->wakeup);
+    print_hist("Despacho (simulador)", &j->dispatch);
+}
+
+void rt_submenu(void) {
+    int option;
+
+    while (1) {
+        printf("\n=== MODO TIEMPO REAL ===\n");
+        printf("1. Mostrar estado e histogramas del timer\n");
+        printf("2. Medir jitter (despertares periódicos + despacho)\n");
+        printf("3. Reiniciar histogramas del timer\n");
+        printf("0. Volver\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+
+        option = get_valid_input(0, 3);
+        switch (option) {
+            case 0:
+                return;
+            case 1:
+                show_rt();
+                break;
+            case 2: {
+                irq_rt_jitter_t j;
+                printf("Segundos (1-%d): ", IRQ_RT_MAX_JITTER_SECONDS);
+                fflush(stdout);
+                int seconds = get_valid_input(1, IRQ_RT_MAX_JITTER_SECONDS);
+                printf("Periodo en µs (50-100000): ");
+                fflush(stdout);
+                int period = get_valid_input(50, 100000);
+                printf("Midiendo durante %d s...\n", seconds);
+                fflush(stdout);
+                if (irq_rt_measure_jitter(seconds, period, &j) == SUCCESS) {
+                    show_jitter(&j);
+                } else {
+                    printf("✗ No se pudo medir (¿otra medida en curso?)\n");
+                }
+                break;
+            }
+            case 3:
+                irq_rt_reset_timer_stats();
+                printf("✓ Histogramas del timer reiniciados.\n");
+                break;
+        }
+    }
+}
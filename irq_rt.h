@@ -0,0 +1,93 @@
+#ifndef IRQ_RT_H
+#define IRQ_RT_H
+
+#include <stdint.h>
+#include "interrupt_simulator.h"
+#include "irq_profile.h"
+
+// Modo tiempo real: hilos fijados a CPUs, SCHED_FIFO, memoria bloqueada
+//
+// Sin este modo, el timer y los hilos que despachan (pool, corrutinas,
+// generador de carga, inyección, dispositivos, reproducción, handlers en
+// hilo) son hilos SCHED_OTHER normales, y el jitter del tick refleja el
+// ruido del host. El modo se activa al arrancar (--rt "cpus=2,3 prio=80 lock")
+// antes de crear los hilos. Después, cada uno llama a irq_rt_enter_thread()
+// al empezar:
+//   - pthread_setaffinity_np a las CPUs elegidas;
+//   - SCHED_FIFO con la prioridad pedida; sin privilegios (EPERM) sigue en
+//     SCHED_OTHER y lo cuenta;
+//   - con lock, prefault de su pila.
+// Con lock, el arranque hace mlockall(MCL_CURRENT | MCL_FUTURE), deja el
+// heap sin recortes (mallopt) y prefaulta una reserva. Si no hay permiso,
+// sigue sin bloquear y guarda el errno.
+//
+// El timer duerme hasta plazos absolutos (clock_nanosleep). Cada tick separa
+// dos cosas en histogramas log2 (irq_profile_hist_t):
+//   - el retraso del despertar respecto al plazo: ruido del SO;
+//   - el coste de despachar IRQ0: sobrecoste del simulador.
+// irq_rt_measure_jitter() hace lo mismo a alta frecuencia, en un hilo con
+// la configuración RT y una máquina propia (sim_context_create).
+
+#define IRQ_RT_MAX_CPUS 64
+#define IRQ_RT_DEFAULT_PRIORITY 80
+#define IRQ_RT_STACK_PREFAULT (256 * 1024)     // Pila tocada en cada hilo RT
+#define IRQ_RT_HEAP_PREFAULT (8 * 1024 * 1024)  // Reserva del heap tocada al activar
+#define IRQ_RT_MAX_JITTER_SECONDS 60
+
+typedef struct {
+    uint64_t cpu_mask;                      // Bit n = CPU n (0 = sin fijar)
+    int priority;                           // SCHED_FIFO 1-99 (0 = sin cambiar)
+    int lock_memory;                        // mlockall y prefault
+} irq_rt_config_t;
+
+typedef struct {
+    int enabled;
+    irq_rt_config_t config;
+    int memory_locked;                      // mlockall concedido
+    int lock_errno;                         // Por qué no (0 = concedido o no pedido)
+    unsigned long threads;                  // Hilos que entraron en modo RT
+    unsigned long fifo_threads;             // ... con SCHED_FIFO
+    unsigned long pinned_threads;           // ... con la afinidad aplicada
+    int sched_errno;                        // Último fallo de SCHED_FIFO
+    int affinity_errno;                     // Último fallo de afinidad
+    unsigned long timer_ticks;
+    unsigned long timer_overruns;           // Plazos perdidos (tick saltado)
+    irq_profile_hist_t timer_wakeup;        // Despertar del timer - plazo
+    irq_profile_hist_t timer_dispatch;      // Despacho de IRQ0 en el tick
+} irq_rt_status_t;
+
+typedef struct {
+    double seconds;
+    int period_us;
+    unsigned long samples;
+    unsigned long overruns;                 // Despertares más allá del siguiente plazo
+    int fifo;                               // El hilo de medida obtuvo SCHED_FIFO
+    int cpu;                                // CPU donde terminó
+    irq_profile_hist_t wakeup;              // Ruido del SO
+    irq_profile_hist_t dispatch;            // Coste del simulador
+} irq_rt_jitter_t;
+
+// "cpus=0,2-3 prio=80 lock" (cualquier orden; prio=0 deja SCHED_OTHER)
+int irq_rt_parse(const char *spec, irq_rt_config_t *out);
+// Activa el modo para los hilos que se creen a partir de ahora
+int irq_rt_enable(const irq_rt_config_t *config);
+// Consume --rt SPEC al principio de argv (los frontends, antes de arrancar)
+int irq_rt_take_args(int *argc, char ***argv);
+int irq_rt_is_enabled(void);
+void irq_rt_describe(char *buf, size_t size);
+
+// Al empezar cada hilo del simulador (no hace nada sin modo RT)
+void irq_rt_enter_thread(void);
+
+// Un tick del timer: plazo, despertar y fin del despacho (ns monotónicos)
+void irq_rt_timer_tick(uint64_t deadline_ns, uint64_t woke_ns, uint64_t done_ns, int overrun);
+void irq_rt_get_status(irq_rt_status_t *out);
+void irq_rt_reset_timer_stats(void);
+
+// Medida de jitter a period_us durante seconds (una a la vez)
+int irq_rt_measure_jitter(double seconds, int period_us, irq_rt_jitter_t *out);
+
+void show_rt(void);
+void rt_submenu(void);
+
+#endif // IRQ_RT_H
@@ -0,0 +1,189 @@
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "interrupt_simulator.h"
+#include "irq_shm.h"
+
+// irq_shm.h no incluye el simulador (lo usan irqtop y otros lectores)
+_Static_assert(IRQ_SHM_MAX_VECTORS == MAX_INTERRUPTS, "IRQ_SHM_MAX_VECTORS debe coincidir con MAX_INTERRUPTS");
+_Static_assert(IRQ_SHM_DESC_LEN == MAX_DESCRIPTION_LEN, "IRQ_SHM_DESC_LEN debe coincidir con MAX_DESCRIPTION_LEN");
+
+// Página compartida actual (NULL si no se ha inicializado)
+static irq_shm_page_t *shm_page = NULL;
+static int shm_is_anonymous = 0;
+static char shm_name[64] = IRQ_SHM_DEFAULT_NAME;
+
+// Crear y mapear el segmento de estadísticas compartido
+int irq_shm_init(const char *name) {
+    if (shm_page != NULL) {
+        return SUCCESS;
+    }
+
+    if (name != NULL) {
+        strncpy(shm_name, name, sizeof(shm_name) - 1);
+        shm_name[sizeof(shm_name) - 1] = '\0';
+    }
+
+    int result = SUCCESS;
+    void *mem = MAP_FAILED;
+    int fd = shm_open(shm_name, O_CREAT | O_RDWR, 0644);
+
+    if (fd >= 0) {
+        if (ftruncate(fd, sizeof(irq_shm_page_t)) == 0) {
+            mem = mmap(NULL, sizeof(irq_shm_page_t), PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+        }
+        close(fd);
+    }
+
+    // Sin /dev/shm: publicar en memoria privada para no ramificar el despacho
+    if (mem == MAP_FAILED) {
+        mem = mmap(NULL, sizeof(irq_shm_page_t), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (mem == MAP_FAILED) {
+            return ERROR_SHM;
+        }
+        shm_is_anonymous = 1;
+        result = ERROR_SHM;
+    }
+
+    irq_shm_page_t *page = (irq_shm_page_t *)mem;
+    memset(page, 0, sizeof(*page));
+    page->version = IRQ_SHM_VERSION;
+    page->num_vectors = MAX_INTERRUPTS;
+    page->num_cpus = IRQ_SHM_MAX_CPUS;
+    page->writer_pid = (int32_t)getpid();
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        page->vectors[i].state = IRQ_STATE_FREE;
+        page->vectors[i].min_execution_time = UINT64_MAX;
+    }
+
+    // El magic se publica al final: los lectores lo usan para saber que la página es válida
+    __atomic_store_n(&page->magic, IRQ_SHM_MAGIC, __ATOMIC_RELEASE);
+    shm_page = page;
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    if (shm_is_anonymous) {
+        snprintf(trace_msg, sizeof(trace_msg),
+            "⚠️  KERNEL: No se pudo crear %s - Estadísticas solo en memoria local", shm_name);
+    } else {
+        snprintf(trace_msg, sizeof(trace_msg),
+            "📡 KERNEL: Estadísticas publicadas en memoria compartida %s", shm_name);
+    }
+    add_trace_silent(trace_msg);
+
+    return result;
+}
+
+// Desmapear y eliminar el segmento compartido
+void irq_shm_shutdown(void) {
+    if (shm_page == NULL) {
+        return;
+    }
+
+    irq_shm_page_t *page = shm_page;
+    shm_page = NULL;
+    __atomic_store_n(&page->magic, 0, __ATOMIC_RELEASE);
+    munmap(page, sizeof(*page));
+
+    if (!shm_is_anonymous) {
+        shm_unlink(shm_name);
+    }
+    shm_is_anonymous = 0;
+}
+
+const char *irq_shm_get_name(void) {
+    return shm_name;
+}
+
+// Publicar el descriptor completo (registro, desregistro, restauración)
+void irq_shm_publish_descriptor(int irq, int state, unsigned long call_count,
+                                unsigned long total_execution_time, const char *description) {
+    if (shm_page == NULL || !IS_VALID_IRQ(irq)) {
+        return;
+    }
+
+    irq_shm_vector_t *v = &shm_page->vectors[irq];
+    irq_seqlock_write_begin(&v->seq);
+    v->state = state;
+    v->call_count = call_count;
+    v->total_execution_time = total_execution_time;
+    if (call_count == 0) {
+        // Vector reiniciado: descartar el histórico de latencias
+        v->min_execution_time = UINT64_MAX;
+        v->max_execution_time = 0;
+        v->last_execution_time = 0;
+        v->last_call = 0;
+        memset(v->latency_hist, 0, sizeof(v->latency_hist));
+        memset(v->cpu_count, 0, sizeof(v->cpu_count));
+    }
+    strncpy(v->description, description, sizeof(v->description) - 1);
+    v->description[sizeof(v->description) - 1] = '\0';
+    irq_seqlock_write_end(&v->seq);
+
+    __atomic_fetch_add(&shm_page->generation, 1, __ATOMIC_RELAXED);
+}
+
+// Publicar solo el cambio de estado (REGISTRADO <-> EJECUTANDO)
+void irq_shm_publish_state(int irq, int state) {
+    if (shm_page == NULL || !IS_VALID_IRQ(irq)) {
+        return;
+    }
+
+    irq_shm_vector_t *v = &shm_page->vectors[irq];
+    irq_seqlock_write_begin(&v->seq);
+    v->state = state;
+    irq_seqlock_write_end(&v->seq);
+}
+
+// Publicar el resultado de un despacho completado
+void irq_shm_publish_dispatch(int irq, int state, unsigned long call_count,
+                              unsigned long total_execution_time, unsigned long execution_time,
+                              long last_call, int cpu) {
+    if (shm_page == NULL || !IS_VALID_IRQ(irq)) {
+        return;
+    }
+
+    if (cpu < 0) {
+        cpu = 0;
+    }
+    cpu %= IRQ_SHM_MAX_CPUS;
+
+    irq_shm_vector_t *v = &shm_page->vectors[irq];
+    irq_seqlock_write_begin(&v->seq);
+    v->state = state;
+    v->call_count = call_count;
+    v->total_execution_time = total_execution_time;
+    v->last_execution_time = execution_time;
+    v->last_call = last_call;
+    if (execution_time < v->min_execution_time) {
+        v->min_execution_time = execution_time;
+    }
+    if (execution_time > v->max_execution_time) {
+        v->max_execution_time = execution_time;
+    }
+    v->latency_hist[irq_shm_latency_bucket(execution_time)]++;
+    v->cpu_count[cpu]++;
+    irq_seqlock_write_end(&v->seq);
+
+    __atomic_fetch_add(&shm_page->generation, 1, __ATOMIC_RELAXED);
+}
+
+// Publicar la copia de system_stats_t
+void irq_shm_publish_system(unsigned long total, unsigned long timer, unsigned long keyboard,
+                            unsigned long custom, double average_response_time, long start_time) {
+    if (shm_page == NULL) {
+        return;
+    }
+
+    irq_shm_system_t *s = &shm_page->system;
+    irq_seqlock_write_begin(&s->seq);
+    s->total_interrupts = total;
+    s->timer_interrupts = timer;
+    s->keyboard_interrupts = keyboard;
+    s->custom_interrupts = custom;
+    s->average_response_time = average_response_time;
+    s->system_start_time = start_time;
+    irq_seqlock_write_end(&s->seq);
+}
@@ -0,0 +1,137 @@
+#ifndef IRQ_SHM_H
+#define IRQ_SHM_H
+
+#include <stdint.h>
+#include <string.h>
+
+// Página de estadísticas en memoria compartida POSIX (estilo /proc/interrupts)
+//
+// El simulador es el único escritor. Cada vector y el bloque de estadísticas
+// globales van protegidos por su propio seqlock, de modo que lectores externos
+// (irqtop) pueden mapear la página en solo lectura y refrescarla a alta
+// frecuencia sin tomar ningún lock del simulador ni escribir en sus líneas
+// de caché.
+
+#define IRQ_SHM_DEFAULT_NAME "/irqsim_stats"
+#define IRQ_SHM_MAGIC 0x53515249u       // "IRQS"
+#define IRQ_SHM_VERSION 1
+#define IRQ_SHM_MAX_VECTORS 16          // == MAX_INTERRUPTS (comprobado en irq_shm.c)
+#define IRQ_SHM_MAX_CPUS 64
+#define IRQ_SHM_LAT_BUCKETS 32          // Buckets log2 en μs: [0,1), [1,2), [2,4)...
+#define IRQ_SHM_DESC_LEN 64             // == MAX_DESCRIPTION_LEN (comprobado en irq_shm.c)
+
+// Contadores publicados por vector
+typedef struct {
+    uint32_t seq;                               // Seqlock (impar = escritura en curso)
+    int32_t state;                              // irq_state_t del vector
+    uint64_t call_count;                        // Llamadas desde el registro
+    uint64_t total_execution_time;              // Tiempo total de ISR en μs
+    uint64_t min_execution_time;                // Latencia mínima (UINT64_MAX = sin datos)
+    uint64_t max_execution_time;                // Latencia máxima observada (μs)
+    uint64_t last_execution_time;               // Latencia de la última llamada (μs)
+    int64_t last_call;                          // time_t de la última llamada
+    uint64_t latency_hist[IRQ_SHM_LAT_BUCKETS]; // Histograma log2 de latencias
+    uint64_t cpu_count[IRQ_SHM_MAX_CPUS];       // Llamadas por CPU
+    char description[IRQ_SHM_DESC_LEN];
+} __attribute__((aligned(64))) irq_shm_vector_t;
+
+// Copia publicada de system_stats_t
+typedef struct {
+    uint32_t seq;
+    uint32_t pad;
+    uint64_t total_interrupts;
+    uint64_t timer_interrupts;
+    uint64_t keyboard_interrupts;
+    uint64_t custom_interrupts;
+    double average_response_time;
+    int64_t system_start_time;
+} __attribute__((aligned(64))) irq_shm_system_t;
+
+// Cabecera y contenido completo del segmento
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t num_vectors;
+    uint32_t num_cpus;
+    int32_t writer_pid;
+    uint32_t pad;
+    uint64_t generation;                        // Se incrementa en cada publicación
+    irq_shm_system_t system;
+    irq_shm_vector_t vectors[IRQ_SHM_MAX_VECTORS];
+} irq_shm_page_t;
+
+// Seqlock: lado escritor (los escritores deben estar serializados externamente)
+static inline void irq_seqlock_write_begin(uint32_t *seq) {
+    uint32_t s = __atomic_load_n(seq, __ATOMIC_RELAXED);
+#ifdef __SANITIZE_THREAD__
+    // ThreadSanitizer no admite barreras sueltas
+    __atomic_store_n(seq, s + 1, __ATOMIC_SEQ_CST);
+#else
+    __atomic_store_n(seq, s + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+#endif
+}
+
+static inline void irq_seqlock_write_end(uint32_t *seq) {
+    uint32_t s = __atomic_load_n(seq, __ATOMIC_RELAXED);
+    __atomic_store_n(seq, s + 1, __ATOMIC_RELEASE);
+}
+
+// Seqlock: lado lector. Devuelve el número de secuencia a validar después.
+static inline uint32_t irq_seqlock_read_begin(const uint32_t *seq) {
+    uint32_t s;
+    while ((s = __atomic_load_n(seq, __ATOMIC_ACQUIRE)) & 1u) {
+        // Escritura en curso: reintentar
+    }
+    return s;
+}
+
+static inline int irq_seqlock_read_retry(const uint32_t *seq, uint32_t start) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(seq, __ATOMIC_RELAXED) != start;
+}
+
+// Copia consistente de un vector publicado
+static inline void irq_shm_read_vector(const irq_shm_vector_t *src, irq_shm_vector_t *dst) {
+    uint32_t s;
+    do {
+        s = irq_seqlock_read_begin(&src->seq);
+        memcpy(dst, src, sizeof(*dst));
+    } while (irq_seqlock_read_retry(&src->seq, s));
+}
+
+// Copia consistente de las estadísticas globales publicadas
+static inline void irq_shm_read_system(const irq_shm_system_t *src, irq_shm_system_t *dst) {
+    uint32_t s;
+    do {
+        s = irq_seqlock_read_begin(&src->seq);
+        memcpy(dst, src, sizeof(*dst));
+    } while (irq_seqlock_read_retry(&src->seq, s));
+}
+
+// Índice del bucket log2 para una latencia en μs
+static inline int irq_shm_latency_bucket(uint64_t us) {
+    int b = 0;
+    while (us > 0 && b < IRQ_SHM_LAT_BUCKETS - 1) {
+        us >>= 1;
+        b++;
+    }
+    return b;
+}
+
+// API del escritor (implementada en irq_shm.c, solo la usa el simulador).
+// Las llamadas sobre un mismo vector deben hacerse con idt_mutex tomado y
+// las de estadísticas globales con el mutex de estadísticas tomado.
+int irq_shm_init(const char *name);
+void irq_shm_shutdown(void);
+void irq_shm_publish_descriptor(int irq, int state, unsigned long call_count,
+                                unsigned long total_execution_time, const char *description);
+void irq_shm_publish_state(int irq, int state);
+void irq_shm_publish_dispatch(int irq, int state, unsigned long call_count,
+                              unsigned long total_execution_time, unsigned long execution_time,
+                              long last_call, int cpu);
+void irq_shm_publish_system(unsigned long total, unsigned long timer, unsigned long keyboard,
+                            unsigned long custom, double average_response_time, long start_time);
+const char *irq_shm_get_name(void);
+
+#endif // IRQ_SHM_H
@@ -0,0 +1,1168 @@
+#define _GNU_SOURCE
+#include "interrupt_simulator.h"
+#include "irq_shm.h"
+#include "irq_inject.h"
+#include "irq_fd_source.h"
+#include "irq_ctl.h"
+#include "irq_plugin.h"
+#include "irq_storm.h"
+#include "irq_budget.h"
+#include "irq_coro.h"
+#include "irq_workpool.h"
+#include "irq_balance.h"
+#include "irq_msix.h"
+#include "irq_device.h"
+#include "irq_trace.h"
+#include "irq_capture.h"
+#include "irq_profile.h"
+#include "irq_replay.h"
+#include "irq_loadgen.h"
+#include "irq_rt.h"
+
+// Máquina del proceso: la del menú, el plano de control y los subsistemas
+static sim_context_t default_sim = {
+    .idt_mutex = PTHREAD_MUTEX_INITIALIZER,
+    .stats_mutex = PTHREAD_MUTEX_INITIALIZER,
+    .system_running = 1,
+    .log_level = LOG_LEVEL_USER_ONLY,  // Por defecto, solo acciones del usuario
+    .show_timer_logs = 0,              // Timer logs ocultos por defecto
+    .console = 1,
+    .is_default = 1,
+};
+
+static __thread sim_context_t *current_sim = NULL;
+
+sim_context_t *sim_default(void) {
+    return &default_sim;
+}
+
+sim_context_t *sim_current(void) {
+    return current_sim != NULL ? current_sim : &default_sim;
+}
+
+sim_context_t *sim_context_enter(sim_context_t *ctx) {
+    sim_context_t *previous = sim_current();
+    current_sim = ctx;
+    return previous;
+}
+
+sim_context_t *sim_context_create(void) {
+    sim_context_t *ctx = calloc(1, sizeof(*ctx));
+    if (ctx == NULL) {
+        return NULL;
+    }
+    ctx->trace = irq_trace_ring_create();
+    if (ctx->trace == NULL) {
+        free(ctx);
+        return NULL;
+    }
+    pthread_mutex_init(&ctx->idt_mutex, NULL);
+    pthread_mutex_init(&ctx->stats_mutex, NULL);
+    ctx->system_running = 1;
+    ctx->log_level = LOG_LEVEL_SILENT;
+
+    sim_context_t *previous = sim_context_enter(ctx);
+    init_idt();
+    init_system_stats();
+    sim_context_enter(previous);
+    return ctx;
+}
+
+void sim_context_destroy(sim_context_t *ctx) {
+    if (ctx == NULL || ctx == &default_sim) {
+        return;
+    }
+    sim_stop_timer(ctx);
+    irq_trace_ring_destroy(ctx->trace);
+    pthread_mutex_destroy(&ctx->idt_mutex);
+    pthread_mutex_destroy(&ctx->stats_mutex);
+    free(ctx);
+}
+
+
+// Función para obtener timestamp
+// localtime() vuelve a leer la zona horaria en cada llamada (y reserva memoria);
+// se formatea una vez por segundo y por hilo con localtime_r()
+void get_timestamp(char *buffer, size_t size) {
+    static __thread time_t cached_time = -1;
+    static __thread char cached[16];
+    time_t rawtime;
+    time(&rawtime);
+    if (rawtime != cached_time) {
+        struct tm timeinfo;
+        localtime_r(&rawtime, &timeinfo);
+        strftime(cached, sizeof(cached), "%H:%M:%S", &timeinfo);
+        cached_time = rawtime;
+    }
+    snprintf(buffer, size, "%s", cached);
+}
+
+// Imprimir una línea de traza con la hora actual
+static void print_trace_line(const char *event, int irq_num) {
+    char timestamp[16];
+    if (!sim_current()->console) {
+        return;
+    }
+    get_timestamp(timestamp, sizeof(timestamp));
+    if (irq_num >= 0) {
+        printf("[%s] [IRQ%d] %s\n", timestamp, irq_num, event);
+    } else {
+        printf("[%s] %s\n", timestamp, event);
+    }
+    fflush(stdout);
+}
+
+// Función para agregar entrada a la traza (thread-safe)
+void add_trace(const char *event) {
+    irq_trace_emit_text(-1, 0, event);
+    print_trace_line(event, -1);
+}
+
+// Función para agregar entrada a la traza con IRQ específico (thread-safe)
+void add_trace_with_irq(const char *event, int irq_num) {
+    irq_trace_emit_text(irq_num, 0, event);
+    print_trace_line(event, -1);
+}
+
+// Función para logging silencioso (solo guarda en traza, no imprime)
+void add_trace_silent(const char *event) {
+    irq_trace_emit_text(-1, 0, event);
+}
+
+void add_trace_with_irq_silent(const char *event, int irq_num) {
+    irq_trace_emit_text(irq_num, 0, event);
+}
+
+// Función para controlar el nivel de logging
+void set_log_level(log_level_t level) {
+    __atomic_store_n(&sim_current()->log_level, level, __ATOMIC_RELAXED);
+    const char* level_names[] = {"SILENCIOSO", "SOLO USUARIO", "VERBOSE"};
+    printf("Nivel de logging cambiado a: %s\n", level_names[level]);
+}
+
+log_level_t get_log_level(void) {
+    return __atomic_load_n(&sim_current()->log_level, __ATOMIC_RELAXED);
+}
+
+// Cambiar el nivel sin avisar (para silenciar una prueba); devuelve el anterior
+log_level_t swap_log_level(log_level_t level) {
+    return sim_swap_log_level(sim_current(), level);
+}
+
+log_level_t sim_swap_log_level(sim_context_t *ctx, log_level_t level) {
+    return __atomic_exchange_n(&ctx->log_level, level, __ATOMIC_RELAXED);
+}
+
+int sim_swap_timer_logs(sim_context_t *ctx, int show) {
+    int previous = ctx->show_timer_logs;
+    ctx->show_timer_logs = show;
+    return previous;
+}
+
+int sim_is_running(sim_context_t *ctx) {
+    return __atomic_load_n(&ctx->system_running, __ATOMIC_RELAXED);
+}
+
+void sim_request_stop(sim_context_t *ctx) {
+    __atomic_store_n(&ctx->system_running, 0, __ATOMIC_RELAXED);
+}
+
+void toggle_timer_logs(void) {
+    sim_context_t *sim = sim_current();
+    sim->show_timer_logs = !sim->show_timer_logs;
+    printf("Logs del timer: %s\n", sim->show_timer_logs ? "HABILITADOS" : "DESHABILITADOS");
+}
+
+// Decidir si una traza se muestra en pantalla según el nivel de logging
+static int should_print_trace(int is_timer_related) {
+    switch (get_log_level()) {
+        case LOG_LEVEL_SILENT:
+            return 0;
+        case LOG_LEVEL_USER_ONLY:
+            // Solo mostrar si no es del timer, o si los logs del timer están habilitados
+            return is_timer_related ? sim_current()->show_timer_logs : 1;
+        case LOG_LEVEL_VERBOSE:
+            return 1;
+    }
+    return 0;
+}
+
+// Función de logging inteligente
+void add_trace_smart(const char *event, int irq_num, int is_timer_related) {
+    // Siempre guardar en la traza para el historial
+    irq_trace_emit_text(irq_num, is_timer_related ? IRQ_TRACE_TIMER : 0, event);
+    
+    if (should_print_trace(is_timer_related)) {
+        print_trace_line(event, irq_num);
+    }
+}
+
+// Variantes con plantilla: la traza guarda el id del formato y los argumentos,
+// y el texto sólo se formatea si hay que mostrarlo
+void add_trace_smartf(int irq_num, int is_timer_related, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    if (should_print_trace(is_timer_related)) {
+        char event[MAX_TRACE_MSG_LEN];
+        va_list copy;
+        va_copy(copy, ap);
+        vsnprintf(event, sizeof(event), fmt, copy);
+        va_end(copy);
+        print_trace_line(event, irq_num);
+    }
+    irq_trace_emitv(irq_num, is_timer_related ? IRQ_TRACE_TIMER : 0, fmt, ap);
+    va_end(ap);
+}
+
+void add_trace_with_irqf(int irq_num, const char *fmt, ...) {
+    char event[MAX_TRACE_MSG_LEN];
+    va_list ap;
+    va_start(ap, fmt);
+    va_list copy;
+    va_copy(copy, ap);
+    vsnprintf(event, sizeof(event), fmt, copy);
+    va_end(copy);
+    irq_trace_emitv(irq_num, 0, fmt, ap);
+    va_end(ap);
+    print_trace_line(event, -1);
+}
+
+// Copiar las últimas entradas de la traza (de la más antigua a la más reciente)
+int copy_recent_traces(trace_entry_t *out, int max_entries) {
+    return irq_trace_copy_recent(out, max_entries);
+}
+
+int sim_copy_recent_traces(sim_context_t *ctx, trace_entry_t *out, int max_entries) {
+    sim_context_t *previous = sim_context_enter(ctx);
+    int count = irq_trace_copy_recent(out, max_entries);
+    sim_context_enter(previous);
+    return count;
+}
+
+// Validación de número de IRQ
+int validate_irq_num(int irq_num) {
+    return IS_VALID_IRQ(irq_num) ? SUCCESS : ERROR_INVALID_IRQ;
+}
+
+// Verificar si IRQ está disponible
+int is_irq_available(int irq_num) {
+    if (!IS_VALID_IRQ(irq_num)) return 0;
+    sim_context_t *sim = sim_current();
+    LOCK_IDT();
+    int available = (sim->idt[irq_num].state == IRQ_STATE_FREE);
+    UNLOCK_IDT();
+    return available;
+}
+
+// Obtener string del estado del IRQ
+const char* get_irq_state_string(irq_state_t state) {
+    switch (state) {
+        case IRQ_STATE_FREE: return "LIBRE";
+        case IRQ_STATE_REGISTERED: return "REGISTRADO";
+        case IRQ_STATE_EXECUTING: return "EJECUTANDO";
+        default: return "DESCONOCIDO";
+    }
+}
+
+// Inicialización de la IDT
+void init_idt() {
+    sim_context_t *sim = sim_current();
+    LOCK_IDT();
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        sim->idt[i].isr = NULL;
+        sim->idt[i].state = IRQ_STATE_FREE;
+        sim->idt[i].call_count = 0;
+        sim->idt[i].last_call = 0;
+        sim->idt[i].total_execution_time = 0;
+        sim->idt[i].cpu_affinity = -1;
+        sim->idt[i].priority = 0;
+        snprintf(sim->idt[i].description, sizeof(sim->idt[i].description), 
+            "IRQ %d - Vector libre en IDT", i);
+        if (sim->is_default) {
+            irq_shm_publish_descriptor(i, sim->idt[i].state, 0, 0, sim->idt[i].description);
+        }
+    }
+    UNLOCK_IDT();
+    if (sim->is_default) {
+        irq_storm_init();
+        irq_budget_init();
+        irq_msix_init();
+    }
+    
+    add_trace("🚀 KERNEL: Tabla de Descriptores de Interrupción (IDT) inicializada");
+    add_trace("🎯 KERNEL: 16 vectores de interrupción disponibles para asignación");
+    add_trace("🔧 HARDWARE: Controlador de interrupciones (PIC/APIC) configurado");
+}
+
+// Inicialización de estadísticas del sistema
+void init_system_stats() {
+    sim_context_t *sim = sim_current();
+    pthread_mutex_lock(&sim->stats_mutex);
+    memset(&sim->stats, 0, sizeof(system_stats_t));
+    sim->stats.system_start_time = time(NULL);
+    pthread_mutex_unlock(&sim->stats_mutex);
+    if (sim->is_default) {
+        irq_shm_publish_system(0, 0, 0, 0, 0.0, (long)sim->stats.system_start_time);
+    }
+}
+
+// Sumar calls ejecuciones de irq_num que tardaron execution_time μs en total
+static void account_stats(sim_context_t *sim, int irq_num, unsigned long calls,
+                          unsigned long execution_time) {
+    system_stats_t *stats = &sim->stats;
+    
+    pthread_mutex_lock(&sim->stats_mutex);
+    stats->total_interrupts += calls;
+    
+    if (irq_num == IRQ_TIMER) {
+        stats->timer_interrupts += calls;
+    } else if (irq_num == IRQ_KEYBOARD) {
+        stats->keyboard_interrupts += calls;
+    } else {
+        stats->custom_interrupts += calls;
+    }
+    
+    // Calcular tiempo promedio de respuesta
+    if (stats->total_interrupts > 0) {
+        stats->average_response_time = 
+            (stats->average_response_time * (stats->total_interrupts - calls) + execution_time) / 
+            stats->total_interrupts;
+    }
+    if (sim->is_default) {
+        irq_shm_publish_system(stats->total_interrupts, stats->timer_interrupts,
+                               stats->keyboard_interrupts, stats->custom_interrupts,
+                               stats->average_response_time, (long)stats->system_start_time);
+    }
+    pthread_mutex_unlock(&sim->stats_mutex);
+}
+
+// Actualizar estadísticas (thread-safe)
+void update_stats(int irq_num, unsigned long execution_time) {
+    account_stats(sim_current(), irq_num, 1, execution_time);
+}
+
+// Volcar los despachos estáticos pendientes (con idt_mutex tomado). Cada
+// despacho suma primero su tiempo y después la llamada: lo volcado nunca
+// tiene llamadas sin su tiempo, como mucho el de alguna aún sin contar
+static void fold_static_locked(sim_context_t *sim) {
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        sim_static_pending_t *p = &sim->pending[i];
+        if (__atomic_load_n(&p->calls, __ATOMIC_RELAXED) == 0) {
+            continue;
+        }
+        unsigned long calls = __atomic_exchange_n(&p->calls, 0, __ATOMIC_ACQUIRE);
+        unsigned long time_us = __atomic_exchange_n(&p->time_us, 0, __ATOMIC_RELAXED);
+        sim->idt[i].call_count += (int)calls;
+        sim->idt[i].total_execution_time += time_us;
+        sim->idt[i].last_call = (time_t)__atomic_load_n(&p->last_call, __ATOMIC_RELAXED);
+        if (sim->is_default) {
+            irq_shm_publish_dispatch(i, sim->idt[i].state, sim->idt[i].call_count,
+                                     sim->idt[i].total_execution_time, time_us / calls,
+                                     (long)sim->idt[i].last_call,
+                                     sim->idt[i].cpu_affinity >= 0 ? sim->idt[i].cpu_affinity : sched_getcpu());
+        }
+        account_stats(sim, i, calls, time_us);
+    }
+}
+
+// Descartar lo pendiente de un vector cuyos contadores se reinician
+static void drop_static_locked(sim_context_t *sim, int irq_num) {
+    __atomic_store_n(&sim->pending[irq_num].calls, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&sim->pending[irq_num].time_us, 0, __ATOMIC_RELAXED);
+}
+
+void sim_fold_static_dispatches(sim_context_t *ctx) {
+    pthread_mutex_lock(&ctx->idt_mutex);
+    fold_static_locked(ctx);
+    pthread_mutex_unlock(&ctx->idt_mutex);
+}
+
+void sim_get_stats(sim_context_t *ctx, system_stats_t *out) {
+    sim_fold_static_dispatches(ctx);
+    pthread_mutex_lock(&ctx->stats_mutex);
+    *out = ctx->stats;
+    pthread_mutex_unlock(&ctx->stats_mutex);
+}
+
+// Registro de ISR en la IDT
+int register_isr(int irq_num, void (*isr_function)(int), const char *description) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        add_trace("❌ KERNEL: Error en registro ISR - IRQ fuera de rango válido");
+        return ERROR_INVALID_IRQ;
+    }
+    
+    sim_context_t *sim = sim_current();
+    LOCK_IDT();
+    
+    if (sim->idt[irq_num].state == IRQ_STATE_EXECUTING) {
+        UNLOCK_IDT();
+        add_trace("⚠️  KERNEL: Registro ISR fallido - IRQ actualmente en ejecución");
+        return ERROR_ISR_EXECUTING;
+    }
+    
+    sim->idt[irq_num].isr = isr_function;
+    sim->idt[irq_num].state = IRQ_STATE_REGISTERED;
+    sim->idt[irq_num].call_count = 0;
+    sim->idt[irq_num].total_execution_time = 0;
+    drop_static_locked(sim, irq_num);
+    strncpy(sim->idt[irq_num].description, description, sizeof(sim->idt[irq_num].description) - 1);
+    sim->idt[irq_num].description[sizeof(sim->idt[irq_num].description) - 1] = '\0';
+    if (sim->is_default) {
+        irq_shm_publish_descriptor(irq_num, sim->idt[irq_num].state, 0, 0, sim->idt[irq_num].description);
+    }
+    
+    UNLOCK_IDT();
+    
+    add_trace_with_irqf(irq_num,
+        "📝 KERNEL: ISR registrada en IDT[%d] -> Handler: \"%s\"", 
+        irq_num, description);
+    
+    add_trace_with_irqf(irq_num,
+        "🔗 HARDWARE: IRQ %d ahora conectada al kernel - Lista para recibir señales", 
+        irq_num);
+    
+    return SUCCESS;
+}
+
+// Desregistrar ISR
+int unregister_isr(int irq_num) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        add_trace("❌ KERNEL: Error en desregistro ISR - IRQ fuera de rango válido");
+        return ERROR_INVALID_IRQ;
+    }
+    
+    sim_context_t *sim = sim_current();
+    LOCK_IDT();
+    
+    if (sim->idt[irq_num].state == IRQ_STATE_EXECUTING ||
+        (sim->is_default && irq_coro_in_flight(irq_num) > 0)) {
+        UNLOCK_IDT();
+        add_trace("⚠️  KERNEL: Desregistro ISR fallido - IRQ actualmente en ejecución");
+        return ERROR_ISR_EXECUTING;
+    }
+    
+    char old_description[MAX_DESCRIPTION_LEN];
+    strncpy(old_description, sim->idt[irq_num].description, MAX_DESCRIPTION_LEN - 1);
+    old_description[MAX_DESCRIPTION_LEN - 1] = '\0';
+    
+    
+    sim->idt[irq_num].isr = NULL;
+    sim->idt[irq_num].state = IRQ_STATE_FREE;
+    sim->idt[irq_num].call_count = 0;
+    sim->idt[irq_num].total_execution_time = 0;
+    drop_static_locked(sim, irq_num);
+    snprintf(sim->idt[irq_num].description, sizeof(sim->idt[irq_num].description), 
+        "IRQ %d - Disponible para asignación", irq_num);
+    if (sim->is_default) {
+        irq_shm_publish_descriptor(irq_num, sim->idt[irq_num].state, 0, 0, sim->idt[irq_num].description);
+    }
+    
+    UNLOCK_IDT();
+    
+    add_trace_with_irqf(irq_num,
+        "🗑️  KERNEL: ISR removida de IDT[%d] - Era: \"%s\"", 
+        irq_num, old_description);
+    
+    add_trace_with_irqf(irq_num,
+        "🚫 HARDWARE: IRQ %d desconectada - Interrupciones no serán procesadas", 
+        irq_num);
+    
+    return SUCCESS;
+}
+
+int sim_register_isr(sim_context_t *ctx, int irq_num, void (*isr_function)(int), const char *description) {
+    sim_context_t *previous = sim_context_enter(ctx);
+    int result = register_isr(irq_num, isr_function, description);
+    sim_context_enter(previous);
+    return result;
+}
+
+int sim_unregister_isr(sim_context_t *ctx, int irq_num) {
+    sim_context_t *previous = sim_context_enter(ctx);
+    int result = unregister_isr(irq_num);
+    sim_context_enter(previous);
+    return result;
+}
+
+// Copia coherente de un descriptor
+int sim_get_descriptor(sim_context_t *ctx, int irq_num, irq_descriptor_t *out) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+    pthread_mutex_lock(&ctx->idt_mutex);
+    fold_static_locked(ctx);
+    *out = ctx->idt[irq_num];
+    pthread_mutex_unlock(&ctx->idt_mutex);
+    return SUCCESS;
+}
+
+// Instante de entrada a la última ISR ejecutada por este hilo
+static __thread struct timespec last_isr_entry;
+
+void get_last_isr_entry_time(struct timespec *ts) {
+    *ts = last_isr_entry;
+}
+
+static __thread dispatch_outcome_t last_dispatch_outcome;
+
+dispatch_outcome_t get_last_dispatch_outcome(void) {
+    return last_dispatch_outcome;
+}
+
+// Asignar la CPU que atiende un vector (-1 = cualquiera)
+int set_irq_affinity(int irq_num, int cpu) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+    if (cpu < -1 || cpu >= IRQ_SHM_MAX_CPUS) {
+        return ERROR_INVALID_ARG;
+    }
+    
+    sim_context_t *sim = sim_current();
+    LOCK_IDT();
+    sim->idt[irq_num].cpu_affinity = cpu;
+    UNLOCK_IDT();
+    
+    add_trace_smartf(irq_num, 0,
+        "🧭 KERNEL: Afinidad de IRQ %d fijada a CPU %d", irq_num, cpu);
+    return SUCCESS;
+}
+
+// Cambiar la prioridad de un vector
+int set_irq_priority(int irq_num, int priority) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+    
+    sim_context_t *sim = sim_current();
+    LOCK_IDT();
+    sim->idt[irq_num].priority = priority;
+    UNLOCK_IDT();
+    
+    add_trace_smartf(irq_num, 0,
+        "🎚️  KERNEL: Prioridad de IRQ %d fijada a %d", irq_num, priority);
+    return SUCCESS;
+}
+
+// Pasar el vector a EJECUTANDO (con idt_mutex tomado) y devolver su ISR
+void (*begin_isr_execution(int irq_num))(int) {
+    sim_context_t *sim = sim_current();
+    sim->idt[irq_num].state = IRQ_STATE_EXECUTING;
+    sim->idt[irq_num].call_count++;
+    sim->idt[irq_num].last_call = time(NULL);
+    if (sim->is_default) {
+        irq_shm_publish_state(irq_num, IRQ_STATE_EXECUTING);
+        irq_budget_begin(irq_num, irq_storm_now_ns());
+    }
+    return sim->idt[irq_num].isr;
+}
+
+// Ejecutar la ISR, medirla y devolver el vector a REGISTRADO
+void execute_isr(int irq_num, void (*isr_function)(int), int is_timer_irq) {
+    struct timespec start_time, end_time;
+    
+    // ✅ EJECUTAR LA ISR
+    clock_gettime(CLOCK_MONOTONIC, &start_time);
+    last_isr_entry = start_time;
+    
+    irq_storm_take_unhandled();
+    if (isr_function) {
+        isr_function(irq_num);
+    }
+    int unhandled = irq_storm_take_unhandled();
+    
+    clock_gettime(CLOCK_MONOTONIC, &end_time);
+    irq_profile_mark(IRQ_PROFILE_HANDLER);
+    
+    unsigned long execution_time = 
+        (end_time.tv_sec - start_time.tv_sec) * 1000000 +
+        (end_time.tv_nsec - start_time.tv_nsec) / 1000;
+    
+    finish_isr_execution(irq_num, execution_time,
+                         (uint64_t)end_time.tv_sec * 1000000000ULL + (uint64_t)end_time.tv_nsec,
+                         unhandled, is_timer_irq, 1);
+}
+
+// Contabilizar una ejecución terminada (inline, en hilo o en corrutina)
+void finish_isr_execution(int irq_num, unsigned long execution_time, uint64_t end_ns,
+                          int unhandled, int is_timer_irq, int restore_state) {
+    // ✅ RESTAURAR ESTADO A REGISTRADO
+    sim_context_t *sim = sim_current();
+    LOCK_IDT();
+    irq_profile_mark(IRQ_PROFILE_RELOCK);
+    if (restore_state) {
+        sim->idt[irq_num].state = IRQ_STATE_REGISTERED;  // ✅ VOLVER A REGISTRADO
+    }
+    sim->idt[irq_num].total_execution_time += execution_time;
+    if (sim->is_default) {
+        irq_budget_end(irq_num, execution_time);
+        irq_storm_account(irq_num, end_ns,
+                          unhandled ? IRQ_STORM_UNHANDLED : IRQ_STORM_HANDLED);
+        irq_shm_publish_dispatch(irq_num, sim->idt[irq_num].state, sim->idt[irq_num].call_count,
+                                 sim->idt[irq_num].total_execution_time, execution_time,
+                                 (long)sim->idt[irq_num].last_call,
+                                 sim->idt[irq_num].cpu_affinity >= 0 ? sim->idt[irq_num].cpu_affinity : sched_getcpu());
+    }
+    UNLOCK_IDT();
+    
+    update_stats(irq_num, execution_time);
+    irq_profile_mark(IRQ_PROFILE_STATS);
+    
+    add_trace_smartf(irq_num, is_timer_irq,
+        "🔄 CPU: Restaurando contexto - Volviendo al proceso interrumpido (%lu μs)", 
+        execution_time);
+    
+    add_trace_smartf(irq_num, is_timer_irq,
+        "✅ KERNEL: IRQ %d procesada - Sistema listo para nuevas interrupciones", irq_num);
+    irq_profile_mark(IRQ_PROFILE_TRACE);
+}
+
+// Contabilizar un despacho estático (irq_static.h): sin estados, traza ni
+// locks; la IDT, las estadísticas y la página compartida lo ven al volcarse
+int sim_account_dispatch(int irq_num, unsigned long execution_time) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+    sim_static_pending_t *p = &sim_current()->pending[irq_num];
+    __atomic_store_n(&p->last_call, (long)time(NULL), __ATOMIC_RELAXED);
+    __atomic_add_fetch(&p->time_us, execution_time, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&p->calls, 1, __ATOMIC_RELEASE);
+    return SUCCESS;
+}
+
+// Despacho de interrupciones - VERSIÓN CORREGIDA
+// Los contextos creados no pasan por los subsistemas de proceso (hooks = 0)
+void dispatch_interrupt(int irq_num) {
+    void (*isr_function)(int) = NULL;
+    int is_timer_irq = (irq_num == IRQ_TIMER);
+    sim_context_t *sim = sim_current();
+    int hooks = sim->is_default;
+    
+    if (hooks) {
+        irq_record_raise(irq_num);
+    }
+    last_dispatch_outcome = DISPATCH_DROPPED;
+    irq_profile_begin(irq_num);
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        add_trace_smartf(-1, 0,
+            "❌ HARDWARE: IRQ %d RECHAZADA - Número fuera del rango válido (0-%d)", 
+            irq_num, MAX_INTERRUPTS-1);
+        irq_profile_discard();
+        return;
+    }
+    irq_profile_mark(IRQ_PROFILE_VALIDATE);
+    
+    LOCK_IDT();
+    irq_profile_mark(IRQ_PROFILE_LOCK);
+    
+    // Vector enmascarado por una tormenta: la interrupción se descarta
+    if (hooks && !irq_storm_admit(irq_num, irq_storm_now_ns())) {
+        UNLOCK_IDT();
+        irq_profile_discard();
+        return;
+    }
+    
+    // Handler degradado a hilo: la mitad superior sólo lo despierta
+    if (hooks && sim->idt[irq_num].isr != NULL && irq_budget_defer(irq_num)) {
+        UNLOCK_IDT();
+        add_trace_smartf(irq_num, is_timer_irq,
+            "🧵 KERNEL: IRQ %d delegada a su hilo de handler (irq/%d)", irq_num, irq_num);
+        last_dispatch_outcome = DISPATCH_DEFERRED;
+        irq_profile_discard();
+        return;
+    }
+    
+    // ✅ VERIFICAR ESTADO CORRECTO
+    if (sim->idt[irq_num].state != IRQ_STATE_REGISTERED || sim->idt[irq_num].isr == NULL) {
+        irq_state_t state = sim->idt[irq_num].state;
+        if (hooks) {
+            irq_storm_account(irq_num, irq_storm_now_ns(),
+                              state == IRQ_STATE_EXECUTING ? IRQ_STORM_OVERRUN : IRQ_STORM_UNHANDLED);
+        }
+        UNLOCK_IDT();
+        add_trace_smartf(irq_num, is_timer_irq,
+            "❌ KERNEL: IRQ %d SIN HANDLER - Estado: %s", 
+            irq_num, get_irq_state_string(state));
+        irq_profile_discard();
+        return;
+    }
+    
+    // ✅ VERIFICAR SI YA SE ESTÁ EJECUTANDO (protección contra reentrancy)
+    if (sim->idt[irq_num].state == IRQ_STATE_EXECUTING) {
+        if (hooks) {
+            irq_storm_account(irq_num, irq_storm_now_ns(), IRQ_STORM_OVERRUN);
+        }
+        UNLOCK_IDT();
+        add_trace_smartf(irq_num, is_timer_irq,
+            "⚠️  KERNEL: IRQ %d ya ejecutándose - Interrupción ignorada (reentrancy)", irq_num);
+        irq_profile_discard();
+        return;
+    }
+    
+    // Handler cooperativo: cada llegada corre en su propia corrutina
+    if (hooks && irq_coro_is_enabled(irq_num)) {
+        int spawned = irq_coro_spawn(irq_num, sim->idt[irq_num].isr);
+        if (spawned > 0) {
+            sim->idt[irq_num].call_count++;
+            sim->idt[irq_num].last_call = time(NULL);
+            UNLOCK_IDT();
+            irq_coro_refill();
+            add_trace_smartf(irq_num, is_timer_irq,
+                "🌀 KERNEL: IRQ %d atendida por corrutina", irq_num);
+            last_dispatch_outcome = DISPATCH_DEFERRED;
+            irq_profile_discard();
+            return;
+        }
+        if (spawned < 0) {
+            irq_storm_account(irq_num, irq_storm_now_ns(), IRQ_STORM_OVERRUN);
+            UNLOCK_IDT();
+            irq_coro_refill();
+            add_trace_smartf(irq_num, is_timer_irq,
+                "⚠️  KERNEL: IRQ %d descartada - Sin corrutinas libres (%d en vuelo)", 
+                irq_num, IRQ_CORO_MAX_IN_FLIGHT);
+            irq_profile_discard();
+            return;
+        }
+    }
+    
+    irq_profile_mark(IRQ_PROFILE_CHECK);
+    
+    // Simular el proceso real de Linux
+    add_trace_smartf(irq_num, is_timer_irq,
+        "🔥 HARDWARE: IRQ %d disparada - Línea de interrupción activada", irq_num);
+    
+    add_trace_smartf(irq_num, is_timer_irq,
+        "🚨 CPU: Guardando contexto actual - Registros y estado del procesador");
+    
+    add_trace_smartf(irq_num, is_timer_irq,
+        "🔍 KERNEL: Consultando IDT[%d] - Vector de interrupción encontrado", irq_num);
+    irq_profile_mark(IRQ_PROFILE_TRACE);
+    
+    // ✅ CAMBIAR ESTADO A EJECUTANDO
+    isr_function = begin_isr_execution(irq_num);
+    
+    // La descripción se copia: la entrada puede cambiar en cuanto se suelte la IDT
+    char description[MAX_DESCRIPTION_LEN];
+    memcpy(description, sim->idt[irq_num].description, sizeof(description));
+    int call_count = sim->idt[irq_num].call_count;
+    
+    UNLOCK_IDT();
+    irq_profile_mark(IRQ_PROFILE_STATE);
+    add_trace_smartf(irq_num, is_timer_irq,
+        "⚡ KERNEL: Ejecutando ISR \"%s\" - Llamada #%d [Modo Kernel]", 
+        description, call_count);
+    irq_profile_mark(IRQ_PROFILE_TRACE);
+    
+    execute_isr(irq_num, isr_function, is_timer_irq);
+    last_dispatch_outcome = DISPATCH_EXECUTED;
+    irq_profile_end();
+}
+
+void sim_dispatch_interrupt(sim_context_t *ctx, int irq_num) {
+    sim_context_t *previous = sim_context_enter(ctx);
+    dispatch_interrupt(irq_num);
+    sim_context_enter(previous);
+}
+
+
+
+// ISR del Timer del Sistema (IRQ 0)
+void timer_isr(int irq_num) {
+    int tick = __atomic_add_fetch(&sim_current()->timer_counter, 1, __ATOMIC_RELAXED);
+    
+    add_trace_smartf(irq_num, 1,
+        "    ⏰ TIMER_ISR: Tick del sistema #%d - Actualizando jiffies del kernel", 
+        tick);
+    
+    add_trace_smartf(irq_num, 1,
+        "    📊 SCHEDULER: Verificando quantum de procesos - Time slice check");
+    
+    irq_await_us(ISR_SIMULATION_DELAY_US);
+    
+    add_trace_smartf(irq_num, 1,
+        "    🔄 TIMER_ISR: Completada - Sistema de tiempo actualizado");
+}
+
+// ISR del Teclado (IRQ 1)
+void keyboard_isr(int irq_num) {
+    add_trace_with_irqf(irq_num,
+        "    ⌨️  KEYBOARD_ISR: Leyendo scancode del controlador 8042");
+    
+    add_trace_with_irqf(irq_num,
+        "    🔤 INPUT_LAYER: Traduciendo scancode a keycode");
+    
+    add_trace_with_irqf(irq_num,
+        "    📤 EVENT_QUEUE: Enviando evento de teclado a /dev/input/eventX");
+    
+    irq_await_us(KEYBOARD_DELAY_US);
+}
+
+// ISR personalizada de ejemplo
+void custom_isr(int irq_num) {
+    add_trace_with_irqf(irq_num,
+        "    🔧 CUSTOM_ISR: Procesando interrupción de dispositivo personalizado");
+    
+    add_trace_with_irqf(irq_num,
+        "    💾 DEVICE_DRIVER: Intercambiando datos con hardware específico");
+    
+    add_trace_with_irqf(irq_num,
+        "    ✅ CUSTOM_ISR: Operación completada - Hardware listo para nuevas operaciones");
+    
+    irq_await_us(CUSTOM_DELAY_US);
+}
+
+// ISR de error
+void error_isr(int irq_num) {
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg), "    ERROR ISR: Manejando error en IRQ %d", irq_num);
+    add_trace_with_irq(trace_msg, irq_num);
+    
+    irq_await_us(50000); // 50ms
+}
+
+// Hilo del timer automático (arg = contexto al que pertenece)
+void* timer_thread_func(void* arg) {
+    sim_context_t *sim = arg != NULL ? (sim_context_t *)arg : sim_default();
+    sim_context_enter(sim);
+    irq_replay_set_source(IRQ_REPLAY_SRC_TIMER);
+    
+    irq_rt_enter_thread();
+    
+    add_trace("🕐 HARDWARE: Hilo del timer PIT (Programmable Interval Timer) iniciado");
+    add_trace("⚙️  TIMER: Configurado para generar IRQ0 cada 3 segundos");
+    
+    // Plazos absolutos: el retraso de cada despertar no se acumula en los siguientes
+    const uint64_t period = (uint64_t)TIMER_INTERVAL_SEC * 1000000000ULL;
+    uint64_t deadline = irq_storm_now_ns();
+    while (__atomic_load_n(&sim->system_running, __ATOMIC_RELAXED)) {
+        deadline += period;
+        struct timespec ts = { (time_t)(deadline / 1000000000ULL), (long)(deadline % 1000000000ULL) };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+        }
+        if (__atomic_load_n(&sim->system_running, __ATOMIC_RELAXED)) {
+            uint64_t woke = irq_storm_now_ns();
+            add_trace_smartf(-1, 1,
+                "⏲️  HARDWARE: Timer PIT disparando IRQ0 - Señal de reloj del sistema");
+            
+            dispatch_interrupt(IRQ_TIMER);
+            sim_fold_static_dispatches(sim);
+            if (sim->is_default) {
+                irq_storm_tick();
+                uint64_t done = irq_storm_now_ns();
+                int overrun = done >= deadline + period;
+                irq_rt_timer_tick(deadline, woke, done, overrun);
+                // Plazos ya vencidos: se saltan en lugar de encadenar ticks
+                if (overrun) {
+                    deadline += (done - deadline) / period * period;
+                }
+            }
+        }
+    }
+    
+    add_trace("🛑 HARDWARE: Timer PIT detenido - Hilo del timer finalizando");
+    return NULL;
+}
+
+int sim_start_timer(sim_context_t *ctx) {
+    if (ctx->timer_started) {
+        return SUCCESS;
+    }
+    __atomic_store_n(&ctx->system_running, 1, __ATOMIC_RELAXED);
+    if (pthread_create(&ctx->timer_thread, NULL, timer_thread_func, ctx) != 0) {
+        return ERROR_INVALID_ARG;
+    }
+    ctx->timer_started = 1;
+    return SUCCESS;
+}
+
+// Espera a que el hilo termine su sleep en curso (hasta TIMER_INTERVAL_SEC)
+void sim_stop_timer(sim_context_t *ctx) {
+    __atomic_store_n(&ctx->system_running, 0, __ATOMIC_RELAXED);
+    if (ctx->timer_started) {
+        pthread_join(ctx->timer_thread, NULL);
+        ctx->timer_started = 0;
+    }
+}
+
+// Arranque del contexto por defecto con los subsistemas de proceso
+int sim_system_start(void) {
+    // Inicializar sistema
+    printf("📡 Publicando estadísticas en memoria compartida (%s)...\n", IRQ_SHM_DEFAULT_NAME);
+    fflush(stdout);
+    irq_shm_init(NULL);
+    
+    printf("📋 Inicializando IDT (Interrupt Descriptor Table)...\n");
+    fflush(stdout);
+    init_idt();
+    
+    printf("📈 Configurando sistema de estadísticas...\n");
+    fflush(stdout);
+    init_system_stats();
+    
+    // Registrar ISRs predeterminadas
+    printf("⏰ Registrando handler del Timer PIT (IRQ0)...\n");
+    fflush(stdout);
+    register_isr(IRQ_TIMER, timer_isr, "Timer PIT - Reloj del sistema");
+    
+    printf("⌨️  Registrando handler del teclado (IRQ1)...\n");
+    fflush(stdout);
+    register_isr(IRQ_KEYBOARD, keyboard_isr, "Controlador de teclado 8042");
+    
+    if (irq_rt_is_enabled()) {
+        char desc[256];
+        irq_rt_describe(desc, sizeof(desc));
+        printf("⏲️  Modo tiempo real: %s\n", desc);
+        fflush(stdout);
+    }
+    
+    // Iniciar hilo del timer
+    printf("🕐 Iniciando hilo del timer automático...\n");
+    fflush(stdout);
+    if (sim_start_timer(sim_default()) != SUCCESS) {
+        add_trace("❌ KERNEL PANIC: Error creando hilo del timer");
+        printf("❌ ERROR CRÍTICO: No se pudo iniciar el timer del sistema\n");
+        return ERROR_INVALID_ARG;
+    }
+    
+    // Watchdog de ISRs que exceden su plazo
+    if (irq_watchdog_start() != SUCCESS) {
+        printf("⚠️  Watchdog de ISRs no disponible\n");
+    }
+    
+    // Balanceador de vectores entre CPUs (se habilita desde el menú o BALANCE 1)
+    if (irq_balance_start() != SUCCESS) {
+        printf("⚠️  Balanceador de IRQs no disponible\n");
+    }
+    
+    // Pool de trabajo diferido (mitades inferiores y ráfagas de prueba)
+    if (irq_workpool_start(IRQ_WORKPOOL_DEFAULT_WORKERS, 0) != SUCCESS) {
+        printf("⚠️  Pool de trabajo diferido no disponible - Ejecución en línea\n");
+    }
+    
+    // Planificador de handlers cooperativos
+    if (irq_coro_start(IRQ_CORO_WORKERS) != SUCCESS) {
+        printf("⚠️  Handlers cooperativos no disponibles\n");
+    }
+    
+    // Anillo de inyección para generadores de carga externos
+    printf("📥 Habilitando anillo de inyección externa (%s)...\n", IRQ_INJECT_DEFAULT_NAME);
+    fflush(stdout);
+    if (irq_inject_init(NULL) != SUCCESS) {
+        printf("⚠️  Anillo de inyección no disponible - Solo fuentes internas\n");
+    }
+    
+    // Plano de control para arneses de prueba y herramientas externas
+    printf("🎛️  Abriendo plano de control (%s)...\n", CTL_DEFAULT_SOCKET_PATH);
+    fflush(stdout);
+    if (ctl_server_start(NULL) != SUCCESS) {
+        printf("⚠️  Plano de control no disponible - Solo menú interactivo\n");
+    }
+    
+    return SUCCESS;
+}
+
+// Apagado en orden inverso: primero las fuentes externas, la captura al final
+void sim_system_shutdown(void) {
+    add_trace("Finalizando sistema de interrupciones");
+    
+    // Detener las fuentes externas antes que el resto del sistema
+    irq_loadgen_shutdown();
+    irq_replay_shutdown();
+    ctl_server_stop();
+    irq_inject_shutdown();
+    fd_controller_stop();
+    irq_device_shutdown();
+    irq_balance_stop();
+    irq_coro_stop();
+    irq_budget_shutdown();
+    irq_plugin_shutdown();
+    irq_msix_shutdown();
+    irq_workpool_stop();
+    
+    // Esperar a que termine el hilo del timer
+    sim_stop_timer(sim_default());
+    
+    // La captura se cierra la última para conservar la traza del apagado
+    irq_capture_shutdown();
+    irq_shm_shutdown();
+    
+    pthread_mutex_destroy(&sim_default()->idt_mutex);
+    pthread_mutex_destroy(&sim_default()->stats_mutex);
+}
+
+// Función auxiliar mejorada para detectar trazas del timer
+int is_timer_related_trace(const trace_entry_t *entry) {
+    // Verificar por IRQ número
+    if (entry->irq_num == IRQ_TIMER) {
+        return 1;
+    }
+    
+    // Verificar por contenido del mensaje (patrones más completos)
+    const char* timer_patterns[] = {
+        "TIMER", "Timer", "timer",
+        "TICK", "Tick", "tick",
+        "Hilo del timer", "timer_thread",
+        "DESPACHANDO IRQ 0", "FINALIZANDO IRQ 0",
+        ">>> DESPACHANDO IRQ 0", "<<< FINALIZANDO IRQ 0",
+        "iniciado", "finalizando"  // Para mensajes del hilo del timer
+    };
+    
+    int num_patterns = sizeof(timer_patterns) / sizeof(timer_patterns[0]);
+    
+    for (int i = 0; i < num_patterns; i++) {
+        if (strstr(entry->event, timer_patterns[i]) != NULL) {
+            return 1;
+        }
+    }
+    
+    return 0;
+}
+
+// Entrada age-ésima si no es del timer (las del timer se descartan sin
+// reconstruir el texto)
+// Función para limpiar entrada inválida del buffer
+void clear_input_buffer() {
+    int c;
+    while ((c = getchar()) != '\n' && c != EOF);
+}
+
+// Función para obtener entrada numérica válida
+int get_valid_input(int min, int max) {
+    int input;
+    char buffer[256];
+    char *endptr;
+    
+    while (1) {
+        memset(buffer, 0, sizeof(buffer));
+        
+        if (fgets(buffer, sizeof(buffer), stdin) == NULL) {
+            printf("Error leyendo entrada. Intente de nuevo: ");
+            continue;
+        }
+        
+        size_t len = strlen(buffer);
+        if (len > 0 && buffer[len-1] == '\n') {
+            buffer[len-1] = '\0';
+        }
+        
+        char *trimmed = buffer;
+        while (*trimmed == ' ' || *trimmed == '\t') {
+            trimmed++;
+        }
+        
+        if (*trimmed == '\0') {
+            printf("Entrada inválida. Ingrese un número entre %d y %d: ", min, max);
+            continue;
+        }
+        
+        input = (int)strtol(trimmed, &endptr, 10);
+        
+        if (*endptr != '\0') {
+            printf("Entrada inválida. Ingrese un número entre %d y %d: ", min, max);
+            continue;
+        }
+        
+        if (input >= min && input <= max) {
+            return input;
+        }
+        
+        printf("Número fuera de rango. Ingrese un número entre %d y %d: ", min, max);
+    }
+}
+
+// Función simple para esperar Enter
+void wait_for_enter() {
+    printf("\nPresione Enter para continuar...");
+    fflush(stdout);
+    
+    char buffer[10];
+    fgets(buffer, sizeof(buffer), stdin);
+}
+
+
+// Función para guardar el estado actual de la IDT
+void save_idt_state(irq_descriptor_t *backup) {
+    sim_context_t *sim = sim_current();
+    LOCK_IDT();
+    fold_static_locked(sim);
+    
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        backup[i].isr = sim->idt[i].isr;
+        backup[i].state = sim->idt[i].state;
+        backup[i].call_count = sim->idt[i].call_count;
+        backup[i].last_call = sim->idt[i].last_call;
+        backup[i].total_execution_time = sim->idt[i].total_execution_time;
+        backup[i].cpu_affinity = sim->idt[i].cpu_affinity;
+        backup[i].priority = sim->idt[i].priority;
+        strncpy(backup[i].description, sim->idt[i].description, sizeof(backup[i].description) - 1);
+        backup[i].description[sizeof(backup[i].description) - 1] = '\0';
+    }
+    
+    UNLOCK_IDT();
+    
+    add_trace("💾 KERNEL: Estado de IDT guardado para respaldo");
+}
+
+// Función para restaurar el estado previo de la IDT
+void restore_idt_state(const irq_descriptor_t *backup) {
+    sim_context_t *sim = sim_current();
+    LOCK_IDT();
+    
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        sim->idt[i].isr = backup[i].isr;
+        sim->idt[i].state = backup[i].state;
+        sim->idt[i].call_count = backup[i].call_count;
+        sim->idt[i].last_call = backup[i].last_call;
+        sim->idt[i].total_execution_time = backup[i].total_execution_time;
+        sim->idt[i].cpu_affinity = backup[i].cpu_affinity;
+        sim->idt[i].priority = backup[i].priority;
+        strncpy(sim->idt[i].description, backup[i].description, sizeof(sim->idt[i].description) - 1);
+        sim->idt[i].description[sizeof(sim->idt[i].description) - 1] = '\0';
+        if (sim->is_default) {
+            irq_shm_publish_descriptor(i, sim->idt[i].state, sim->idt[i].call_count,
+                                       sim->idt[i].total_execution_time, sim->idt[i].description);
+        }
+    }
+    
+    UNLOCK_IDT();
+    
+    add_trace("🧹 KERNEL: Estado de IDT restaurado tras pruebas");
+}
+
+// Función para limpiar ISRs de prueba (mantiene solo las del sistema)
+void cleanup_test_isrs(void) {
+    int cleaned_count = 0;
+    
+    sim_context_t *sim = sim_current();
+    LOCK_IDT();
+    
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        // Preservar ISRs del sistema (IRQ0 Timer e IRQ1 Keyboard)
+        if (i == IRQ_TIMER || i == IRQ_KEYBOARD) {
+            continue;
+        }
+        
+        // Limpiar cualquier otra ISR registrada
+        if (sim->idt[i].state != IRQ_STATE_FREE && sim->idt[i].isr != NULL) {
+            sim->idt[i].isr = NULL;
+            sim->idt[i].state = IRQ_STATE_FREE;
+            sim->idt[i].call_count = 0;
+            sim->idt[i].total_execution_time = 0;
+            drop_static_locked(sim, i);
+            snprintf(sim->idt[i].description, sizeof(sim->idt[i].description), 
+                "IRQ %d - Disponible para asignación", i);
+            if (sim->is_default) {
+                irq_shm_publish_descriptor(i, sim->idt[i].state, 0, 0, sim->idt[i].description);
+            }
+            cleaned_count++;
+        }
+    }
+    
+    UNLOCK_IDT();
+    
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg), 
+        "🧼 KERNEL: %d ISRs de prueba limpiadas - Solo ISRs del sistema preservadas", 
+        cleaned_count);
+    add_trace(trace_msg);
+}
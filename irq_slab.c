@@ -0,0 +1,285 @@
+#define _GNU_SOURCE
+#include "irq_slab.h"
+#include "irq_workpool.h"
+
+// Contadores escritos por el dueño de la caché y leídos desde fuera
+#define STAT_ADD(field, value) \
+    __atomic_store_n(&(field), __atomic_load_n(&(field), __ATOMIC_RELAXED) + (value), __ATOMIC_RELAXED)
+#define STAT_GET(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+
+#define SLAB_HEADER 16                      // Mantiene la carga alineada a 16
+
+struct slab_cache;
+
+// Cabecera de cada objeto; next sólo se usa mientras el objeto está libre
+typedef struct slab_object {
+    struct slab_cache *owner;
+    struct slab_object *next;
+} slab_object_t;
+
+typedef struct slab_cache {
+    irq_slab_t *slab;
+    int owned;                              // 1 mientras un hilo vivo la usa
+    slab_object_t *local;                   // Sólo el dueño
+    slab_object_t *remote __attribute__((aligned(64)));   // Liberados por otros hilos
+    unsigned long capacity;
+    unsigned long chunks;
+    unsigned long allocs;
+    unsigned long local_frees;
+    unsigned long cross_frees;
+    void *chunk_list;                       // Bloques de la caché, enlazados
+    struct slab_cache *next_cache;
+} slab_cache_t;
+
+struct irq_slab {
+    int id;
+    const char *name;
+    size_t object_size;
+    size_t stride;
+    pthread_key_t key;
+    slab_cache_t *caches;                   // Sólo crece (push sin bloqueo)
+    unsigned long live;
+    unsigned long high_water;
+};
+
+static irq_slab_t slabs[IRQ_SLAB_MAX];
+static int slab_count = 0;
+static pthread_mutex_t slab_mutex = PTHREAD_MUTEX_INITIALIZER;
+static __thread slab_cache_t *thread_caches[IRQ_SLAB_MAX];
+
+static void atomic_max(unsigned long *target, unsigned long value) {
+    unsigned long current = __atomic_load_n(target, __ATOMIC_RELAXED);
+    while (value > current &&
+           !__atomic_compare_exchange_n(target, &current, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+// Al terminar el hilo su caché queda libre para el siguiente que la adopte
+static void cache_release(void *arg) {
+    slab_cache_t *cache = (slab_cache_t *)arg;
+    __atomic_store_n(&cache->owned, 0, __ATOMIC_RELEASE);
+}
+
+irq_slab_t *irq_slab_create(const char *name, size_t object_size) {
+    pthread_mutex_lock(&slab_mutex);
+    if (slab_count >= IRQ_SLAB_MAX) {
+        pthread_mutex_unlock(&slab_mutex);
+        return NULL;
+    }
+    irq_slab_t *slab = &slabs[slab_count];
+    memset(slab, 0, sizeof(*slab));
+    slab->id = slab_count;
+    slab->name = name;
+    slab->object_size = object_size;
+    size_t payload = object_size > sizeof(void *) ? object_size : sizeof(void *);
+    slab->stride = (SLAB_HEADER + payload + 15) & ~(size_t)15;
+    if (pthread_key_create(&slab->key, cache_release) != 0) {
+        pthread_mutex_unlock(&slab_mutex);
+        return NULL;
+    }
+    __atomic_store_n(&slab_count, slab_count + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&slab_mutex);
+    return slab;
+}
+
+// Caché del hilo actual: adopta una huérfana o crea una nueva (sólo la primera vez)
+static slab_cache_t *current_cache(irq_slab_t *slab) {
+    slab_cache_t *cache = thread_caches[slab->id];
+    if (cache != NULL) {
+        return cache;
+    }
+
+    for (cache = __atomic_load_n(&slab->caches, __ATOMIC_ACQUIRE); cache != NULL; cache = cache->next_cache) {
+        int expected = 0;
+        if (__atomic_load_n(&cache->owned, __ATOMIC_RELAXED) == 0 &&
+            __atomic_compare_exchange_n(&cache->owned, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+    if (cache == NULL) {
+        cache = calloc(1, sizeof(*cache));
+        if (cache == NULL) {
+            return NULL;
+        }
+        cache->slab = slab;
+        cache->owned = 1;
+        cache->next_cache = __atomic_load_n(&slab->caches, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&slab->caches, &cache->next_cache, cache, 1,
+                                            __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        }
+    }
+    pthread_setspecific(slab->key, cache);
+    thread_caches[slab->id] = cache;
+    return cache;
+}
+
+// Ampliar la caché con un bloque nuevo (única llamada al sistema)
+static int cache_grow(slab_cache_t *cache) {
+    irq_slab_t *slab = cache->slab;
+    size_t header = (sizeof(void *) + 63) & ~(size_t)63;
+    uint8_t *chunk;
+    if (posix_memalign((void **)&chunk, 64, header + slab->stride * IRQ_SLAB_CHUNK_OBJECTS) != 0) {
+        return 0;
+    }
+    *(void **)chunk = cache->chunk_list;
+    cache->chunk_list = chunk;
+
+    for (int i = IRQ_SLAB_CHUNK_OBJECTS - 1; i >= 0; i--) {
+        slab_object_t *object = (slab_object_t *)(chunk + header + slab->stride * (size_t)i);
+        object->owner = cache;
+        object->next = cache->local;
+        cache->local = object;
+    }
+    cache->capacity += IRQ_SLAB_CHUNK_OBJECTS;
+    STAT_ADD(cache->chunks, 1);
+    return 1;
+}
+
+void *irq_slab_alloc(irq_slab_t *slab) {
+    slab_cache_t *cache = current_cache(slab);
+    if (cache == NULL) {
+        return NULL;
+    }
+
+    slab_object_t *object = cache->local;
+    if (object == NULL) {
+        // Llevarse de golpe todo lo que han devuelto otros hilos
+        object = __atomic_exchange_n(&cache->remote, NULL, __ATOMIC_ACQUIRE);
+        if (object == NULL && cache_grow(cache)) {
+            object = cache->local;
+        }
+        if (object == NULL) {
+            return NULL;
+        }
+    }
+    cache->local = object->next;
+
+    STAT_ADD(cache->allocs, 1);
+    unsigned long live = __atomic_add_fetch(&slab->live, 1, __ATOMIC_RELAXED);
+    atomic_max(&slab->high_water, live);
+    return (uint8_t *)object + SLAB_HEADER;
+}
+
+void irq_slab_free(irq_slab_t *slab, void *ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    slab_object_t *object = (slab_object_t *)((uint8_t *)ptr - SLAB_HEADER);
+    slab_cache_t *owner = object->owner;
+    __atomic_sub_fetch(&slab->live, 1, __ATOMIC_RELAXED);
+
+    if (owner == thread_caches[slab->id]) {
+        object->next = owner->local;
+        owner->local = object;
+        STAT_ADD(owner->local_frees, 1);
+        return;
+    }
+
+    // Devolverlo a la caché que lo creó (el dueño vacía la lista entera)
+    object->next = __atomic_load_n(&owner->remote, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&owner->remote, &object->next, object, 1,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+    __atomic_add_fetch(&owner->cross_frees, 1, __ATOMIC_RELAXED);
+}
+
+int irq_slab_reserve(irq_slab_t *slab, unsigned long count) {
+    slab_cache_t *cache = current_cache(slab);
+    if (cache == NULL) {
+        return ERROR_INVALID_ARG;
+    }
+    while (cache->capacity < count) {
+        if (!cache_grow(cache)) {
+            return ERROR_INVALID_ARG;
+        }
+    }
+    return SUCCESS;
+}
+
+int irq_slab_count(void) {
+    return __atomic_load_n(&slab_count, __ATOMIC_ACQUIRE);
+}
+
+int irq_slab_get_stats(int index, irq_slab_stats_t *out) {
+    if (index < 0 || index >= irq_slab_count()) {
+        return ERROR_INVALID_ARG;
+    }
+    irq_slab_t *slab = &slabs[index];
+    memset(out, 0, sizeof(*out));
+    out->name = slab->name;
+    out->object_size = slab->object_size;
+    for (slab_cache_t *cache = __atomic_load_n(&slab->caches, __ATOMIC_ACQUIRE);
+         cache != NULL; cache = cache->next_cache) {
+        out->caches++;
+        out->chunks += STAT_GET(cache->chunks);
+        out->allocs += STAT_GET(cache->allocs);
+        out->frees += STAT_GET(cache->local_frees) + STAT_GET(cache->cross_frees);
+        out->cross_frees += STAT_GET(cache->cross_frees);
+    }
+    out->live = STAT_GET(slab->live);
+    out->high_water = STAT_GET(slab->high_water);
+    return SUCCESS;
+}
+
+// ---- Comprobación de reservas en el camino de despacho ----
+
+// Una comprobación a la vez: el grupo es compartido con la ISR y el contador
+// de reservas es global, así que dos comprobaciones se medirían entre sí
+static pthread_mutex_t check_mutex = PTHREAD_MUTEX_INITIALIZER;
+static irq_work_group_t check_group;
+
+static void check_work(void *arg) {
+    (void)arg;
+}
+
+// ISR que difiere su trabajo al pool, como una mitad inferior
+static void check_isr(int irq_num) {
+    (void)irq_num;
+    irq_work_submit(check_work, NULL, &check_group);
+}
+
+long irq_slab_dispatch_check(int count) {
+    if (irq_alloc_probe_count == NULL) {
+        return -1;
+    }
+    if (count < 1) {
+        return ERROR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&check_mutex);
+    int irq_num = -1;
+    for (int i = 2; i < MAX_INTERRUPTS; i++) {
+        if (is_irq_available(i)) {
+            irq_num = i;
+            break;
+        }
+    }
+    // Otro camino pudo quedarse el vector entre tanto: no medir su ISR
+    if (irq_num < 0 ||
+        register_isr(irq_num, check_isr, "Comprobación de reservas") != SUCCESS) {
+        pthread_mutex_unlock(&check_mutex);
+        return ERROR_INVALID_ARG;
+    }
+    irq_work_group_init(&check_group);
+    log_level_t saved = swap_log_level(LOG_LEVEL_SILENT);
+
+    // Calentamiento: crea las cachés y los bloques que hagan falta
+    irq_workpool_reserve((unsigned long)count);
+    for (int i = 0; i < count; i++) {
+        dispatch_interrupt(irq_num);
+    }
+    irq_work_group_wait(&check_group);
+
+    unsigned long before = irq_alloc_probe_count();
+    for (int i = 0; i < count; i++) {
+        dispatch_interrupt(irq_num);
+    }
+    irq_work_group_wait(&check_group);
+    unsigned long after = irq_alloc_probe_count();
+
+    swap_log_level(saved);
+    irq_work_group_destroy(&check_group);
+    unregister_isr(irq_num);
+    pthread_mutex_unlock(&check_mutex);
+    return (long)(after - before);
+}
@@ -0,0 +1,53 @@
+#ifndef IRQ_SLAB_H
+#define IRQ_SLAB_H
+
+#include <stddef.h>
+#include "interrupt_simulator.h"
+
+// Cachés slab por hilo para los objetos que se crean por interrupción
+// (trabajos diferidos del pool, mitades inferiores...)
+//
+// Cada hilo que reserva de un slab adopta una caché propia con su lista libre
+// local, sin bloqueos ni atómicos. Un objeto liberado desde otro hilo vuelve a
+// la caché que lo creó por una lista remota sin bloqueos (pila de Treiber con
+// varios productores); el dueño se la lleva entera cuando su lista local se
+// vacía. Sólo se pide memoria al sistema para ampliar una caché con un bloque
+// nuevo, así que en régimen estacionario dispatch_interrupt() no llama a malloc.
+// Las cachés de hilos que terminan quedan libres y las adopta el siguiente.
+
+#define IRQ_SLAB_MAX 8
+#define IRQ_SLAB_CHUNK_OBJECTS 256          // Objetos por bloque
+
+typedef struct irq_slab irq_slab_t;
+
+typedef struct {
+    const char *name;
+    size_t object_size;
+    int caches;                             // Hilos que han usado el slab
+    unsigned long chunks;                   // Bloques pedidos al sistema
+    unsigned long allocs;
+    unsigned long frees;
+    unsigned long cross_frees;              // Liberados desde otro hilo
+    unsigned long live;
+    unsigned long high_water;
+} irq_slab_stats_t;
+
+// Crea un slab en la tabla estática (NULL si no quedan entradas)
+irq_slab_t *irq_slab_create(const char *name, size_t object_size);
+void *irq_slab_alloc(irq_slab_t *slab);
+void irq_slab_free(irq_slab_t *slab, void *object);
+// Asegura capacidad para count objetos en la caché del hilo que llama
+int irq_slab_reserve(irq_slab_t *slab, unsigned long count);
+
+int irq_slab_count(void);
+int irq_slab_get_stats(int index, irq_slab_stats_t *out);
+
+// Sonda de reservas (irq_alloc_probe.so con LD_PRELOAD); NULL si no está cargada
+unsigned long irq_alloc_probe_count(void) __attribute__((weak));
+
+// Despacha count interrupciones con trabajo diferido tras un calentamiento y
+// cuenta las reservas de heap del proceso (-1 si la sonda no está cargada,
+// ERROR_INVALID_ARG sin vector libre o si no se pudo registrar)
+long irq_slab_dispatch_check(int count);
+
+#endif // IRQ_SLAB_H
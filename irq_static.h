@@ -0,0 +1,74 @@
+#ifndef IRQ_STATIC_H
+#define IRQ_STATIC_H
+
+#include "irqsim.h"
+
+// Despacho especializado en compilación para layouts de IDT fijos
+//
+// Si la asignación vector → handler se conoce al compilar (como irq_table
+// más las IRQs del sistema), el layout se describe con una X-macro de
+// entradas X(irq, handler, descripción) e IRQ_STATIC_DEFINE genera:
+//
+//   prefijo_dispatch(irq)   Un switch directo sobre el contexto actual.
+//                           Cada case llama a su handler por nombre, sin
+//                           puntero a función, así que el compilador lo
+//                           puede poner en línea. Un vector
+//                           fuera del layout cae en default (ERROR_NO_ISR).
+//                           Con irq constante, el switch se reduce a la
+//                           llamada.
+//   prefijo_install(ctx)    Registra el layout en la IDT del contexto para
+//                           que la vista dinámica coincida (menú, STATS,
+//                           irqtop).
+//
+// La validación se hace al compilar: un vector fuera de 0..MAX_INTERRUPTS-1
+// no compila, y uno repetido da "duplicate case value".
+//
+// El despacho estático no usa los estados REGISTERED/EXECUTING, ni las
+// tormentas, los presupuestos, las corrutinas o la traza, y no toma locks:
+// mide el handler y lo contabiliza con sim_account_dispatch, que suma con
+// atómicos en contadores por vector. call_count, el tiempo acumulado y las
+// estadísticas los reciben al consultarse (sim_get_descriptor, sim_get_stats,
+// el tick del timer). Los vectores del layout no se desregistran en
+// ejecución. El resto sigue por el camino dinámico (dispatch_interrupt).
+//
+//     #define MI_LAYOUT(X) X(IRQ_TIMER, timer_isr, "Timer PIT") X(5, nic_isr, "NIC")
+//     IRQ_STATIC_DEFINE(mi, MI_LAYOUT)
+//
+//     mi_install(ctx);
+//     mi_dispatch(5);
+
+static inline uint64_t irq_static_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+#define IRQ_STATIC_CASE(irq, handler, desc)                                                   \
+    case (irq): {                                                                             \
+        (void)sizeof(char[IS_VALID_IRQ(irq) ? 1 : -1]);    /* Vector fuera de la IDT */       \
+        uint64_t start_ns = irq_static_now_ns();                                              \
+        handler(irq);                                                                         \
+        return sim_account_dispatch((irq),                                                    \
+            (unsigned long)((irq_static_now_ns() - start_ns) / 1000));                        \
+    }
+
+#define IRQ_STATIC_INSTALL(irq, handler, desc)                      \
+    if ((rc = sim_register_isr(ctx, (irq), handler, (desc))) != SUCCESS) { \
+        return rc;                                                  \
+    }
+
+#define IRQ_STATIC_DEFINE(prefix, LAYOUT)                           \
+    static inline int prefix##_dispatch(int irq_num) {              \
+        switch (irq_num) {                                          \
+        LAYOUT(IRQ_STATIC_CASE)                                     \
+        default:                                                    \
+            return ERROR_NO_ISR;                                    \
+        }                                                           \
+    }                                                               \
+    static inline int prefix##_install(sim_context_t *ctx) {        \
+        int rc;                                                     \
+        LAYOUT(IRQ_STATIC_INSTALL)                                  \
+        return SUCCESS;                                             \
+    }
+
+#endif // IRQ_STATIC_H
@@ -0,0 +1,320 @@
+#define _GNU_SOURCE
+#include "irq_storm.h"
+
+// Estado interno de un vector (protegido por idt_mutex)
+typedef struct {
+    irq_storm_info_t info;
+    uint64_t bucket_start_ns;
+    int cur;
+    unsigned long hits[IRQ_STORM_BUCKETS];
+    unsigned long unhandled[IRQ_STORM_BUCKETS];
+    unsigned long overrun[IRQ_STORM_BUCKETS];
+    uint64_t unmask_at_ns;
+    uint64_t last_unmask_ns;
+} storm_state_t;
+
+static storm_state_t storm[MAX_INTERRUPTS];
+
+// La ISR en curso no reconoció la interrupción (por hilo)
+static __thread int isr_unhandled;
+
+uint64_t irq_storm_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+const char *irq_storm_reason_string(irq_storm_reason_t reason) {
+    switch (reason) {
+        case IRQ_STORM_REASON_RATE: return "tasa";
+        case IRQ_STORM_REASON_OVERRUN: return "ISR saturada";
+        case IRQ_STORM_REASON_UNHANDLED: return "sin atender";
+        default: return "-";
+    }
+}
+
+void irq_storm_mark_unhandled(void) {
+    isr_unhandled = 1;
+}
+
+int irq_storm_take_unhandled(void) {
+    int value = isr_unhandled;
+    isr_unhandled = 0;
+    return value;
+}
+
+static void clear_window(storm_state_t *s, uint64_t now_ns) {
+    memset(s->hits, 0, sizeof(s->hits));
+    memset(s->unhandled, 0, sizeof(s->unhandled));
+    memset(s->overrun, 0, sizeof(s->overrun));
+    s->cur = 0;
+    s->bucket_start_ns = now_ns;
+}
+
+// Deslizar la ventana hasta la cubeta que contiene now_ns
+static void advance_window(storm_state_t *s, uint64_t now_ns) {
+    if (s->bucket_start_ns == 0) {
+        s->bucket_start_ns = now_ns;
+        return;
+    }
+    if (now_ns - s->bucket_start_ns < IRQ_STORM_BUCKET_NS) {
+        return;
+    }
+
+    uint64_t steps = (now_ns - s->bucket_start_ns) / IRQ_STORM_BUCKET_NS;
+    if (steps >= IRQ_STORM_BUCKETS) {
+        clear_window(s, now_ns);
+        return;
+    }
+    for (uint64_t i = 0; i < steps; i++) {
+        s->cur = (s->cur + 1) % IRQ_STORM_BUCKETS;
+        s->hits[s->cur] = 0;
+        s->unhandled[s->cur] = 0;
+        s->overrun[s->cur] = 0;
+    }
+    s->bucket_start_ns += steps * IRQ_STORM_BUCKET_NS;
+}
+
+static void sum_window(const storm_state_t *s, unsigned long *hits,
+                       unsigned long *unhandled, unsigned long *overrun) {
+    *hits = *unhandled = *overrun = 0;
+    for (int i = 0; i < IRQ_STORM_BUCKETS; i++) {
+        *hits += s->hits[i];
+        *unhandled += s->unhandled[i];
+        *overrun += s->overrun[i];
+    }
+}
+
+static void try_unmask(int irq_num, storm_state_t *s, uint64_t now_ns) {
+    if (!s->info.masked || now_ns < s->unmask_at_ns) {
+        return;
+    }
+    s->info.masked = 0;
+    s->last_unmask_ns = s->unmask_at_ns;   // Instante real de rehabilitación
+    clear_window(s, now_ns);
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg),
+        "🌦️  KERNEL: IRQ %d rehabilitada tras %.0f ms enmascarada",
+        irq_num, s->info.backoff_ns / 1e6);
+    add_trace_smart(trace_msg, irq_num, 0);
+}
+
+// Un episodio termina cuando el vector pasa una ventana completa sin recaer
+static void try_close_episode(int irq_num, storm_state_t *s, uint64_t now_ns) {
+    if (!s->info.in_episode || s->info.masked ||
+        now_ns - s->last_unmask_ns < IRQ_STORM_WINDOW_NS) {
+        return;
+    }
+
+    uint64_t duration = s->last_unmask_ns - s->info.episode_start_ns;
+    s->info.in_episode = 0;
+    s->info.backoff_ns = 0;
+    s->info.last_episode_ns = duration;
+    if (duration > s->info.longest_episode_ns) {
+        s->info.longest_episode_ns = duration;
+    }
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg),
+        "🌤️  KERNEL: Fin de tormenta en IRQ %d - Duró %.1f ms, %lu interrupciones descartadas",
+        irq_num, duration / 1e6, s->info.episode_shed);
+    add_trace_smart(trace_msg, irq_num, 0);
+}
+
+static void trigger_storm(int irq_num, storm_state_t *s, uint64_t now_ns,
+                          irq_storm_reason_t reason) {
+    if (s->info.in_episode) {
+        s->info.backoff_ns *= 2;
+        if (s->info.backoff_ns > IRQ_STORM_BACKOFF_MAX_NS) {
+            s->info.backoff_ns = IRQ_STORM_BACKOFF_MAX_NS;
+        }
+    } else {
+        s->info.in_episode = 1;
+        s->info.episodes++;
+        s->info.episode_start_ns = now_ns;
+        s->info.episode_shed = 0;
+        s->info.backoff_ns = IRQ_STORM_BACKOFF_MIN_NS;
+    }
+
+    s->info.storms++;
+    s->info.reason = reason;
+    s->info.masked = 1;
+    s->unmask_at_ns = now_ns + s->info.backoff_ns;
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    unsigned long hits, unhandled, overrun;
+    sum_window(s, &hits, &unhandled, &overrun);
+    snprintf(trace_msg, sizeof(trace_msg),
+        "🌩️  KERNEL: Tormenta en IRQ %d (%s: %lu llegadas, %lu sin atender, %lu con ISR ocupada) - Enmascarada %.0f ms",
+        irq_num, irq_storm_reason_string(reason), hits, unhandled, overrun,
+        s->info.backoff_ns / 1e6);
+    add_trace_smart(trace_msg, irq_num, 0);
+
+    clear_window(s, now_ns);
+}
+
+int irq_storm_admit(int irq_num, uint64_t now_ns) {
+    storm_state_t *s = &storm[irq_num];
+
+    advance_window(s, now_ns);
+    try_unmask(irq_num, s, now_ns);
+    if (s->info.masked) {
+        s->info.shed++;
+        s->info.episode_shed++;
+        return 0;
+    }
+    try_close_episode(irq_num, s, now_ns);
+
+    s->hits[s->cur]++;
+    return 1;
+}
+
+void irq_storm_account(int irq_num, uint64_t now_ns, int outcome) {
+    storm_state_t *s = &storm[irq_num];
+    unsigned long hits, unhandled, overrun;
+
+    advance_window(s, now_ns);
+    if (outcome == IRQ_STORM_UNHANDLED) {
+        s->unhandled[s->cur]++;
+    } else if (outcome == IRQ_STORM_OVERRUN) {
+        s->overrun[s->cur]++;
+    }
+    if (s->info.masked) {
+        return;
+    }
+
+    sum_window(s, &hits, &unhandled, &overrun);
+    if (s->info.rate_limit > 0 && hits > s->info.rate_limit) {
+        trigger_storm(irq_num, s, now_ns, IRQ_STORM_REASON_RATE);
+    } else if (hits >= IRQ_STORM_MIN_EVENTS && overrun * 2 > hits) {
+        trigger_storm(irq_num, s, now_ns, IRQ_STORM_REASON_OVERRUN);
+    } else if (hits >= IRQ_STORM_MIN_EVENTS &&
+               unhandled * 1000 >= hits * IRQ_STORM_UNHANDLED_PERMILLE) {
+        trigger_storm(irq_num, s, now_ns, IRQ_STORM_REASON_UNHANDLED);
+    }
+}
+
+void irq_storm_init(void) {
+    LOCK_IDT();
+    memset(storm, 0, sizeof(storm));
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        storm[i].info.rate_limit = IRQ_STORM_DEFAULT_RATE;
+    }
+    UNLOCK_IDT();
+}
+
+int irq_storm_set_rate_limit(int irq_num, unsigned long per_second) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+    LOCK_IDT();
+    storm[irq_num].info.rate_limit = per_second;
+    UNLOCK_IDT();
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg),
+        "⚙️  KERNEL: Límite de tormenta de IRQ %d: %lu IRQs/s%s",
+        irq_num, per_second, per_second == 0 ? " (sin límite)" : "");
+    add_trace_smart(trace_msg, irq_num, 0);
+    return SUCCESS;
+}
+
+int irq_storm_get_info(int irq_num, irq_storm_info_t *out) {
+    if (validate_irq_num(irq_num) != SUCCESS) {
+        return ERROR_INVALID_IRQ;
+    }
+    LOCK_IDT();
+    storm_state_t *s = &storm[irq_num];
+    advance_window(s, irq_storm_now_ns());
+    *out = s->info;
+    sum_window(s, &out->window_hits, &out->window_unhandled, &out->window_overrun);
+    UNLOCK_IDT();
+    return SUCCESS;
+}
+
+void irq_storm_tick(void) {
+    uint64_t now_ns = irq_storm_now_ns();
+
+    LOCK_IDT();
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        advance_window(&storm[i], now_ns);
+        try_unmask(i, &storm[i], now_ns);
+        try_close_episode(i, &storm[i], now_ns);
+    }
+    UNLOCK_IDT();
+}
+
+void show_irq_storms(void) {
+    irq_storm_tick();
+
+    printf("\n=== TORMENTAS DE INTERRUPCIONES (ventana de %.0f ms) ===\n",
+           IRQ_STORM_WINDOW_NS / 1e6);
+    printf("IRQ │ Límite/s │ Estado      │ Ventana lleg/sin/ocup │ Tormentas │ Episodios │ Descartadas │ Últ. ep. ms │ Máx. ep. ms\n");
+
+    for (int i = 0; i < MAX_INTERRUPTS; i++) {
+        irq_storm_info_t info;
+        irq_storm_get_info(i, &info);
+        if (info.storms == 0 && info.window_hits == 0 &&
+            info.rate_limit == IRQ_STORM_DEFAULT_RATE) {
+            continue;
+        }
+
+        char window[32];
+        snprintf(window, sizeof(window), "%lu/%lu/%lu",
+                 info.window_hits, info.window_unhandled, info.window_overrun);
+        const char *state = info.masked ? "ENMASCARADA" : (info.in_episode ? "VIGILADA" : "normal");
+        printf("%3d │ %8lu │ %-11s │ %21s │ %9lu │ %9lu │ %11lu │ %11.1f │ %.1f\n",
+               i, info.rate_limit, state, window, info.storms, info.episodes,
+               info.shed, info.last_episode_ns / 1e6, info.longest_episode_ns / 1e6);
+        if (info.storms > 0) {
+            printf("    └─ Última causa: %s, backoff actual %.0f ms\n",
+                   irq_storm_reason_string(info.reason), info.backoff_ns / 1e6);
+        }
+    }
+    printf("(se omiten vectores sin actividad y con la configuración por defecto)\n\n");
+}
+
+void irq_storm_submenu(void) {
+    int option, irq_num;
+
+    while (1) {
+        printf("\n=== TORMENTAS DE INTERRUPCIONES ===\n");
+        printf("1. Mostrar estado y episodios\n");
+        printf("2. Cambiar límite de tasa de un IRQ (0 = sin límite)\n");
+        printf("3. Simular inundación de un IRQ\n");
+        printf("0. Volver\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+
+        option = get_valid_input(0, 3);
+        if (option == 0) {
+            return;
+        }
+        if (option == 1) {
+            show_irq_storms();
+            continue;
+        }
+
+        printf("Ingrese el número de IRQ (0-%d): ", MAX_INTERRUPTS - 1);
+        fflush(stdout);
+        irq_num = get_valid_input(0, MAX_INTERRUPTS - 1);
+
+        if (option == 2) {
+            printf("Límite en IRQs por segundo (0-10000000): ");
+            fflush(stdout);
+            irq_storm_set_rate_limit(irq_num, (unsigned long)get_valid_input(0, 10000000));
+            printf("✓ Límite actualizado para IRQ %d.\n", irq_num);
+        } else {
+            printf("Cantidad de interrupciones (1-100000): ");
+            fflush(stdout);
+            int count = get_valid_input(1, 100000);
+            log_level_t saved = swap_log_level(LOG_LEVEL_SILENT);
+            for (int i = 0; i < count; i++) {
+                dispatch_interrupt(irq_num);
+            }
+            swap_log_level(saved);
+            show_irq_storms();
+        }
+    }
+}
@@ -0,0 +1,79 @@
+#ifndef IRQ_STORM_H
+#define IRQ_STORM_H
+
+#include <stdint.h>
+#include "interrupt_simulator.h"
+
+// Detección de tormentas de interrupciones (equivalente a note_interrupt)
+//
+// Cada vector cuenta, en una ventana deslizante de IRQ_STORM_BUCKETS cubetas,
+// las llegadas, las que no atendió ningún handler y las que llegaron mientras
+// su ISR seguía ejecutándose. Se declara tormenta cuando:
+//   - la tasa supera el umbral del vector (IRQs/s, 0 = sin límite), o
+//   - la mayoría de las llegadas encuentra la ISR ocupada (dispara más rápido
+//     de lo que el handler puede atenderlo), o
+//   - casi todas las llegadas quedan sin atender (línea "que nadie reclama").
+// El vector se enmascara temporalmente; si al rehabilitarlo la tormenta sigue,
+// el tiempo de enmascarado se duplica. Un episodio termina tras una ventana
+// completa sin recaídas y se registra con su duración y el trabajo descartado.
+
+#define IRQ_STORM_BUCKETS 10
+#define IRQ_STORM_BUCKET_NS 100000000ULL            // 100 ms -> ventana de 1 s
+#define IRQ_STORM_WINDOW_NS (IRQ_STORM_BUCKETS * IRQ_STORM_BUCKET_NS)
+#define IRQ_STORM_DEFAULT_RATE 0                    // IRQs/s por vector (0 = sin límite, activar con STORM)
+#define IRQ_STORM_MIN_EVENTS 50                     // Muestras mínimas para juzgar
+#define IRQ_STORM_UNHANDLED_PERMILLE 990            // 99% sin atender = inundación
+#define IRQ_STORM_BACKOFF_MIN_NS 10000000ULL        // 10 ms
+#define IRQ_STORM_BACKOFF_MAX_NS 5000000000ULL      // 5 s
+
+typedef enum {
+    IRQ_STORM_REASON_NONE,
+    IRQ_STORM_REASON_RATE,          // Tasa por encima del umbral
+    IRQ_STORM_REASON_OVERRUN,       // Llegadas con la ISR aún en ejecución
+    IRQ_STORM_REASON_UNHANDLED      // Nadie reclama la interrupción
+} irq_storm_reason_t;
+
+// Estado y estadísticas de un vector
+typedef struct {
+    unsigned long rate_limit;               // IRQs/s (0 = sin límite por tasa)
+    int masked;
+    int in_episode;
+    irq_storm_reason_t reason;              // Causa del último disparo
+    uint64_t backoff_ns;                    // Enmascarado actual
+    unsigned long storms;                   // Disparos (incluye recaídas)
+    unsigned long episodes;
+    unsigned long shed;                     // Interrupciones descartadas en total
+    unsigned long episode_shed;
+    uint64_t episode_start_ns;
+    uint64_t last_episode_ns;               // Duración del último episodio cerrado
+    uint64_t longest_episode_ns;
+    unsigned long window_hits;              // Contenido actual de la ventana
+    unsigned long window_unhandled;
+    unsigned long window_overrun;
+} irq_storm_info_t;
+
+// Llamadas desde dispatch_interrupt() con idt_mutex tomado
+int irq_storm_admit(int irq_num, uint64_t now_ns);          // 0 = descartar
+void irq_storm_account(int irq_num, uint64_t now_ns, int outcome);
+
+// Resultado de una llegada para irq_storm_account()
+#define IRQ_STORM_HANDLED 0
+#define IRQ_STORM_UNHANDLED 1
+#define IRQ_STORM_OVERRUN 2
+
+// La ISR en curso informa de que no reconoció la interrupción
+void irq_storm_mark_unhandled(void);
+int irq_storm_take_unhandled(void);
+
+// Configuración y consulta (toman idt_mutex)
+void irq_storm_init(void);
+int irq_storm_set_rate_limit(int irq_num, unsigned long per_second);
+int irq_storm_get_info(int irq_num, irq_storm_info_t *out);
+void irq_storm_tick(void);              // Cierra episodios de vectores inactivos
+uint64_t irq_storm_now_ns(void);
+const char *irq_storm_reason_string(irq_storm_reason_t reason);
+
+void show_irq_storms(void);
+void irq_storm_submenu(void);
+
+#endif // IRQ_STORM_H
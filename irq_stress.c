@@ -0,0 +1,368 @@
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include "irq_stress.h"
+#include "irq_storm.h"
+#include "irq_budget.h"
+#include "irq_coro.h"
+#include "irq_trace.h"
+
+#define STRESS_READ_ENTRIES 64
+
+typedef struct {
+    pthread_t thread;
+    int own_irq;                            // -1 = sólo el vector común
+    unsigned long own_dispatches;
+    unsigned long shared_dispatches;
+    unsigned long churn_dispatches;
+} stress_dispatcher_t;
+
+typedef struct {
+    pthread_t thread;
+    unsigned long reads;
+} stress_reader_t;
+
+static int stress_stop = 0;
+static int shared_irq = -1;
+static int churn_irq = -1;
+static unsigned long runs[MAX_INTERRUPTS];  // ISR ejecutadas, contadas por la propia ISR
+static int in_flight[MAX_INTERRUPTS];
+static unsigned long violations = 0;
+static char first_violation[128];
+static unsigned long registrations = 0;
+static unsigned long unregister_busy = 0;
+static pthread_mutex_t violation_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t stress_run_mutex = PTHREAD_MUTEX_INITIALIZER;  // Un banco a la vez
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void violation(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+static void violation(const char *fmt, ...) {
+    pthread_mutex_lock(&violation_mutex);
+    if (violations++ == 0) {
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(first_violation, sizeof(first_violation), fmt, args);
+        va_end(args);
+    }
+    pthread_mutex_unlock(&violation_mutex);
+}
+
+static int stopping(void) {
+    return __atomic_load_n(&stress_stop, __ATOMIC_RELAXED);
+}
+
+static void stress_isr(int irq_num) {
+    if (__atomic_add_fetch(&in_flight[irq_num], 1, __ATOMIC_ACQ_REL) > 1) {
+        violation("dos ISR a la vez en IRQ %d", irq_num);
+    }
+    // En el vector común se cede la CPU para que los demás choquen con él
+    if (irq_num == __atomic_load_n(&shared_irq, __ATOMIC_RELAXED)) {
+        sched_yield();
+    }
+    __atomic_fetch_add(&runs[irq_num], 1, __ATOMIC_RELAXED);
+    __atomic_sub_fetch(&in_flight[irq_num], 1, __ATOMIC_ACQ_REL);
+}
+
+static void *dispatcher_func(void *arg) {
+    stress_dispatcher_t *d = (stress_dispatcher_t *)arg;
+
+    for (unsigned long i = 0; !stopping(); i++) {
+        if (d->own_irq >= 0) {
+            dispatch_interrupt(d->own_irq);
+            d->own_dispatches++;
+        }
+        if (d->own_irq < 0 || i % 4 == 0) {
+            dispatch_interrupt(shared_irq);
+            d->shared_dispatches++;
+        }
+        if (churn_irq >= 0 && i % 8 == 0) {
+            dispatch_interrupt(churn_irq);
+            d->churn_dispatches++;
+        }
+    }
+    return NULL;
+}
+
+static void *churn_func(void *arg) {
+    (void)arg;
+    while (!stopping()) {
+        int result = register_isr(churn_irq, stress_isr, "Estrés: registro");
+        if (result != SUCCESS) {
+            violation("register_isr(%d) devolvió %d", churn_irq, result);
+            return NULL;
+        }
+        __atomic_fetch_add(&registrations, 1, __ATOMIC_RELAXED);
+        sched_yield();
+        while ((result = unregister_isr(churn_irq)) == ERROR_ISR_EXECUTING) {
+            __atomic_fetch_add(&unregister_busy, 1, __ATOMIC_RELAXED);
+            sched_yield();
+        }
+        if (result != SUCCESS) {
+            violation("unregister_isr(%d) devolvió %d", churn_irq, result);
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+static void *reader_func(void *arg) {
+    stress_reader_t *r = (stress_reader_t *)arg;
+    trace_entry_t *entries = malloc(sizeof(trace_entry_t) * STRESS_READ_ENTRIES);
+    irq_tracefile_query_t q;
+    unsigned long scanned;
+
+    if (entries == NULL) {
+        violation("lector sin memoria");
+        return NULL;
+    }
+    memset(&q, 0, sizeof(q));
+    q.irq_mask = IRQ_TRACEFILE_IRQ_BIT(shared_irq);
+    for (unsigned long i = 0; !stopping(); i++) {
+        // Alterna la copia de lo reciente con una consulta filtrada
+        int filtered = i % 2 == 1;
+        int count = filtered ? irq_trace_query(&q, entries, STRESS_READ_ENTRIES, &scanned) :
+                               irq_trace_copy_recent(entries, STRESS_READ_ENTRIES);
+        if (count < 0 || count > STRESS_READ_ENTRIES) {
+            violation("lectura de la traza devolvió %d entradas", count);
+            break;
+        }
+        for (int e = 0; e < count; e++) {
+            int irq = entries[e].irq_num;
+            if (filtered ? irq != shared_irq : (irq < -1 || irq >= MAX_INTERRUPTS)) {
+                violation("entrada de traza con IRQ %d fuera del filtro", irq);
+                break;
+            }
+        }
+        r->reads++;
+    }
+    free(entries);
+    return NULL;
+}
+
+// Vector apto para el banco: libre y sin corrutinas ni handler en hilo
+static int usable_irq(int irq) {
+    irq_budget_info_t budget;
+    return is_irq_available(irq) && !irq_coro_is_enabled(irq) &&
+           irq_budget_get_info(irq, &budget) == SUCCESS && !budget.threaded;
+}
+
+int irq_stress_run(const irq_stress_config_t *config, irq_stress_result_t *out) {
+    stress_dispatcher_t dispatchers[IRQ_STRESS_MAX_THREADS];
+    stress_reader_t readers[IRQ_STRESS_MAX_READERS];
+    pthread_t churn_thread;
+    int vectors[MAX_INTERRUPTS], num_vectors = 0;
+    unsigned long rate_limits[MAX_INTERRUPTS], shed_before[MAX_INTERRUPTS];
+    int started = 0, started_readers = 0, churn_started = 0;
+
+    if (config->threads < 1 || config->threads > IRQ_STRESS_MAX_THREADS ||
+        config->readers < 0 || config->readers > IRQ_STRESS_MAX_READERS || config->seconds <= 0) {
+        return ERROR_INVALID_ARG;
+    }
+    if (pthread_mutex_trylock(&stress_run_mutex) != 0) {
+        return ERROR_INVALID_ARG;
+    }
+
+    // Vector común, el del registro/desregistro y uno propio por hilo
+    int needed = 1 + (config->churn ? 1 : 0) + config->threads;
+    for (int irq = 0; irq < MAX_INTERRUPTS && num_vectors < needed; irq++) {
+        if (usable_irq(irq)) {
+            vectors[num_vectors++] = irq;
+        }
+    }
+    if (num_vectors < 1 + (config->churn ? 1 : 0)) {
+        pthread_mutex_unlock(&stress_run_mutex);
+        return ERROR_NO_ISR;
+    }
+
+    memset(out, 0, sizeof(*out));
+    memset(dispatchers, 0, sizeof(dispatchers));
+    memset(readers, 0, sizeof(readers));
+    memset(runs, 0, sizeof(runs));
+    memset(in_flight, 0, sizeof(in_flight));
+    violations = registrations = unregister_busy = 0;
+    first_violation[0] = '\0';
+    stress_stop = 0;
+    __atomic_store_n(&shared_irq, vectors[0], __ATOMIC_RELAXED);
+    churn_irq = config->churn ? vectors[1] : -1;
+    int first_own = config->churn ? 2 : 1;
+    for (int i = 0; i < config->threads; i++) {
+        dispatchers[i].own_irq = first_own + i < num_vectors ? vectors[first_own + i] : -1;
+    }
+
+    // Sin límite de tasa: una tormenta por tasa descartaría llegadas
+    for (int v = 0; v < num_vectors; v++) {
+        irq_storm_info_t info;
+        irq_storm_get_info(vectors[v], &info);
+        rate_limits[v] = info.rate_limit;
+        irq_storm_set_rate_limit(vectors[v], 0);
+        if (vectors[v] != churn_irq) {
+            register_isr(vectors[v], stress_isr, "Estrés concurrente");
+        }
+        irq_storm_get_info(vectors[v], &info);
+        shed_before[v] = info.shed;
+    }
+
+    log_level_t saved_level = swap_log_level(LOG_LEVEL_SILENT);
+    uint64_t start = now_ns();
+    for (; started < config->threads; started++) {
+        if (pthread_create(&dispatchers[started].thread, NULL, dispatcher_func, &dispatchers[started]) != 0) {
+            violation("no se pudo crear el despachador %d", started);
+            break;
+        }
+    }
+    for (; started_readers < config->readers; started_readers++) {
+        if (pthread_create(&readers[started_readers].thread, NULL, reader_func, &readers[started_readers]) != 0) {
+            violation("no se pudo crear el lector %d", started_readers);
+            break;
+        }
+    }
+    if (churn_irq >= 0) {
+        churn_started = pthread_create(&churn_thread, NULL, churn_func, NULL) == 0;
+    }
+
+    struct timespec duration = { (time_t)config->seconds,
+                                 (long)((config->seconds - (time_t)config->seconds) * 1e9) };
+    nanosleep(&duration, NULL);
+    __atomic_store_n(&stress_stop, 1, __ATOMIC_RELAXED);
+
+    for (int i = 0; i < started; i++) {
+        pthread_join(dispatchers[i].thread, NULL);
+    }
+    for (int i = 0; i < started_readers; i++) {
+        pthread_join(readers[i].thread, NULL);
+    }
+    if (churn_started) {
+        pthread_join(churn_thread, NULL);
+    }
+    out->elapsed_s = (now_ns() - start) / 1e9;
+    swap_log_level(saved_level);
+
+    // Invariantes con todos los hilos ya terminados
+    unsigned long shared_dispatches = 0;
+    for (int i = 0; i < started; i++) {
+        const stress_dispatcher_t *d = &dispatchers[i];
+        out->dispatches += d->own_dispatches + d->shared_dispatches + d->churn_dispatches;
+        shared_dispatches += d->shared_dispatches;
+    }
+    for (int v = 0; v < num_vectors; v++) {
+        int irq = vectors[v];
+        irq_storm_info_t info;
+        irq_storm_get_info(irq, &info);
+        unsigned long shed = info.shed - shed_before[v];
+
+        irq_descriptor_t desc;
+        sim_get_descriptor(sim_current(), irq, &desc);
+        irq_state_t state = desc.state;
+        unsigned long calls = (unsigned long)desc.call_count;
+        unsigned long ran = runs[irq];
+        out->executed += ran;
+
+        if (state == IRQ_STATE_EXECUTING) {
+            violation("IRQ %d quedó en EXECUTING", irq);
+        }
+        if (irq == churn_irq) {
+            if (state != IRQ_STATE_FREE) {
+                violation("IRQ %d (registro/desregistro) no quedó libre", irq);
+            }
+            continue;
+        }
+        if (calls != ran) {
+            violation("IRQ %d: call_count %lu pero la ISR corrió %lu veces", irq, calls, ran);
+        }
+        if (irq == shared_irq) {
+            if (ran > shared_dispatches) {
+                violation("IRQ %d: %lu ejecuciones para %lu despachos", irq, ran, shared_dispatches);
+            }
+            out->rejected = shared_dispatches - (ran < shared_dispatches ? ran : shared_dispatches);
+            continue;
+        }
+        for (int i = 0; i < started; i++) {
+            if (dispatchers[i].own_irq == irq && ran + shed != dispatchers[i].own_dispatches) {
+                violation("IRQ %d: %lu despachos pero %lu ejecuciones (%lu descartadas)", irq,
+                          dispatchers[i].own_dispatches, ran, shed);
+            }
+        }
+    }
+
+    for (int v = 0; v < num_vectors; v++) {
+        if (vectors[v] != churn_irq) {
+            while (unregister_isr(vectors[v]) == ERROR_ISR_EXECUTING) {
+                usleep(1000);
+            }
+        }
+        irq_storm_set_rate_limit(vectors[v], rate_limits[v]);
+    }
+
+    out->threads = started;
+    out->readers = started_readers;
+    out->churn_irq = churn_irq;
+    out->shared_irq = shared_irq;
+    out->registrations = registrations;
+    out->unregister_busy = unregister_busy;
+    for (int i = 0; i < started_readers; i++) {
+        out->reads += readers[i].reads;
+    }
+    out->ops_per_s = out->elapsed_s > 0 ?
+        (out->dispatches + 2 * out->registrations + out->reads) / out->elapsed_s : 0.0;
+    out->violations = violations;
+    snprintf(out->first_violation, sizeof(out->first_violation), "%s", first_violation);
+    pthread_mutex_unlock(&stress_run_mutex);
+
+    add_trace_with_irqf(-1, "🧪 Estrés concurrente: %lu despachos en %.2f s, %lu violaciones",
+                        out->dispatches, out->elapsed_s, out->violations);
+    return SUCCESS;
+}
+
+void show_stress_result(const irq_stress_result_t *r) {
+    printf("\n=== ESTRÉS CONCURRENTE ===\n");
+    printf("Hilos: %d despachadores │ %d lectores │ registro/desregistro %s\n", r->threads, r->readers,
+           r->churn_irq >= 0 ? "activo" : "no");
+    printf("Duración: %.2f s │ %.0f operaciones/s\n", r->elapsed_s, r->ops_per_s);
+    printf("Despachos: %lu (%.0f/s) │ ISR ejecutadas: %lu │ rechazadas en el vector común (IRQ %d): %lu\n",
+           r->dispatches, r->elapsed_s > 0 ? r->dispatches / r->elapsed_s : 0.0, r->executed,
+           r->shared_irq, r->rejected);
+    if (r->churn_irq >= 0) {
+        printf("IRQ %d: %lu registros │ %lu desregistros con la ISR en curso\n",
+               r->churn_irq, r->registrations, r->unregister_busy);
+    }
+    printf("Lecturas de la traza: %lu\n", r->reads);
+    if (r->violations == 0) {
+        printf("✓ Invariantes cumplidos: sin cuentas perdidas ni vectores en EXECUTING\n\n");
+    } else {
+        printf("✗ %lu violaciones; la primera: %s\n\n", r->violations, r->first_violation);
+    }
+}
+
+void stress_submenu(void) {
+    irq_stress_config_t config;
+    irq_stress_result_t result;
+
+    printf("\n=== ESTRÉS CONCURRENTE ===\n");
+    printf("Hilos despachadores (1-%d): ", IRQ_STRESS_MAX_THREADS);
+    fflush(stdout);
+    config.threads = get_valid_input(1, IRQ_STRESS_MAX_THREADS);
+    printf("Lectores de la traza (0-%d): ", IRQ_STRESS_MAX_READERS);
+    fflush(stdout);
+    config.readers = get_valid_input(0, IRQ_STRESS_MAX_READERS);
+    printf("¿Registrar y desregistrar un vector durante la prueba? (1 = sí, 0 = no): ");
+    fflush(stdout);
+    config.churn = get_valid_input(0, 1);
+    printf("Duración en segundos (1-60): ");
+    fflush(stdout);
+    config.seconds = get_valid_input(1, 60);
+
+    printf("Ejecutando...\n");
+    int result_code = irq_stress_run(&config, &result);
+    if (result_code == SUCCESS) {
+        show_stress_result(&result);
+    } else if (result_code == ERROR_NO_ISR) {
+        printf("✗ No quedan vectores libres para la prueba.\n");
+    } else {
+        printf("✗ Ya hay una prueba de estrés en curso.\n");
+    }
+}
@@ -0,0 +1,56 @@
+#ifndef IRQ_STRESS_H
+#define IRQ_STRESS_H
+
+#include <stdint.h>
+#include "interrupt_simulator.h"
+
+// Banco de estrés concurrente del despacho
+//
+// Durante un tiempo fijo, varios hilos atacan a la vez el núcleo del
+// simulador:
+//   - despachadores: cada uno tiene un vector propio y además comparten uno
+//     común, donde chocan entre sí (reentrada, tormentas por solapamiento);
+//   - un hilo que registra y desregistra sin pausa un vector mientras los
+//     despachadores le disparan interrupciones;
+//   - lectores de la traza (copias recientes y consultas filtradas).
+// Al terminar se comprueban invariantes: en los vectores propios cada
+// despacho se ejecutó exactamente una vez (call_count = despachos = ISR
+// ejecutadas), en el común call_count coincide con las ISR ejecutadas y
+// nunca hubo dos a la vez, y ningún vector del banco quedó en EXECUTING.
+// Sólo se usan vectores libres; durante la prueba se les quita el límite de
+// tasa de la detección de tormentas para que no descarte llegadas.
+
+#define IRQ_STRESS_MAX_THREADS 8
+#define IRQ_STRESS_MAX_READERS 4
+
+typedef struct {
+    int threads;                            // Despachadores
+    int readers;                            // Lectores de la traza
+    int churn;                              // 1 = hilo de registro/desregistro
+    double seconds;
+} irq_stress_config_t;
+
+typedef struct {
+    int threads;
+    int readers;
+    int churn_irq;                          // -1 = sin hilo de registro
+    int shared_irq;
+    double elapsed_s;
+    unsigned long dispatches;
+    unsigned long executed;                 // ISR ejecutadas (contadas por la ISR)
+    unsigned long rejected;                 // Despachos del vector común no ejecutados
+    unsigned long registrations;
+    unsigned long unregister_busy;          // Desregistros con la ISR en curso
+    unsigned long reads;
+    double ops_per_s;                       // Despachos + registros + lecturas
+    unsigned long violations;
+    char first_violation[128];
+} irq_stress_result_t;
+
+// Bloquea durante config->seconds; devuelve SUCCESS o un código de error
+int irq_stress_run(const irq_stress_config_t *config, irq_stress_result_t *out);
+
+void show_stress_result(const irq_stress_result_t *r);
+void stress_submenu(void);
+
+#endif // IRQ_STRESS_H
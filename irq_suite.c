@@ -0,0 +1,331 @@
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include "irq_suite.h"
+#include "irq_rand.h"
+#include "irq_workpool.h"
+
+#define SUITE_TABLE_SIZE ((int)(sizeof(irq_table) / sizeof(irq_table[0])))
+#define SUITE_MAX_JOBS 64
+#define FNV_OFFSET 0xcbf29ce484222325ULL
+#define FNV_PRIME 0x100000001b3ULL
+
+// Ejecuciones contadas por la ISR de comprobación (una máquina por hilo)
+static __thread unsigned long runs[MAX_INTERRUPTS];
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t fnv_mix(uint64_t hash, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        hash ^= (value >> (i * 8)) & 0xff;
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+static void add_event(irq_suite_plan_t *plan, int table_idx, unsigned long delay_us, int pooled) {
+    irq_suite_event_t *ev = &plan->events[plan->num_events++];
+    ev->table_idx = table_idx;
+    ev->irq = irq_table[table_idx].irq;
+    ev->delay_us = delay_us;
+    ev->pooled = pooled;
+}
+
+// Mismo orden de sorteos que las suites originales
+void irq_suite_plan(irq_suite_kind_t kind, uint64_t seed, irq_suite_plan_t *plan) {
+    irq_rand_t rng;
+
+    irq_rand_seed(&rng, seed);
+    memset(plan, 0, sizeof(*plan));
+    plan->kind = kind;
+    plan->seed = seed;
+    if (kind == IRQ_SUITE_BASIC) {
+        int total = 3 + (int)irq_rand_below(&rng, 6);                       // 3-8 interrupciones
+        for (int i = 0; i < total; i++) {
+            int idx = (int)irq_rand_below(&rng, SUITE_TABLE_SIZE);
+            add_event(plan, idx, 100000 + irq_rand_below(&rng, 701000), 0);  // 100-801 ms
+        }
+        return;
+    }
+
+    // Ráfaga al pool (con una pausa de 1 s al final) y patrón de esperas variables
+    static const unsigned long pattern_delays[] = { 100000, 300000, 600000 };
+    int burst = 2 + (int)irq_rand_below(&rng, 4);                           // 2-5
+    for (int i = 0; i < burst; i++) {
+        add_event(plan, (int)irq_rand_below(&rng, SUITE_TABLE_SIZE), i == burst - 1 ? 1000000 : 0, 1);
+    }
+    int pattern = 3 + (int)irq_rand_below(&rng, 5);                         // 3-7
+    for (int i = 0; i < pattern; i++) {
+        int idx = (int)irq_rand_below(&rng, SUITE_TABLE_SIZE);
+        add_event(plan, idx, pattern_delays[irq_rand_below(&rng, 3)], 0);
+    }
+}
+
+const char *irq_suite_kind_name(irq_suite_kind_t kind) {
+    return kind == IRQ_SUITE_BASIC ? "basic" : kind == IRQ_SUITE_ADVANCED ? "advanced" : "?";
+}
+
+static void suite_isr(int irq_num) {
+    runs[irq_num]++;
+}
+
+static void suite_dispatch_work(void *arg) {
+    dispatch_interrupt((int)(intptr_t)arg);
+}
+
+static void fail(irq_suite_result_t *out, const char *fmt, ...) __attribute__((format(printf, 2, 3)));
+
+static void fail(irq_suite_result_t *out, const char *fmt, ...) {
+    if (out->failures++ == 0) {
+        va_list args;
+        va_start(args, fmt);
+        vsnprintf(out->reason, sizeof(out->reason), fmt, args);
+        va_end(args);
+    }
+}
+
+int irq_suite_check_seed(uint64_t seed, irq_suite_result_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->seed = seed;
+    out->digest = FNV_OFFSET;
+
+    for (int kind = 0; kind < IRQ_SUITE_KINDS; kind++) {
+        irq_suite_plan_t plan;
+        unsigned long expected[MAX_INTERRUPTS] = { 0 };
+
+        irq_suite_plan((irq_suite_kind_t)kind, seed, &plan);
+        out->events[kind] = plan.num_events;
+        memset(runs, 0, sizeof(runs));
+        for (int i = 0; i < SUITE_TABLE_SIZE; i++) {
+            if (register_isr(irq_table[i].irq, suite_isr, irq_table[i].desc) != SUCCESS) {
+                fail(out, "%s: no se pudo registrar IRQ %d", irq_suite_kind_name(kind), irq_table[i].irq);
+            }
+        }
+
+        // Mismo recorrido que la suite, sin las esperas
+        irq_work_group_t group;
+        int group_open = 0;
+        for (int e = 0; e < plan.num_events; e++) {
+            const irq_suite_event_t *ev = &plan.events[e];
+            if (ev->pooled) {
+                if (!group_open) {
+                    irq_work_group_init(&group);
+                    group_open = 1;
+                }
+                irq_work_submit(suite_dispatch_work, (void *)(intptr_t)ev->irq, &group);
+            } else {
+                dispatch_interrupt(ev->irq);
+            }
+            if (group_open && (e + 1 == plan.num_events || !plan.events[e + 1].pooled)) {
+                irq_work_group_wait(&group);
+                irq_work_group_destroy(&group);
+                group_open = 0;
+            }
+            expected[ev->irq]++;
+            out->digest = fnv_mix(out->digest, ((uint64_t)ev->irq << 32) | ((uint64_t)ev->pooled << 31) |
+                                               ev->delay_us);
+        }
+
+        for (int i = 0; i < SUITE_TABLE_SIZE; i++) {
+            int irq = irq_table[i].irq;
+            irq_descriptor_t desc;
+            sim_get_descriptor(sim_current(), irq, &desc);
+            irq_state_t state = desc.state;
+            unsigned long calls = (unsigned long)desc.call_count;
+            if (state != IRQ_STATE_REGISTERED) {
+                fail(out, "%s: IRQ %d en estado %s", irq_suite_kind_name(kind), irq,
+                     get_irq_state_string(state));
+            }
+            if (calls != expected[irq] || runs[irq] != expected[irq]) {
+                fail(out, "%s: IRQ %d con %lu despachos, call_count %lu, ISR %lu", irq_suite_kind_name(kind),
+                     irq, expected[irq], calls, runs[irq]);
+            }
+            out->digest = fnv_mix(out->digest, calls);
+        }
+
+        // La suite deja la IDT como la encontró
+        for (int i = 0; i < SUITE_TABLE_SIZE; i++) {
+            unregister_isr(irq_table[i].irq);
+        }
+        for (int irq = 0; irq < MAX_INTERRUPTS; irq++) {
+            if (!is_irq_available(irq)) {
+                fail(out, "%s: IRQ %d no quedó libre", irq_suite_kind_name(kind), irq);
+            }
+        }
+    }
+    return out->failures == 0 ? SUCCESS : ERROR_INVALID_ARG;
+}
+
+// Hilo del barrido: semillas first + k*stride en su propia máquina simulada
+typedef struct {
+    pthread_t thread;
+    uint64_t first_seed;
+    int seeds;
+    int index;
+    int stride;
+    irq_suite_result_t *results;
+    int ok;
+} sweep_worker_t;
+
+static void *sweep_worker_func(void *arg) {
+    sweep_worker_t *w = (sweep_worker_t *)arg;
+    sim_context_t *ctx = sim_context_create();
+    if (ctx == NULL) {
+        return NULL;
+    }
+    sim_context_enter(ctx);
+    for (int k = w->index; k < w->seeds; k += w->stride) {
+        irq_suite_check_seed(w->first_seed + (uint64_t)k, &w->results[k]);
+    }
+    sim_context_enter(NULL);
+    sim_context_destroy(ctx);
+    w->ok = 1;
+    return NULL;
+}
+
+int irq_suite_sweep(uint64_t first_seed, int seeds, int jobs, FILE *failures_out, irq_suite_sweep_t *out) {
+    sweep_worker_t workers[SUITE_MAX_JOBS];
+
+    if (seeds <= 0) {
+        return ERROR_INVALID_ARG;
+    }
+    if (jobs <= 0) {
+        long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+        jobs = cpus > 0 ? (int)cpus : 1;
+    }
+    jobs = jobs > SUITE_MAX_JOBS ? SUITE_MAX_JOBS : jobs;
+    jobs = jobs > seeds ? seeds : jobs;
+
+    irq_suite_result_t *results = calloc((size_t)seeds, sizeof(*results));
+    if (results == NULL) {
+        return ERROR_INVALID_ARG;
+    }
+
+    memset(out, 0, sizeof(*out));
+    out->first_seed = first_seed;
+    out->seeds = seeds;
+    out->jobs = jobs;
+    uint64_t start = now_ns();
+    int started = 0;
+    for (; started < jobs; started++) {
+        sweep_worker_t *w = &workers[started];
+        memset(w, 0, sizeof(*w));
+        w->first_seed = first_seed;
+        w->seeds = seeds;
+        w->index = started;
+        w->stride = jobs;
+        w->results = results;
+        if (pthread_create(&w->thread, NULL, sweep_worker_func, w) != 0) {
+            break;
+        }
+    }
+    int all_ok = started == jobs;
+    for (int j = 0; j < started; j++) {
+        pthread_join(workers[j].thread, NULL);
+        all_ok = all_ok && workers[j].ok;
+    }
+
+    // Agregado en orden de semilla: no depende de cuántos hilos hubo
+    out->digest = FNV_OFFSET;
+    for (int k = 0; k < seeds; k++) {
+        const irq_suite_result_t *r = &results[k];
+        if (r->digest == 0 || r->seed != first_seed + (uint64_t)k) {     // Hilo sin contexto
+            out->failed++;
+            if (out->failed == 1) {
+                out->first_failed_seed = first_seed + (uint64_t)k;
+            }
+            if (failures_out != NULL) {
+                fprintf(failures_out, "FAIL seed=%llu sin resultado\n",
+                        (unsigned long long)(first_seed + (uint64_t)k));
+            }
+            continue;
+        }
+        out->dispatches += (unsigned long)(r->events[IRQ_SUITE_BASIC] + r->events[IRQ_SUITE_ADVANCED]);
+        out->digest = fnv_mix(out->digest, r->digest);
+        if (r->failures > 0) {
+            if (out->failed++ == 0) {
+                out->first_failed_seed = r->seed;
+            }
+            if (failures_out != NULL) {
+                fprintf(failures_out, "FAIL seed=%llu failures=%d %s\n", (unsigned long long)r->seed,
+                        r->failures, r->reason);
+            }
+        }
+    }
+    out->elapsed_s = (now_ns() - start) / 1e9;
+    free(results);
+    return all_ok ? SUCCESS : ERROR_INVALID_ARG;
+}
+
+// Modos no interactivos (sin timer ni subsistemas de proceso)
+int irq_suite_main(int argc, char *argv[]) {
+    unsigned long long first = 1, seed = 0;
+    int seeds = 0, jobs = 0, replay = 0;
+
+    for (int i = 1; i < argc; i++) {
+        char *end = NULL;
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Uso: %s [--seed S | --sweep N [--first S] [--jobs J]]\n", argv[0]);
+            return 2;
+        }
+        if (strcmp(argv[i], "--seed") == 0) {
+            seed = strtoull(argv[++i], &end, 0);
+            replay = 1;
+        } else if (strcmp(argv[i], "--sweep") == 0) {
+            seeds = (int)strtol(argv[++i], &end, 0);
+        } else if (strcmp(argv[i], "--first") == 0) {
+            first = strtoull(argv[++i], &end, 0);
+        } else if (strcmp(argv[i], "--jobs") == 0) {
+            jobs = (int)strtol(argv[++i], &end, 0);
+        } else {
+            fprintf(stderr, "Opción desconocida: %s\n", argv[i]);
+            return 2;
+        }
+        if (end == argv[i] || *end != '\0') {
+            fprintf(stderr, "Valor inválido: %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    if (replay) {
+        irq_suite_result_t r;
+        init_idt();
+        init_system_stats();
+        swap_log_level(LOG_LEVEL_SILENT);
+        for (int kind = 0; kind < IRQ_SUITE_KINDS; kind++) {
+            irq_suite_plan_t plan;
+            irq_suite_plan((irq_suite_kind_t)kind, seed, &plan);
+            printf("%s:", irq_suite_kind_name((irq_suite_kind_t)kind));
+            for (int e = 0; e < plan.num_events; e++) {
+                printf(" IRQ%d%s/%lums", plan.events[e].irq, plan.events[e].pooled ? "*" : "",
+                       plan.events[e].delay_us / 1000);
+            }
+            printf("\n");
+        }
+        int rc = irq_suite_check_seed(seed, &r);
+        printf("%s seed=%llu basic=%d advanced=%d digest=0x%016llx%s%s\n", rc == SUCCESS ? "OK" : "FAIL",
+               seed, r.events[IRQ_SUITE_BASIC], r.events[IRQ_SUITE_ADVANCED], (unsigned long long)r.digest,
+               rc == SUCCESS ? "" : " ", r.reason);
+        return rc == SUCCESS ? 0 : 1;
+    }
+    if (seeds > 0) {
+        irq_suite_sweep_t sweep;
+        int rc = irq_suite_sweep(first, seeds, jobs, stdout, &sweep);
+        printf("%s seeds=%d failed=%d jobs=%d seconds=%.2f dispatches=%lu digest=0x%016llx\n",
+               rc == SUCCESS && sweep.failed == 0 ? "OK" : "FAIL", sweep.seeds, sweep.failed, sweep.jobs,
+               sweep.elapsed_s, sweep.dispatches, (unsigned long long)sweep.digest);
+        if (sweep.failed > 0) {
+            printf("🔁 Repetir la primera fallida: %s --seed %llu\n", argv[0],
+                   (unsigned long long)sweep.first_failed_seed);
+        }
+        return rc == SUCCESS && sweep.failed == 0 ? 0 : 1;
+    }
+    if (argc > 1) {
+        fprintf(stderr, "--first/--jobs requieren --sweep\n");
+        return 2;
+    }
+    return -1;
+}
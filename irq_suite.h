@@ -0,0 +1,81 @@
+#ifndef IRQ_SUITE_H
+#define IRQ_SUITE_H
+
+#include <stdint.h>
+#include "interrupt_simulator.h"
+
+// Escenarios sembrados de las suites de prueba y barrido paralelo
+//
+// Cada suite (la básica y la avanzada del menú) se describe como un plan:
+// la lista de interrupciones, las esperas entre ellas y cuáles van al pool
+// de trabajo. El plan sólo depende de la semilla (irq_rand.h), así que la
+// suite interactiva que imprime "Semilla: S" se puede repetir exactamente.
+//
+// El barrido ejecuta miles de semillas repartidas entre hilos (uno por
+// núcleo), cada uno con su propia máquina simulada (sim_context_create).
+// Cada hilo parte de una IDT limpia, ejecuta los planes sin esperas con una
+// ISR que cuenta sus ejecuciones y comprueba invariantes: cada despacho se
+// ejecutó exactamente una vez, call_count cuadra, ningún vector queda en
+// EXECUTING y la IDT vuelve a su estado inicial. Los resultados se agregan
+// por semilla con un resumen (digest) que no depende del número de hilos:
+// dos barridos con las mismas semillas deben dar el mismo digest.
+
+#define IRQ_SUITE_MAX_EVENTS 16
+
+typedef enum {
+    IRQ_SUITE_BASIC,
+    IRQ_SUITE_ADVANCED,
+    IRQ_SUITE_KINDS
+} irq_suite_kind_t;
+
+typedef struct {
+    int table_idx;                          // Índice en irq_table
+    int irq;
+    unsigned long delay_us;                 // Espera tras el evento
+    int pooled;                             // Ráfaga enviada al pool de trabajo
+} irq_suite_event_t;
+
+typedef struct {
+    irq_suite_kind_t kind;
+    uint64_t seed;
+    int num_events;
+    irq_suite_event_t events[IRQ_SUITE_MAX_EVENTS];
+} irq_suite_plan_t;
+
+typedef struct {
+    uint64_t seed;
+    int events[IRQ_SUITE_KINDS];
+    int failures;
+    uint64_t digest;                        // Plan y contadores finales
+    char reason[96];                        // Primer invariante roto
+} irq_suite_result_t;
+
+typedef struct {
+    uint64_t first_seed;
+    int seeds;
+    int jobs;
+    int failed;
+    uint64_t first_failed_seed;
+    unsigned long dispatches;
+    double elapsed_s;
+    uint64_t digest;                        // Combinación en orden de semilla
+} irq_suite_sweep_t;
+
+void irq_suite_plan(irq_suite_kind_t kind, uint64_t seed, irq_suite_plan_t *plan);
+const char *irq_suite_kind_name(irq_suite_kind_t kind);
+
+// Ejecuta las dos suites de una semilla sobre el contexto actual (que debe
+// tener libres los vectores de irq_table) y comprueba los invariantes
+int irq_suite_check_seed(uint64_t seed, irq_suite_result_t *out);
+
+// Barrido en jobs hilos (0 = uno por núcleo), cada uno en un contexto nuevo.
+// failures_out recibe una línea por semilla fallida.
+int irq_suite_sweep(uint64_t first_seed, int seeds, int jobs, FILE *failures_out,
+                    irq_suite_sweep_t *out);
+
+// Modos de línea de órdenes compartidos por el menú e irqrun:
+// --seed S repite una semilla, --sweep N [--first S] [--jobs J] barre N.
+// Devuelve el código de salida, o -1 si no hay modo que ejecutar
+int irq_suite_main(int argc, char *argv[]);
+
+#endif // IRQ_SUITE_H
@@ -0,0 +1,626 @@
+#define _GNU_SOURCE
+#include <stdarg.h>
+#include "irq_trace.h"
+
+#define TEMPLATE_HASH_SIZE (IRQ_TRACE_MAX_TEMPLATES * 2)
+#define NAME_HASH_SIZE (IRQ_TRACE_MAX_NAMES * 2)
+
+_Static_assert(sizeof(irq_trace_record_t) == 32, "el registro de traza debe ocupar 32 bytes");
+_Static_assert(IRQ_TRACE_MAX_TEMPLATES <= 256, "template_id se guarda en un byte");
+_Static_assert((IRQ_TRACE_RECORDS & (IRQ_TRACE_RECORDS - 1)) == 0, "IRQ_TRACE_RECORDS debe ser potencia de 2");
+_Static_assert((IRQ_TRACE_ARENA_SIZE & (IRQ_TRACE_ARENA_SIZE - 1)) == 0, "IRQ_TRACE_ARENA_SIZE debe ser potencia de 2");
+_Static_assert(IRQ_TRACE_MAX_NAMES <= 65536, "los ids de texto se guardan en 16 bits");
+
+typedef enum {
+    ARG_INT,                                // d, i, c
+    ARG_UINT,                               // u, x, X, o
+    ARG_LONG,                               // ld, li (si cabe en 32 bits)
+    ARG_ULONG,                              // lu, lx, zu... (si cabe en 32 bits)
+    ARG_STRING                              // s (internado o al anillo de texto)
+} arg_kind_t;
+
+typedef struct {
+    const char *fmt;
+    int compact;                            // 0 = se guarda formateado
+    int argc;
+    unsigned char kinds[IRQ_TRACE_MAX_ARGS + IRQ_TRACE_MAX_ARGS];
+    int strings;
+    int named;                              // Cada %s ocupa un argumento con su id de texto
+} trace_template_t;
+
+// La plantilla 0 es el texto libre: "%s" con todo el mensaje en el anillo
+static trace_template_t templates[IRQ_TRACE_MAX_TEMPLATES] = {
+    {"%s", 1, 1, {ARG_STRING}, 1, 0}
+};
+static int template_count = 1;
+static const char *template_keys[TEMPLATE_HASH_SIZE];
+static uint16_t template_ids[TEMPLATE_HASH_SIZE];
+static pthread_mutex_t template_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Textos %s internados por contenido; nunca se liberan
+static char names[IRQ_TRACE_MAX_NAMES][IRQ_TRACE_NAME_LEN];
+static int name_count = 0;
+static const char *name_keys[NAME_HASH_SIZE];
+static uint16_t name_ids[NAME_HASH_SIZE];
+static pthread_mutex_t name_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Anillo de la máquina por defecto (los contextos creados tienen el suyo)
+static irq_trace_ring_t process_ring = { .mutex = PTHREAD_MUTEX_INITIALIZER, .sink_enabled = 1 };
+static irq_trace_sink_t trace_sink = NULL;
+
+// Clasificar los argumentos de un formato; 0 si no se puede compactar
+static int parse_template(trace_template_t *t) {
+    int count = 0;
+    t->argc = 0;
+    t->strings = 0;
+    for (const char *p = t->fmt; *p != '\0'; p++) {
+        if (*p != '%') {
+            continue;
+        }
+        p++;
+        if (*p == '%') {
+            continue;
+        }
+        while (*p != '\0' && strchr("-+ #0123456789.", *p) != NULL) {
+            p++;
+        }
+        int is_long = 0;
+        while (*p == 'l' || *p == 'z') {
+            is_long = 1;
+            p++;
+        }
+        arg_kind_t kind;
+        switch (*p) {
+            case 'd': case 'i': case 'c':
+                kind = is_long ? ARG_LONG : ARG_INT;
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                kind = is_long ? ARG_ULONG : ARG_UINT;
+                break;
+            case 's':
+                kind = ARG_STRING;
+                t->strings++;
+                break;
+            default:
+                return 0;                   // Flotantes, punteros, '*'...
+        }
+        if (kind != ARG_STRING && ++count > IRQ_TRACE_MAX_ARGS) {
+            return 0;
+        }
+        if (t->argc >= (int)sizeof(t->kinds)) {
+            return 0;
+        }
+        t->kinds[t->argc++] = (unsigned char)kind;
+        if (*p == '\0') {
+            return 0;
+        }
+    }
+    t->named = count + t->strings <= IRQ_TRACE_MAX_ARGS;
+    return 1;
+}
+
+// Id de la plantilla (por puntero: una búsqueda sin bloqueo en el caso común)
+static int intern_template(const char *fmt) {
+    unsigned int slot = (unsigned int)(((uintptr_t)fmt >> 3) * 2654435761u) % TEMPLATE_HASH_SIZE;
+    for (int probe = 0; probe < TEMPLATE_HASH_SIZE; probe++) {
+        unsigned int i = (slot + (unsigned int)probe) % TEMPLATE_HASH_SIZE;
+        const char *key = __atomic_load_n(&template_keys[i], __ATOMIC_ACQUIRE);
+        if (key == fmt) {
+            return template_ids[i];
+        }
+        if (key != NULL) {
+            continue;
+        }
+
+        pthread_mutex_lock(&template_mutex);
+        key = __atomic_load_n(&template_keys[i], __ATOMIC_ACQUIRE);
+        if (key != NULL) {
+            pthread_mutex_unlock(&template_mutex);
+            probe--;                        // Otro hilo ocupó la ranura: repetirla
+            continue;
+        }
+        // El mismo texto desde otro punto del código comparte plantilla
+        int id = -1;
+        for (int t = 1; t < template_count; t++) {
+            if (strcmp(templates[t].fmt, fmt) == 0) {
+                id = t;
+                break;
+            }
+        }
+        if (id < 0 && template_count < IRQ_TRACE_MAX_TEMPLATES) {
+            trace_template_t *t = &templates[template_count];
+            t->fmt = fmt;
+            t->compact = parse_template(t);
+            id = template_count;
+            __atomic_store_n(&template_count, id + 1, __ATOMIC_RELEASE);
+        }
+        if (id < 0) {
+            pthread_mutex_unlock(&template_mutex);
+            return -1;                      // Tabla llena: guardar el texto
+        }
+        template_ids[i] = (uint16_t)id;
+        __atomic_store_n(&template_keys[i], fmt, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&template_mutex);
+        return id;
+    }
+    return -1;
+}
+
+// Id de un texto %s (por contenido); IRQ_TRACE_ARG_TEXT si es largo o ya no
+// caben más y hay que copiarlo al anillo
+static uint32_t intern_name(const char *text) {
+    size_t len = strnlen(text, IRQ_TRACE_NAME_LEN);
+    if (len >= IRQ_TRACE_NAME_LEN) {
+        return IRQ_TRACE_ARG_TEXT;
+    }
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ (unsigned char)text[i]) * 16777619u;
+    }
+
+    for (int probe = 0; probe < NAME_HASH_SIZE; probe++) {
+        unsigned int i = (hash + (unsigned int)probe) % NAME_HASH_SIZE;
+        const char *key = __atomic_load_n(&name_keys[i], __ATOMIC_ACQUIRE);
+        if (key != NULL) {
+            if (strcmp(key, text) == 0) {
+                return name_ids[i];
+            }
+            continue;
+        }
+        if (__atomic_load_n(&name_count, __ATOMIC_RELAXED) >= IRQ_TRACE_MAX_NAMES) {
+            return IRQ_TRACE_ARG_TEXT;
+        }
+
+        pthread_mutex_lock(&name_mutex);
+        key = __atomic_load_n(&name_keys[i], __ATOMIC_ACQUIRE);
+        if (key != NULL) {
+            pthread_mutex_unlock(&name_mutex);
+            probe--;                        // Otro hilo ocupó la ranura: repetirla
+            continue;
+        }
+        if (name_count >= IRQ_TRACE_MAX_NAMES) {
+            pthread_mutex_unlock(&name_mutex);
+            return IRQ_TRACE_ARG_TEXT;
+        }
+        int id = name_count;
+        memcpy(names[id], text, len + 1);
+        __atomic_store_n(&name_count, id + 1, __ATOMIC_RELAXED);
+        name_ids[i] = (uint16_t)id;
+        __atomic_store_n(&name_keys[i], names[id], __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&name_mutex);
+        return (uint32_t)id;
+    }
+    return IRQ_TRACE_ARG_TEXT;
+}
+
+static irq_trace_ring_t *current_ring(void) {
+    irq_trace_ring_t *ring = sim_current()->trace;
+    return ring != NULL ? ring : &process_ring;
+}
+
+irq_trace_ring_t *irq_trace_ring_create(void) {
+    irq_trace_ring_t *ring = calloc(1, sizeof(*ring));
+    if (ring != NULL) {
+        pthread_mutex_init(&ring->mutex, NULL);
+    }
+    return ring;
+}
+
+void irq_trace_ring_destroy(irq_trace_ring_t *ring) {
+    if (ring != NULL && ring != &process_ring) {
+        pthread_mutex_destroy(&ring->mutex);
+        free(ring);
+    }
+}
+
+static uint64_t realtime_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Copiar un texto al anillo (con ring->mutex tomado)
+static void arena_append(irq_trace_ring_t *ring, const char *text, int terminate) {
+    size_t len = strnlen(text, MAX_TRACE_MSG_LEN - 1);
+    for (size_t i = 0; i < len; i++) {
+        ring->arena[(ring->arena_head + i) & (IRQ_TRACE_ARENA_SIZE - 1)] = text[i];
+    }
+    ring->arena_head += (uint32_t)len;
+    if (terminate) {
+        ring->arena[ring->arena_head & (IRQ_TRACE_ARENA_SIZE - 1)] = '\0';
+        ring->arena_head++;
+    }
+}
+
+// Leer un texto del anillo y avanzar el cursor hasta el siguiente (con ring->mutex tomado)
+static size_t arena_read(const irq_trace_ring_t *ring, uint32_t *cursor, char *out, size_t size) {
+    size_t len = 0;
+    for (;;) {
+        char c = ring->arena[(*cursor)++ & (IRQ_TRACE_ARENA_SIZE - 1)];
+        if (c == '\0') {
+            break;
+        }
+        if (len + 1 < size) {
+            out[len++] = c;
+        }
+    }
+    out[len] = '\0';
+    return len;
+}
+
+// Entregar el registro al receptor con sus textos contiguos (con ring->mutex tomado).
+// El receptor recibe siempre los enteros seguidos y todos los %s en el texto,
+// también los internados, como en la captura a disco.
+static void publish_record(irq_trace_ring_t *ring, const irq_trace_record_t *r) {
+    irq_trace_sink_t sink = __atomic_load_n(&trace_sink, __ATOMIC_ACQUIRE);
+    if (sink == NULL || !ring->sink_enabled) {
+        return;
+    }
+    const trace_template_t *t = &templates[r->template_id];
+    char payload[IRQ_TRACE_SINK_PAYLOAD];
+    size_t len = 0;
+
+    if (!t->named) {
+        len = ring->arena_head - r->payload;
+        if (len > sizeof(payload)) {
+            len = sizeof(payload);
+        }
+        for (size_t i = 0; i < len; i++) {
+            payload[i] = ring->arena[(r->payload + i) & (IRQ_TRACE_ARENA_SIZE - 1)];
+        }
+        sink(r, payload, len);
+        return;
+    }
+
+    irq_trace_record_t flat = *r;
+    uint32_t cursor = r->payload;
+    int n = 0;
+    memset(flat.args, 0, sizeof(flat.args));
+    for (int i = 0; i < t->argc; i++) {
+        if (t->kinds[i] != ARG_STRING) {
+            flat.args[n++] = r->args[i];
+            continue;
+        }
+        char text[MAX_TRACE_MSG_LEN];
+        size_t tlen = r->args[i] != IRQ_TRACE_ARG_TEXT ?
+            (size_t)snprintf(text, sizeof(text), "%s", names[r->args[i]]) :
+            arena_read(ring, &cursor, text, sizeof(text));
+        if (len + tlen + 1 > sizeof(payload)) {
+            break;
+        }
+        memcpy(payload + len, text, tlen + 1);
+        len += tlen + 1;
+    }
+    sink(&flat, payload, len);
+}
+
+static irq_trace_record_t *next_record(irq_trace_ring_t *ring, int irq_num, int flags, int template_id) {
+    irq_trace_record_t *r = &ring->records[ring->record_head & (IRQ_TRACE_RECORDS - 1)];
+    r->timestamp_ns = realtime_ns();
+    int cpu = sched_getcpu();
+    r->template_id = (uint8_t)template_id;
+    r->cpu = (uint8_t)(cpu >= 0 && cpu < IRQ_TRACE_NO_CPU ? cpu : IRQ_TRACE_NO_CPU);
+    r->irq = (int8_t)(irq_num >= 0 && irq_num < 128 ? irq_num : -1);
+    r->flags = (uint8_t)flags;
+    r->payload = ring->arena_head;
+    return r;
+}
+
+void irq_trace_emit_text(int irq_num, int flags, const char *text) {
+    irq_trace_ring_t *ring = current_ring();
+    pthread_mutex_lock(&ring->mutex);
+    irq_trace_record_t *r = next_record(ring, irq_num, flags, 0);
+    arena_append(ring, text, 1);
+    publish_record(ring, r);
+    __atomic_store_n(&ring->record_head, ring->record_head + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+void irq_trace_emitv(int irq_num, int flags, const char *fmt, va_list ap) {
+    int id = intern_template(fmt);
+    int compact = id >= 0 && templates[id].compact;
+    const trace_template_t *t = compact ? &templates[id] : NULL;
+    uint32_t args[IRQ_TRACE_MAX_ARGS] = {0};
+    const char *texts[IRQ_TRACE_MAX_ARGS + IRQ_TRACE_MAX_ARGS];
+    int n = 0, texts_count = 0;
+    va_list copy;
+
+    // Recoger los argumentos fuera del mutex; un %ld/%lu que no cabe en
+    // 32 bits obliga a guardar este registro ya formateado
+    va_copy(copy, ap);
+    for (int i = 0; compact && i < t->argc; i++) {
+        switch (t->kinds[i]) {
+            case ARG_INT:
+                args[n++] = (uint32_t)va_arg(ap, int);
+                break;
+            case ARG_UINT:
+                args[n++] = va_arg(ap, unsigned int);
+                break;
+            case ARG_LONG: {
+                long value = va_arg(ap, long);
+                compact = value >= INT32_MIN && value <= INT32_MAX;
+                args[n++] = (uint32_t)value;
+                break;
+            }
+            case ARG_ULONG: {
+                unsigned long value = va_arg(ap, unsigned long);
+                compact = value <= UINT32_MAX;
+                args[n++] = (uint32_t)value;
+                break;
+            }
+            case ARG_STRING: {
+                const char *s = va_arg(ap, const char *);
+                s = s != NULL ? s : "(null)";
+                uint32_t name = t->named ? intern_name(s) : IRQ_TRACE_ARG_TEXT;
+                if (t->named) {
+                    args[n++] = name;
+                }
+                if (name == IRQ_TRACE_ARG_TEXT) {
+                    texts[texts_count++] = s;
+                }
+                break;
+            }
+        }
+    }
+    if (!compact) {
+        char text[MAX_TRACE_MSG_LEN];
+        vsnprintf(text, sizeof(text), fmt, copy);
+        va_end(copy);
+        irq_trace_emit_text(irq_num, flags, text);
+        return;
+    }
+    va_end(copy);
+
+    irq_trace_ring_t *ring = current_ring();
+    pthread_mutex_lock(&ring->mutex);
+    irq_trace_record_t *r = next_record(ring, irq_num, flags, id);
+    memcpy(r->args, args, sizeof(r->args));
+    for (int i = 0; i < texts_count; i++) {
+        arena_append(ring, texts[i], 1);
+    }
+    publish_record(ring, r);
+    __atomic_store_n(&ring->record_head, ring->record_head + 1, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&ring->mutex);
+}
+
+void irq_trace_set_sink(irq_trace_sink_t sink) {
+    pthread_mutex_lock(&process_ring.mutex);
+    __atomic_store_n(&trace_sink, sink, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&process_ring.mutex);
+}
+
+int irq_trace_template_info(int id, const char **fmt, int *int_args) {
+    if (id < 0 || id >= __atomic_load_n(&template_count, __ATOMIC_ACQUIRE)) {
+        return ERROR_INVALID_ARG;
+    }
+    *fmt = templates[id].fmt;
+    *int_args = templates[id].argc - templates[id].strings;
+    return SUCCESS;
+}
+
+// ---- Lectura ----
+
+// Hora local de una marca de tiempo (una conversión por segundo y por hilo)
+static void format_timestamp(uint64_t timestamp_ns, char *buffer, size_t size) {
+    static __thread time_t cached_time = -1;
+    static __thread char cached[16];
+    time_t seconds = (time_t)(timestamp_ns / 1000000000ULL);
+    if (seconds != cached_time) {
+        struct tm timeinfo;
+        localtime_r(&seconds, &timeinfo);
+        strftime(cached, sizeof(cached), "%H:%M:%S", &timeinfo);
+        cached_time = seconds;
+    }
+    snprintf(buffer, size, "%s", cached);
+}
+
+// Reconstruir el texto de un registro (con ring->mutex tomado)
+static void render_record(irq_trace_ring_t *ring, const irq_trace_record_t *r, char *out, size_t size) {
+    const trace_template_t *t = &templates[r->template_id];
+    int payload_valid = (uint32_t)(ring->arena_head - r->payload) <= IRQ_TRACE_ARENA_SIZE;
+    uint32_t cursor = r->payload;
+    size_t used = 0;
+    int arg = 0, n = 0, lost = 0;
+
+    out[0] = '\0';
+    for (const char *p = t->fmt; *p != '\0' && used + 1 < size; p++) {
+        if (*p != '%') {
+            out[used++] = *p;
+            out[used] = '\0';
+            continue;
+        }
+        if (p[1] == '%') {
+            out[used++] = '%';
+            out[used] = '\0';
+            p++;
+            continue;
+        }
+
+        // Copiar la especificación completa y formatear un solo valor
+        char spec[16];
+        size_t len = 0;
+        spec[len++] = *p++;
+        while (*p != '\0' && strchr("-+ #0123456789.lz", *p) != NULL && len < sizeof(spec) - 2) {
+            spec[len++] = *p++;
+        }
+        spec[len++] = *p;
+        spec[len] = '\0';
+
+        int written = 0;
+        switch (t->kinds[arg++]) {
+            case ARG_INT:
+                written = snprintf(out + used, size - used, spec, (int)r->args[n++]);
+                break;
+            case ARG_UINT:
+                written = snprintf(out + used, size - used, spec, (unsigned int)r->args[n++]);
+                break;
+            case ARG_LONG:
+                written = snprintf(out + used, size - used, spec, (long)(int32_t)r->args[n++]);
+                break;
+            case ARG_ULONG:
+                written = snprintf(out + used, size - used, spec, (unsigned long)r->args[n++]);
+                break;
+            case ARG_STRING: {
+                char text[MAX_TRACE_MSG_LEN];
+                uint32_t name = t->named ? r->args[n++] : IRQ_TRACE_ARG_TEXT;
+                if (name != IRQ_TRACE_ARG_TEXT) {
+                    snprintf(text, sizeof(text), "%s", names[name]);
+                } else if (payload_valid) {
+                    arena_read(ring, &cursor, text, sizeof(text));
+                } else {
+                    snprintf(text, sizeof(text), "(texto sobrescrito)");
+                    lost = 1;
+                }
+                written = snprintf(out + used, size - used, spec, text);
+                break;
+            }
+        }
+        if (written > 0) {
+            used += (size_t)written < size - used ? (size_t)written : size - used - 1;
+        }
+    }
+    ring->payload_lost += (unsigned long)lost;
+}
+
+int irq_trace_count(void) {
+    irq_trace_ring_t *ring = current_ring();
+    unsigned long head = __atomic_load_n(&ring->record_head, __ATOMIC_ACQUIRE);
+    return head < IRQ_TRACE_RECORDS ? (int)head : IRQ_TRACE_RECORDS;
+}
+
+int irq_trace_get(int age, trace_entry_t *out) {
+    irq_trace_ring_t *ring = current_ring();
+    pthread_mutex_lock(&ring->mutex);
+    if (age < 0 || (unsigned long)age >= ring->record_head || age >= IRQ_TRACE_RECORDS) {
+        pthread_mutex_unlock(&ring->mutex);
+        return ERROR_INVALID_ARG;
+    }
+    const irq_trace_record_t *r = &ring->records[(ring->record_head - 1 - (unsigned long)age) & (IRQ_TRACE_RECORDS - 1)];
+    format_timestamp(r->timestamp_ns, out->timestamp, sizeof(out->timestamp));
+    out->irq_num = r->irq;
+    render_record(ring, r, out->event, sizeof(out->event));
+    pthread_mutex_unlock(&ring->mutex);
+    return SUCCESS;
+}
+
+int irq_trace_copy_recent(trace_entry_t *out, int max) {
+    irq_trace_ring_t *ring = current_ring();
+    pthread_mutex_lock(&ring->mutex);
+    int available = ring->record_head < IRQ_TRACE_RECORDS ? (int)ring->record_head : IRQ_TRACE_RECORDS;
+    int count = max < available ? max : available;
+    for (int i = 0; i < count; i++) {
+        const irq_trace_record_t *r =
+            &ring->records[(ring->record_head - (unsigned long)(count - i)) & (IRQ_TRACE_RECORDS - 1)];
+        format_timestamp(r->timestamp_ns, out[i].timestamp, sizeof(out[i].timestamp));
+        out[i].irq_num = r->irq;
+        render_record(ring, r, out[i].event, sizeof(out[i].event));
+    }
+    pthread_mutex_unlock(&ring->mutex);
+    return count < 0 ? 0 : count;
+}
+
+int irq_trace_is_timer(int age) {
+    irq_trace_ring_t *ring = current_ring();
+    pthread_mutex_lock(&ring->mutex);
+    int timer = 0;
+    if (age >= 0 && (unsigned long)age < ring->record_head && age < IRQ_TRACE_RECORDS) {
+        const irq_trace_record_t *r = &ring->records[(ring->record_head - 1 - (unsigned long)age) & (IRQ_TRACE_RECORDS - 1)];
+        timer = (r->flags & IRQ_TRACE_TIMER) || r->irq == IRQ_TIMER;
+    }
+    pthread_mutex_unlock(&ring->mutex);
+    return timer;
+}
+
+void irq_trace_get_stats(irq_trace_stats_t *out) {
+    irq_trace_ring_t *ring = current_ring();
+    pthread_mutex_lock(&ring->mutex);
+    out->emitted = ring->record_head;
+    out->records = ring->record_head < IRQ_TRACE_RECORDS ? (int)ring->record_head : IRQ_TRACE_RECORDS;
+    out->capacity = IRQ_TRACE_RECORDS;
+    out->record_size = (int)sizeof(irq_trace_record_t);
+    out->payload_bytes = ring->arena_head;
+    out->payload_lost = ring->payload_lost;
+    pthread_mutex_unlock(&ring->mutex);
+    out->templates = __atomic_load_n(&template_count, __ATOMIC_RELAXED);
+    out->names = __atomic_load_n(&name_count, __ATOMIC_RELAXED);
+    out->memory_bytes = sizeof(ring->records) + sizeof(ring->arena);
+    out->legacy_entry_size = sizeof(trace_entry_t);
+}
+
+// ---- Consultas ----
+
+int irq_trace_query(const irq_tracefile_query_t *q, trace_entry_t *out, int max, unsigned long *scanned) {
+    static __thread irq_trace_record_t snapshot[IRQ_TRACE_RECORDS];
+    static __thread unsigned long candidates[IRQ_TRACE_RECORDS];
+    const unsigned long text_bit = 1UL << (sizeof(long) * 8 - 1);  // Comprobar con el texto
+    signed char template_match[IRQ_TRACE_MAX_TEMPLATES];
+    int count = 0, found = 0;
+    irq_trace_ring_t *ring = current_ring();
+
+    // Copia de los registros: lo único que se hace con el emisor bloqueado
+    pthread_mutex_lock(&ring->mutex);
+    unsigned long head = ring->record_head;
+    int available = head < IRQ_TRACE_RECORDS ? (int)head : IRQ_TRACE_RECORDS;
+    for (int i = 0; i < available; i++) {
+        snapshot[i] = ring->records[(head - (unsigned long)available + (unsigned long)i) & (IRQ_TRACE_RECORDS - 1)];
+    }
+    pthread_mutex_unlock(&ring->mutex);
+
+    memset(template_match, 2, sizeof(template_match));  // 2 = sin evaluar
+    for (int i = available - 1; i >= 0 && found < max; i--) {
+        const irq_trace_record_t *r = &snapshot[i];
+        irq_tracefile_event_t ev = {
+            .timestamp_ns = r->timestamp_ns,
+            .irq = r->irq,
+            .cpu = r->cpu != IRQ_TRACE_NO_CPU ? r->cpu : -1,
+            .flags = r->flags | (r->irq == IRQ_TIMER ? IRQ_TRACE_TIMER : 0),
+        };
+        if (q->from_ns != 0 && r->timestamp_ns < q->from_ns) {
+            break;                          // Las anteriores son más antiguas
+        }
+        if (!irq_tracefile_match_event(q, &ev)) {
+            continue;
+        }
+        signed char *match = &template_match[r->template_id];
+        if (*match == 2) {
+            *match = (signed char)irq_tracefile_match_template(q, templates[r->template_id].fmt);
+        }
+        if (*match == 0) {
+            continue;
+        }
+        candidates[count++] = (head - (unsigned long)available + (unsigned long)i) | (*match < 0 ? text_bit : 0);
+        if (*match > 0) {
+            found++;
+        }
+    }
+    if (scanned != NULL) {
+        *scanned = (unsigned long)available;
+    }
+
+    // Reconstruir los elegidos; los sobrescritos desde la copia se pierden
+    int n = 0;
+    pthread_mutex_lock(&ring->mutex);
+    for (int c = 0; c < count && n < max; c++) {
+        unsigned long index = candidates[c] & ~text_bit;
+        if (ring->record_head - index > IRQ_TRACE_RECORDS) {
+            continue;
+        }
+        const irq_trace_record_t *r = &ring->records[index & (IRQ_TRACE_RECORDS - 1)];
+        render_record(ring, r, out[n].event, sizeof(out[n].event));
+        if ((candidates[c] & text_bit) && !irq_tracefile_match_text(q, out[n].event)) {
+            continue;
+        }
+        format_timestamp(r->timestamp_ns, out[n].timestamp, sizeof(out[n].timestamp));
+        out[n].irq_num = r->irq;
+        n++;
+    }
+    pthread_mutex_unlock(&ring->mutex);
+
+    // De la más reciente a la más antigua -> orden cronológico
+    for (int i = 0; i < n / 2; i++) {
+        trace_entry_t tmp = out[i];
+        out[i] = out[n - 1 - i];
+        out[n - 1 - i] = tmp;
+    }
+    return n;
+}
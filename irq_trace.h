@@ -0,0 +1,103 @@
+#ifndef IRQ_TRACE_H
+#define IRQ_TRACE_H
+
+#include <stdarg.h>
+#include <stdint.h>
+#include "interrupt_simulator.h"
+#include "irq_tracefile.h"
+
+// Almacenamiento compacto de la traza
+//
+// Cada entrada es un registro de 32 bytes: id de plantilla, IRQ, CPU, marca
+// de tiempo de 64 bits y hasta cuatro argumentos de 32 bits. Las plantillas
+// son los formatos printf de los mensajes fijos (despacho, ISRs...) y se
+// internan una sola vez por puntero. Si caben en los argumentos, los %s
+// cortos (descripciones de ISR, nombres de dispositivo) se internan por
+// contenido y el registro guarda su id. Los %s largos, los enteros %ld/%lu
+// que no caben en 32 bits y los mensajes ya formateados van a un anillo de
+// bytes aparte; si se ha sobrescrito cuando se consulta la entrada, el texto
+// se muestra como perdido. El texto sólo se reconstruye al leer la traza.
+
+#define IRQ_TRACE_RECORDS MAX_TRACE_LINES  // Potencia de 2
+#define IRQ_TRACE_ARENA_SIZE (IRQ_TRACE_RECORDS * 32)   // 32 bytes de texto por registro
+#define IRQ_TRACE_MAX_TEMPLATES 256
+#define IRQ_TRACE_MAX_ARGS 4
+#define IRQ_TRACE_MAX_NAMES 512             // Textos %s internados
+#define IRQ_TRACE_NAME_LEN MAX_DESCRIPTION_LEN
+#define IRQ_TRACE_ARG_TEXT 0xffffffffu      // Argumento %s guardado en el anillo de texto
+
+#define IRQ_TRACE_TIMER 0x01                // Entrada relacionada con el timer
+#define IRQ_TRACE_NO_CPU 0xff
+
+typedef struct {
+    uint64_t timestamp_ns;                  // CLOCK_REALTIME
+    uint8_t template_id;                    // < IRQ_TRACE_MAX_TEMPLATES
+    uint8_t cpu;                            // CPU del hilo emisor (IRQ_TRACE_NO_CPU = desconocida)
+    int8_t irq;                             // -1 = sin IRQ
+    uint8_t flags;
+    uint32_t payload;                       // Posición absoluta en el anillo de texto
+    uint32_t args[IRQ_TRACE_MAX_ARGS];
+} irq_trace_record_t;
+
+// Registros y anillo de texto de una máquina (sim_context_t::trace)
+struct irq_trace_ring {
+    pthread_mutex_t mutex;                  // Serializa a los emisores
+    irq_trace_record_t records[IRQ_TRACE_RECORDS];
+    unsigned long record_head;              // Entradas escritas
+    char arena[IRQ_TRACE_ARENA_SIZE];
+    uint32_t arena_head;                    // Bytes escritos (absoluto, da la vuelta)
+    unsigned long payload_lost;
+    int sink_enabled;                       // Sólo el anillo del proceso alimenta la captura
+};
+
+typedef struct {
+    unsigned long emitted;                  // Entradas escritas desde el arranque
+    int records;                            // Entradas disponibles ahora
+    int capacity;
+    int record_size;
+    int templates;
+    int names;                              // Textos %s internados
+    unsigned long payload_bytes;            // Bytes escritos en el anillo de texto
+    unsigned long payload_lost;             // Textos sobrescritos al leerlos
+    size_t memory_bytes;                    // Registros + anillo de texto
+    size_t legacy_entry_size;               // sizeof(trace_entry_t)
+} irq_trace_stats_t;
+
+// Receptor de cada registro nuevo (captura a disco). Se llama con el mutex
+// del anillo del proceso tomado; payload contiene los textos del registro separados por '\0'.
+typedef void (*irq_trace_sink_t)(const irq_trace_record_t *r, const char *payload, size_t len);
+
+#define IRQ_TRACE_SINK_PAYLOAD 1024         // Máximo de texto entregado al receptor
+
+// Anillo propio para un contexto creado con sim_context_create(); todas las
+// funciones de este módulo trabajan sobre el anillo del contexto actual
+irq_trace_ring_t *irq_trace_ring_create(void);
+void irq_trace_ring_destroy(irq_trace_ring_t *ring);
+
+// Registrar una entrada; fmt debe ser una cadena de vida estática
+void irq_trace_emitv(int irq_num, int flags, const char *fmt, va_list ap);
+// Registrar un texto ya formateado (va entero al anillo de texto)
+void irq_trace_emit_text(int irq_num, int flags, const char *text);
+
+// Entrada age-ésima desde la más reciente (0 = última), ya reconstruida
+int irq_trace_get(int age, trace_entry_t *out);
+// Las últimas max entradas, de la más antigua a la más reciente
+int irq_trace_copy_recent(trace_entry_t *out, int max);
+// 1 si el registro está marcado como del timer (sin reconstruir el texto)
+int irq_trace_is_timer(int age);
+int irq_trace_count(void);
+void irq_trace_get_stats(irq_trace_stats_t *out);
+
+// NULL para desconectar; sólo puede haber un receptor
+void irq_trace_set_sink(irq_trace_sink_t sink);
+// Formato y número de argumentos enteros de una plantilla
+int irq_trace_template_info(int id, const char **fmt, int *int_args);
+
+// Consulta sobre la traza en memoria: las últimas max entradas que cumplen
+// el filtro, de la más antigua a la más reciente. Los registros se copian
+// con el mutex del anillo tomado y se filtran fuera; sólo se reconstruye el texto de
+// los que cumplen (o de los de texto libre si hay filtro de categoría/tipo).
+// scanned (opcional) recibe los registros examinados.
+int irq_trace_query(const irq_tracefile_query_t *q, trace_entry_t *out, int max, unsigned long *scanned);
+
+#endif // IRQ_TRACE_H
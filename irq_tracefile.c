@@ -0,0 +1,1255 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "irq_tracefile.h"
+
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 12
+#define LZ_MAX_OFFSET 65535
+#define LZ_LAST_LITERALS 5                  // Los últimos bytes siempre van como literales
+
+// Cota del tamaño codificado de un evento (sin plantilla ni texto)
+#define EVENT_MAX_FIXED (6 * 10 + IRQ_TRACEFILE_MAX_ARGS * 5)
+
+// ---- Codificación de enteros ----
+
+size_t irq_tracefile_put_varint(uint8_t *out, uint64_t value) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+size_t irq_tracefile_get_varint(const uint8_t *in, size_t len, uint64_t *value) {
+    uint64_t result = 0;
+    for (size_t i = 0; i < len && i < 10; i++) {
+        result |= (uint64_t)(in[i] & 0x7f) << (7 * i);
+        if ((in[i] & 0x80) == 0) {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static uint64_t zigzag_encode(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static int64_t zigzag_decode(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+static void put_u32(uint8_t *out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static void put_u64(uint8_t *out, uint64_t value) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = (uint8_t)(value >> (8 * i));
+    }
+}
+
+static uint32_t get_u32(const uint8_t *in) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; i++) {
+        value |= (uint32_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+static uint64_t get_u64(const uint8_t *in) {
+    uint64_t value = 0;
+    for (int i = 0; i < 8; i++) {
+        value |= (uint64_t)in[i] << (8 * i);
+    }
+    return value;
+}
+
+// FNV-1a de los bytes de un bloque tal como están en disco
+static uint32_t block_checksum(const uint8_t *data, size_t len) {
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// ---- Compresión LZ77 (secuencias estilo LZ4) ----
+//
+// Cada secuencia es un token (literales << 4 | coincidencia - 4), las
+// extensiones de longitud en bytes de 255, los literales y un offset de
+// 16 bits. La última secuencia sólo lleva literales.
+
+static size_t put_length(uint8_t *out, size_t pos, size_t cap, size_t extra) {
+    while (extra >= 255) {
+        if (pos >= cap) {
+            return 0;
+        }
+        out[pos++] = 255;
+        extra -= 255;
+    }
+    if (pos >= cap) {
+        return 0;
+    }
+    out[pos++] = (uint8_t)extra;
+    return pos;
+}
+
+static size_t emit_sequence(uint8_t *dst, size_t pos, size_t cap, const uint8_t *literals,
+                            size_t lit_len, size_t offset, size_t match_len) {
+    if (pos >= cap) {
+        return 0;
+    }
+    size_t token_pos = pos++;
+    uint8_t token = (uint8_t)((lit_len < 15 ? lit_len : 15) << 4);
+    if (lit_len >= 15 && (pos = put_length(dst, pos, cap, lit_len - 15)) == 0) {
+        return 0;
+    }
+    if (pos + lit_len > cap) {
+        return 0;
+    }
+    memcpy(dst + pos, literals, lit_len);
+    pos += lit_len;
+
+    if (match_len > 0) {
+        size_t code = match_len - LZ_MIN_MATCH;
+        token |= (uint8_t)(code < 15 ? code : 15);
+        if (pos + 2 > cap) {
+            return 0;
+        }
+        dst[pos++] = (uint8_t)offset;
+        dst[pos++] = (uint8_t)(offset >> 8);
+        if (code >= 15 && (pos = put_length(dst, pos, cap, code - 15)) == 0) {
+            return 0;
+        }
+    }
+    dst[token_pos] = token;
+    return pos;
+}
+
+size_t irq_tracefile_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap) {
+    uint32_t table[1 << LZ_HASH_BITS];      // Posición + 1 (0 = vacía)
+    memset(table, 0, sizeof(table));
+
+    size_t ip = 0, anchor = 0, out = 0;
+    while (len > LZ_MIN_MATCH + LZ_LAST_LITERALS && ip + LZ_MIN_MATCH + LZ_LAST_LITERALS <= len) {
+        uint32_t seq;
+        memcpy(&seq, src + ip, sizeof(seq));
+        uint32_t h = (seq * 2654435761u) >> (32 - LZ_HASH_BITS);
+        size_t ref = table[h];
+        table[h] = (uint32_t)ip + 1;
+        if (ref == 0 || ip - (ref - 1) > LZ_MAX_OFFSET || memcmp(src + ref - 1, src + ip, LZ_MIN_MATCH) != 0) {
+            ip++;
+            continue;
+        }
+        ref--;
+
+        size_t match = LZ_MIN_MATCH;
+        while (ip + match < len - LZ_LAST_LITERALS && src[ref + match] == src[ip + match]) {
+            match++;
+        }
+        out = emit_sequence(dst, out, cap, src + anchor, ip - anchor, ip - ref, match);
+        if (out == 0) {
+            return 0;
+        }
+        ip += match;
+        anchor = ip;
+    }
+
+    out = emit_sequence(dst, out, cap, src + anchor, len - anchor, 0, 0);
+    return out < len ? out : 0;
+}
+
+static int get_length(const uint8_t *src, size_t len, size_t *pos, size_t *value) {
+    uint8_t b;
+    do {
+        if (*pos >= len) {
+            return -1;
+        }
+        b = src[(*pos)++];
+        *value += b;
+    } while (b == 255);
+    return 0;
+}
+
+long irq_tracefile_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap) {
+    size_t ip = 0, op = 0;
+    while (ip < len) {
+        uint8_t token = src[ip++];
+        size_t lit_len = token >> 4;
+        if (lit_len == 15 && get_length(src, len, &ip, &lit_len) < 0) {
+            return -1;
+        }
+        if (ip + lit_len > len || op + lit_len > cap) {
+            return -1;
+        }
+        memcpy(dst + op, src + ip, lit_len);
+        ip += lit_len;
+        op += lit_len;
+        if (ip == len) {
+            break;                          // Última secuencia
+        }
+
+        if (ip + 2 > len) {
+            return -1;
+        }
+        size_t offset = (size_t)src[ip] | ((size_t)src[ip + 1] << 8);
+        ip += 2;
+        size_t match = token & 0x0f;
+        if (match == 15 && get_length(src, len, &ip, &match) < 0) {
+            return -1;
+        }
+        match += LZ_MIN_MATCH;
+        if (offset == 0 || offset > op || op + match > cap) {
+            return -1;
+        }
+        // Byte a byte: la coincidencia puede solaparse con lo que se copia
+        for (size_t i = 0; i < match; i++, op++) {
+            dst[op] = dst[op - offset];
+        }
+    }
+    return (long)op;
+}
+
+// ---- Plantillas ----
+
+// 1 si la plantilla tiene conversiones %s (el evento lleva texto)
+static int fmt_has_text(const char *fmt) {
+    for (const char *p = fmt; *p != '\0'; p++) {
+        if (*p != '%') {
+            continue;
+        }
+        p++;
+        while (*p != '\0' && strchr("-+ #0123456789.lz", *p) != NULL) {
+            p++;
+        }
+        if (*p == 's') {
+            return 1;
+        }
+        if (*p == '\0') {
+            break;
+        }
+    }
+    return 0;
+}
+
+void irq_tracefile_render(const irq_tracefile_event_t *ev, char *out, size_t size) {
+    size_t used = 0;
+    size_t cursor = 0;
+    int n = 0;
+
+    if (size == 0) {
+        return;
+    }
+    out[0] = '\0';
+    for (const char *p = ev->fmt; *p != '\0' && used + 1 < size; p++) {
+        if (*p != '%') {
+            out[used++] = *p;
+            out[used] = '\0';
+            continue;
+        }
+        if (p[1] == '%') {
+            out[used++] = '%';
+            out[used] = '\0';
+            p++;
+            continue;
+        }
+
+        char spec[16];
+        size_t len = 0;
+        int is_long = 0;
+        spec[len++] = *p++;
+        while (*p != '\0' && strchr("-+ #0123456789.lz", *p) != NULL && len < sizeof(spec) - 2) {
+            if (*p == 'l' || *p == 'z') {
+                is_long = 1;
+            }
+            spec[len++] = *p++;
+        }
+        if (*p == '\0') {
+            break;
+        }
+        spec[len++] = *p;
+        spec[len] = '\0';
+
+        uint32_t arg = n < ev->argc ? ev->args[n] : 0;
+        int written = 0;
+        switch (*p) {
+            case 'd': case 'i': case 'c':
+                n++;
+                written = is_long ? snprintf(out + used, size - used, spec, (long)(int32_t)arg)
+                                  : snprintf(out + used, size - used, spec, (int)arg);
+                break;
+            case 'u': case 'x': case 'X': case 'o':
+                n++;
+                written = is_long ? snprintf(out + used, size - used, spec, (unsigned long)arg)
+                                  : snprintf(out + used, size - used, spec, (unsigned int)arg);
+                break;
+            case 's': {
+                const char *text = "";
+                size_t avail = 0;
+                if (ev->text != NULL && cursor < ev->text_len) {
+                    text = ev->text + cursor;
+                    avail = strnlen(text, ev->text_len - cursor);
+                    cursor += avail + 1;
+                }
+                written = snprintf(out + used, size - used, "%.*s", (int)avail, text);
+                break;
+            }
+            default:
+                written = snprintf(out + used, size - used, "%s", spec);
+                break;
+        }
+        if (written > 0) {
+            used += (size_t)written < size - used ? (size_t)written : size - used - 1;
+        }
+    }
+}
+
+// ---- Consultas ----
+
+void irq_tracefile_category(const char *text, char *out, size_t size) {
+    const char *p = text;
+    size_t len = 0;
+
+    // Saltar sangría, emoji y signos hasta la primera letra
+    while (*p != '\0' && !(*p >= 'A' && *p <= 'Z') && !(*p >= 'a' && *p <= 'z')) {
+        p++;
+    }
+    while ((p[len] >= 'A' && p[len] <= 'Z') || (p[len] >= '0' && p[len] <= '9') || p[len] == '_') {
+        len++;
+    }
+    if (len == 0 || p[len] != ':' || len >= size) {
+        len = 0;
+    }
+    memcpy(out, p, len);
+    out[len] = '\0';
+}
+
+static int match_category_type(const irq_tracefile_query_t *q, const char *text) {
+    if (q->category[0] != '\0') {
+        char category[32];
+        irq_tracefile_category(text, category, sizeof(category));
+        if (strcasecmp(category, q->category) != 0) {
+            return 0;
+        }
+    }
+    return q->type[0] == '\0' || strstr(text, q->type) != NULL;
+}
+
+int irq_tracefile_match_template(const irq_tracefile_query_t *q, const char *fmt) {
+    if (q->category[0] == '\0' && q->type[0] == '\0') {
+        return 1;
+    }
+    if (strcmp(fmt, "%s") == 0) {
+        return -1;                          // Texto libre: se decide con el texto
+    }
+    return match_category_type(q, fmt);
+}
+
+int irq_tracefile_match_text(const irq_tracefile_query_t *q, const char *text) {
+    return match_category_type(q, text);
+}
+
+int irq_tracefile_match_event(const irq_tracefile_query_t *q, const irq_tracefile_event_t *ev) {
+    return (q->from_ns == 0 || ev->timestamp_ns >= q->from_ns) &&
+           (q->to_ns == 0 || ev->timestamp_ns <= q->to_ns) &&
+           (q->irq_mask == 0 || (q->irq_mask & IRQ_TRACEFILE_IRQ_BIT(ev->irq)) != 0) &&
+           (q->cpu_mask == 0 || (q->cpu_mask & IRQ_TRACEFILE_CPU_BIT(ev->cpu)) != 0) &&
+           (ev->flags & q->exclude_flags) == 0;
+}
+
+int irq_tracefile_parse_mask(const char *list, int cpus, uint64_t *mask) {
+    const char *p = list;
+    *mask = 0;
+    while (*p != '\0') {
+        char *end;
+        long value = strtol(p, &end, 10);
+        if (end == p || value < (cpus ? 0 : -1) || value > 1024 || (*end != ',' && *end != '\0')) {
+            return -1;
+        }
+        *mask |= cpus ? IRQ_TRACEFILE_CPU_BIT((int)value) : IRQ_TRACEFILE_IRQ_BIT((int)value);
+        p = *end == ',' ? end + 1 : end;
+    }
+    return *mask != 0 ? 0 : -1;
+}
+
+// Resumen de un bloque: compartido por su cabecera y su entrada del índice
+static void put_summary(uint8_t *out, const irq_tracefile_index_t *e) {
+    put_u64(out, e->irq_mask);
+    put_u64(out + 8, e->cpu_mask);
+    for (int i = 0; i < IRQ_TRACEFILE_TEMPLATE_BITS / 64; i++) {
+        put_u64(out + 16 + 8 * i, e->template_mask[i]);
+    }
+}
+
+static void get_summary(const uint8_t *in, irq_tracefile_index_t *e) {
+    e->irq_mask = get_u64(in);
+    e->cpu_mask = get_u64(in + 8);
+    for (int i = 0; i < IRQ_TRACEFILE_TEMPLATE_BITS / 64; i++) {
+        e->template_mask[i] = get_u64(in + 16 + 8 * i);
+    }
+}
+
+static void set_template_bit(uint64_t *mask, int id) {
+    int bit = id < IRQ_TRACEFILE_TEMPLATE_BITS ? id : IRQ_TRACEFILE_TEMPLATE_BITS - 1;
+    mask[bit / 64] |= 1ULL << (bit % 64);
+}
+
+// ---- Escritura ----
+
+typedef struct {
+    int id;
+    char *fmt;
+} dict_entry_t;
+
+struct irq_tracefile_writer {
+    char dir[256];
+    uint64_t chunk_bytes;
+    int fd;                                 // -1 = el próximo bloque abre un chunk
+    int chunk;
+    uint64_t offset;                        // Bytes escritos en el chunk actual
+    irq_tracefile_index_t *index;
+    size_t index_count;
+    size_t index_capacity;
+    dict_entry_t *dict;                     // Plantillas usadas en el chunk
+    size_t dict_count;
+    size_t dict_capacity;
+    uint8_t in_dict[IRQ_TRACEFILE_MAX_TEMPLATES / 8];
+
+    uint8_t block[IRQ_TRACEFILE_BLOCK_SIZE];
+    size_t block_len;
+    uint32_t block_events;
+    uint64_t first_ns;
+    uint64_t prev_ns;
+    int prev_cpu;
+    irq_tracefile_index_t summary;          // Mapas de bits del bloque en curso
+    uint8_t defined[IRQ_TRACEFILE_MAX_TEMPLATES / 8];    // Plantillas ya definidas en el bloque
+    uint8_t has_text[IRQ_TRACEFILE_MAX_TEMPLATES];       // 0 = sin mirar, 1 = no, 2 = sí
+    uint8_t stored[IRQ_TRACEFILE_BLOCK_HEADER_SIZE + IRQ_TRACEFILE_BLOCK_SIZE];
+
+    irq_tracefile_stats_t stats;
+};
+
+static int write_all(int fd, const void *data, size_t len) {
+    const uint8_t *p = data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static void clear_dict(irq_tracefile_writer_t *w) {
+    for (size_t i = 0; i < w->dict_count; i++) {
+        free(w->dict[i].fmt);
+    }
+    w->dict_count = 0;
+    memset(w->in_dict, 0, sizeof(w->in_dict));
+}
+
+static int open_chunk(irq_tracefile_writer_t *w) {
+    char path[320];
+    snprintf(path, sizeof(path), "%s/" IRQ_TRACEFILE_CHUNK_NAME, w->dir, w->chunk + 1);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+
+    uint8_t header[IRQ_TRACEFILE_HEADER_SIZE];
+    put_u32(header, IRQ_TRACEFILE_MAGIC);
+    put_u32(header + 4, IRQ_TRACEFILE_VERSION);
+    if (write_all(fd, header, sizeof(header)) < 0) {
+        close(fd);
+        return -1;
+    }
+    w->fd = fd;
+    w->chunk++;
+    w->offset = sizeof(header);
+    w->index_count = 0;
+    clear_dict(w);
+    w->stats.chunks++;
+    w->stats.file_bytes += sizeof(header);
+    return 0;
+}
+
+// Diccionario, índice y pie del chunk actual
+static int finish_chunk(irq_tracefile_writer_t *w) {
+    if (w->fd < 0) {
+        return 0;
+    }
+
+    int result = 0;
+    uint64_t start = w->offset;
+    uint64_t dict_offset = w->offset;
+    uint8_t buf[IRQ_TRACEFILE_INDEX_ENTRY_SIZE + 32];
+    put_u32(buf, (uint32_t)w->dict_count);
+    result = write_all(w->fd, buf, 4);
+    w->offset += 4;
+    for (size_t i = 0; i < w->dict_count && result == 0; i++) {
+        size_t len = strlen(w->dict[i].fmt);
+        size_t n = irq_tracefile_put_varint(buf, (uint64_t)w->dict[i].id);
+        n += irq_tracefile_put_varint(buf + n, len);
+        result = write_all(w->fd, buf, n);
+        if (result == 0) {
+            result = write_all(w->fd, w->dict[i].fmt, len);
+        }
+        w->offset += n + len;
+    }
+
+    uint64_t index_offset = w->offset;
+    for (size_t i = 0; i < w->index_count && result == 0; i++) {
+        const irq_tracefile_index_t *e = &w->index[i];
+        put_u64(buf, e->offset);
+        put_u64(buf + 8, e->first_ns);
+        put_u64(buf + 16, e->last_ns);
+        put_u32(buf + 24, e->events);
+        put_u32(buf + 28, e->stored_len);
+        put_summary(buf + 32, e);
+        result = write_all(w->fd, buf, IRQ_TRACEFILE_INDEX_ENTRY_SIZE);
+        w->offset += IRQ_TRACEFILE_INDEX_ENTRY_SIZE;
+    }
+
+    put_u64(buf, dict_offset);
+    put_u64(buf + 8, index_offset);
+    put_u32(buf + 16, (uint32_t)w->index_count);
+    put_u32(buf + 20, IRQ_TRACEFILE_INDEX_MAGIC);
+    if (result == 0) {
+        result = write_all(w->fd, buf, IRQ_TRACEFILE_FOOTER_SIZE);
+    }
+    w->offset += IRQ_TRACEFILE_FOOTER_SIZE;
+    w->stats.file_bytes += w->offset - start;
+    close(w->fd);
+    w->fd = -1;
+    return result;
+}
+
+irq_tracefile_writer_t *irq_tracefile_writer_open(const char *dir, uint64_t chunk_bytes) {
+    if (dir == NULL || strlen(dir) >= sizeof(((irq_tracefile_writer_t *)0)->dir)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+        return NULL;
+    }
+
+    irq_tracefile_writer_t *w = calloc(1, sizeof(*w));
+    if (w == NULL) {
+        return NULL;
+    }
+    snprintf(w->dir, sizeof(w->dir), "%s", dir);
+    w->chunk_bytes = chunk_bytes;
+    w->fd = -1;
+    if (open_chunk(w) < 0) {
+        free(w);
+        return NULL;
+    }
+    return w;
+}
+
+int irq_tracefile_flush(irq_tracefile_writer_t *w) {
+    if (w->block_events == 0) {
+        return 0;
+    }
+    if (w->fd < 0 && open_chunk(w) < 0) {
+        return -1;
+    }
+
+    uint8_t *payload = w->stored + IRQ_TRACEFILE_BLOCK_HEADER_SIZE;
+    size_t stored_len = irq_tracefile_compress(w->block, w->block_len, payload, IRQ_TRACEFILE_BLOCK_SIZE);
+    if (stored_len == 0) {
+        memcpy(payload, w->block, w->block_len);    // Incompresible: se guarda tal cual
+        stored_len = w->block_len;
+    }
+
+    irq_tracefile_index_t *s = &w->summary;
+    s->offset = w->offset;
+    s->first_ns = w->first_ns;
+    s->last_ns = w->prev_ns;
+    s->events = w->block_events;
+    s->stored_len = (uint32_t)stored_len;
+
+    uint8_t *header = w->stored;
+    put_u32(header, IRQ_TRACEFILE_BLOCK_MAGIC);
+    put_u32(header + 4, (uint32_t)w->block_len);
+    put_u32(header + 8, (uint32_t)stored_len);
+    put_u32(header + 12, w->block_events);
+    put_u64(header + 16, s->first_ns);
+    put_u64(header + 24, s->last_ns);
+    put_summary(header + 32, s);
+    put_u32(header + 80, block_checksum(payload, stored_len));
+    if (write_all(w->fd, w->stored, IRQ_TRACEFILE_BLOCK_HEADER_SIZE + stored_len) < 0) {
+        return -1;
+    }
+
+    if (w->index_count == w->index_capacity) {
+        size_t capacity = w->index_capacity ? w->index_capacity * 2 : 64;
+        irq_tracefile_index_t *grown = realloc(w->index, capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return -1;
+        }
+        w->index = grown;
+        w->index_capacity = capacity;
+    }
+    w->index[w->index_count++] = *s;
+
+    w->offset += IRQ_TRACEFILE_BLOCK_HEADER_SIZE + stored_len;
+    w->stats.blocks++;
+    w->stats.raw_bytes += w->block_len;
+    w->stats.file_bytes += IRQ_TRACEFILE_BLOCK_HEADER_SIZE + stored_len;
+    w->block_len = 0;
+    w->block_events = 0;
+    memset(s, 0, sizeof(*s));
+    memset(w->defined, 0, sizeof(w->defined));
+
+    if (w->chunk_bytes > 0 && w->offset >= w->chunk_bytes) {
+        return finish_chunk(w);
+    }
+    return 0;
+}
+
+// Anotar la plantilla en el diccionario del chunk (una copia por chunk)
+static int add_to_dict(irq_tracefile_writer_t *w, int id, const char *fmt) {
+    if ((w->in_dict[id / 8] >> (id % 8)) & 1) {
+        return 0;
+    }
+    if (w->dict_count == w->dict_capacity) {
+        size_t capacity = w->dict_capacity ? w->dict_capacity * 2 : 64;
+        dict_entry_t *grown = realloc(w->dict, capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return -1;
+        }
+        w->dict = grown;
+        w->dict_capacity = capacity;
+    }
+    char *copy = strdup(fmt);
+    if (copy == NULL) {
+        return -1;
+    }
+    w->dict[w->dict_count].id = id;
+    w->dict[w->dict_count].fmt = copy;
+    w->dict_count++;
+    w->in_dict[id / 8] |= (uint8_t)(1u << (id % 8));
+    return 0;
+}
+
+int irq_tracefile_write(irq_tracefile_writer_t *w, const irq_tracefile_event_t *ev) {
+    if (ev->template_id < 0 || ev->template_id >= IRQ_TRACEFILE_MAX_TEMPLATES ||
+        ev->argc < 0 || ev->argc > IRQ_TRACEFILE_MAX_ARGS || ev->fmt == NULL) {
+        return -1;
+    }
+    int id = ev->template_id;
+    if (w->has_text[id] == 0) {
+        w->has_text[id] = (uint8_t)(1 + fmt_has_text(ev->fmt));
+    }
+    int has_text = w->has_text[id] == 2;
+    int defined = (w->defined[id / 8] >> (id % 8)) & 1;
+    size_t fmt_len = defined ? 0 : strlen(ev->fmt);
+    size_t text_len = ev->text_len < IRQ_TRACEFILE_MAX_TEXT ? ev->text_len : IRQ_TRACEFILE_MAX_TEXT;
+    size_t bound = EVENT_MAX_FIXED + fmt_len + text_len;
+    if (bound > IRQ_TRACEFILE_BLOCK_SIZE) {
+        return -1;
+    }
+    if (w->block_len + bound > IRQ_TRACEFILE_BLOCK_SIZE) {
+        if (irq_tracefile_flush(w) < 0) {
+            return -1;
+        }
+        defined = 0;
+        fmt_len = strlen(ev->fmt);
+    }
+    if (w->fd < 0 && open_chunk(w) < 0) {
+        return -1;
+    }
+    if (add_to_dict(w, id, ev->fmt) < 0) {
+        return -1;
+    }
+
+    uint8_t *out = w->block + w->block_len;
+    size_t n = 0;
+    if (w->block_events == 0) {
+        w->first_ns = ev->timestamp_ns;
+        w->prev_ns = ev->timestamp_ns;
+        w->prev_cpu = -2;                   // El primer evento del bloque lleva su CPU
+    }
+    if (!defined) {
+        // Definición: 0, id, argc y si lleva texto, longitud y formato
+        n += irq_tracefile_put_varint(out + n, 0);
+        n += irq_tracefile_put_varint(out + n, (uint64_t)id);
+        n += irq_tracefile_put_varint(out + n, (uint64_t)ev->argc << 1 | (uint64_t)has_text);
+        n += irq_tracefile_put_varint(out + n, fmt_len);
+        memcpy(out + n, ev->fmt, fmt_len);
+        n += fmt_len;
+        w->defined[id / 8] |= (uint8_t)(1u << (id % 8));
+    }
+
+    int cpu = ev->cpu >= 0 ? ev->cpu : -1;
+    int cpu_changed = cpu != w->prev_cpu;
+    int has_flags = ev->flags != 0;
+    n += irq_tracefile_put_varint(out + n, (uint64_t)id + 1);
+    n += irq_tracefile_put_varint(out + n, zigzag_encode((int64_t)(ev->timestamp_ns - w->prev_ns)));
+    n += irq_tracefile_put_varint(out + n, (uint64_t)(ev->irq + 1) << 2 |
+                                           (uint64_t)cpu_changed << 1 | (uint64_t)has_flags);
+    if (has_flags) {
+        n += irq_tracefile_put_varint(out + n, (uint64_t)ev->flags);
+    }
+    if (cpu_changed) {
+        n += irq_tracefile_put_varint(out + n, (uint64_t)(cpu + 1));
+    }
+    for (int i = 0; i < ev->argc; i++) {
+        n += irq_tracefile_put_varint(out + n, ev->args[i]);
+    }
+    if (has_text) {
+        n += irq_tracefile_put_varint(out + n, text_len);
+        memcpy(out + n, ev->text, text_len);
+        n += text_len;
+    }
+
+    w->summary.irq_mask |= IRQ_TRACEFILE_IRQ_BIT(ev->irq);
+    w->summary.cpu_mask |= IRQ_TRACEFILE_CPU_BIT(cpu);
+    set_template_bit(w->summary.template_mask, id);
+    w->block_len += n;
+    w->block_events++;
+    w->prev_ns = ev->timestamp_ns;
+    w->prev_cpu = cpu;
+    w->stats.events++;
+    return 0;
+}
+
+uint64_t irq_tracefile_pending_since(const irq_tracefile_writer_t *w) {
+    return w->block_events > 0 ? w->first_ns : 0;
+}
+
+void irq_tracefile_writer_stats(const irq_tracefile_writer_t *w, irq_tracefile_stats_t *out) {
+    *out = w->stats;
+}
+
+int irq_tracefile_writer_close(irq_tracefile_writer_t *w, irq_tracefile_stats_t *final) {
+    if (w == NULL) {
+        return 0;
+    }
+    int result = irq_tracefile_flush(w);
+    if (finish_chunk(w) < 0) {
+        result = -1;
+    }
+    if (final != NULL) {
+        *final = w->stats;
+    }
+    clear_dict(w);
+    free(w->dict);
+    free(w->index);
+    free(w);
+    return result;
+}
+
+// ---- Lectura ----
+
+typedef struct {
+    uint32_t generation;                    // Bloque en el que se definió
+    uint32_t fmt_offset;                    // En el almacén de formatos del bloque
+    uint8_t argc;
+    uint8_t has_text;
+    int8_t match;                           // Resultado de irq_tracefile_match_template
+} reader_template_t;
+
+struct irq_tracefile_reader {
+    int fd;
+    irq_tracefile_query_t query;
+    int indexed;                            // 0 = sin pie, índice reconstruido
+    irq_tracefile_index_t *index;
+    size_t index_count;
+    uint32_t *plan;                         // Bloques que pueden cumplir la consulta
+    size_t plan_count;
+    size_t next_block;
+
+    char *dict_blob;                        // Diccionario del pie (formatos con '\0')
+    int *dict_ids;
+    const char **dict_fmts;
+    int dict_count;
+
+    uint8_t stored[IRQ_TRACEFILE_BLOCK_SIZE];
+    uint8_t block[IRQ_TRACEFILE_BLOCK_SIZE];
+    size_t block_len;
+    size_t pos;
+    uint64_t prev_ns;
+    int prev_cpu;
+    uint32_t generation;
+    char fmts[IRQ_TRACEFILE_BLOCK_SIZE + 1];
+    size_t fmts_len;
+    reader_template_t *templates;
+
+    unsigned long decoded;
+    irq_tracefile_stats_t stats;
+};
+
+static int read_at(int fd, void *buffer, size_t len, uint64_t offset) {
+    uint8_t *p = buffer;
+    while (len > 0) {
+        ssize_t n = pread(fd, p, len, (off_t)offset);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return 0;
+}
+
+static int add_index_entry(irq_tracefile_reader_t *r, const irq_tracefile_index_t *entry, size_t *capacity) {
+    if (r->index_count == *capacity) {
+        size_t grown_capacity = *capacity ? *capacity * 2 : 64;
+        irq_tracefile_index_t *grown = realloc(r->index, grown_capacity * sizeof(*grown));
+        if (grown == NULL) {
+            return -1;
+        }
+        r->index = grown;
+        *capacity = grown_capacity;
+    }
+    r->index[r->index_count++] = *entry;
+    return 0;
+}
+
+// Diccionario de plantillas del pie: [n] y n veces {id, longitud, formato}
+static int load_dict(irq_tracefile_reader_t *r, uint64_t offset, uint64_t end) {
+    if (end < offset + 4 || end - offset > 16 * 1024 * 1024) {
+        return -1;
+    }
+    size_t len = (size_t)(end - offset);
+    uint8_t *raw = malloc(len);
+    if (raw == NULL || read_at(r->fd, raw, len, offset) < 0) {
+        free(raw);
+        return -1;
+    }
+
+    uint32_t count = get_u32(raw);
+    if (count > len) {
+        free(raw);
+        return -1;
+    }
+    r->dict_blob = malloc(len + count);
+    r->dict_ids = calloc(count + 1, sizeof(int));
+    r->dict_fmts = calloc(count + 1, sizeof(char *));
+    if (r->dict_blob == NULL || r->dict_ids == NULL || r->dict_fmts == NULL) {
+        free(raw);
+        return -1;
+    }
+    size_t pos = 4, blob = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t id, fmt_len;
+        size_t n = irq_tracefile_get_varint(raw + pos, len - pos, &id);
+        size_t m = n ? irq_tracefile_get_varint(raw + pos + n, len - pos - n, &fmt_len) : 0;
+        if (n == 0 || m == 0 || fmt_len > len - pos - n - m) {
+            free(raw);
+            return -1;
+        }
+        pos += n + m;
+        memcpy(r->dict_blob + blob, raw + pos, fmt_len);
+        r->dict_blob[blob + fmt_len] = '\0';
+        r->dict_ids[i] = (int)id;
+        r->dict_fmts[i] = r->dict_blob + blob;
+        blob += fmt_len + 1;
+        pos += fmt_len;
+    }
+    r->dict_count = (int)count;
+    free(raw);
+    return 0;
+}
+
+// Índice del pie; si no está (chunk abierto o sin cerrar) se recorren las cabeceras
+static int load_index(irq_tracefile_reader_t *r, uint64_t file_size) {
+    size_t capacity = 0;
+    uint8_t buf[IRQ_TRACEFILE_BLOCK_HEADER_SIZE];
+    if (file_size >= IRQ_TRACEFILE_HEADER_SIZE + IRQ_TRACEFILE_FOOTER_SIZE &&
+        read_at(r->fd, buf, IRQ_TRACEFILE_FOOTER_SIZE, file_size - IRQ_TRACEFILE_FOOTER_SIZE) == 0 &&
+        get_u32(buf + 20) == IRQ_TRACEFILE_INDEX_MAGIC) {
+        uint64_t dict_offset = get_u64(buf);
+        uint64_t index_offset = get_u64(buf + 8);
+        uint32_t blocks = get_u32(buf + 16);
+        if (dict_offset <= index_offset &&
+            index_offset + (uint64_t)blocks * IRQ_TRACEFILE_INDEX_ENTRY_SIZE + IRQ_TRACEFILE_FOOTER_SIZE == file_size) {
+            if (load_dict(r, dict_offset, index_offset) < 0) {
+                return -1;
+            }
+            for (uint32_t i = 0; i < blocks; i++) {
+                if (read_at(r->fd, buf, IRQ_TRACEFILE_INDEX_ENTRY_SIZE,
+                            index_offset + (uint64_t)i * IRQ_TRACEFILE_INDEX_ENTRY_SIZE) < 0) {
+                    return -1;
+                }
+                irq_tracefile_index_t e = {
+                    get_u64(buf), get_u64(buf + 8), get_u64(buf + 16),
+                    get_u32(buf + 24), get_u32(buf + 28), 0, 0, {0}
+                };
+                get_summary(buf + 32, &e);
+                if (add_index_entry(r, &e, &capacity) < 0) {
+                    return -1;
+                }
+            }
+            r->indexed = 1;
+            return 0;
+        }
+    }
+
+    uint64_t offset = IRQ_TRACEFILE_HEADER_SIZE;
+    while (offset + sizeof(buf) <= file_size &&
+           read_at(r->fd, buf, sizeof(buf), offset) == 0 &&
+           get_u32(buf) == IRQ_TRACEFILE_BLOCK_MAGIC) {
+        irq_tracefile_index_t e = {
+            offset, get_u64(buf + 16), get_u64(buf + 24),
+            get_u32(buf + 12), get_u32(buf + 8), 0, 0, {0}
+        };
+        get_summary(buf + 32, &e);
+        if (offset + sizeof(buf) + e.stored_len > file_size) {
+            break;                          // Bloque a medio escribir
+        }
+        if (add_index_entry(r, &e, &capacity) < 0) {
+            return -1;
+        }
+        offset += sizeof(buf) + e.stored_len;
+    }
+    return 0;
+}
+
+// Primer candidato cuyo bloque termina en o después de from_ns (los bloques
+// de un chunk están en orden de tiempo)
+static size_t first_candidate(const irq_tracefile_reader_t *r, const uint32_t *candidates,
+                              size_t count, uint64_t from_ns) {
+    size_t lo = 0, hi = count;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (r->index[candidates[mid]].last_ns < from_ns) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Elegir los bloques a descomprimir: listas por IRQ, bisección por tiempo y
+// mapas de CPUs y plantillas de cada bloque
+static int plan_query(irq_tracefile_reader_t *r) {
+    const irq_tracefile_query_t *q = &r->query;
+    size_t n = r->index_count;
+    uint32_t *candidates = malloc((n + 1) * sizeof(uint32_t));
+    r->plan = malloc((n + 1) * sizeof(uint32_t));
+    if (candidates == NULL || r->plan == NULL) {
+        free(candidates);
+        return -1;
+    }
+
+    size_t count = 0;
+    if (q->irq_mask != 0) {
+        // Listas de bloques por IRQ; la unión se recorre en orden de bloque
+        uint32_t *postings[64] = {NULL};
+        size_t lengths[64] = {0};
+        for (int bit = 0; bit < 64; bit++) {
+            if ((q->irq_mask >> bit) & 1) {
+                postings[bit] = malloc((n + 1) * sizeof(uint32_t));
+                if (postings[bit] == NULL) {
+                    for (int b = 0; b < bit; b++) {
+                        free(postings[b]);
+                    }
+                    free(candidates);
+                    return -1;
+                }
+            }
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint64_t present = r->index[i].irq_mask & q->irq_mask;
+            while (present != 0) {
+                int bit = __builtin_ctzll(present);
+                postings[bit][lengths[bit]++] = (uint32_t)i;
+                present &= present - 1;
+            }
+        }
+        size_t cursor[64] = {0};
+        for (;;) {
+            uint32_t next = UINT32_MAX;
+            for (int bit = 0; bit < 64; bit++) {
+                if (postings[bit] != NULL && cursor[bit] < lengths[bit] && postings[bit][cursor[bit]] < next) {
+                    next = postings[bit][cursor[bit]];
+                }
+            }
+            if (next == UINT32_MAX) {
+                break;
+            }
+            candidates[count++] = next;
+            for (int bit = 0; bit < 64; bit++) {
+                if (postings[bit] != NULL && cursor[bit] < lengths[bit] && postings[bit][cursor[bit]] == next) {
+                    cursor[bit]++;
+                }
+            }
+        }
+        for (int bit = 0; bit < 64; bit++) {
+            free(postings[bit]);
+        }
+    } else {
+        for (size_t i = 0; i < n; i++) {
+            candidates[count++] = (uint32_t)i;
+        }
+    }
+
+    // Plantillas que pueden cumplir categoría y tipo (sin diccionario, todas)
+    uint64_t templates[IRQ_TRACEFILE_TEMPLATE_BITS / 64];
+    memset(templates, 0xff, sizeof(templates));
+    if ((q->category[0] != '\0' || q->type[0] != '\0') && r->dict_count > 0) {
+        memset(templates, 0, sizeof(templates));
+        for (int i = 0; i < r->dict_count; i++) {
+            if (irq_tracefile_match_template(q, r->dict_fmts[i]) != 0) {
+                set_template_bit(templates, r->dict_ids[i]);
+            }
+        }
+    }
+
+    size_t start = q->from_ns != 0 ? first_candidate(r, candidates, count, q->from_ns) : 0;
+    for (size_t c = start; c < count; c++) {
+        const irq_tracefile_index_t *e = &r->index[candidates[c]];
+        if (q->to_ns != 0 && e->first_ns > q->to_ns) {
+            break;
+        }
+        int template_hit = 0;
+        for (int w = 0; w < IRQ_TRACEFILE_TEMPLATE_BITS / 64; w++) {
+            template_hit |= (e->template_mask[w] & templates[w]) != 0;
+        }
+        if ((q->cpu_mask != 0 && (e->cpu_mask & q->cpu_mask) == 0) || !template_hit) {
+            continue;
+        }
+        r->plan[r->plan_count++] = candidates[c];
+    }
+    free(candidates);
+    return 0;
+}
+
+irq_tracefile_reader_t *irq_tracefile_reader_open(const char *path, const irq_tracefile_query_t *query) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    uint8_t header[IRQ_TRACEFILE_HEADER_SIZE];
+    if (fstat(fd, &st) < 0 || read_at(fd, header, sizeof(header), 0) < 0 ||
+        get_u32(header) != IRQ_TRACEFILE_MAGIC || get_u32(header + 4) != IRQ_TRACEFILE_VERSION) {
+        close(fd);
+        errno = EINVAL;
+        return NULL;
+    }
+
+    irq_tracefile_reader_t *r = calloc(1, sizeof(*r));
+    if (r == NULL) {
+        close(fd);
+        return NULL;
+    }
+    r->templates = calloc(IRQ_TRACEFILE_MAX_TEMPLATES, sizeof(*r->templates));
+    r->fd = fd;
+    if (query != NULL) {
+        r->query = *query;
+    }
+    if (r->templates == NULL || load_index(r, (uint64_t)st.st_size) < 0 || plan_query(r) < 0) {
+        irq_tracefile_reader_close(r);
+        return NULL;
+    }
+
+    r->stats.chunks = 1;
+    r->stats.blocks = r->index_count;
+    r->stats.file_bytes = (uint64_t)st.st_size;
+    for (size_t i = 0; i < r->index_count; i++) {
+        r->stats.events += r->index[i].events;
+    }
+    return r;
+}
+
+// Descomprimir el siguiente bloque del plan
+static int load_block(irq_tracefile_reader_t *r) {
+    if (r->next_block >= r->plan_count) {
+        return 0;
+    }
+    const irq_tracefile_index_t *e = &r->index[r->plan[r->next_block++]];
+
+    uint8_t header[IRQ_TRACEFILE_BLOCK_HEADER_SIZE];
+    if (e->stored_len > sizeof(r->stored) ||
+        read_at(r->fd, header, sizeof(header), e->offset) < 0 ||
+        get_u32(header) != IRQ_TRACEFILE_BLOCK_MAGIC ||
+        read_at(r->fd, r->stored, e->stored_len, e->offset + sizeof(header)) < 0 ||
+        block_checksum(r->stored, e->stored_len) != get_u32(header + 80)) {
+        return -1;
+    }
+    uint32_t raw_len = get_u32(header + 4);
+    if (raw_len > sizeof(r->block)) {
+        return -1;
+    }
+    if (e->stored_len == raw_len) {
+        memcpy(r->block, r->stored, raw_len);
+    } else if (irq_tracefile_decompress(r->stored, e->stored_len, r->block, sizeof(r->block)) != (long)raw_len) {
+        return -1;
+    }
+
+    r->block_len = raw_len;
+    r->pos = 0;
+    r->prev_ns = e->first_ns;
+    r->prev_cpu = -1;
+    r->generation++;
+    r->fmts_len = 0;
+    r->decoded++;
+    r->stats.raw_bytes += raw_len;
+    return 1;
+}
+
+static int next_varint(irq_tracefile_reader_t *r, uint64_t *value) {
+    size_t n = irq_tracefile_get_varint(r->block + r->pos, r->block_len - r->pos, value);
+    if (n == 0) {
+        return -1;
+    }
+    r->pos += n;
+    return 0;
+}
+
+int irq_tracefile_next(irq_tracefile_reader_t *r, irq_tracefile_event_t *ev) {
+    for (;;) {
+        if (r->pos >= r->block_len) {
+            int loaded = load_block(r);
+            if (loaded <= 0) {
+                return loaded;
+            }
+        }
+
+        uint64_t tag, value;
+        if (next_varint(r, &tag) < 0) {
+            return -1;
+        }
+        if (tag == 0) {
+            uint64_t id, shape, len;
+            if (next_varint(r, &id) < 0 || next_varint(r, &shape) < 0 || next_varint(r, &len) < 0 ||
+                id >= IRQ_TRACEFILE_MAX_TEMPLATES || (shape >> 1) > IRQ_TRACEFILE_MAX_ARGS ||
+                len > r->block_len - r->pos) {
+                return -1;
+            }
+            reader_template_t *t = &r->templates[id];
+            t->generation = r->generation;
+            t->fmt_offset = (uint32_t)r->fmts_len;
+            t->argc = (uint8_t)(shape >> 1);
+            t->has_text = (uint8_t)(shape & 1);
+            memcpy(r->fmts + r->fmts_len, r->block + r->pos, len);
+            r->fmts_len += len;
+            r->fmts[r->fmts_len++] = '\0';
+            r->pos += len;
+            t->match = (int8_t)irq_tracefile_match_template(&r->query, r->fmts + t->fmt_offset);
+            continue;
+        }
+
+        uint64_t id = tag - 1;
+        if (id >= IRQ_TRACEFILE_MAX_TEMPLATES || r->templates[id].generation != r->generation) {
+            return -1;                      // Plantilla sin definir en este bloque
+        }
+        const reader_template_t *t = &r->templates[id];
+        ev->template_id = (int)id;
+        ev->fmt = r->fmts + t->fmt_offset;
+        ev->argc = t->argc;
+
+        if (next_varint(r, &value) < 0) {
+            return -1;
+        }
+        r->prev_ns += (uint64_t)zigzag_decode(value);
+        ev->timestamp_ns = r->prev_ns;
+        if (next_varint(r, &value) < 0) {
+            return -1;
+        }
+        ev->irq = (int)(value >> 2) - 1;
+        ev->flags = 0;
+        if ((value & 1) && next_varint(r, &tag) == 0) {
+            ev->flags = (int)tag;
+        }
+        if ((value & 2) && next_varint(r, &tag) == 0) {
+            r->prev_cpu = (int)tag - 1;
+        }
+        ev->cpu = r->prev_cpu;
+        for (int i = 0; i < t->argc; i++) {
+            if (next_varint(r, &value) < 0) {
+                return -1;
+            }
+            ev->args[i] = (uint32_t)value;
+        }
+        ev->text = NULL;
+        ev->text_len = 0;
+        if (t->has_text) {
+            if (next_varint(r, &value) < 0 || value > r->block_len - r->pos) {
+                return -1;
+            }
+            ev->text = (const char *)r->block + r->pos;
+            ev->text_len = (size_t)value;
+            r->pos += (size_t)value;
+        }
+
+        if (t->match == 0 || !irq_tracefile_match_event(&r->query, ev)) {
+            continue;
+        }
+        if (t->match < 0) {
+            char text[IRQ_TRACEFILE_MAX_TEXT];
+            irq_tracefile_render(ev, text, sizeof(text));
+            if (!irq_tracefile_match_text(&r->query, text)) {
+                continue;
+            }
+        }
+        return 1;
+    }
+}
+
+void irq_tracefile_reader_span(const irq_tracefile_reader_t *r, uint64_t *first_ns, uint64_t *last_ns) {
+    *first_ns = r->index_count > 0 ? r->index[0].first_ns : 0;
+    *last_ns = r->index_count > 0 ? r->index[r->index_count - 1].last_ns : 0;
+}
+
+void irq_tracefile_reader_stats(const irq_tracefile_reader_t *r, unsigned long *decoded,
+                                unsigned long *skipped, irq_tracefile_stats_t *out) {
+    *decoded = r->decoded;
+    *skipped = (unsigned long)(r->index_count - r->plan_count);
+    *out = r->stats;
+}
+
+int irq_tracefile_reader_indexed(const irq_tracefile_reader_t *r) {
+    return r->indexed;
+}
+
+int irq_tracefile_reader_template(const irq_tracefile_reader_t *r, int i, int *id, const char **fmt) {
+    if (i < 0 || i >= r->dict_count) {
+        return 0;
+    }
+    *id = r->dict_ids[i];
+    *fmt = r->dict_fmts[i];
+    return 1;
+}
+
+void irq_tracefile_reader_close(irq_tracefile_reader_t *r) {
+    if (r == NULL) {
+        return;
+    }
+    close(r->fd);
+    free(r->index);
+    free(r->plan);
+    free(r->dict_blob);
+    free(r->dict_ids);
+    free(r->dict_fmts);
+    free(r->templates);
+    free(r);
+}
@@ -0,0 +1,154 @@
+#ifndef IRQ_TRACEFILE_H
+#define IRQ_TRACEFILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Formato en disco de la captura de traza (simulador e irqtrace)
+//
+// Los eventos se codifican en bloques de hasta 64 KiB: marca de tiempo como
+// delta zigzag-varint respecto al evento anterior, id de plantilla, IRQ, CPU
+// (sólo cuando cambia) y argumentos como varints, y los textos con su
+// longitud. Cada bloque lleva las definiciones de las plantillas que usa, así
+// que se decodifica sin leer los anteriores, y se comprime con un LZ77 de
+// estilo LZ4. La cabecera de cada bloque resume su contenido: primera y
+// última marca y mapas de bits de las IRQs, CPUs y plantillas que aparecen.
+//
+// Los bloques se agrupan en ficheros de chunk; al cerrar un chunk se añaden
+// el diccionario de plantillas, un índice con el resumen de cada bloque y un
+// pie que apunta a ambos. Con ellos las consultas (irq_tracefile_query_t)
+// sólo descomprimen los bloques que pueden contener eventos del rango de
+// tiempo, las IRQs, las CPUs y las categorías pedidas: el rango se busca por
+// bisección y cada IRQ tiene su lista de bloques. Un chunk sin pie (captura
+// en curso o interrumpida) se recorre por las cabeceras de sus bloques.
+//
+// Todos los enteros del fichero son little-endian.
+
+#define IRQ_TRACEFILE_MAGIC 0x54515249u         // "IRQT", cabecera del chunk
+#define IRQ_TRACEFILE_BLOCK_MAGIC 0x42515249u   // "IRQB"
+#define IRQ_TRACEFILE_INDEX_MAGIC 0x58515249u   // "IRQX", pie con el índice
+#define IRQ_TRACEFILE_VERSION 2
+#define IRQ_TRACEFILE_BLOCK_SIZE 65536          // Bytes codificados por bloque
+#define IRQ_TRACEFILE_HEADER_SIZE 8             // magic + versión
+#define IRQ_TRACEFILE_BLOCK_HEADER_SIZE 84
+#define IRQ_TRACEFILE_INDEX_ENTRY_SIZE 80
+#define IRQ_TRACEFILE_FOOTER_SIZE 24
+#define IRQ_TRACEFILE_MAX_ARGS 4
+#define IRQ_TRACEFILE_MAX_TEXT 1024             // Textos de un evento, con sus '\0'
+#define IRQ_TRACEFILE_MAX_TEMPLATES 65536
+#define IRQ_TRACEFILE_CHUNK_NAME "chunk-%06d.irqt"
+
+// Bit de una IRQ (-1 = sin IRQ), una CPU (-1 = desconocida) o una plantilla
+// en los mapas de los bloques; los valores que no caben comparten el último
+#define IRQ_TRACEFILE_IRQ_BIT(irq) (1ULL << ((irq) >= -1 && (irq) < 62 ? (irq) + 1 : 63))
+#define IRQ_TRACEFILE_CPU_BIT(cpu) (1ULL << ((cpu) >= 0 && (cpu) < 63 ? (cpu) : 63))
+#define IRQ_TRACEFILE_TEMPLATE_BITS 256
+#define IRQ_TRACEFILE_FLAG_TIMER 0x01       // Igual que IRQ_TRACE_TIMER
+
+// Evento de traza; fmt y text sólo son válidos hasta el siguiente evento
+typedef struct {
+    uint64_t timestamp_ns;
+    int template_id;
+    const char *fmt;                    // Plantilla printf (0 = texto libre "%s")
+    int irq;                            // -1 = sin IRQ
+    int cpu;                            // -1 = desconocida
+    int flags;
+    int argc;                           // Argumentos enteros
+    uint32_t args[IRQ_TRACEFILE_MAX_ARGS];
+    const char *text;                   // Textos %s separados por '\0'
+    size_t text_len;
+} irq_tracefile_event_t;
+
+// Entrada del índice de un chunk
+typedef struct {
+    uint64_t offset;                    // Posición de la cabecera del bloque
+    uint64_t first_ns;
+    uint64_t last_ns;
+    uint32_t events;
+    uint32_t stored_len;                // Bytes del bloque en disco (sin cabecera)
+    uint64_t irq_mask;                  // IRQ_TRACEFILE_IRQ_BIT de cada evento
+    uint64_t cpu_mask;
+    uint64_t template_mask[IRQ_TRACEFILE_TEMPLATE_BITS / 64];
+} irq_tracefile_index_t;
+
+// Filtro de una consulta; los campos a cero no filtran
+typedef struct {
+    uint64_t from_ns;
+    uint64_t to_ns;
+    uint64_t irq_mask;                  // OR de IRQ_TRACEFILE_IRQ_BIT
+    uint64_t cpu_mask;                  // OR de IRQ_TRACEFILE_CPU_BIT
+    char category[32];                  // Palabra antes de ':' ("KERNEL", "HARDWARE"...)
+    char type[64];                      // Subcadena de la plantilla ("Ejecutando ISR")
+    int exclude_flags;                  // Descarta eventos con alguno de estos flags
+} irq_tracefile_query_t;
+
+typedef struct {
+    unsigned long events;
+    unsigned long blocks;
+    unsigned long chunks;
+    uint64_t raw_bytes;                 // Bytes codificados antes de comprimir
+    uint64_t file_bytes;                // Bytes escritos en disco
+} irq_tracefile_stats_t;
+
+typedef struct irq_tracefile_writer irq_tracefile_writer_t;
+typedef struct irq_tracefile_reader irq_tracefile_reader_t;
+
+// ---- Escritura ----
+
+// Abre el chunk 1 en dir (lo crea si no existe); rota al superar chunk_bytes.
+// Los ids de plantilla deben corresponder siempre al mismo formato.
+irq_tracefile_writer_t *irq_tracefile_writer_open(const char *dir, uint64_t chunk_bytes);
+int irq_tracefile_write(irq_tracefile_writer_t *w, const irq_tracefile_event_t *ev);
+// Cierra el bloque en curso y lo escribe (aunque no esté lleno)
+int irq_tracefile_flush(irq_tracefile_writer_t *w);
+// Marca de tiempo del primer evento sin escribir (0 = bloque vacío)
+uint64_t irq_tracefile_pending_since(const irq_tracefile_writer_t *w);
+void irq_tracefile_writer_stats(const irq_tracefile_writer_t *w, irq_tracefile_stats_t *out);
+// Escribe lo pendiente, el índice del chunk actual y libera el escritor;
+// final (opcional) recibe las cifras definitivas
+int irq_tracefile_writer_close(irq_tracefile_writer_t *w, irq_tracefile_stats_t *final);
+
+// ---- Lectura ----
+
+// Abre un chunk y planifica la consulta (NULL = todos los eventos)
+irq_tracefile_reader_t *irq_tracefile_reader_open(const char *path, const irq_tracefile_query_t *query);
+// 1 = evento que cumple la consulta, 0 = no quedan, <0 = fichero corrupto
+int irq_tracefile_next(irq_tracefile_reader_t *r, irq_tracefile_event_t *ev);
+// Primera y última marca del chunk según su índice (o recorriendo bloques)
+void irq_tracefile_reader_span(const irq_tracefile_reader_t *r, uint64_t *first_ns, uint64_t *last_ns);
+// Bloques descomprimidos y descartados por el índice, y totales del fichero
+void irq_tracefile_reader_stats(const irq_tracefile_reader_t *r, unsigned long *decoded,
+                                unsigned long *skipped, irq_tracefile_stats_t *out);
+int irq_tracefile_reader_indexed(const irq_tracefile_reader_t *r);
+// Plantilla i-ésima del diccionario del chunk (0 = no hay más o no hay pie)
+int irq_tracefile_reader_template(const irq_tracefile_reader_t *r, int i, int *id, const char **fmt);
+void irq_tracefile_reader_close(irq_tracefile_reader_t *r);
+
+// Reconstruye el texto de un evento a partir de su plantilla
+void irq_tracefile_render(const irq_tracefile_event_t *ev, char *out, size_t size);
+
+// ---- Consultas ----
+
+// Categoría de un formato o texto: la palabra en mayúsculas antes de ':'
+// tras los emoji ("🔍 KERNEL: ..." -> "KERNEL"); "" si no tiene
+void irq_tracefile_category(const char *text, char *out, size_t size);
+// 1/0 si la plantilla cumple categoría y tipo; -1 si depende del texto ("%s")
+int irq_tracefile_match_template(const irq_tracefile_query_t *q, const char *fmt);
+// Categoría y tipo sobre un texto ya formateado
+int irq_tracefile_match_text(const irq_tracefile_query_t *q, const char *text);
+// Tiempo, IRQ, CPU y flags (sin mirar la plantilla)
+int irq_tracefile_match_event(const irq_tracefile_query_t *q, const irq_tracefile_event_t *ev);
+// Lista "2,5,9" de IRQs (cpus = 0) o de CPUs (cpus = 1) como máscara; -1 si no es válida
+int irq_tracefile_parse_mask(const char *list, int cpus, uint64_t *mask);
+
+// ---- Códecs (expuestos para pruebas y herramientas) ----
+
+size_t irq_tracefile_put_varint(uint8_t *out, uint64_t value);
+// Bytes consumidos (0 si el varint está truncado o es demasiado largo)
+size_t irq_tracefile_get_varint(const uint8_t *in, size_t len, uint64_t *value);
+// Comprime src en dst; 0 si la salida no cabe o no es más pequeña que src
+size_t irq_tracefile_compress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap);
+// Bytes descomprimidos, o -1 si el bloque está corrupto
+long irq_tracefile_decompress(const uint8_t *src, size_t len, uint8_t *dst, size_t cap);
+
+#endif // IRQ_TRACEFILE_H
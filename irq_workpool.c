@@ -0,0 +1,650 @@
+#define _GNU_SOURCE
+#include "irq_workpool.h"
+#include "irq_slab.h"
+#include "irq_rt.h"
+
+// Contadores escritos por un solo hilo y leídos por otros sin bloqueo
+#define STAT_ADD(field, value) \
+    __atomic_store_n(&(field), __atomic_load_n(&(field), __ATOMIC_RELAXED) + (value), __ATOMIC_RELAXED)
+#define STAT_GET(field) __atomic_load_n(&(field), __ATOMIC_RELAXED)
+
+typedef struct irq_work {
+    irq_work_fn fn;
+    void *arg;
+    irq_work_group_t *group;
+    sim_context_t *sim;                 // Contexto de quien lo envió
+    uint64_t submit_ns;
+    struct irq_work *next;              // Cola de inyección
+} irq_work_t;
+
+// Deque Chase-Lev de capacidad fija: el dueño usa bottom, los ladrones top
+typedef struct {
+    int64_t top __attribute__((aligned(64)));
+    int64_t bottom __attribute__((aligned(64)));
+    irq_work_t *buffer[IRQ_WORKPOOL_DEQUE_SIZE] __attribute__((aligned(64)));
+} work_deque_t;
+
+typedef struct {
+    pthread_t thread;
+    int id;
+    uint32_t rng;
+    work_deque_t deque;
+    irq_workpool_worker_stats_t stats;
+} pool_worker_t;
+
+static pool_worker_t pool_workers[IRQ_WORKPOOL_MAX_WORKERS];
+static int pool_size = 0;
+static int pool_pinned = 0;
+static int pool_running = 0;
+static pthread_mutex_t pool_lifecycle_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Cola de inyección para trabajo encolado desde fuera del pool
+static irq_work_t *inject_head = NULL;
+static irq_work_t *inject_tail = NULL;
+static pthread_mutex_t inject_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// Hilos dormidos esperando trabajo
+static pthread_mutex_t idle_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t idle_cond = PTHREAD_COND_INITIALIZER;
+static int idle_sleepers = 0;
+
+static long pool_pending = 0;
+static int pool_submitters = 0;             // Encolando desde fuera del pool
+static unsigned long pool_max_pending = 0;
+static unsigned long pool_submitted = 0;
+static unsigned long pool_executed = 0;
+static unsigned long pool_inline_runs = 0;
+static unsigned long pool_overflows = 0;
+static unsigned long pool_latency_total_us = 0;
+static unsigned long pool_latency_max_us = 0;
+
+static __thread pool_worker_t *self_worker = NULL;
+
+// Los trabajos salen de cachés slab por hilo: encolar no llama a malloc
+static irq_slab_t *work_slab = NULL;
+static pthread_once_t work_slab_once = PTHREAD_ONCE_INIT;
+
+static void work_slab_create(void) {
+    work_slab = irq_slab_create("irq_work", sizeof(irq_work_t));
+}
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void atomic_max(unsigned long *target, unsigned long value) {
+    unsigned long current = __atomic_load_n(target, __ATOMIC_RELAXED);
+    while (value > current &&
+           !__atomic_compare_exchange_n(target, &current, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+// Sólo el dueño: empujar por abajo (0 = deque llena)
+static int deque_push(work_deque_t *dq, irq_work_t *item) {
+    int64_t b = __atomic_load_n(&dq->bottom, __ATOMIC_RELAXED);
+    int64_t t = __atomic_load_n(&dq->top, __ATOMIC_ACQUIRE);
+    if (b - t >= IRQ_WORKPOOL_DEQUE_SIZE) {
+        return 0;
+    }
+    __atomic_store_n(&dq->buffer[b & (IRQ_WORKPOOL_DEQUE_SIZE - 1)], item, __ATOMIC_RELAXED);
+    __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+// Sólo el dueño: sacar por abajo (LIFO, datos aún en caché)
+static irq_work_t *deque_take(work_deque_t *dq) {
+    int64_t b = __atomic_load_n(&dq->bottom, __ATOMIC_RELAXED) - 1;
+    // Store y load seq_cst en vez de barrera suelta (ThreadSanitizer no las modela)
+    __atomic_store_n(&dq->bottom, b, __ATOMIC_SEQ_CST);
+    int64_t t = __atomic_load_n(&dq->top, __ATOMIC_SEQ_CST);
+
+    if (t > b) {
+        __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELAXED);
+        return NULL;
+    }
+    irq_work_t *item = __atomic_load_n(&dq->buffer[b & (IRQ_WORKPOOL_DEQUE_SIZE - 1)], __ATOMIC_RELAXED);
+    if (t == b) {
+        // Último elemento: competir con los ladrones
+        if (!__atomic_compare_exchange_n(&dq->top, &t, t + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            item = NULL;
+        }
+        __atomic_store_n(&dq->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+    return item;
+}
+
+// Cualquier hilo: robar por arriba (FIFO). *contended = 1 si perdió la carrera
+static irq_work_t *deque_steal(work_deque_t *dq, int *contended) {
+    int64_t t = __atomic_load_n(&dq->top, __ATOMIC_SEQ_CST);
+    int64_t b = __atomic_load_n(&dq->bottom, __ATOMIC_SEQ_CST);
+
+    if (t >= b) {
+        return NULL;
+    }
+    irq_work_t *item = __atomic_load_n(&dq->buffer[t & (IRQ_WORKPOOL_DEQUE_SIZE - 1)], __ATOMIC_RELAXED);
+    if (!__atomic_compare_exchange_n(&dq->top, &t, t + 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+        *contended = 1;
+        return NULL;
+    }
+    return item;
+}
+
+static void inject_push(irq_work_t *item) {
+    item->next = NULL;
+    pthread_mutex_lock(&inject_mutex);
+    if (inject_tail != NULL) {
+        inject_tail->next = item;
+    } else {
+        inject_head = item;
+    }
+    inject_tail = item;
+    pthread_mutex_unlock(&inject_mutex);
+}
+
+// Tomar un lote de la cola compartida: el primero se ejecuta, el resto
+// queda en la deque propia a disposición de los ladrones
+static irq_work_t *take_injected(pool_worker_t *w) {
+    irq_work_t *batch[IRQ_WORKPOOL_INJECT_BATCH];
+    int count = 0;
+
+    pthread_mutex_lock(&inject_mutex);
+    while (inject_head != NULL && count < IRQ_WORKPOOL_INJECT_BATCH) {
+        batch[count++] = inject_head;
+        inject_head = inject_head->next;
+    }
+    if (inject_head == NULL) {
+        inject_tail = NULL;
+    }
+    pthread_mutex_unlock(&inject_mutex);
+
+    if (count == 0) {
+        return NULL;
+    }
+    STAT_ADD(w->stats.injected, (unsigned long)count);
+    for (int i = count - 1; i > 0; i--) {
+        if (!deque_push(&w->deque, batch[i])) {
+            inject_push(batch[i]);
+        }
+    }
+    return batch[0];
+}
+
+static irq_work_t *steal_any(pool_worker_t *w) {
+    // xorshift32 para elegir la primera víctima
+    w->rng ^= w->rng << 13;
+    w->rng ^= w->rng >> 17;
+    w->rng ^= w->rng << 5;
+    int start = (int)(w->rng % (uint32_t)pool_size);
+
+    for (int retry = 0; retry < 2; retry++) {
+        int contended = 0;
+        for (int i = 0; i < pool_size; i++) {
+            pool_worker_t *victim = &pool_workers[(start + i) % pool_size];
+            if (victim == w) {
+                continue;
+            }
+            STAT_ADD(w->stats.steal_attempts, 1);
+            irq_work_t *item = deque_steal(&victim->deque, &contended);
+            if (item != NULL) {
+                STAT_ADD(w->stats.stolen, 1);
+                return item;
+            }
+        }
+        if (!contended) {
+            break;
+        }
+    }
+    return NULL;
+}
+
+// El último trabajo avisa con el mutex tomado: quien espera puede destruir el
+// grupo en cuanto ve pending == 0
+static void work_done(irq_work_group_t *group) {
+    if (group == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&group->mutex);
+    if (__atomic_sub_fetch(&group->pending, 1, __ATOMIC_ACQ_REL) == 0) {
+        pthread_cond_broadcast(&group->cond);
+    }
+    pthread_mutex_unlock(&group->mutex);
+}
+
+static void run_work(pool_worker_t *w, irq_work_t *item) {
+    __atomic_sub_fetch(&pool_pending, 1, __ATOMIC_SEQ_CST);
+
+    uint64_t start = now_ns();
+    unsigned long latency_us = (unsigned long)((start - item->submit_ns) / 1000);
+    __atomic_add_fetch(&pool_latency_total_us, latency_us, __ATOMIC_RELAXED);
+    atomic_max(&pool_latency_max_us, latency_us);
+
+    sim_context_t *previous = sim_context_enter(item->sim);
+    item->fn(item->arg);
+    sim_context_enter(previous);
+
+    STAT_ADD(w->stats.busy_us, (unsigned long)((now_ns() - start) / 1000));
+    STAT_ADD(w->stats.executed, 1);
+    __atomic_add_fetch(&pool_executed, 1, __ATOMIC_RELAXED);
+
+    irq_work_group_t *group = item->group;
+    irq_slab_free(work_slab, item);
+    work_done(group);
+}
+
+static void *pool_worker_func(void *arg) {
+    pool_worker_t *w = (pool_worker_t *)arg;
+    self_worker = w;
+    // El modo RT fija la CPU del conjunto; la CPU propia del trabajador manda
+    irq_rt_enter_thread();
+
+    if (w->stats.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(w->stats.cpu, &set);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            __atomic_store_n(&w->stats.cpu, -1, __ATOMIC_RELAXED);
+        }
+    }
+
+    for (;;) {
+        irq_work_t *item = deque_take(&w->deque);
+        if (item == NULL) {
+            item = take_injected(w);
+        }
+        if (item == NULL) {
+            item = steal_any(w);
+        }
+        if (item != NULL) {
+            run_work(w, item);
+            continue;
+        }
+
+        if (__atomic_load_n(&pool_pending, __ATOMIC_SEQ_CST) > 0) {
+            sched_yield();  // Trabajo en tránsito: reintentar enseguida
+            continue;
+        }
+        if (!__atomic_load_n(&pool_running, __ATOMIC_ACQUIRE)) {
+            break;
+        }
+
+        // Dormir hasta que alguien encole (el timeout cubre el arranque y la parada)
+        uint64_t idle_start = now_ns();
+        pthread_mutex_lock(&idle_mutex);
+        __atomic_add_fetch(&idle_sleepers, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&pool_pending, __ATOMIC_SEQ_CST) == 0 &&
+            __atomic_load_n(&pool_running, __ATOMIC_ACQUIRE)) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_nsec += 50000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&idle_cond, &idle_mutex, &deadline);
+        }
+        __atomic_sub_fetch(&idle_sleepers, 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&idle_mutex);
+        STAT_ADD(w->stats.idle_sleeps, 1);
+        STAT_ADD(w->stats.idle_us, (unsigned long)((now_ns() - idle_start) / 1000));
+    }
+
+    self_worker = NULL;
+    return NULL;
+}
+
+int irq_work_submit(irq_work_fn fn, void *arg, irq_work_group_t *group) {
+    if (fn == NULL) {
+        return ERROR_INVALID_ARG;
+    }
+    if (group != NULL) {
+        __atomic_add_fetch(&group->pending, 1, __ATOMIC_ACQ_REL);
+    }
+
+    // Desde fuera del pool: anunciarse para que la parada no deje trabajo huérfano
+    int external = (self_worker == NULL);
+    if (external) {
+        __atomic_add_fetch(&pool_submitters, 1, __ATOMIC_SEQ_CST);
+    }
+
+    irq_work_t *item = NULL;
+    if (!external || __atomic_load_n(&pool_running, __ATOMIC_SEQ_CST)) {
+        item = irq_slab_alloc(work_slab);
+    }
+    if (item == NULL) {
+        if (external) {
+            __atomic_sub_fetch(&pool_submitters, 1, __ATOMIC_SEQ_CST);
+        }
+        // Sin pool (o sin memoria): ejecutar en el hilo que llama
+        __atomic_add_fetch(&pool_inline_runs, 1, __ATOMIC_RELAXED);
+        fn(arg);
+        work_done(group);
+        return SUCCESS;
+    }
+
+    item->fn = fn;
+    item->arg = arg;
+    item->group = group;
+    item->sim = sim_current();
+    item->submit_ns = now_ns();
+
+    long pending = __atomic_add_fetch(&pool_pending, 1, __ATOMIC_SEQ_CST);
+    atomic_max(&pool_max_pending, (unsigned long)pending);
+    __atomic_add_fetch(&pool_submitted, 1, __ATOMIC_RELAXED);
+
+    if (self_worker == NULL || !deque_push(&self_worker->deque, item)) {
+        if (self_worker != NULL) {
+            __atomic_add_fetch(&pool_overflows, 1, __ATOMIC_RELAXED);
+        }
+        inject_push(item);
+    }
+    if (external) {
+        __atomic_sub_fetch(&pool_submitters, 1, __ATOMIC_SEQ_CST);
+    }
+
+    if (__atomic_load_n(&idle_sleepers, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&idle_mutex);
+        pthread_cond_signal(&idle_cond);
+        pthread_mutex_unlock(&idle_mutex);
+    }
+    return SUCCESS;
+}
+
+void irq_work_group_init(irq_work_group_t *group) {
+    group->pending = 0;
+    pthread_mutex_init(&group->mutex, NULL);
+    pthread_cond_init(&group->cond, NULL);
+}
+
+void irq_work_group_wait(irq_work_group_t *group) {
+    pthread_mutex_lock(&group->mutex);
+    while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) > 0) {
+        pthread_cond_wait(&group->cond, &group->mutex);
+    }
+    pthread_mutex_unlock(&group->mutex);
+}
+
+void irq_work_group_destroy(irq_work_group_t *group) {
+    pthread_mutex_destroy(&group->mutex);
+    pthread_cond_destroy(&group->cond);
+}
+
+int irq_workpool_start(int workers, int pin_cpus) {
+    if (workers <= 0 || workers > IRQ_WORKPOOL_MAX_WORKERS) {
+        return ERROR_INVALID_ARG;
+    }
+
+    pthread_once(&work_slab_once, work_slab_create);
+    if (work_slab == NULL) {
+        return ERROR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&pool_lifecycle_mutex);
+    if (pool_running) {
+        pthread_mutex_unlock(&pool_lifecycle_mutex);
+        return SUCCESS;
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus <= 0) {
+        cpus = 1;
+    }
+
+    pool_size = workers;
+    pool_pinned = pin_cpus ? 1 : 0;
+    __atomic_store_n(&pool_running, 1, __ATOMIC_RELEASE);
+    // Todas las deques listas antes del primer hilo: los ladrones miran las ajenas
+    for (int i = 0; i < workers; i++) {
+        pool_worker_t *w = &pool_workers[i];
+        memset(&w->stats, 0, sizeof(w->stats));
+        w->id = i;
+        w->rng = 0x9e3779b9u * (uint32_t)(i + 1);
+        w->deque.top = 0;
+        w->deque.bottom = 0;
+        w->stats.cpu = pin_cpus ? (int)(i % cpus) : -1;
+    }
+    for (int i = 0; i < workers; i++) {
+        pool_worker_t *w = &pool_workers[i];
+        if (pthread_create(&w->thread, NULL, pool_worker_func, w) != 0) {
+            pool_size = i;
+            break;
+        }
+    }
+    if (pool_size == 0) {
+        __atomic_store_n(&pool_running, 0, __ATOMIC_RELEASE);
+        pthread_mutex_unlock(&pool_lifecycle_mutex);
+        return ERROR_INVALID_ARG;
+    }
+    pthread_mutex_unlock(&pool_lifecycle_mutex);
+
+    char trace_msg[MAX_TRACE_MSG_LEN];
+    snprintf(trace_msg, sizeof(trace_msg),
+        "🧰 KERNEL: Pool de trabajo diferido iniciado (%d hilos%s)",
+        pool_size, pool_pinned ? ", fijados a CPUs" : "");
+    add_trace_silent(trace_msg);
+    return SUCCESS;
+}
+
+void irq_workpool_stop(void) {
+    pthread_mutex_lock(&pool_lifecycle_mutex);
+    if (!pool_running) {
+        pthread_mutex_unlock(&pool_lifecycle_mutex);
+        return;
+    }
+
+    // Los hilos terminan cuando no queda nada pendiente
+    __atomic_store_n(&pool_running, 0, __ATOMIC_SEQ_CST);
+    pthread_mutex_lock(&idle_mutex);
+    pthread_cond_broadcast(&idle_cond);
+    pthread_mutex_unlock(&idle_mutex);
+    for (int i = 0; i < pool_size; i++) {
+        pthread_join(pool_workers[i].thread, NULL);
+    }
+
+    // Trabajo encolado desde fuera mientras el pool se detenía
+    while (__atomic_load_n(&pool_pending, __ATOMIC_SEQ_CST) > 0 ||
+           __atomic_load_n(&pool_submitters, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&inject_mutex);
+        irq_work_t *item = inject_head;
+        if (item != NULL) {
+            inject_head = item->next;
+            if (inject_head == NULL) {
+                inject_tail = NULL;
+            }
+        }
+        pthread_mutex_unlock(&inject_mutex);
+        if (item != NULL) {
+            __atomic_sub_fetch(&pool_pending, 1, __ATOMIC_SEQ_CST);
+            sim_context_t *previous = sim_context_enter(item->sim);
+            item->fn(item->arg);
+            sim_context_enter(previous);
+            irq_work_group_t *group = item->group;
+            irq_slab_free(work_slab, item);
+            work_done(group);
+        } else {
+            sched_yield();
+        }
+    }
+    pthread_mutex_unlock(&pool_lifecycle_mutex);
+}
+
+int irq_workpool_is_running(void) {
+    return __atomic_load_n(&pool_running, __ATOMIC_ACQUIRE);
+}
+
+int irq_workpool_reserve(unsigned long count) {
+    pthread_once(&work_slab_once, work_slab_create);
+    return work_slab != NULL ? irq_slab_reserve(work_slab, count) : ERROR_INVALID_ARG;
+}
+
+void irq_workpool_get_stats(irq_workpool_stats_t *out) {
+    memset(out, 0, sizeof(*out));
+    pthread_mutex_lock(&pool_lifecycle_mutex);
+    out->running = pool_running;
+    out->workers = pool_size;
+    out->pinned = pool_pinned;
+    for (int i = 0; i < pool_size; i++) {
+        pool_worker_t *w = &pool_workers[i];
+        irq_workpool_worker_stats_t *ws = &out->worker[i];
+        ws->executed = STAT_GET(w->stats.executed);
+        ws->stolen = STAT_GET(w->stats.stolen);
+        ws->steal_attempts = STAT_GET(w->stats.steal_attempts);
+        ws->injected = STAT_GET(w->stats.injected);
+        ws->idle_sleeps = STAT_GET(w->stats.idle_sleeps);
+        ws->idle_us = STAT_GET(w->stats.idle_us);
+        ws->busy_us = STAT_GET(w->stats.busy_us);
+        ws->cpu = __atomic_load_n(&w->stats.cpu, __ATOMIC_RELAXED);
+        int64_t depth = __atomic_load_n(&w->deque.bottom, __ATOMIC_RELAXED) -
+                        __atomic_load_n(&w->deque.top, __ATOMIC_RELAXED);
+        ws->queue_depth = depth > 0 ? (unsigned long)depth : 0;
+    }
+    pthread_mutex_unlock(&pool_lifecycle_mutex);
+
+    long pending = __atomic_load_n(&pool_pending, __ATOMIC_SEQ_CST);
+    out->pending = pending > 0 ? (unsigned long)pending : 0;
+    out->max_pending = __atomic_load_n(&pool_max_pending, __ATOMIC_RELAXED);
+    out->submitted = __atomic_load_n(&pool_submitted, __ATOMIC_RELAXED);
+    out->executed = __atomic_load_n(&pool_executed, __ATOMIC_RELAXED);
+    out->inline_runs = __atomic_load_n(&pool_inline_runs, __ATOMIC_RELAXED);
+    out->overflows = __atomic_load_n(&pool_overflows, __ATOMIC_RELAXED);
+    out->latency_total_us = __atomic_load_n(&pool_latency_total_us, __ATOMIC_RELAXED);
+    out->latency_max_us = __atomic_load_n(&pool_latency_max_us, __ATOMIC_RELAXED);
+}
+
+void show_irq_workpool(void) {
+    irq_workpool_stats_t st;
+    irq_workpool_get_stats(&st);
+
+    printf("\n=== POOL DE TRABAJO DIFERIDO (robo de trabajo) ===\n");
+    printf("Estado: %s │ Hilos: %d │ Fijados a CPU: %s\n",
+           st.running ? "ACTIVO" : "DETENIDO", st.workers, st.pinned ? "sí" : "no");
+    printf("Encolados: %lu │ Ejecutados: %lu │ En línea: %lu │ Pendientes: %lu (máx. %lu) │ Desbordes: %lu\n",
+           st.submitted, st.executed, st.inline_runs, st.pending, st.max_pending, st.overflows);
+    printf("Latencia de cola: %.1f μs prom. / %lu μs máx.\n\n",
+           st.executed > 0 ? (double)st.latency_total_us / st.executed : 0.0, st.latency_max_us);
+
+    printf("Hilo │ CPU │ Ejecutados │ Robados │ Intentos │ Inyectados │ Cola │ Ocupado ms │ Ocioso ms │ Siestas\n");
+    for (int i = 0; i < st.workers; i++) {
+        irq_workpool_worker_stats_t *ws = &st.worker[i];
+        char cpu[12];
+        if (ws->cpu >= 0) {
+            snprintf(cpu, sizeof(cpu), "%d", ws->cpu);
+        } else {
+            snprintf(cpu, sizeof(cpu), "-");
+        }
+        printf("%4d │ %3s │ %10lu │ %7lu │ %8lu │ %10lu │ %4lu │ %10.1f │ %9.1f │ %lu\n",
+               i, cpu, ws->executed, ws->stolen, ws->steal_attempts, ws->injected,
+               ws->queue_depth, ws->busy_us / 1000.0, ws->idle_us / 1000.0, ws->idle_sleeps);
+    }
+    printf("\n");
+}
+
+// Carga mixta en ráfagas: trabajos de coste variable, algunos con hijos
+static irq_work_group_t bench_group;
+
+static void spin_us(unsigned long us) {
+    uint64_t end = now_ns() + (uint64_t)us * 1000ULL;
+    while (now_ns() < end) {
+    }
+}
+
+static void bench_work(void *arg) {
+    uintptr_t v = (uintptr_t)arg;
+    unsigned long cost_us = v & 0xffff;
+    int children = (int)(v >> 16);
+
+    spin_us(cost_us);
+    for (int i = 0; i < children; i++) {
+        irq_work_submit(bench_work, (void *)(uintptr_t)(cost_us / 2 + 1), &bench_group);
+    }
+}
+
+int irq_workpool_benchmark(int items, double *elapsed_ms) {
+    if (items <= 0) {
+        return ERROR_INVALID_ARG;
+    }
+
+    unsigned int seed = 12345;
+    int total = 0;
+    irq_work_group_init(&bench_group);
+    uint64_t start = now_ns();
+    for (int burst = 0; total < items; burst++) {
+        int burst_len = 16 + (int)(rand_r(&seed) % 112);
+        for (int i = 0; i < burst_len && total < items; i++) {
+            unsigned long cost_us = 5 + (unsigned long)(rand_r(&seed) % 46);
+            uintptr_t children = (rand_r(&seed) % 8 == 0) ? 2 : 0;
+            irq_work_submit(bench_work, (void *)((children << 16) | cost_us), &bench_group);
+            total += 1 + (int)children;
+        }
+        // Entre ráfagas el productor hace una pausa breve
+        spin_us(20);
+    }
+    irq_work_group_wait(&bench_group);
+    *elapsed_ms = (now_ns() - start) / 1e6;
+    irq_work_group_destroy(&bench_group);
+    return total;
+}
+
+void irq_workpool_submenu(void) {
+    int option;
+
+    while (1) {
+        printf("\n=== POOL DE TRABAJO DIFERIDO ===\n");
+        printf("1. Mostrar estado y métricas\n");
+        printf("2. Reconfigurar hilos y fijación a CPUs\n");
+        printf("3. Medir escalado con carga mixta en ráfagas\n");
+        printf("0. Volver\n");
+        printf("Seleccione una opción: ");
+        fflush(stdout);
+
+        option = get_valid_input(0, 3);
+        switch (option) {
+            case 0:
+                return;
+            case 1:
+                show_irq_workpool();
+                break;
+            case 2: {
+                printf("Número de hilos (1-%d): ", IRQ_WORKPOOL_MAX_WORKERS);
+                fflush(stdout);
+                int workers = get_valid_input(1, IRQ_WORKPOOL_MAX_WORKERS);
+                printf("Fijar cada hilo a una CPU (1 = sí, 0 = no): ");
+                fflush(stdout);
+                int pin = get_valid_input(0, 1);
+                irq_workpool_stop();
+                if (irq_workpool_start(workers, pin) == SUCCESS) {
+                    printf("✓ Pool reiniciado con %d hilos.\n", workers);
+                } else {
+                    printf("✗ No se pudo reiniciar el pool.\n");
+                }
+                break;
+            }
+            case 3: {
+                irq_workpool_stats_t st;
+                irq_workpool_get_stats(&st);
+                int workers = st.workers > 0 ? st.workers : IRQ_WORKPOOL_DEFAULT_WORKERS;
+                int pinned = st.pinned;
+                double base_rate = 0.0;
+
+                printf("\nHilos │ Trabajos │ Tiempo ms │ Trabajos/s │ Aceleración\n");
+                for (int n = 1; n <= workers; n = (n * 2 > workers && n < workers) ? workers : n * 2) {
+                    double ms = 0.0;
+                    irq_workpool_stop();
+                    irq_workpool_start(n, pinned);
+                    int done = irq_workpool_benchmark(20000, &ms);
+                    double rate = ms > 0 ? done * 1000.0 / ms : 0.0;
+                    if (n == 1) {
+                        base_rate = rate;
+                    }
+                    printf("%5d │ %8d │ %9.1f │ %10.0f │ %.2fx\n",
+                           n, done, ms, rate, base_rate > 0 ? rate / base_rate : 0.0);
+                }
+                irq_workpool_stop();
+                irq_workpool_start(workers, pinned);
+                printf("CPUs en línea: %ld\n", sysconf(_SC_NPROCESSORS_ONLN));
+                break;
+            }
+        }
+    }
+}
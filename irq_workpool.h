@@ -0,0 +1,78 @@
+#ifndef IRQ_WORKPOOL_H
+#define IRQ_WORKPOOL_H
+
+#include <stdint.h>
+#include "interrupt_simulator.h"
+
+// Ejecutor con robo de trabajo para el trabajo diferido de interrupciones
+// (mitades inferiores, trabajos de workqueue y ráfagas de prueba)
+//
+// Cada hilo tiene una deque Chase-Lev propia: empuja y saca por abajo sin
+// bloqueos y los hilos ociosos roban por arriba. Lo que se encola desde fuera
+// del pool entra por una cola de inyección compartida, de la que cada hilo toma
+// lotes que reparte en su deque para que los demás puedan robarlos. Con el
+// pool detenido, irq_work_submit() ejecuta el trabajo en el hilo que llama.
+
+#define IRQ_WORKPOOL_DEFAULT_WORKERS 4
+#define IRQ_WORKPOOL_MAX_WORKERS 16
+#define IRQ_WORKPOOL_DEQUE_SIZE 1024        // Potencia de 2
+#define IRQ_WORKPOOL_INJECT_BATCH 16        // Trabajos tomados de la cola compartida
+
+typedef void (*irq_work_fn)(void *arg);
+
+// Grupo de trabajos para esperar a que terminen todos
+typedef struct {
+    unsigned long pending;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+} irq_work_group_t;
+
+typedef struct {
+    unsigned long executed;
+    unsigned long stolen;                   // Trabajos robados a otros hilos
+    unsigned long steal_attempts;
+    unsigned long injected;                 // Tomados de la cola compartida
+    unsigned long idle_sleeps;
+    unsigned long idle_us;
+    unsigned long busy_us;
+    unsigned long queue_depth;              // Ocupación actual de la deque
+    int cpu;                                // -1 = sin fijar
+} irq_workpool_worker_stats_t;
+
+typedef struct {
+    int running;
+    int workers;
+    int pinned;
+    unsigned long submitted;
+    unsigned long executed;
+    unsigned long inline_runs;              // Ejecutados sin pool
+    unsigned long pending;                  // Encolados sin empezar
+    unsigned long max_pending;
+    unsigned long overflows;                // Deque llena: desviado a la cola compartida
+    unsigned long latency_total_us;         // Encolado -> inicio
+    unsigned long latency_max_us;
+    irq_workpool_worker_stats_t worker[IRQ_WORKPOOL_MAX_WORKERS];
+} irq_workpool_stats_t;
+
+// Ciclo de vida (stop espera a que se vacíen las colas)
+int irq_workpool_start(int workers, int pin_cpus);
+void irq_workpool_stop(void);
+int irq_workpool_is_running(void);
+
+// Encolar trabajo (group puede ser NULL)
+int irq_work_submit(irq_work_fn fn, void *arg, irq_work_group_t *group);
+void irq_work_group_init(irq_work_group_t *group);
+void irq_work_group_wait(irq_work_group_t *group);
+void irq_work_group_destroy(irq_work_group_t *group);
+// Reservar capacidad para count trabajos encolados desde el hilo actual
+int irq_workpool_reserve(unsigned long count);
+
+void irq_workpool_get_stats(irq_workpool_stats_t *out);
+
+// Carga mixta en ráfagas sobre el pool actual; devuelve los trabajos ejecutados
+int irq_workpool_benchmark(int items, double *elapsed_ms);
+
+void show_irq_workpool(void);
+void irq_workpool_submenu(void);
+
+#endif // IRQ_WORKPOOL_H
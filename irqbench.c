@@ -0,0 +1,209 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "irqsim.h"
+#include "irq_static.h"
+
+// irqbench - Benchmark del despacho dentro del proceso
+//
+// Enlaza libirqsim y mide el coste del despacho sin terminal, sin sleeps y
+// sin plano de control. Cada hilo crea su propia máquina
+// (sim_context_create), instala una ISR vacía en los vectores 2-15 y
+// despacha N interrupciones en rueda sobre V de ellos, por dos caminos:
+//   dynamic  dispatch_interrupt: validación, estados, puntero a la ISR, traza
+//            y contabilidad bajo los mutex de la IDT y las estadísticas
+//   static   switch generado con irq_static.h para el mismo layout, con
+//            contabilidad atómica por vector (sin locks en el despacho)
+// Uso:
+//   irqbench [--mode dynamic|static|both] [--threads T] [--dispatches N] [--vectors V]
+
+#define BENCH_MAX_THREADS 64
+#define BENCH_FIRST_VECTOR 2
+
+typedef enum {
+    BENCH_DYNAMIC,
+    BENCH_STATIC,
+    BENCH_MODES
+} bench_mode_t;
+
+static const char *mode_names[BENCH_MODES] = { "dynamic", "static" };
+static const char *mode_accounting[BENCH_MODES] = { "locked", "atomic" };
+
+typedef struct {
+    pthread_t thread;
+    bench_mode_t mode;
+    long dispatches;
+    int vectors;
+    unsigned long handled;
+    unsigned long accounted;                // Suma de call_count en la IDT
+    unsigned long counted;                  // total_interrupts en las estadísticas
+    uint64_t elapsed_ns;
+    int ok;
+} bench_worker_t;
+
+static __thread unsigned long handled;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static inline void bench_isr(int irq_num) {
+    (void)irq_num;
+    handled++;
+}
+
+#define BENCH_LAYOUT(X)               \
+    X(2, bench_isr, "irqbench 2")     \
+    X(3, bench_isr, "irqbench 3")     \
+    X(4, bench_isr, "irqbench 4")     \
+    X(5, bench_isr, "irqbench 5")     \
+    X(6, bench_isr, "irqbench 6")     \
+    X(7, bench_isr, "irqbench 7")     \
+    X(8, bench_isr, "irqbench 8")     \
+    X(9, bench_isr, "irqbench 9")     \
+    X(10, bench_isr, "irqbench 10")   \
+    X(11, bench_isr, "irqbench 11")   \
+    X(12, bench_isr, "irqbench 12")   \
+    X(13, bench_isr, "irqbench 13")   \
+    X(14, bench_isr, "irqbench 14")   \
+    X(15, bench_isr, "irqbench 15")
+
+IRQ_STATIC_DEFINE(bench, BENCH_LAYOUT)
+
+static void *bench_worker_func(void *arg) {
+    bench_worker_t *w = (bench_worker_t *)arg;
+    sim_context_t *ctx = sim_context_create();
+    if (ctx == NULL) {
+        return NULL;
+    }
+    // Mismo layout en la IDT para los dos caminos
+    if (bench_install(ctx) != SUCCESS) {
+        sim_context_destroy(ctx);
+        return NULL;
+    }
+
+    sim_context_enter(ctx);
+    handled = 0;
+    uint64_t start = now_ns();
+    if (w->mode == BENCH_STATIC) {
+        for (long i = 0; i < w->dispatches; i++) {
+            bench_dispatch(BENCH_FIRST_VECTOR + (int)(i % w->vectors));
+        }
+    } else {
+        for (long i = 0; i < w->dispatches; i++) {
+            dispatch_interrupt(BENCH_FIRST_VECTOR + (int)(i % w->vectors));
+        }
+    }
+    w->elapsed_ns = now_ns() - start;
+    w->handled = handled;
+    sim_context_enter(NULL);
+
+    for (int irq = BENCH_FIRST_VECTOR; irq < MAX_INTERRUPTS; irq++) {
+        irq_descriptor_t desc;
+        sim_get_descriptor(ctx, irq, &desc);
+        w->accounted += (unsigned long)desc.call_count;
+    }
+    system_stats_t stats;
+    sim_get_stats(ctx, &stats);
+    w->counted = stats.total_interrupts;
+    sim_context_destroy(ctx);
+    w->ok = 1;
+    return NULL;
+}
+
+// Devuelve ns por despacho (0 si falló)
+static double run_mode(bench_mode_t mode, int threads, long dispatches, int vectors) {
+    bench_worker_t workers[BENCH_MAX_THREADS];
+    uint64_t start = now_ns();
+    int started = 0;
+    for (; started < threads; started++) {
+        bench_worker_t *w = &workers[started];
+        memset(w, 0, sizeof(*w));
+        w->mode = mode;
+        w->dispatches = dispatches;
+        w->vectors = vectors;
+        if (pthread_create(&w->thread, NULL, bench_worker_func, w) != 0) {
+            break;
+        }
+    }
+    unsigned long total = 0;
+    uint64_t busy_ns = 0;
+    int all_ok = started == threads;
+    for (int t = 0; t < started; t++) {
+        pthread_join(workers[t].thread, NULL);
+        all_ok = all_ok && workers[t].ok && workers[t].handled == (unsigned long)dispatches &&
+                 workers[t].accounted == (unsigned long)dispatches &&
+                 workers[t].counted == (unsigned long)dispatches;
+        total += workers[t].handled;
+        busy_ns += workers[t].elapsed_ns;
+    }
+    double seconds = (now_ns() - start) / 1e9;
+    double ns_per_dispatch = total > 0 ? (double)busy_ns / (double)total : 0.0;
+
+    printf("%s mode=%s accounting=%s threads=%d dispatches=%lu seconds=%.3f rate=%.0f/s ns_per_dispatch=%.0f\n",
+           all_ok ? "OK" : "FAIL", mode_names[mode], mode_accounting[mode], started, total, seconds,
+           seconds > 0 ? total / seconds : 0.0, ns_per_dispatch);
+    return all_ok ? ns_per_dispatch : 0.0;
+}
+
+static int parse_long(const char *text, long min, long max, long *out) {
+    char *end = NULL;
+    long value = strtol(text, &end, 0);
+    if (end == text || *end != '\0' || value < min || value > max) {
+        fprintf(stderr, "Valor inválido: %s\n", text);
+        return -1;
+    }
+    *out = value;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    long threads = 1, dispatches = 200000, vectors = 8;
+    int first_mode = BENCH_DYNAMIC, last_mode = BENCH_STATIC;
+
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Uso: %s [--mode dynamic|static|both] [--threads T] [--dispatches N] [--vectors V]\n",
+                    argv[0]);
+            return 2;
+        }
+        int rc = 0;
+        if (strcmp(argv[i], "--mode") == 0) {
+            const char *mode = argv[++i];
+            if (strcmp(mode, "dynamic") == 0) {
+                last_mode = BENCH_DYNAMIC;
+            } else if (strcmp(mode, "static") == 0) {
+                first_mode = BENCH_STATIC;
+            } else if (strcmp(mode, "both") != 0) {
+                fprintf(stderr, "Valor inválido: %s\n", mode);
+                rc = -1;
+            }
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            rc = parse_long(argv[++i], 1, BENCH_MAX_THREADS, &threads);
+        } else if (strcmp(argv[i], "--dispatches") == 0) {
+            rc = parse_long(argv[++i], 1, 1000000000L, &dispatches);
+        } else if (strcmp(argv[i], "--vectors") == 0) {
+            rc = parse_long(argv[++i], 1, MAX_INTERRUPTS - BENCH_FIRST_VECTOR, &vectors);
+        } else {
+            fprintf(stderr, "Opción desconocida: %s\n", argv[i]);
+            return 2;
+        }
+        if (rc != 0) {
+            return 2;
+        }
+    }
+
+    double ns[BENCH_MODES] = { 0 };
+    int all_ok = 1;
+    for (int mode = first_mode; mode <= last_mode; mode++) {
+        ns[mode] = run_mode((bench_mode_t)mode, (int)threads, dispatches, (int)vectors);
+        all_ok = all_ok && ns[mode] > 0;
+    }
+    if (all_ok && first_mode != last_mode) {
+        printf("OK speedup=%.1fx (dynamic/static)\n", ns[BENCH_DYNAMIC] / ns[BENCH_STATIC]);
+    }
+    return all_ok ? 0 : 1;
+}
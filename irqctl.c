@@ -0,0 +1,142 @@
+#define _GNU_SOURCE
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "irq_ctl.h"
+
+// irqctl - Cliente del plano de control
+//
+// Envía todos los comandos (argumentos o stdin) en una única ráfaga, cierra
+// el lado de escritura y muestra las respuestas a medida que llegan.
+
+static int send_all(int fd, const char *data, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// Reunir los comandos en un solo buffer (una línea por argumento o de stdin)
+static char *collect_commands(int argc, char *argv[], int first, size_t *len) {
+    size_t cap = 4096;
+    char *buf = malloc(cap);
+    *len = 0;
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    if (first < argc) {
+        for (int i = first; i < argc; i++) {
+            size_t arg_len = strlen(argv[i]);
+            while (*len + arg_len + 2 > cap) {
+                cap *= 2;
+                char *grown = realloc(buf, cap);
+                if (grown == NULL) {
+                    free(buf);
+                    return NULL;
+                }
+                buf = grown;
+            }
+            memcpy(buf + *len, argv[i], arg_len);
+            *len += arg_len;
+            buf[(*len)++] = '\n';
+        }
+        return buf;
+    }
+
+    size_t n;
+    while ((n = fread(buf + *len, 1, cap - *len, stdin)) > 0) {
+        *len += n;
+        if (*len == cap) {
+            cap *= 2;
+            char *grown = realloc(buf, cap);
+            if (grown == NULL) {
+                free(buf);
+                return NULL;
+            }
+            buf = grown;
+        }
+    }
+    if (*len > 0 && buf[*len - 1] != '\n') {
+        if (*len == cap) {
+            char *grown = realloc(buf, cap + 1);
+            if (grown == NULL) {
+                free(buf);
+                return NULL;
+            }
+            buf = grown;
+        }
+        buf[(*len)++] = '\n';
+    }
+    return buf;
+}
+
+static void show_usage(const char *prog) {
+    printf("Uso: %s [-s SOCKET] [COMANDO ...]\n", prog);
+    printf("  -s SOCKET   Socket del simulador (por defecto %s)\n", CTL_DEFAULT_SOCKET_PATH);
+    printf("  -h          Mostrar esta ayuda\n");
+    printf("Sin comandos en la línea, se leen de stdin (uno por línea).\n");
+    printf("Ejemplo: %s 'REG 5 custom Sensor' 'RAISE 5 100' 'STATS 5'\n", prog);
+}
+
+int main(int argc, char *argv[]) {
+    const char *path = CTL_DEFAULT_SOCKET_PATH;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:h")) != -1) {
+        switch (opt) {
+            case 's': path = optarg; break;
+            case 'h': show_usage(argv[0]); return 0;
+            default:  show_usage(argv[0]); return 1;
+        }
+    }
+
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "❌ Ruta de socket demasiado larga\n");
+        return 1;
+    }
+    memcpy(addr.sun_path, path, strlen(path) + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+        fprintf(stderr, "❌ No se pudo conectar a %s (¿simulador en ejecución?)\n", path);
+        return 1;
+    }
+
+    size_t len;
+    char *commands = collect_commands(argc, argv, optind, &len);
+    if (commands == NULL) {
+        fprintf(stderr, "❌ Memoria insuficiente\n");
+        close(fd);
+        return 1;
+    }
+
+    int status = 0;
+    if (send_all(fd, commands, len) != 0) {
+        perror("send");
+        status = 1;
+    }
+    free(commands);
+    shutdown(fd, SHUT_WR);
+
+    char buf[CTL_READ_BUFFER];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) {
+        fwrite(buf, 1, (size_t)n, stdout);
+        if (memmem(buf, (size_t)n, "ERR ", 4) != NULL) {
+            status = 2;
+        }
+    }
+    close(fd);
+    return status;
+}
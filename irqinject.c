@@ -0,0 +1,161 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "irq_inject.h"
+
+// irqinject - Generador de carga externo para el anillo de inyección
+//
+// Cada hilo productor escribe lotes de registros directamente en la memoria
+// compartida del simulador: ninguna llamada al sistema por interrupción.
+
+#define MAX_PRODUCER_THREADS 64
+#define MAX_TARGET_IRQS 16
+
+typedef struct {
+    irq_inject_ring_t *ring;
+    int id;
+    unsigned long count;            // Registros a inyectar por este hilo
+    unsigned int batch;
+    const int *irqs;
+    int num_irqs;
+    unsigned long pushed;
+    unsigned long retries;
+} producer_args_t;
+
+static void *producer_func(void *arg) {
+    producer_args_t *p = (producer_args_t *)arg;
+    irq_inject_record_t recs[IRQ_INJECT_BATCH];
+    unsigned long seqno = 0;
+
+    while (p->pushed < p->count) {
+        unsigned long remaining = p->count - p->pushed;
+        unsigned int n = remaining < p->batch ? (unsigned int)remaining : p->batch;
+        uint64_t now = irq_inject_now_ns();
+
+        for (unsigned int i = 0; i < n; i++) {
+            recs[i].irq = p->irqs[(seqno + i) % (unsigned long)p->num_irqs];
+            recs[i].flags = 0;
+            recs[i].payload = ((uint64_t)p->id << 48) | (seqno + i);
+            recs[i].timestamp_ns = now;
+        }
+
+        if (irq_inject_push_batch(p->ring, recs, n) != 0) {
+            // Anillo lleno: contrapresión del consumidor
+            p->retries++;
+            sched_yield();
+            continue;
+        }
+        p->pushed += n;
+        seqno += n;
+    }
+    return NULL;
+}
+
+static int parse_irq_list(const char *arg, int *irqs) {
+    int count = 0;
+    char buf[128];
+    strncpy(buf, arg, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = '\0';
+
+    for (char *tok = strtok(buf, ","); tok != NULL && count < MAX_TARGET_IRQS;
+         tok = strtok(NULL, ",")) {
+        irqs[count++] = atoi(tok);
+    }
+    return count;
+}
+
+static void show_help(const char *prog) {
+    printf("Uso: %s [opciones]\n", prog);
+    printf("  -s NOMBRE   Segmento del anillo (por defecto %s)\n", IRQ_INJECT_DEFAULT_NAME);
+    printf("  -q LISTA    IRQs destino separadas por comas (por defecto 1)\n");
+    printf("  -n N        Total de interrupciones a inyectar (por defecto 1000)\n");
+    printf("  -b N        Registros por lote (1-%d, por defecto 32)\n", IRQ_INJECT_BATCH);
+    printf("  -t N        Hilos productores (por defecto 1)\n");
+    printf("  -h          Mostrar esta ayuda\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *name = IRQ_INJECT_DEFAULT_NAME;
+    int irqs[MAX_TARGET_IRQS] = {1};
+    int num_irqs = 1;
+    unsigned long total = 1000;
+    long batch = 32;
+    long threads = 1;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:q:n:b:t:h")) != -1) {
+        switch (opt) {
+            case 's': name = optarg; break;
+            case 'q': num_irqs = parse_irq_list(optarg, irqs); break;
+            case 'n': total = strtoul(optarg, NULL, 10); break;
+            case 'b': batch = strtol(optarg, NULL, 10); break;
+            case 't': threads = strtol(optarg, NULL, 10); break;
+            case 'h': show_help(argv[0]); return 0;
+            default:  show_help(argv[0]); return 1;
+        }
+    }
+    if (num_irqs <= 0 || batch <= 0 || batch > IRQ_INJECT_BATCH ||
+        threads <= 0 || threads > MAX_PRODUCER_THREADS) {
+        show_help(argv[0]);
+        return 1;
+    }
+
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        fprintf(stderr, "❌ No se encontró el anillo %s (¿simulador en ejecución?)\n", name);
+        return 1;
+    }
+    void *mem = mmap(NULL, sizeof(irq_inject_ring_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        perror("mmap");
+        return 1;
+    }
+    irq_inject_ring_t *ring = (irq_inject_ring_t *)mem;
+    if (__atomic_load_n(&ring->magic, __ATOMIC_ACQUIRE) != IRQ_INJECT_MAGIC ||
+        ring->version != IRQ_INJECT_VERSION) {
+        fprintf(stderr, "❌ El segmento %s no contiene un anillo de inyección válido\n", name);
+        munmap(mem, sizeof(irq_inject_ring_t));
+        return 1;
+    }
+
+    pthread_t tids[MAX_PRODUCER_THREADS];
+    producer_args_t args[MAX_PRODUCER_THREADS];
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for (long t = 0; t < threads; t++) {
+        args[t].ring = ring;
+        args[t].id = (int)t;
+        args[t].count = total / threads + ((unsigned long)t < total % threads ? 1 : 0);
+        args[t].batch = (unsigned int)batch;
+        args[t].irqs = irqs;
+        args[t].num_irqs = num_irqs;
+        args[t].pushed = 0;
+        args[t].retries = 0;
+        pthread_create(&tids[t], NULL, producer_func, &args[t]);
+    }
+
+    unsigned long pushed = 0;
+    unsigned long retries = 0;
+    for (long t = 0; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+        pushed += args[t].pushed;
+        retries += args[t].retries;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("✓ Inyectadas %lu interrupciones en %.3f s (%.0f IRQs/s) - %ld hilos, lotes de %ld, %lu reintentos por anillo lleno\n",
+           pushed, elapsed, elapsed > 0 ? pushed / elapsed : 0.0, threads, batch, retries);
+
+    munmap(mem, sizeof(irq_inject_ring_t));
+    return 0;
+}
@@ -0,0 +1,82 @@
+#define _GNU_SOURCE
+#include <signal.h>
+#include "irqsim.h"
+#include "irq_suite.h"
+#include "irq_rt.h"
+
+// irqrun - Ejecutor del simulador sin menú
+//
+// Mismo motor que el menú (libirqsim) para scripts y CI:
+//   irqrun --seed S | --sweep N [--first S] [--jobs J]   Suites sembradas
+//   irqrun --serve [SEGUNDOS]                            Sistema completo
+//   irqrun --rt "cpus=2 prio=80 lock" ...                Hilos en modo RT
+// --serve arranca el contexto por defecto (timer, pool, inyección, plano
+// de control) y lo mantiene hasta SIGINT/SIGTERM o el plazo; se maneja con
+// irqctl e irqinject como el menú.
+
+static int serve(double seconds) {
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    // Bloqueadas antes de crear hilos: sólo las recibe sigtimedwait
+    pthread_sigmask(SIG_BLOCK, &stop_signals, NULL);
+
+    if (sim_system_start() != SUCCESS) {
+        sim_system_shutdown();
+        return 1;
+    }
+    printf("OK serving pid=%d\n", (int)getpid());
+    fflush(stdout);
+
+    struct timespec start, now;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (;;) {
+        struct timespec tick = { 0, 200 * 1000000L };
+        int sig = sigtimedwait(&stop_signals, NULL, &tick);
+        if (sig == SIGINT || sig == SIGTERM) {
+            printf("🛑 Señal %d recibida\n", sig);
+            break;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double elapsed = (double)(now.tv_sec - start.tv_sec) + (now.tv_nsec - start.tv_nsec) / 1e9;
+        if (seconds > 0 && elapsed >= seconds) {
+            break;
+        }
+    }
+
+    system_stats_t stats;
+    sim_get_stats(sim_default(), &stats);
+    sim_system_shutdown();
+    printf("OK stopped interrupts=%lu\n", stats.total_interrupts);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    if (irq_rt_take_args(&argc, &argv) != SUCCESS) {
+        return 2;
+    }
+    if (argc >= 2 && strcmp(argv[1], "--serve") == 0) {
+        double seconds = 0;
+        if (argc > 3) {
+            fprintf(stderr, "Uso: %s --serve [SEGUNDOS]\n", argv[0]);
+            return 2;
+        }
+        if (argc == 3) {
+            char *end = NULL;
+            seconds = strtod(argv[2], &end);
+            if (end == argv[2] || *end != '\0' || seconds < 0) {
+                fprintf(stderr, "Valor inválido: %s\n", argv[2]);
+                return 2;
+            }
+        }
+        return serve(seconds);
+    }
+
+    int rc = irq_suite_main(argc, argv);
+    if (rc < 0) {
+        fprintf(stderr, "Uso: %s [--rt SPEC] --seed S | --sweep N [--first S] [--jobs J] | --serve [SEGUNDOS]\n", argv[0]);
+        return 2;
+    }
+    return rc;
+}
@@ -0,0 +1,204 @@
+#ifndef IRQSIM_H
+#define IRQSIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <pthread.h>
+
+// API pública del motor de interrupciones (libirqsim.a / libirqsim.so)
+//
+// Es todo lo que necesita un programa que incrusta el simulador: la IDT,
+// el despacho, la traza, las estadísticas y los contextos de simulación.
+// El menú (interrupt_simulator), el ejecutor sin terminal (irqrun) y el
+// benchmark (irqbench) son frontends que sólo enlazan la biblioteca.
+// interrupt_simulator.h añade las declaraciones internas de los módulos.
+//
+// Uso mínimo sin subsistemas de proceso:
+//
+//     sim_context_t *ctx = sim_context_create();
+//     sim_register_isr(ctx, 5, mi_isr, "Mi dispositivo");
+//     sim_dispatch_interrupt(ctx, 5);
+//     sim_context_destroy(ctx);
+//
+// sim_system_start() arranca además el contexto por defecto con el timer,
+// la memoria compartida, el pool de trabajo y el plano de control, como el
+// menú; sim_system_shutdown() lo detiene todo.
+
+// Configuración del simulador
+#define MAX_INTERRUPTS 16
+#define MAX_TRACE_LINES 1024               // Registros compactos (irq_trace.h)
+#define MAX_TRACE_MSG_LEN 256
+#define MAX_DESCRIPTION_LEN 64
+
+// Intervalos de tiempo (en segundos y microsegundos)
+#define TIMER_INTERVAL_SEC 3
+#define ISR_SIMULATION_DELAY_US 100000  // 100ms
+#define KEYBOARD_DELAY_US 50000         // 50ms
+#define CUSTOM_DELAY_US 75000           // 75ms
+
+// IRQs estándar del sistema
+#define IRQ_TIMER 0
+#define IRQ_KEYBOARD 1
+
+// Códigos de error
+#define SUCCESS 0
+#define ERROR_INVALID_IRQ -1
+#define ERROR_ISR_EXECUTING -2
+#define ERROR_NO_ISR -3
+#define ERROR_SHM -4
+#define ERROR_FD_SOURCE -5
+#define ERROR_INVALID_ARG -6
+#define ERROR_PLUGIN -7
+#define ERROR_CAPTURE -8
+#define ERROR_REPLAY -9
+
+#define IS_VALID_IRQ(irq) ((irq) >= 0 && (irq) < MAX_INTERRUPTS)
+
+// Estados de IRQ
+typedef enum {
+    IRQ_STATE_FREE,
+    IRQ_STATE_REGISTERED,
+    IRQ_STATE_EXECUTING
+} irq_state_t;
+
+// Niveles de logging
+typedef enum {
+    LOG_LEVEL_SILENT,
+    LOG_LEVEL_USER_ONLY,
+    LOG_LEVEL_VERBOSE
+} log_level_t;
+
+// Descriptor de IRQ en la IDT
+typedef struct {
+    void (*isr)(int);                    // Puntero a la función ISR
+    irq_state_t state;                   // Estado actual del IRQ
+    int call_count;                      // Número de veces llamada
+    time_t last_call;                    // Timestamp de última llamada
+    unsigned long total_execution_time;  // Tiempo total de ejecución en μs
+    char description[MAX_DESCRIPTION_LEN]; // Descripción del handler
+    int cpu_affinity;                    // CPU asignada (-1 = cualquiera)
+    int priority;                        // Prioridad del vector (0 = normal)
+} irq_descriptor_t;
+
+// Entrada de traza ya reconstruida (se guarda compacta, ver irq_trace.h)
+typedef struct {
+    char timestamp[16];
+    char event[MAX_TRACE_MSG_LEN];
+    int irq_num;
+} trace_entry_t;
+
+// Estadísticas del sistema
+typedef struct {
+    unsigned long total_interrupts;
+    unsigned long timer_interrupts;
+    unsigned long keyboard_interrupts;
+    unsigned long custom_interrupts;
+    double average_response_time;
+    time_t system_start_time;
+} system_stats_t;
+
+// Contexto de simulación: el estado completo de una máquina simulada
+//
+// La IDT, las estadísticas, la traza, el timer y el nivel de log viven en un
+// sim_context_t en lugar de en variables globales. El proceso tiene uno por
+// defecto: el del menú, el plano de control y los subsistemas de proceso
+// (memoria compartida, tormentas, presupuesto, corrutinas, captura, MSI-X).
+// sim_context_create() crea máquinas independientes sin esos subsistemas,
+// para ejecutar muchas a la vez en hilos del mismo proceso.
+//
+// Cada hilo trabaja sobre su contexto actual (sim_current(), el de defecto
+// si no ha entrado en otro). Las funciones de siempre (register_isr,
+// dispatch_interrupt...) usan ese contexto, y también las ISRs, que sólo
+// reciben el número de IRQ; las variantes sim_* reciben el contexto
+// explícito y lo hacen actual mientras se ejecutan.
+//
+// La estructura es interna (interrupt_simulator.h): los programas que
+// enlazan la biblioteca sólo manejan punteros y usan las funciones sim_*,
+// así su disposición puede cambiar sin recompilarlos.
+typedef struct sim_context sim_context_t;
+
+sim_context_t *sim_default(void);
+sim_context_t *sim_current(void);
+// Hace ctx actual en el hilo que llama (NULL = el de defecto); devuelve el anterior
+sim_context_t *sim_context_enter(sim_context_t *ctx);
+// Máquina nueva con la IDT libre, en silencio y sin salida por terminal
+sim_context_t *sim_context_create(void);
+void sim_context_destroy(sim_context_t *ctx);
+
+// API con contexto explícito
+int sim_register_isr(sim_context_t *ctx, int irq_num, void (*isr_function)(int), const char *description);
+int sim_unregister_isr(sim_context_t *ctx, int irq_num);
+void sim_dispatch_interrupt(sim_context_t *ctx, int irq_num);
+void sim_get_stats(sim_context_t *ctx, system_stats_t *out);
+int sim_get_descriptor(sim_context_t *ctx, int irq_num, irq_descriptor_t *out);
+int sim_copy_recent_traces(sim_context_t *ctx, trace_entry_t *out, int max_entries);
+log_level_t sim_swap_log_level(sim_context_t *ctx, log_level_t level);
+// Cambia si se muestran las trazas del timer; devuelve el valor anterior
+int sim_swap_timer_logs(sim_context_t *ctx, int show);
+// La máquina sigue en marcha hasta sim_request_stop (o sim_system_shutdown)
+int sim_is_running(sim_context_t *ctx);
+void sim_request_stop(sim_context_t *ctx);
+int sim_start_timer(sim_context_t *ctx);
+void sim_stop_timer(sim_context_t *ctx);
+
+// Contexto por defecto con los subsistemas de proceso (timer, memoria
+// compartida, pool, corrutinas, inyección y plano de control)
+int sim_system_start(void);
+void sim_system_shutdown(void);
+
+// Funciones de utilidad
+void get_timestamp(char *buffer, size_t size);
+int validate_irq_num(int irq_num);
+int is_irq_available(int irq_num);
+const char* get_irq_state_string(irq_state_t state);
+
+// Funciones de trazabilidad
+void add_trace(const char *event);
+void add_trace_with_irq(const char *event, int irq_num);
+void add_trace_silent(const char *event);
+void add_trace_with_irq_silent(const char *event, int irq_num);
+void add_trace_smart(const char *event, int irq_num, int is_timer_related);
+void add_trace_smartf(int irq_num, int is_timer_related, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+void add_trace_with_irqf(int irq_num, const char *fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+int copy_recent_traces(trace_entry_t *out, int max_entries);
+
+// Funciones de configuración
+void set_log_level(log_level_t level);
+log_level_t get_log_level(void);
+log_level_t swap_log_level(log_level_t level);
+void toggle_timer_logs(void);
+
+// Funciones de inicialización
+void init_idt(void);
+void init_system_stats(void);
+
+// Funciones de manejo de ISR
+int register_isr(int irq_num, void (*isr_function)(int), const char *description);
+int unregister_isr(int irq_num);
+void dispatch_interrupt(int irq_num);
+// Contabiliza un despacho hecho por un dispatcher estático (irq_static.h)
+// sin tomar locks: suma con atómicos en los contadores pendientes del vector,
+// que se vuelcan en la IDT y las estadísticas al consultarlas.
+// ERROR_INVALID_IRQ si el vector está fuera de la IDT
+int sim_account_dispatch(int irq_num, unsigned long execution_time);
+// Vuelca los despachos estáticos pendientes (sim_get_descriptor,
+// sim_get_stats y el tick del timer ya lo hacen)
+void sim_fold_static_dispatches(sim_context_t *ctx);
+int set_irq_affinity(int irq_num, int cpu);
+int set_irq_priority(int irq_num, int priority);
+
+// ISRs predefinidas
+void timer_isr(int irq_num);
+void keyboard_isr(int irq_num);
+void custom_isr(int irq_num);
+void error_isr(int irq_num);
+
+// Funciones de backup/restore
+void save_idt_state(irq_descriptor_t *backup);
+void restore_idt_state(const irq_descriptor_t *backup);
+void cleanup_test_isrs(void);
+
+#endif // IRQSIM_H
@@ -0,0 +1,198 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "irq_shm.h"
+
+// irqtop - Lector externo de la página de estadísticas del simulador
+//
+// Mapea el segmento en solo lectura y copia cada vector con su seqlock:
+// nunca toma locks del simulador ni escribe en la memoria compartida.
+
+static const char *state_names[] = {"LIBRE", "REGISTRADO", "EJECUTANDO"};
+
+// Mapear el segmento publicado por el simulador (NULL si no existe o no es válido)
+static const irq_shm_page_t *map_stats_page(const char *name) {
+    int fd = shm_open(name, O_RDONLY, 0);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    void *mem = mmap(NULL, sizeof(irq_shm_page_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mem == MAP_FAILED) {
+        return NULL;
+    }
+
+    const irq_shm_page_t *page = (const irq_shm_page_t *)mem;
+    if (__atomic_load_n(&page->magic, __ATOMIC_ACQUIRE) != IRQ_SHM_MAGIC ||
+        page->version != IRQ_SHM_VERSION) {
+        munmap(mem, sizeof(irq_shm_page_t));
+        return NULL;
+    }
+    return page;
+}
+
+// Percentil aproximado (límite superior del bucket log2, acotado al máximo)
+static unsigned long histogram_percentile(const irq_shm_vector_t *v, double p) {
+    uint64_t total = 0;
+    for (int b = 0; b < IRQ_SHM_LAT_BUCKETS; b++) {
+        total += v->latency_hist[b];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t target = (uint64_t)(p * (double)total);
+    if (target == 0) {
+        target = 1;
+    }
+
+    uint64_t acc = 0;
+    for (int b = 0; b < IRQ_SHM_LAT_BUCKETS; b++) {
+        acc += v->latency_hist[b];
+        if (acc >= target) {
+            unsigned long bound = b == 0 ? 0 : (1UL << b) - 1;
+            return bound < v->max_execution_time ? bound : v->max_execution_time;
+        }
+    }
+    return v->max_execution_time;
+}
+
+// Lista compacta de las CPUs que atendieron el vector ("c0:12 c3:4")
+static void format_cpu_list(const irq_shm_vector_t *v, char *buf, size_t size) {
+    size_t used = 0;
+    buf[0] = '\0';
+    for (int c = 0; c < IRQ_SHM_MAX_CPUS && used < size; c++) {
+        if (v->cpu_count[c] == 0) {
+            continue;
+        }
+        int n = snprintf(buf + used, size - used, "%sc%d:%lu",
+                         used > 0 ? " " : "", c, (unsigned long)v->cpu_count[c]);
+        if (n < 0) {
+            break;
+        }
+        used += (size_t)n;
+    }
+    if (used == 0) {
+        snprintf(buf, size, "-");
+    }
+}
+
+static void show_help(const char *prog) {
+    printf("Uso: %s [opciones]\n", prog);
+    printf("  -s NOMBRE   Segmento de memoria compartida (por defecto %s)\n", IRQ_SHM_DEFAULT_NAME);
+    printf("  -i MS       Intervalo de refresco en milisegundos (por defecto 250)\n");
+    printf("  -n N        Número de refrescos antes de salir (0 = infinito)\n");
+    printf("  -1          Una sola muestra, sin limpiar la pantalla\n");
+    printf("  -h          Mostrar esta ayuda\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *name = IRQ_SHM_DEFAULT_NAME;
+    long interval_ms = 250;
+    long iterations = 0;
+    int batch = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:i:n:1h")) != -1) {
+        switch (opt) {
+            case 's': name = optarg; break;
+            case 'i': interval_ms = strtol(optarg, NULL, 10); break;
+            case 'n': iterations = strtol(optarg, NULL, 10); break;
+            case '1': batch = 1; iterations = 1; break;
+            case 'h': show_help(argv[0]); return 0;
+            default:  show_help(argv[0]); return 1;
+        }
+    }
+    if (interval_ms <= 0) {
+        interval_ms = 250;
+    }
+
+    const irq_shm_page_t *page = map_stats_page(name);
+    if (page == NULL) {
+        fprintf(stderr, "❌ No se encontró la página de estadísticas %s (¿simulador en ejecución?)\n", name);
+        return 1;
+    }
+
+    uint64_t prev_calls[IRQ_SHM_MAX_VECTORS] = {0};
+    struct timespec prev_ts;
+    clock_gettime(CLOCK_MONOTONIC, &prev_ts);
+
+    for (long iter = 0; iterations == 0 || iter < iterations; iter++) {
+        // El simulador terminó o reinició: volver a mapear
+        if (__atomic_load_n(&page->magic, __ATOMIC_ACQUIRE) != IRQ_SHM_MAGIC) {
+            munmap((void *)page, sizeof(irq_shm_page_t));
+            page = map_stats_page(name);
+            if (page == NULL) {
+                fprintf(stderr, "🛑 El simulador finalizó - Página %s no disponible\n", name);
+                return 1;
+            }
+            memset(prev_calls, 0, sizeof(prev_calls));
+        }
+
+        struct timespec now_ts;
+        clock_gettime(CLOCK_MONOTONIC, &now_ts);
+        double elapsed = (now_ts.tv_sec - prev_ts.tv_sec) +
+                         (now_ts.tv_nsec - prev_ts.tv_nsec) / 1e9;
+        prev_ts = now_ts;
+
+        irq_shm_system_t sys;
+        irq_shm_read_system(&page->system, &sys);
+
+        if (!batch) {
+            printf("\033[H\033[2J");
+        }
+        time_t uptime = time(NULL) - (time_t)sys.system_start_time;
+        printf("irqtop - pid %d - %s - uptime %lds - generación %lu\n",
+               page->writer_pid, name, (long)uptime,
+               (unsigned long)__atomic_load_n(&page->generation, __ATOMIC_RELAXED));
+        printf("Total: %lu  Timer: %lu  Teclado: %lu  Personalizadas: %lu  ISR promedio: %.2f μs\n\n",
+               (unsigned long)sys.total_interrupts, (unsigned long)sys.timer_interrupts,
+               (unsigned long)sys.keyboard_interrupts, (unsigned long)sys.custom_interrupts,
+               sys.average_response_time);
+        printf("%-4s %-11s %10s %9s %9s %9s %9s %9s  %-24s %s\n",
+               "IRQ", "Estado", "Llamadas", "IRQs/s", "min μs", "avg μs", "p99 μs", "max μs",
+               "CPUs", "Descripción");
+
+        for (uint32_t i = 0; i < page->num_vectors && i < IRQ_SHM_MAX_VECTORS; i++) {
+            irq_shm_vector_t v;
+            irq_shm_read_vector(&page->vectors[i], &v);
+            if (v.state == 0 && v.call_count == 0) {
+                continue;
+            }
+
+            double rate = 0.0;
+            if (iter > 0 && elapsed > 0 && v.call_count >= prev_calls[i]) {
+                rate = (double)(v.call_count - prev_calls[i]) / elapsed;
+            }
+            prev_calls[i] = v.call_count;
+
+            unsigned long min_us = v.min_execution_time == UINT64_MAX ? 0 : v.min_execution_time;
+            unsigned long avg_us = v.call_count > 0 ? v.total_execution_time / v.call_count : 0;
+            char cpus[64];
+            format_cpu_list(&v, cpus, sizeof(cpus));
+
+            printf("%-4u %-11s %10lu %9.1f %9lu %9lu %9lu %9lu  %-24s %s\n",
+                   i, (v.state >= 0 && v.state <= 2) ? state_names[v.state] : "?",
+                   (unsigned long)v.call_count, rate, min_us, avg_us,
+                   histogram_percentile(&v, 0.99), (unsigned long)v.max_execution_time,
+                   cpus, v.description);
+        }
+        fflush(stdout);
+
+        if (iterations != 0 && iter + 1 >= iterations) {
+            break;
+        }
+        struct timespec delay = {interval_ms / 1000, (interval_ms % 1000) * 1000000L};
+        nanosleep(&delay, NULL);
+    }
+
+    munmap((void *)page, sizeof(irq_shm_page_t));
+    return 0;
+}
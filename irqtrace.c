@@ -0,0 +1,245 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "irq_tracefile.h"
+
+// irqtrace - Lector y motor de consultas de capturas de traza
+//
+// Acepta directorios de captura o ficheros de chunk sueltos. Los filtros
+// (rango de tiempo, IRQs, CPUs, categoría, tipo) se resuelven primero contra
+// el índice de cada chunk: sólo se descomprimen los bloques que pueden
+// contener eventos que los cumplan. Se puede consultar una captura en curso:
+// el chunk abierto se recorre por las cabeceras de sus bloques.
+
+#define MAX_CHUNKS 4096
+
+static const char *chunks[MAX_CHUNKS];
+static int chunk_count = 0;
+
+static int add_chunk(const char *path) {
+    if (chunk_count >= MAX_CHUNKS) {
+        fprintf(stderr, "❌ Demasiados chunks (máximo %d)\n", MAX_CHUNKS);
+        return -1;
+    }
+    chunks[chunk_count++] = strdup(path);
+    return 0;
+}
+
+// Un directorio aporta sus chunks en orden; un fichero se toma tal cual
+static int collect_chunks(const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "❌ No existe %s\n", path);
+        return -1;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        return add_chunk(path);
+    }
+
+    int found = 0;
+    for (int n = 1;; n++) {
+        char name[512];
+        snprintf(name, sizeof(name), "%s/" IRQ_TRACEFILE_CHUNK_NAME, path, n);
+        if (access(name, R_OK) != 0) {
+            break;
+        }
+        if (add_chunk(name) < 0) {
+            return -1;
+        }
+        found++;
+    }
+    if (found == 0) {
+        fprintf(stderr, "❌ %s no contiene chunks de captura\n", path);
+        return -1;
+    }
+    return 0;
+}
+
+static void format_time(uint64_t timestamp_ns, char *buffer, size_t size) {
+    time_t seconds = (time_t)(timestamp_ns / 1000000000ULL);
+    struct tm timeinfo;
+    char hms[16];
+    localtime_r(&seconds, &timeinfo);
+    strftime(hms, sizeof(hms), "%H:%M:%S", &timeinfo);
+    snprintf(buffer, size, "%s.%06lu", hms, (unsigned long)(timestamp_ns % 1000000000ULL / 1000));
+}
+
+static void show_usage(const char *prog) {
+    printf("Uso: %s [-s|-l] [-f SEG] [-t SEG] [-i IRQS] [-C CPUS] [-c CATEGORÍA] [-e TIPO] [-x] [-n MAX] CAPTURA...\n", prog);
+    printf("  CAPTURA     Directorio de captura o fichero chunk-NNNNNN.irqt\n");
+    printf("  -f SEG      Desde SEG segundos tras el primer evento (admite decimales)\n");
+    printf("  -t SEG      Hasta SEG segundos tras el primer evento\n");
+    printf("  -i IRQS     Sólo esos vectores (lista separada por comas, -1 = sin IRQ)\n");
+    printf("  -C CPUS     Sólo eventos emitidos en esas CPUs\n");
+    printf("  -c CAT      Sólo esa categoría (HARDWARE, KERNEL, CPU, CUSTOM_ISR...)\n");
+    printf("  -e TIPO     Sólo eventos cuya plantilla contiene TIPO (\"Ejecutando ISR\")\n");
+    printf("  -x          Excluir los eventos del timer\n");
+    printf("  -n MAX      Mostrar como mucho MAX eventos\n");
+    printf("  -s          Sólo el resumen (eventos, bloques leídos y saltados, tiempo)\n");
+    printf("  -l          Listar los tipos de evento (plantillas) de la captura\n");
+    printf("  -h          Mostrar esta ayuda\n");
+    printf("Ejemplo: %s -f 10 -t 10.5 -i 2 -c KERNEL /tmp/captura\n", prog);
+}
+
+// Tipos de evento de todos los chunks, sin repetir
+static void list_templates(void) {
+    printf("%-5s %-14s %s\n", "ID", "CATEGORÍA", "PLANTILLA");
+    static unsigned char seen[IRQ_TRACEFILE_MAX_TEMPLATES];
+    for (int c = 0; c < chunk_count; c++) {
+        irq_tracefile_reader_t *r = irq_tracefile_reader_open(chunks[c], NULL);
+        if (r == NULL) {
+            continue;
+        }
+        int id;
+        const char *fmt;
+        for (int i = 0; irq_tracefile_reader_template(r, i, &id, &fmt); i++) {
+            if (seen[id]) {
+                continue;
+            }
+            seen[id] = 1;
+            char category[32];
+            irq_tracefile_category(fmt, category, sizeof(category));
+            printf("%-5d %-14s %s\n", id, category[0] ? category : "-", fmt);
+        }
+        irq_tracefile_reader_close(r);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    double from_s = -1.0, to_s = -1.0;
+    int summary = 0, list = 0;
+    long max_events = -1;
+    irq_tracefile_query_t query;
+    int opt;
+
+    memset(&query, 0, sizeof(query));
+    while ((opt = getopt(argc, argv, "f:t:i:C:c:e:xn:slh")) != -1) {
+        switch (opt) {
+            case 'f': from_s = atof(optarg); break;
+            case 't': to_s = atof(optarg); break;
+            case 'i':
+            case 'C':
+                if (irq_tracefile_parse_mask(optarg, opt == 'C',
+                                             opt == 'C' ? &query.cpu_mask : &query.irq_mask) < 0) {
+                    fprintf(stderr, "❌ Lista inválida: %s\n", optarg);
+                    return 1;
+                }
+                break;
+            case 'c': snprintf(query.category, sizeof(query.category), "%s", optarg); break;
+            case 'e': snprintf(query.type, sizeof(query.type), "%s", optarg); break;
+            case 'x': query.exclude_flags = IRQ_TRACEFILE_FLAG_TIMER; break;
+            case 'n': max_events = atol(optarg); break;
+            case 's': summary = 1; break;
+            case 'l': list = 1; break;
+            case 'h': show_usage(argv[0]); return 0;
+            default:  show_usage(argv[0]); return 1;
+        }
+    }
+    if (optind >= argc) {
+        show_usage(argv[0]);
+        return 1;
+    }
+    for (int i = optind; i < argc; i++) {
+        if (collect_chunks(argv[i]) < 0) {
+            return 1;
+        }
+    }
+    if (list) {
+        list_templates();
+        return 0;
+    }
+
+    // Origen de los tiempos relativos: la primera marca de la captura
+    uint64_t origin = 0, last = 0;
+    for (int c = 0; c < chunk_count; c++) {
+        irq_tracefile_reader_t *r = irq_tracefile_reader_open(chunks[c], NULL);
+        if (r == NULL) {
+            fprintf(stderr, "❌ %s no es un chunk de captura válido (¿versión %d?)\n",
+                    chunks[c], IRQ_TRACEFILE_VERSION);
+            return 1;
+        }
+        uint64_t first_ns, last_ns;
+        irq_tracefile_reader_span(r, &first_ns, &last_ns);
+        if (first_ns != 0 && (origin == 0 || first_ns < origin)) {
+            origin = first_ns;
+        }
+        if (last_ns > last) {
+            last = last_ns;
+        }
+        irq_tracefile_reader_close(r);
+    }
+    query.from_ns = from_s >= 0 ? origin + (uint64_t)(from_s * 1e9) : 0;
+    query.to_ns = to_s >= 0 ? origin + (uint64_t)(to_s * 1e9) : 0;
+
+    struct timespec started, finished;
+    clock_gettime(CLOCK_MONOTONIC, &started);
+    irq_tracefile_stats_t total = {0};
+    unsigned long decoded = 0, skipped = 0, shown = 0, indexed = 0;
+    int status = 0;
+    for (int c = 0; c < chunk_count && (max_events < 0 || (long)shown < max_events); c++) {
+        irq_tracefile_reader_t *r = irq_tracefile_reader_open(chunks[c], &query);
+        if (r == NULL) {
+            fprintf(stderr, "❌ No se pudo abrir %s\n", chunks[c]);
+            return 1;
+        }
+
+        irq_tracefile_event_t ev;
+        int result = 0;
+        while ((max_events < 0 || (long)shown < max_events) && (result = irq_tracefile_next(r, &ev)) > 0) {
+            shown++;
+            if (summary) {
+                continue;
+            }
+            char timestamp[32], text[1024], cpu[24] = "";
+            format_time(ev.timestamp_ns, timestamp, sizeof(timestamp));
+            irq_tracefile_render(&ev, text, sizeof(text));
+            if (ev.cpu >= 0) {
+                snprintf(cpu, sizeof(cpu), "[CPU%d] ", ev.cpu);
+            }
+            if (ev.irq >= 0) {
+                printf("[%s] %s[IRQ%d] %s\n", timestamp, cpu, ev.irq, text);
+            } else {
+                printf("[%s] %s%s\n", timestamp, cpu, text);
+            }
+        }
+        if (result < 0) {
+            fprintf(stderr, "❌ %s: bloque corrupto, se omite el resto del chunk\n", chunks[c]);
+            status = 2;
+        }
+
+        unsigned long chunk_decoded, chunk_skipped;
+        irq_tracefile_stats_t st;
+        irq_tracefile_reader_stats(r, &chunk_decoded, &chunk_skipped, &st);
+        decoded += chunk_decoded;
+        skipped += chunk_skipped;
+        indexed += (unsigned long)irq_tracefile_reader_indexed(r);
+        total.chunks += st.chunks;
+        total.blocks += st.blocks;
+        total.events += st.events;
+        total.file_bytes += st.file_bytes;
+        total.raw_bytes += st.raw_bytes;
+        irq_tracefile_reader_close(r);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &finished);
+
+    if (summary) {
+        printf("=== CAPTURA ===\n");
+        printf("Chunks: %lu (%lu con índice) │ Bloques: %lu │ Eventos: %lu\n",
+               total.chunks, indexed, total.blocks, total.events);
+        printf("Disco: %.1f KB │ %.2f bytes/evento │ Duración: %.2f s\n",
+               total.file_bytes / 1024.0,
+               total.events > 0 ? (double)total.file_bytes / total.events : 0.0,
+               last > origin ? (last - origin) / 1e9 : 0.0);
+        printf("Consulta: %lu eventos │ %lu bloques descomprimidos │ %lu saltados por el índice │ %.2f ms\n",
+               shown, decoded, skipped,
+               (finished.tv_sec - started.tv_sec) * 1e3 + (finished.tv_nsec - started.tv_nsec) / 1e6);
+    }
+    for (int c = 0; c < chunk_count; c++) {
+        free((void *)chunks[c]);
+    }
+    return status;
+}
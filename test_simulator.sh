@@ -174,29 +174,25 @@ EOF
 test_concurrency() {
     print_status "INFO" "Ejecutando pruebas de concurrencia..."
     
-    # Crear script que pruebe múltiples interrupciones
-    # 5 = generar múltiples interrupciones de prueba
-    # 0 = salir
-    cat > concurrency_test.txt << EOF
-5
-0
-EOF
+    # Despachadores, registro/desregistro y lectores de la traza a la vez
+    ( echo; sleep 5; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > concurrency_sim_output.log 2>&1 &
+    local sim_pid=$!
     
-    timeout 15s ./interrupt_simulator < concurrency_test.txt > concurrency_output.log 2>&1
-    local exit_code=$?
+    sleep 1
+    ./irqctl 'LOG silent' 'STRESS threads=4 readers=2 seconds=2' > concurrency_output.log 2>&1
+    wait $sim_pid
     
-    if [ $exit_code -eq 0 ] || [ $exit_code -eq 124 ]; then
-        if grep -q "DESPACHANDO IRQ" concurrency_output.log && \
-           grep -q "FINALIZANDO IRQ" concurrency_output.log; then
-            print_status "PASS" "Manejo de concurrencia operativo"
-        else
-            print_status "FAIL" "Problemas en manejo de concurrencia"
-        fi
+    local result=$(grep -m1 "^OK threads=" concurrency_output.log)
+    if echo "$result" | awk '{ for (i = 1; i <= NF; i++) { split($i, kv, "="); v[kv[1]] = kv[2] }
+           exit !(v["threads"] == 4 && v["violations"] == 0 && v["dispatches"] > 1000 &&
+                  v["executed"] > 0 && v["registrations"] > 0 && v["reads"] > 0 && v["ops_per_s"] > 0) }'; then
+        print_status "PASS" "Manejo de concurrencia operativo ($(echo "$result" | sed 's/.*ops_per_s=\([0-9]*\).*/\1/') ops/s, sin violaciones)"
     else
-        print_status "FAIL" "Error en pruebas de concurrencia"
+        print_status "FAIL" "Problemas en manejo de concurrencia"
     fi
     
-    rm -f concurrency_test.txt concurrency_output.log
+    rm -f concurrency_sim_output.log concurrency_output.log
 }
 
 # Función para verificar sintaxis del código
@@ -329,6 +325,1005 @@ EOF
     rm -f trace_test.txt trace_output.log
 }
 
+# Función para probar la página de estadísticas compartida (irqtop)
+test_shared_stats() {
+    print_status "INFO" "Probando estadísticas en memoria compartida..."
+    
+    if [ ! -x "./irqtop" ]; then
+        print_status "FAIL" "Lector irqtop no compilado"
+        return 1
+    fi
+    
+    # Mantener el simulador vivo mientras irqtop lee la página
+    # Enter = continuar, 1 + 1 = disparar IRQ de teclado, 0 = salir
+    ( echo; echo 1; echo 1; echo; sleep 3; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > shm_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1.5
+    ./irqtop -1 > shm_output.log 2>&1
+    local exit_code=$?
+    wait $sim_pid
+    
+    if [ $exit_code -eq 0 ] && \
+       grep -q "Controlador de teclado" shm_output.log && \
+       grep -q "Teclado: 1" shm_output.log; then
+        print_status "PASS" "Página de estadísticas legible desde irqtop"
+    else
+        print_status "FAIL" "irqtop no pudo leer la página de estadísticas"
+    fi
+    
+    rm -f shm_sim_output.log shm_output.log
+}
+
+# Función para probar el anillo de inyección externa (irqinject)
+test_injection_ring() {
+    print_status "INFO" "Probando anillo de inyección en memoria compartida..."
+    
+    if [ ! -x "./irqinject" ]; then
+        print_status "FAIL" "Generador irqinject no compilado"
+        return 1
+    fi
+    
+    # 7 = estadísticas tras drenar el anillo, 0 = salir
+    ( echo; sleep 8; echo 7; echo; echo 0 ) | \
+        timeout 20s ./interrupt_simulator > inject_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    local ring_mode=$(stat -c %a /dev/shm/irqsim_inject 2>/dev/null)
+    # Una segunda instancia no debe apropiarse del anillo de la primera
+    ( echo; echo 0 ) | timeout 10s ./interrupt_simulator > inject_second_output.log 2>&1
+    ./irqinject -q 1 -n 10 -b 5 > inject_client.log 2>&1
+    local exit_code=$?
+    wait $sim_pid
+    
+    if [ $exit_code -eq 0 ] && \
+       grep -q "Inyectadas 10 interrupciones" inject_client.log && \
+       grep -a "Inyectadas externamente" inject_output.log | grep -q " 10 "; then
+        print_status "PASS" "Interrupciones inyectadas desde otro proceso despachadas"
+    else
+        print_status "FAIL" "El anillo de inyección no entregó las interrupciones"
+    fi
+    
+    if grep -q "Anillo de inyección no disponible" inject_second_output.log && [ "$ring_mode" = "600" ]; then
+        print_status "PASS" "Anillo privado (modo $ring_mode) y no reutilizado por otra instancia"
+    else
+        print_status "FAIL" "Anillo de inyección: modo '$ring_mode' o tomado por la segunda instancia"
+    fi
+    
+    rm -f inject_output.log inject_client.log inject_second_output.log
+}
+
+# Función para probar las fuentes de hardware reales (epoll)
+test_fd_sources() {
+    print_status "INFO" "Probando fuentes de hardware reales (epoll)..."
+    
+    # 10 = herramientas avanzadas, 1 = fuentes reales
+    # 2 + 1 = eventfd en IRQ1, 5 + 1 + 3 = tres pokes, 1 = listar
+    printf '\n10\n1\n2\n1\n5\n1\n3\n' > fd_test.txt
+    ( cat fd_test.txt; sleep 1; printf '1\n0\n0\n0\n' ) | \
+        timeout 15s ./interrupt_simulator > fd_output.log 2>&1
+    local exit_code=$?
+    
+    if [ $exit_code -eq 0 ] && \
+       grep -a "eventfd      │" fd_output.log | grep -q "│        3 │"; then
+        print_status "PASS" "Pokes del eventfd convertidos en IRQs"
+    else
+        print_status "FAIL" "El controlador epoll no disparó las IRQs"
+    fi
+    
+    # Pipe cuyo otro extremo cierra: se desconecta en lugar de girar en epoll,
+    # y los disparos sin ISR no cuentan para la latencia media
+    cat > fd_hup_test.c << 'EOF'
+#define _GNU_SOURCE
+#include "irq_fd_source.h"
+
+static void isr(int irq) { (void)irq; }
+
+static long cpu_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000L + ts.tv_nsec / 1000000L;
+}
+
+int main(void) {
+    int p[2];
+    fd_source_info_t a, b;
+    init_idt();
+    init_system_stats();
+    set_log_level(LOG_LEVEL_SILENT);
+    register_isr(5, isr, "pipe");
+    if (pipe(p) != 0 || fd_source_attach(5, p[0], FD_SOURCE_STREAM, 1, "pipe") != SUCCESS ||
+        fd_source_create_eventfd(6) != SUCCESS) {
+        return 1;
+    }
+    if (write(p[1], "x", 1) != 1 || fd_source_poke(6, 1) != SUCCESS) {
+        return 1;
+    }
+    usleep(200000);
+    close(p[1]);
+    usleep(100000);
+    long start = cpu_ms();
+    usleep(500000);
+    long spent = cpu_ms() - start;
+    int detached = fd_source_get_info(5, &a) != SUCCESS;
+    fd_source_get_info(6, &b);
+    fd_controller_stop();
+    printf("detached=%d cpu_ms=%ld raises=%lu samples=%lu noisr_raises=%lu noisr_samples=%lu\n",
+           detached, spent, a.raises, a.latency_samples, b.raises, b.latency_samples);
+    return 0;
+}
+EOF
+    local hup_out=""
+    if gcc -Wall -Wextra -std=c99 -pthread -D_POSIX_C_SOURCE=200809L fd_hup_test.c libirqsim.a \
+           -lrt -ldl -lm -o fd_hup_test > fd_hup_build.log 2>&1; then
+        hup_out=$(./fd_hup_test 2>&1 | tail -n1)
+    fi
+    if echo "$hup_out" | grep -qE "^detached=1 cpu_ms=[0-9]{1,2} raises=1 samples=1 noisr_raises=1 noisr_samples=0$"; then
+        print_status "PASS" "Fuente cerrada desconectada sin girar; latencia sólo de ISRs ejecutadas"
+    else
+        print_status "FAIL" "Cierre de fuente: '$hup_out' $(head -n3 fd_hup_build.log)"
+    fi
+    
+    rm -f fd_test.txt fd_output.log fd_hup_test.c fd_hup_test fd_hup_build.log
+}
+
+# Función para probar el plano de control por socket Unix
+test_control_plane() {
+    print_status "INFO" "Probando plano de control por socket Unix..."
+    
+    if [ ! -x "./irqctl" ]; then
+        print_status "FAIL" "Cliente irqctl no compilado"
+        return 1
+    fi
+    
+    ( echo; sleep 3; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > ctl_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    # Todos los comandos viajan en una sola ráfaga
+    printf 'PING\nREG 5 custom Sensor remoto\nRAISE 5 3\nBURST 4 5\nAFFINITY 5 1\nSTATS 5\nRAISE 99\n' | \
+        ./irqctl > ctl_output.log 2>&1
+    wait $sim_pid
+    
+    if grep -q "OK PONG" ctl_output.log && \
+       grep -q "OK raised=4" ctl_output.log && \
+       grep "OK irq=5" ctl_output.log | grep -q "calls=7 .*affinity=1" && \
+       grep -q "^ERR -1 " ctl_output.log; then
+        print_status "PASS" "Comandos encadenados ejecutados en un solo viaje"
+    else
+        print_status "FAIL" "El plano de control no respondió como se esperaba"
+    fi
+    
+    # Una segunda instancia no se queda con el socket de la primera
+    # (su parada espera al tick del timer: la primera vive más)
+    ( echo; sleep 6; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > ctl_sim_output.log 2>&1 &
+    sim_pid=$!
+    sleep 1
+    ( echo; echo 0 ) | timeout 15s ./interrupt_simulator > ctl_second_output.log 2>&1
+    ./irqctl 'PING' > ctl_output.log 2>&1
+    wait $sim_pid
+    
+    if grep -q "Plano de control no disponible" ctl_second_output.log && grep -q "OK PONG" ctl_output.log; then
+        print_status "PASS" "Socket de control ocupado respetado por una segunda instancia"
+    else
+        print_status "FAIL" "La segunda instancia tomó o rompió el socket de control"
+    fi
+    
+    rm -f ctl_sim_output.log ctl_output.log ctl_second_output.log
+}
+
+# Función para probar los plugins de ISR cargados con dlopen
+test_isr_plugins() {
+    print_status "INFO" "Probando plugins de ISR (dlopen)..."
+    
+    if [ ! -f "./irq_plugin_sample.so" ] || [ ! -x "./irqctl" ]; then
+        print_status "FAIL" "Plugin de ejemplo o irqctl no compilados"
+        return 1
+    fi
+    
+    ( echo; sleep 3; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > plugin_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    ./irqctl 'PLUGIN LOAD ./irq_plugin_sample.so' 'PLUGIN ATTACH 5 sample/noop' \
+        'PLUGIN ATTACH 6 spurious' 'RAISE 5 4' 'RAISE 6 2' \
+        'PLUGIN STATS 5' 'PLUGIN STATS 6' > plugin_output.log 2>&1
+    wait $sim_pid
+    
+    if grep -q "^OK id=" plugin_output.log && \
+       grep -q "handler=sample/noop calls=4 unhandled=0" plugin_output.log && \
+       grep -q "handler=sample/spurious calls=2 unhandled=2" plugin_output.log; then
+        print_status "PASS" "Handlers de plugin enlazados y medidos por vector"
+    else
+        print_status "FAIL" "El cargador de plugins no ejecutó los handlers"
+    fi
+    
+    # Plugin de una versión menor posterior: descriptor y handlers más grandes
+    cat > plugin_future.c << 'EOF'
+#include "irq_plugin_abi.h"
+
+typedef struct { irq_plugin_handler_t v1; long extra[3]; } future_handler_t;
+typedef struct { irq_plugin_descriptor_t v1; long extra[2]; } future_descriptor_t;
+
+static int top(int irq, void *ctx) { (void)irq; (void)ctx; return IRQ_PLUGIN_HANDLED; }
+
+static const future_handler_t handlers[] = {
+    {{sizeof(future_handler_t), "a", "", top, 0, 0, 0}, {0, 0, 0}},
+    {{sizeof(future_handler_t), "b", "", top, 0, 0, 0}, {0, 0, 0}}
+};
+
+__attribute__((visibility("default"))) const future_descriptor_t irq_plugin_descriptor = {
+    {IRQ_PLUGIN_ABI_VERSION + 1, sizeof(future_descriptor_t), "future", 0, 0, 2,
+     (const irq_plugin_handler_t *)handlers}, {0, 0}
+};
+EOF
+    gcc -Wall -Wextra -std=c99 -fPIC -shared plugin_future.c -o plugin_future.so > /dev/null 2>&1
+    
+    ( echo; sleep 3; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > plugin_sim_output.log 2>&1 &
+    sim_pid=$!
+    
+    sleep 1
+    ./irqctl 'PLUGIN LOAD ./plugin_future.so' 'PLUGIN ATTACH 7 future/b' 'RAISE 7 3' \
+        'PLUGIN STATS 7' > plugin_output.log 2>&1
+    wait $sim_pid
+    
+    if grep -q "handler=future/b calls=3" plugin_output.log; then
+        print_status "PASS" "Plugin con estructuras de una versión menor posterior"
+    else
+        print_status "FAIL" "Plugin de versión menor posterior rechazado o mal indexado"
+    fi
+    
+    rm -f plugin_sim_output.log plugin_output.log plugin_future.c plugin_future.so
+}
+
+# Función para probar la detección de tormentas de interrupciones
+test_interrupt_storms() {
+    print_status "INFO" "Probando detección de tormentas de interrupciones..."
+    
+    ( echo; sleep 3; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > storm_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    # IRQ 9 sin handler: inundación que nadie reclama
+    ./irqctl 'LOG silent' 'RAISE 9 200' 'STORM 9' > storm_output.log 2>&1
+    # El límite por tasa solo se aplica si se pide: IRQ 10 sin límite por defecto
+    ./irqctl 'STORM 10' 'STORM 10 20' 'RAISE 10 100' 'STORM 10' > storm_rate_output.log 2>&1
+    wait $sim_pid
+    
+    if grep -q "masked=1 storms=1 episodes=1 shed=[1-9][0-9]* reason=sin atender" storm_output.log; then
+        print_status "PASS" "Inundación detectada y vector enmascarado"
+    else
+        print_status "FAIL" "La tormenta no fue detectada"
+    fi
+    
+    if head -n1 storm_rate_output.log | grep -q "limit=0 masked=0 storms=0" && \
+       tail -n1 storm_rate_output.log | grep -q "limit=20 masked=1 storms=1 .*reason=tasa"; then
+        print_status "PASS" "Límite por tasa desactivado por defecto y activable con STORM"
+    else
+        print_status "FAIL" "Límite por tasa: $(tr '\n' ' ' < storm_rate_output.log)"
+    fi
+    
+    rm -f storm_sim_output.log storm_output.log storm_rate_output.log
+}
+
+# Función para probar presupuestos de ejecución, watchdog y degradación a hilo
+test_isr_budgets() {
+    print_status "INFO" "Probando presupuestos de ISR y watchdog..."
+    
+    ( echo; sleep 3; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > budget_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    # custom_isr tarda 75 ms: viola un presupuesto de 1 ms y un límite de 20 ms
+    ./irqctl 'LOG silent' 'REG 5 custom' 'BUDGET 5 1000 20000 1' 'RAISE 5 5' > /dev/null 2>&1
+    sleep 0.5
+    ./irqctl 'BUDGET 5' > budget_output.log 2>&1
+    wait $sim_pid
+    
+    if grep -q "threaded=1 runs=5 violations=5 stalls=5 deferred=2" budget_output.log; then
+        print_status "PASS" "Violaciones contadas, watchdog activo y handler degradado a hilo"
+    else
+        print_status "FAIL" "Presupuestos o watchdog no se comportaron como se esperaba"
+    fi
+    
+    rm -f budget_sim_output.log budget_output.log
+}
+
+# Función para probar handlers cooperativos (corrutinas)
+test_coroutine_isrs() {
+    print_status "INFO" "Probando ISRs cooperativas con corrutinas..."
+    
+    ( echo; sleep 3; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > coro_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    # 200 ISRs de 75 ms bloqueantes tardarían 15 s; cooperativas se solapan
+    ./irqctl 'LOG silent' 'REG 5 custom' 'CORO 5 1' 'RAISE 5 200' > /dev/null 2>&1
+    sleep 0.5
+    ./irqctl 'CORO 5' 'UNREG 5' > coro_output.log 2>&1
+    wait $sim_pid
+    
+    if grep -q "coro=1 spawned=200 completed=200 in_flight=0" coro_output.log && \
+       grep -q "^OK$" coro_output.log; then
+        print_status "PASS" "200 ISRs completadas en paralelo sobre pocos hilos"
+    else
+        print_status "FAIL" "Las corrutinas no completaron la ráfaga a tiempo"
+    fi
+    
+    rm -f coro_sim_output.log coro_output.log
+}
+
+# Función para probar el pool de trabajo diferido con robo de trabajo
+test_work_stealing_pool() {
+    print_status "INFO" "Probando pool de trabajo diferido..."
+    
+    ( echo; sleep 3; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > workq_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    ./irqctl 'WORKQ 3' 'WORKQ BENCH 2000' 'WORKQ' > workq_output.log 2>&1
+    wait $sim_pid
+    
+    local items=$(sed -n 's/^OK items=\([0-9]*\).*/\1/p' workq_output.log)
+    if grep -q "^OK workers=3 .*executed=${items:-x} inline=0 pending=0" workq_output.log; then
+        print_status "PASS" "Carga en ráfagas completada por 3 hilos ($items trabajos)"
+    else
+        print_status "FAIL" "El pool no completó la carga"
+    fi
+    
+    rm -f workq_sim_output.log workq_output.log
+}
+
+# Función para probar el balanceador de IRQs entre CPUs simuladas
+test_irq_balancer() {
+    print_status "INFO" "Probando balanceador de IRQs..."
+    
+    ( echo; sleep 3; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > balance_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    # Tres vectores ocupados apilados en la CPU 0 de un sistema con 2 CPUs
+    ./irqctl 'LOG silent' 'BALANCE CONFIG 2 100 10' 'BALANCE 1' \
+        'REG 3 custom' 'REG 4 custom' 'REG 5 custom' \
+        'AFFINITY 3 0' 'AFFINITY 4 0' 'AFFINITY 5 0' 'BURST 12 3,4,5' > /dev/null 2>&1
+    ./irqctl 'BALANCE' 'BALANCE BENCH 1' > balance_output.log 2>&1
+    wait $sim_pid
+    
+    local migrations=$(sed -n 's/^OK enabled=1 .* migrations=\([0-9]*\) .*/\1/p' balance_output.log)
+    if [ "${migrations:-0}" -ge 1 ] && \
+       awk '/^OK off_p50/ { split($3, off, "="); split($7, on, "="); exit !(on[2] < off[2]) }' balance_output.log; then
+        print_status "PASS" "Vectores migrados ($migrations) y p99 menor con balanceo"
+    else
+        print_status "FAIL" "El balanceador no migró vectores o no redujo la latencia"
+    fi
+    
+    rm -f balance_sim_output.log balance_output.log
+}
+
+# Función para probar dispositivos multicola con reparto RSS
+test_msix_queues() {
+    print_status "INFO" "Probando vectores MSI-X y reparto RSS..."
+    
+    ( echo; sleep 3; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > msix_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    # Vector de verificación de la especificación RSS (TCP/IPv4)
+    ./irqctl 'MSIX HASH 66.9.149.187 161.142.100.80 2794 1766' 'LOG silent' \
+        'MSIX CREATE nic0 4' 'MSIX SEND 0 200 64' 'MSIX STATS 0' > msix_output.log 2>&1
+    wait $sim_pid
+    
+    local steered=$(sed -n 's/^OK q=.* steered=\([0-9]*\) .*/\1/p' msix_output.log | \
+        awk '{ sum += $1 } END { print sum + 0 }')
+    local used=$(grep -c "^OK q=.* steered=[1-9]" msix_output.log)
+    if grep -q "hash=0x51ccc178" msix_output.log && [ "${steered:-0}" -eq 200 ] && [ "$used" -ge 3 ]; then
+        print_status "PASS" "Hash Toeplitz correcto y 200 paquetes repartidos en $used colas"
+    else
+        print_status "FAIL" "El reparto multicola no funcionó como se esperaba"
+    fi
+    
+    rm -f msix_sim_output.log msix_output.log
+}
+
+test_device_models() {
+    print_status "INFO" "Probando modelos de dispositivo con anillos DMA..."
+    
+    ( echo; sleep 3; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > device_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    ./irqctl 'LOG silent' 'DEV CREATE nic 20000 256' 'DEV CREATE block 0 64' > device_output.log 2>&1
+    sleep 1
+    ./irqctl 'DEV STATS 0' 'DEV STATS 1' 'DEV DESTROY 1' >> device_output.log 2>&1
+    wait $sim_pid
+    
+    local consumed=$(grep -c "^OK dev=.* consumed=[1-9].* invalid=0 " device_output.log)
+    if [ "$consumed" -eq 2 ] && grep -q "^OK dev=0 model=nic" device_output.log; then
+        print_status "PASS" "Los dispositivos nic y block entregaron datos válidos por los anillos"
+    else
+        print_status "FAIL" "Los dispositivos no entregaron datos válidos"
+    fi
+    
+    rm -f device_sim_output.log device_output.log
+}
+
+test_zero_alloc_dispatch() {
+    print_status "INFO" "Probando que el despacho no reserva memoria del heap..."
+    
+    if [ ! -f "irq_alloc_probe.so" ]; then
+        print_status "FAIL" "Sonda de reservas no compilada (make irq_alloc_probe.so)"
+        return
+    fi
+    
+    ( echo; sleep 3; echo 0 ) | LD_PRELOAD=./irq_alloc_probe.so \
+        timeout 15s ./interrupt_simulator > alloc_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    ./irqctl 'LOG silent' 'ALLOC CHECK 2000' 'ALLOC' > alloc_output.log 2>&1
+    # Dos comprobaciones a la vez desde conexiones distintas
+    ./irqctl 'ALLOC CHECK 1000' > alloc_parallel.log 2>&1 &
+    local check_pid=$!
+    ./irqctl 'ALLOC CHECK 1000' >> alloc_output.log 2>&1
+    wait $check_pid
+    wait $sim_pid
+    
+    if grep -q "^OK dispatches=2000 mallocs=0$" alloc_output.log && \
+       grep -q "^OK slab=irq_work .* live=0 " alloc_output.log; then
+        print_status "PASS" "2000 despachos con trabajo diferido sin llamadas a malloc"
+    else
+        print_status "FAIL" "El despacho reservó memoria: $(grep dispatches= alloc_output.log)"
+    fi
+    
+    if grep -q "^OK dispatches=1000 mallocs=0$" alloc_output.log && \
+       grep -q "^OK dispatches=1000 mallocs=0$" alloc_parallel.log; then
+        print_status "PASS" "Comprobaciones concurrentes serializadas sin interferencias"
+    else
+        print_status "FAIL" "Comprobaciones concurrentes: $(cat alloc_parallel.log)"
+    fi
+    
+    rm -f alloc_sim_output.log alloc_output.log alloc_parallel.log
+}
+
+test_compact_trace() {
+    print_status "INFO" "Probando la traza compacta..."
+    
+    ( echo; sleep 3; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > ctrace_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    ./irqctl 'LOG silent' 'DEV CREATE serial 2000' > /dev/null 2>&1
+    sleep 1
+    ./irqctl 'TRACE 1000' 'TRACE STATS' > ctrace_output.log 2>&1
+    wait $sim_pid
+    
+    local executed=$(grep -c "Ejecutando ISR \"Dispositivo serial0\" - Llamada #[0-9]" ctrace_output.log)
+    if grep -q "^OK 1000$" ctrace_output.log && [ "$executed" -ge 50 ] && \
+       grep -q "^OK emitted=.* capacity=1024 record_bytes=32 " ctrace_output.log; then
+        print_status "PASS" "1000 entradas reconstruidas desde registros de 32 bytes"
+    else
+        print_status "FAIL" "La traza compacta no conservó el historial esperado"
+    fi
+    
+    # Muchos despachos seguidos no deben agotar el anillo de texto, y un %lu
+    # que no cabe en 32 bits se conserva entero
+    cat > ctrace_test.c << 'EOF'
+#define _GNU_SOURCE
+#include "interrupt_simulator.h"
+
+static void isr(int irq) { (void)irq; }
+
+int main(void) {
+    static trace_entry_t entries[MAX_TRACE_LINES];
+    int lost = 0, last = 0, big = 0;
+    init_idt();
+    init_system_stats();
+    set_log_level(LOG_LEVEL_SILENT);
+    register_isr(5, isr, "Disco de prueba");
+    for (int i = 0; i < 300; i++) {
+        dispatch_interrupt(5);
+    }
+    add_trace_smartf(-1, 0, "valores %lu %ld", 5000000000UL, -5000000000L);
+    int count = copy_recent_traces(entries, MAX_TRACE_LINES);
+    for (int i = 0; i < count; i++) {
+        lost += strstr(entries[i].event, "texto sobrescrito") != NULL;
+        last += strstr(entries[i].event, "Ejecutando ISR \"Disco de prueba\" - Llamada #300 ") != NULL;
+        big += strcmp(entries[i].event, "valores 5000000000 -5000000000") == 0;
+    }
+    printf("entries=%d lost=%d last=%d big=%d\n", count, lost, last, big);
+    return 0;
+}
+EOF
+    local ctrace_out=""
+    if gcc -Wall -Wextra -std=c99 -pthread -D_POSIX_C_SOURCE=200809L ctrace_test.c libirqsim.a \
+           -lrt -ldl -lm -o ctrace_test > ctrace_build.log 2>&1; then
+        ctrace_out=$(./ctrace_test 2>&1 | tail -n1)
+    fi
+    if [ "$ctrace_out" = "entries=1024 lost=0 last=1 big=1" ]; then
+        print_status "PASS" "300 despachos sin textos sobrescritos y argumentos de 64 bits exactos"
+    else
+        print_status "FAIL" "Anillo de texto: '$ctrace_out' $(head -n3 ctrace_build.log)"
+    fi
+    
+    rm -f ctrace_sim_output.log ctrace_output.log ctrace_test.c ctrace_test ctrace_build.log
+}
+
+# Función para probar la captura comprimida de la traza y su lectura
+test_trace_capture() {
+    print_status "INFO" "Probando la captura de traza a disco..."
+    
+    local cap_dir="/tmp/irqsim_capture_test_$$"
+    rm -rf "$cap_dir"
+    ( echo; sleep 4; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > capture_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    ./irqctl 'LOG silent' "CAPTURE START $cap_dir 64" 'DEV CREATE nic 10000' > /dev/null 2>&1
+    sleep 2.5
+    ./irqctl 'CAPTURE STOP' > capture_output.log 2>&1
+    wait $sim_pid
+    
+    ./irqtrace -s "$cap_dir" > capture_summary.log 2>&1
+    ./irqtrace -s -f 1 -t 1.2 "$cap_dir" > capture_range.log 2>&1
+    local events=$(sed -n 's/.*events=\([0-9]*\).*/\1/p' capture_output.log)
+    local per_event=$(sed -n 's/.*bytes_per_event=\([0-9.]*\).*/\1/p' capture_output.log)
+    local read_back=$(sed -n 's/.*Eventos: \([0-9]*\).*/\1/p' capture_summary.log)
+    local skipped=$(sed -n 's/.* \([0-9]*\) saltados por el índice.*/\1/p' capture_range.log)
+    local chunks=$(ls "$cap_dir" 2>/dev/null | grep -c '^chunk-[0-9]*\.irqt$')
+    
+    if [ -n "$events" ] && [ "$events" -ge 10000 ] && [ "$read_back" = "$events" ] && \
+       [ "$chunks" -ge 2 ] && [ "${skipped:-0}" -ge 1 ] && \
+       awk -v b="$per_event" 'BEGIN { exit !(b > 0 && b < 8) }' && \
+       ./irqtrace -f 1 -t 1.2 -n 5 "$cap_dir" | grep -q "\[IRQ2\] "; then
+        print_status "PASS" "$events eventos a $per_event bytes/evento en $chunks chunks, rango leído por índice"
+    else
+        print_status "FAIL" "La captura no se pudo leer completa o no alcanzó la densidad esperada"
+    fi
+    
+    rm -rf "$cap_dir"
+    rm -f capture_sim_output.log capture_output.log capture_summary.log capture_range.log
+}
+
+test_trace_query() {
+    print_status "INFO" "Probando las consultas sobre la traza..."
+    
+    local cap_dir="/tmp/irqsim_query_test_$$"
+    rm -rf "$cap_dir"
+    ( echo; sleep 5; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > query_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    ./irqctl 'LOG silent' "CAPTURE START $cap_dir 128" 'DEV CREATE nic 10000' > /dev/null 2>&1
+    sleep 1.5
+    ./irqctl 'RAISE 5' > /dev/null 2>&1
+    sleep 1
+    ./irqctl 'QUERY irq=2 cat=KERNEL limit=3' 'QUERY irq=5 src=capture' 'CAPTURE STOP' > query_output.log 2>&1
+    wait $sim_pid
+    
+    ./irqtrace -s -i 5 "$cap_dir" > query_rare.log 2>&1
+    local rare=$(sed -n 's/^Consulta: \([0-9]*\) eventos.*/\1/p' query_rare.log)
+    local decoded=$(sed -n 's/.* \([0-9]*\) bloques descomprimidos.*/\1/p' query_rare.log)
+    local skipped=$(sed -n 's/.* \([0-9]*\) saltados por el índice.*/\1/p' query_rare.log)
+    local kernel=$(./irqtrace -c KERNEL -i 2 -n 50 "$cap_dir" | grep -c "\[IRQ2\] .*KERNEL:")
+    local typed=$(./irqtrace -e "Ejecutando ISR" -n 50 "$cap_dir" | grep -c "Ejecutando ISR")
+    
+    if [ "${rare:-0}" -ge 1 ] && [ "${decoded:-99}" -le 2 ] && [ "${skipped:-0}" -ge 5 ] && \
+       [ "$kernel" -eq 50 ] && [ "$typed" -eq 50 ] && \
+       grep -q "^OK 3 " query_output.log && grep -q "\[IRQ5\] " query_output.log; then
+        print_status "PASS" "IRQ 5 encontrada leyendo $decoded bloques ($skipped saltados); filtros de categoría y QUERY correctos"
+    else
+        print_status "FAIL" "Las consultas no usaron el índice o devolvieron eventos incorrectos"
+    fi
+    
+    rm -rf "$cap_dir"
+    rm -f query_sim_output.log query_output.log query_rare.log
+}
+
+test_dispatch_profile() {
+    print_status "INFO" "Probando el perfil de fases del despacho..."
+    
+    ( echo; sleep 4; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > profile_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    ./irqctl 'LOG silent' 'PROFILE ON' 'DEV CREATE nic 5000' > /dev/null 2>&1
+    sleep 1.5
+    ./irqctl 'PROFILE OFF' 'PROFILE' 'PROFILE 2' > profile_output.log 2>&1
+    sleep 0.5
+    ./irqctl 'PROFILE' > profile_after.log 2>&1
+    wait $sim_pid
+    
+    local line=$(grep -m1 "^OK irq=2 dispatches=.* validate=" profile_output.log)
+    local dispatches=$(echo "$line" | sed -n 's/.*dispatches=\([0-9]*\).*/\1/p')
+    local after=$(sed -n 's/^OK irq=2 dispatches=\([0-9]*\).*/\1/p' profile_after.log)
+    local top=$(echo "$line" | sed -n 's/.* top=\([a-z]*\).*/\1/p')
+    local phases=$(grep -c "^OK phase=" profile_output.log)
+    
+    # Desactivado deja de contar (salvo un despacho en vuelo) y las fases
+    # deben sumar el despacho completo (salvo redondeo)
+    if [ "${dispatches:-0}" -ge 1000 ] && [ "${after:-0}" -le $((dispatches + 2)) ] && [ "$phases" -eq 8 ] && \
+       [ -n "$top" ] && [ "$top" != "handler" ] && \
+       echo "$line" | awk '{ avg = 0; sum = 0
+           for (i = 1; i <= NF; i++) { split($i, kv, "=")
+               if (kv[1] == "avg_ns") avg = kv[2]
+               else if (kv[1] ~ /^(validate|lock|check|trace|state|handler|relock|stats)$/) sum += kv[2] }
+           exit !(avg > 0 && sum > avg * 0.95 && sum < avg * 1.05) }'; then
+        print_status "PASS" "$dispatches despachos desglosados en 8 fases; fuera de la ISR domina: $top"
+    else
+        print_status "FAIL" "El perfil de fases no cuadra con el despacho completo"
+    fi
+    
+    rm -f profile_sim_output.log profile_output.log profile_after.log
+}
+
+test_record_replay() {
+    print_status "INFO" "Probando la grabación y reproducción de cargas..."
+    
+    local rec_file="/tmp/irqsim_replay_test_$$.irqr"
+    ( echo; sleep 5; echo 0 ) | \
+        timeout 15s ./interrupt_simulator > replay_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    ./irqctl 'LOG silent' "RECORD START $rec_file" 'RAISE 3 5' > /dev/null 2>&1
+    sleep 0.5
+    ./irqctl 'BURST 20 4,5' > /dev/null 2>&1
+    sleep 0.5
+    ./irqctl 'RAISE 6' 'RECORD STOP' > replay_record.log 2>&1
+    ./irqctl "REPLAY START $rec_file" > /dev/null 2>&1
+    sleep 1.5
+    ./irqctl 'REPLAY' "REPLAY START $rec_file afap" > replay_exact.log 2>&1
+    sleep 0.5
+    ./irqctl 'REPLAY' > replay_afap.log 2>&1
+    wait $sim_pid
+    
+    local events=$(sed -n 's/^OK recording=0 events=\([0-9]*\).*/\1/p' replay_record.log)
+    local bytes=$(sed -n 's/^OK recording=0 .* bytes=\([0-9]*\).*/\1/p' replay_record.log)
+    local exact=$(grep -m1 "^OK active=0 " replay_exact.log)
+    local afap=$(grep -m1 "^OK active=0 " replay_afap.log)
+    
+    # Tiempos originales: misma duración (±50 ms); sin esperas: mucho menos
+    if [ "$events" = "26" ] && grep -q " ctl=26" replay_record.log && [ "${bytes:-999}" -le $((24 + 26 * 5)) ] && \
+       echo "$exact" | grep -q "replayed=26 " && echo "$afap" | grep -q "replayed=26 " && \
+       echo "$exact" | awk '{ for (i = 1; i <= NF; i++) { split($i, kv, "="); v[kv[1]] = kv[2] }
+           d = v["seconds"] - v["recorded_s"]; exit !(v["recorded_s"] > 0.9 && d > -0.05 && d < 0.05) }' && \
+       echo "$afap" | awk '{ for (i = 1; i <= NF; i++) { split($i, kv, "="); v[kv[1]] = kv[2] }
+           exit !(v["seconds"] < v["recorded_s"] / 5) }'; then
+        print_status "PASS" "26 interrupciones en $bytes bytes, reproducidas con su ritmo original y sin esperas"
+    else
+        print_status "FAIL" "La reproducción no respetó la grabación"
+    fi
+    
+    rm -f "$rec_file" replay_sim_output.log replay_record.log replay_exact.log replay_afap.log
+}
+
+# Función para probar el generador de carga sintética
+test_loadgen() {
+    print_status "INFO" "Probando el generador de carga sintética..."
+    
+    ( echo; sleep 7; echo 0 ) | \
+        timeout 20s ./interrupt_simulator > loadgen_sim_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 1
+    ./irqctl 'LOG silent' 'LOADGEN ADD irq=8-11 rate=20000' 'LOADGEN START threads=2 seconds=1' > /dev/null 2>&1
+    sleep 1.5
+    ./irqctl 'LOADGEN' 'LOADGEN ADD irq=8 rate=0' > loadgen_steady.log 2>&1
+    # Sobrecarga: el simulador no sostiene 3M/s y la cola debe verse en la latencia
+    ./irqctl 'LOADGEN CLEAR' 'LOADGEN ADD irq=8,9 rate=3000000 proc=poisson zipf=1' 'LOADGEN START' > /dev/null 2>&1
+    sleep 0.5
+    ./irqctl 'LOADGEN STOP' > loadgen_overload.log 2>&1
+    # Con la tormenta limitando el vector, lo descartado no cuenta como atendido
+    ./irqctl 'STORM 12 2000' 'LOADGEN CLEAR' 'LOADGEN ADD irq=12 rate=20000' \
+             'LOADGEN START threads=1 seconds=1' > /dev/null 2>&1
+    sleep 1.5
+    ./irqctl 'LOADGEN' > loadgen_shed.log 2>&1
+    wait $sim_pid
+    
+    local steady=$(grep -m1 "^OK active=0 " loadgen_steady.log)
+    local overload=$(grep -m1 "^OK active=0 " loadgen_overload.log)
+    local shed=$(grep -m1 "^OK active=0 " loadgen_shed.log)
+    
+    # Ritmo constante: ±10% de lo ofrecido; sobrecarga: p99 desde el plan >> servicio
+    if echo "$steady" | awk '{ for (i = 1; i <= NF; i++) { split($i, kv, "="); v[kv[1]] = kv[2] }
+           exit !(v["rate"] > 18000 && v["rate"] < 22000 && v["sent"] > 18000) }' && \
+       grep -q "^ERR " loadgen_steady.log && \
+       echo "$overload" | awk '{ for (i = 1; i <= NF; i++) { split($i, kv, "="); v[kv[1]] = kv[2] }
+           exit !(v["sent"] > 0 && v["p99_us"] > 100 * v["service_p99_us"] && v["max_behind_us"] > 1000) }' && \
+       echo "$shed" | awk '{ for (i = 1; i <= NF; i++) { split($i, kv, "="); v[kv[1]] = kv[2] }
+           exit !(v["shed"] > 0 && v["sent"] == v["serviced"] + v["deferred"] + v["shed"] &&
+                  v["rate"] < 0.9 * v["offered_rate"]) }'; then
+        print_status "PASS" "Carga constante sostenida y latencia sin omisión coordinada bajo sobrecarga"
+    else
+        print_status "FAIL" "El generador de carga no cumplió la tasa o escondió la cola"
+    fi
+    
+    rm -f loadgen_sim_output.log loadgen_steady.log loadgen_overload.log loadgen_shed.log
+}
+
+# Función para probar el banco de estrés con ThreadSanitizer
+test_thread_sanitizer() {
+    print_status "INFO" "Ejecutando el estrés concurrente con ThreadSanitizer..."
+    
+    if ! echo 'int main(void) { return 0; }' | \
+         gcc -fsanitize=thread -x c - -o /tmp/irqsim_tsan_probe_$$ > /dev/null 2>&1; then
+        print_status "WARN" "El compilador no admite -fsanitize=thread; prueba omitida"
+        return
+    fi
+    rm -f /tmp/irqsim_tsan_probe_$$
+    
+    # make tsan limpia antes de compilar: se hace en una copia
+    local build_dir=$(mktemp -d)
+    cp *.c *.h Makefile "$build_dir"/
+    if ! make -C "$build_dir" tsan > tsan_build.log 2>&1 || grep -q "warning" tsan_build.log; then
+        print_status "FAIL" "La versión con ThreadSanitizer no compila limpia"
+        rm -rf "$build_dir" tsan_build.log
+        return
+    fi
+    
+    ( echo; sleep 8; echo 0 ) | \
+        TSAN_OPTIONS="report_signal_unsafe=0" timeout 30s "$build_dir/interrupt_simulator" > tsan_output.log 2>&1 &
+    local sim_pid=$!
+    
+    sleep 2
+    ./irqctl 'LOG silent' 'STRESS threads=4 readers=2 seconds=2' > tsan_stress.log 2>&1
+    wait $sim_pid
+    
+    if grep -q "violations=0" tsan_stress.log && ! grep -q "WARNING: ThreadSanitizer" tsan_output.log; then
+        print_status "PASS" "Sin carreras de datos bajo estrés concurrente"
+    else
+        print_status "FAIL" "ThreadSanitizer detectó carreras ($(grep -c 'WARNING: ThreadSanitizer' tsan_output.log) avisos)"
+    fi
+    
+    rm -rf "$build_dir" tsan_build.log tsan_output.log tsan_stress.log
+}
+
+# Prueba de barrido de semillas: mismo resultado con uno o varios contextos
+test_seed_sweep() {
+    print_status "INFO" "Barriendo semillas de las suites en paralelo..."
+    
+    ./interrupt_simulator --sweep 2000 --jobs 1 > sweep_serial.log 2>&1
+    local serial_rc=$?
+    # Cada hilo del barrido usa su propio sim_context_t
+    ./interrupt_simulator --sweep 2000 --jobs 16 > sweep_parallel.log 2>&1
+    local parallel_rc=$?
+    local serial=$(grep "^OK seeds=" sweep_serial.log)
+    local parallel=$(grep "^OK seeds=" sweep_parallel.log)
+    
+    if [ $serial_rc -eq 0 ] && [ $parallel_rc -eq 0 ] && \
+       echo "$serial" | grep -q "failed=0" && \
+       [ "$(echo "$serial" | grep -o 'digest=.*')" = "$(echo "$parallel" | grep -o 'digest=.*')" ]; then
+        print_status "PASS" "2000 semillas sin fallos y mismo digest con 1 y 16 contextos en paralelo"
+    else
+        print_status "FAIL" "Barrido de semillas: '$serial' / '$parallel'"
+    fi
+    
+    # Una semilla repetida da el mismo plan y el mismo digest
+    local first=$(./interrupt_simulator --seed 1234 2>&1 | grep -E "^(basic|advanced|OK)")
+    local second=$(./interrupt_simulator --seed 1234 2>&1 | grep -E "^(basic|advanced|OK)")
+    if [ -n "$first" ] && [ "$first" = "$second" ] && echo "$first" | grep -q "^OK seed=1234"; then
+        print_status "PASS" "La semilla 1234 se repite exactamente"
+    else
+        print_status "FAIL" "La semilla 1234 no se repite"
+    fi
+    
+    rm -f sweep_serial.log sweep_parallel.log
+}
+
+test_library() {
+    print_status "INFO" "Probando libirqsim y sus frontends..."
+    
+    if [ ! -f libirqsim.a ] || [ ! -f libirqsim.so ] || [ ! -x irqrun ] || [ ! -x irqbench ]; then
+        print_status "FAIL" "libirqsim o sus frontends no compilados (make all)"
+        return
+    fi
+    
+    # El motor no arrastra el menú
+    if nm -D --defined-only libirqsim.so | grep -qE " (show_menu|main)$"; then
+        print_status "FAIL" "libirqsim.so contiene símbolos del menú"
+    else
+        print_status "PASS" "libirqsim.so sin símbolos del menú"
+    fi
+    
+    # Un programa externo sólo con irqsim.h y la biblioteca compartida
+    cat > embed_test.c << 'EOF'
+#include <stdio.h>
+#include "irqsim.h"
+
+static int hits;
+static void isr(int irq) { hits += irq; }
+
+int main(void) {
+    sim_context_t *ctx = sim_context_create();
+    if (ctx == NULL || sim_register_isr(ctx, 7, isr, "embebida") != SUCCESS) {
+        return 1;
+    }
+    for (int i = 0; i < 1000; i++) {
+        sim_dispatch_interrupt(ctx, 7);
+    }
+    system_stats_t stats;
+    sim_get_stats(ctx, &stats);
+    int running = sim_is_running(ctx);
+    sim_request_stop(ctx);
+    running += sim_is_running(ctx);
+    sim_context_destroy(ctx);
+    printf("hits=%d total=%lu running=%d\n", hits, stats.total_interrupts, running);
+    return 0;
+}
+EOF
+    local embed_out=""
+    if gcc -Wall -Wextra -std=c99 -pthread embed_test.c -L. -lirqsim -o embed_test > embed_build.log 2>&1; then
+        embed_out=$(LD_LIBRARY_PATH=. ./embed_test 2>&1)
+    fi
+    if [ "$embed_out" = "hits=7000 total=1000 running=1" ]; then
+        print_status "PASS" "Programa externo despacha 1000 IRQs con libirqsim.so"
+    else
+        print_status "FAIL" "Programa embebido: '$embed_out' $(head -n3 embed_build.log)"
+    fi
+    
+    # sim_context_t es opaco: la disposición del contexto no forma parte de la API
+    printf '#include "irqsim.h"\nint main(void) { return sim_default()->is_default; }\n' > embed_opaque.c
+    if gcc -std=c99 -pthread -fsyntax-only embed_opaque.c > /dev/null 2>&1; then
+        print_status "FAIL" "irqsim.h expone los campos de sim_context_t"
+    else
+        print_status "PASS" "sim_context_t opaco fuera de la biblioteca"
+    fi
+    
+    # Benchmark en el proceso y el ejecutor sin menú frente al menú
+    local bench=$(./irqbench --mode dynamic --threads 2 --dispatches 20000 2>&1)
+    if echo "$bench" | grep -q "^OK mode=dynamic accounting=locked threads=2 dispatches=40000"; then
+        print_status "PASS" "irqbench: $(echo "$bench" | grep -o 'rate=[^ ]*')"
+    else
+        print_status "FAIL" "irqbench: '$bench'"
+    fi
+    local headless=$(./irqrun --seed 1234 2>&1 | grep "^OK seed=")
+    local menu=$(./interrupt_simulator --seed 1234 2>&1 | grep "^OK seed=")
+    if [ -n "$headless" ] && [ "$headless" = "$menu" ]; then
+        print_status "PASS" "irqrun y el menú dan el mismo resultado para la semilla 1234"
+    else
+        print_status "FAIL" "irqrun '$headless' / menú '$menu'"
+    fi
+    
+    # Sistema completo sin terminal: arranca, atiende el plano de control y para con SIGTERM
+    ./irqrun --serve 30 > irqrun_serve.log 2>&1 &
+    local serve_pid=$!
+    local ctl_out=""
+    for _ in $(seq 1 20); do
+        ctl_out=$(./irqctl PING 2>/dev/null)
+        echo "$ctl_out" | grep -q "^OK" && break
+        sleep 0.25
+    done
+    kill -TERM $serve_pid 2>/dev/null
+    wait $serve_pid
+    local serve_rc=$?
+    if echo "$ctl_out" | grep -q "^OK" && [ $serve_rc -eq 0 ] && grep -q "^OK stopped" irqrun_serve.log; then
+        print_status "PASS" "irqrun --serve responde al plano de control y se detiene con SIGTERM"
+    else
+        print_status "FAIL" "irqrun --serve: ctl='$ctl_out' rc=$serve_rc"
+    fi
+    
+    rm -f embed_test.c embed_test embed_build.log embed_opaque.c irqrun_serve.log
+}
+
+test_static_dispatch() {
+    print_status "INFO" "Comparando el despacho estático con el dinámico..."
+    
+    if [ ! -x irqbench ]; then
+        print_status "FAIL" "irqbench no compilado (make irqbench)"
+        return
+    fi
+    
+    # Mismo layout y mismos contadores en la IDT por los dos caminos
+    local bench=$(./irqbench --mode both --dispatches 50000 2>&1)
+    local dynamic_ns=$(echo "$bench" | grep "^OK mode=dynamic" | grep -o 'ns_per_dispatch=[0-9]*' | cut -d= -f2)
+    local static_ns=$(echo "$bench" | grep "^OK mode=static accounting=atomic " | grep -o 'ns_per_dispatch=[0-9]*' | cut -d= -f2)
+    if [ -n "$dynamic_ns" ] && [ -n "$static_ns" ] && [ "$static_ns" -lt "$dynamic_ns" ]; then
+        print_status "PASS" "Despacho estático ${static_ns} ns frente a ${dynamic_ns} ns ($(echo "$bench" | grep -o 'speedup=[^ ]*'))"
+    else
+        print_status "FAIL" "irqbench --mode both: '$bench'"
+    fi
+    
+    # La validación del layout es de compilación
+    local template='#include "irq_static.h"\nstatic void isr(int irq) { (void)irq; }\n#define LAYOUT(X) %s\nIRQ_STATIC_DEFINE(t, LAYOUT)\nint main(void) { return t_dispatch(3); }\n'
+    local bad_layouts=('X(16, isr, "fuera de rango")' 'X(3, isr, "a") X(3, isr, "b")')
+    local valid=0 rejected=0
+    printf "$template" 'X(3, isr, "válido")' > static_layout_test.c
+    gcc -std=c99 -pthread -fsyntax-only static_layout_test.c > /dev/null 2>&1 && valid=1
+    for layout in "${bad_layouts[@]}"; do
+        printf "$template" "$layout" > static_layout_test.c
+        gcc -std=c99 -pthread -fsyntax-only static_layout_test.c > /dev/null 2>&1 || rejected=$((rejected + 1))
+    done
+    if [ $valid -eq 1 ] && [ $rejected -eq ${#bad_layouts[@]} ]; then
+        print_status "PASS" "Layouts con vectores fuera de rango o repetidos no compilan"
+    else
+        print_status "FAIL" "Layouts estáticos: válido=$valid, $rejected de ${#bad_layouts[@]} inválidos rechazados"
+    fi
+    
+    rm -f static_layout_test.c
+}
+
+test_rt_mode() {
+    print_status "INFO" "Probando el modo tiempo real..."
+    
+    if [ ! -x irqrun ] || [ ! -x irqctl ]; then
+        print_status "FAIL" "irqrun o irqctl no compilados (make all)"
+        return
+    fi
+    
+    if ./irqrun --rt "prio=200" --seed 1 > /dev/null 2>&1; then
+        print_status "FAIL" "--rt acepta una prioridad fuera de rango"
+    else
+        print_status "PASS" "--rt rechaza una especificación inválida"
+    fi
+    
+    # Con privilegios: hilos fijados, SCHED_FIFO y memoria bloqueada
+    ./irqrun --rt "cpus=0 prio=80 lock" --serve 30 > irqrun_rt.log 2>&1 &
+    local serve_pid=$!
+    local status=""
+    for _ in $(seq 1 20); do
+        status=$(./irqctl RT 2>/dev/null | head -n1)
+        echo "$status" | grep -q "^OK" && break
+        sleep 0.25
+    done
+    local jitter=$(./irqctl 'RT JITTER seconds=1 period_us=1000' 2>&1)
+    kill -TERM $serve_pid 2>/dev/null
+    wait $serve_pid
+    
+    if echo "$status" | grep -q "enabled=1 cpu_mask=0x1 prio=80" && echo "$status" | grep -qE "threads=[1-9]"; then
+        print_status "PASS" "RT: $(echo "$status" | grep -oE 'threads=[0-9]+ fifo=[0-9]+ pinned=[0-9]+')"
+    else
+        print_status "FAIL" "RT: '$status'"
+    fi
+    if echo "$jitter" | grep -qE "^OK samples=[1-9]" && echo "$jitter" | grep -q "^OK hist=wakeup count=[1-9]" &&
+       echo "$jitter" | grep -q "^OK hist=dispatch count=[1-9]"; then
+        print_status "PASS" "Jitter: $(echo "$jitter" | grep '^OK hist=wakeup' | grep -oE 'p99_ns=[0-9]+') (SO)"
+    else
+        print_status "FAIL" "RT JITTER: '$jitter'"
+    fi
+    
+    # Sin privilegios: sigue en SCHED_OTHER sin bloquear memoria y lo indica
+    if command -v setpriv > /dev/null 2>&1 && [ "$(id -u)" -eq 0 ]; then
+        cp irqrun /tmp/irqrun_rt_unpriv
+        setpriv --reuid=65534 --regid=65534 --clear-groups --inh-caps=-all \
+            /tmp/irqrun_rt_unpriv --rt "cpus=0 prio=80 lock" --serve 30 > irqrun_rt.log 2>&1 &
+        serve_pid=$!
+        status=""
+        for _ in $(seq 1 20); do
+            status=$(./irqctl RT 2>/dev/null | head -n1)
+            echo "$status" | grep -q "^OK" && break
+            sleep 0.25
+        done
+        kill -TERM $serve_pid 2>/dev/null
+        wait $serve_pid
+        local serve_rc=$?
+        if echo "$status" | grep -q "locked=0 threads=[1-9][0-9]* fifo=0" && [ $serve_rc -eq 0 ]; then
+            print_status "PASS" "Sin privilegios: hilos en SCHED_OTHER y el sistema arranca igual"
+        else
+            print_status "FAIL" "Sin privilegios: '$status' rc=$serve_rc"
+        fi
+        rm -f /tmp/irqrun_rt_unpriv
+    fi
+    
+    rm -f irqrun_rt.log
+}
+
 # Función para generar reporte de pruebas
 generate_report() {
     print_status "INFO" "Generando reporte de pruebas..."
@@ -370,6 +1365,13 @@ cleanup() {
     rm -f concurrency_output.log stress_test.txt stress_output.log
     rm -f valgrind_output.log stats_test.txt stats_output.log
     rm -f trace_test.txt trace_output.log
+    rm -f shm_sim_output.log shm_output.log
+    rm -f inject_output.log inject_client.log inject_second_output.log
+    rm -f fd_test.txt fd_output.log
+    rm -f ctl_sim_output.log ctl_output.log ctl_second_output.log
+    rm -f plugin_sim_output.log plugin_output.log
+    rm -f storm_sim_output.log storm_output.log storm_rate_output.log
+    rm -f budget_sim_output.log budget_output.log
 }
 
 # Función para mostrar ayuda
@@ -492,6 +1494,30 @@ main() {
             test_trace_system
             test_statistics
             test_stress
+            test_shared_stats
+            test_injection_ring
+            test_fd_sources
+            test_control_plane
+            test_isr_plugins
+            test_interrupt_storms
+            test_isr_budgets
+            test_coroutine_isrs
+            test_work_stealing_pool
+            test_irq_balancer
+            test_msix_queues
+            test_device_models
+            test_zero_alloc_dispatch
+            test_compact_trace
+            test_trace_capture
+            test_trace_query
+            test_dispatch_profile
+            test_record_replay
+            test_loadgen
+            test_seed_sweep
+            test_library
+            test_static_dispatch
+            test_rt_mode
+            test_thread_sanitizer
             test_memory_leaks
             ;;
     esac